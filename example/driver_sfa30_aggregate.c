@@ -0,0 +1,431 @@
+/**
+ * Copyright (c) 2015 - present LibDriver All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_sfa30_aggregate.c
+ * @brief     driver sfa30 aggregate source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2023-07-30
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2023/07/30  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#include "driver_sfa30_aggregate.h"
+
+/**
+ * @brief     integer square root
+ * @param[in] x input value
+ * @return    floor of the square root
+ * @note      constant time, one bit per iteration
+ */
+static uint32_t a_sfa30_aggregate_sqrt(uint64_t x)
+{
+    uint64_t res = 0;
+    uint64_t bit = (uint64_t)1 << 62;
+
+    while (bit > x)
+    {
+        bit >>= 2;
+    }
+    while (bit != 0)
+    {
+        if (x >= res + bit)
+        {
+            x -= res + bit;
+            res = (res >> 1) + bit;
+        }
+        else
+        {
+            res >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    return (uint32_t)res;
+}
+
+/**
+ * @brief      compute the statistics of one channel
+ * @param[in]  count samples
+ * @param[in]  sum sum of the raw values
+ * @param[in]  sum_sq sum of the squared raw values
+ * @param[in]  min min raw value
+ * @param[in]  max max raw value
+ * @param[out] *stat pointer to a statistics buffer
+ * @note       the sums are exact, so the variance is (sum_sq - sum^2 / n) / n without
+ *             the cancellation that welford guards against in floating point,
+ *             sum^2 / n is split as (a n + b)^2 / n to stay in 64 bits and its
+ *             remainder is carried into the fraction
+ */
+static void a_sfa30_aggregate_stat(uint32_t count, int64_t sum, uint64_t sum_sq, int16_t min, int16_t max,
+                                   sfa30_aggregate_stat_t *stat)
+{
+    uint64_t n = count;
+    uint64_t mag;
+    uint64_t a;
+    uint64_t b;
+    uint64_t r;
+    uint64_t d;
+    uint64_t var_q16;
+    int64_t t;
+
+    if (count == 0)
+    {
+        stat->min_raw = 0;
+        stat->max_raw = 0;
+        stat->mean_q8 = 0;
+        stat->stddev_q8 = 0;
+
+        return;
+    }
+
+    /* rounded mean */
+    mag = (sum < 0) ? (uint64_t)(-sum) : (uint64_t)sum;
+    stat->mean_q8 = (int32_t)(((mag << 8) + (n / 2)) / n);
+    if (sum < 0)
+    {
+        stat->mean_q8 = -stat->mean_q8;
+    }
+
+    /* population variance in 1 / 65536 raw^2, sum_sq - sum^2 / n = d - r / n */
+    a = mag / n;
+    b = mag % n;
+    r = (b * b) % n;
+    d = sum_sq - ((a * a * n) + (2 * a * b) + ((b * b) / n));
+    t = (int64_t)((d % n) << 16) - (int64_t)(((r << 16) + n - 1) / n);
+    t = (t >= 0) ? (t / (int64_t)n) : -((-t + (int64_t)n - 1) / (int64_t)n);
+    var_q16 = (uint64_t)((int64_t)((d / n) << 16) + t);
+
+    stat->min_raw = min;
+    stat->max_raw = max;
+    stat->stddev_q8 = a_sfa30_aggregate_sqrt(var_q16);
+}
+
+/**
+ * @brief     drop the oldest sample of a sliding window
+ * @param[in] *window pointer to a window structure
+ * @note      a deque front is always the oldest sample it holds
+ */
+static void a_sfa30_aggregate_evict(sfa30_aggregate_window_t *window)
+{
+    uint32_t k;
+    uint32_t tail = window->tail;
+    const sfa30_aggregate_slot_t *ring = window->slot;
+    const sfa30_aggregate_slot_t *slot = &ring[tail & window->mask];
+
+    for (k = 0; k < 6; k++)
+    {
+        if ((window->deque_head[k] != window->deque_tail[k]) &&
+            ((ring[window->deque_tail[k] & window->mask].deque[k] & 0xFFFFU) == (tail & 0xFFFFU)))
+        {
+            window->deque_tail[k]++;
+        }
+    }
+    for (k = 0; k < 3; k++)
+    {
+        window->sum[k] -= slot->raw[k];
+        window->sum_sq[k] -= (uint64_t)((int32_t)slot->raw[k] * slot->raw[k]);
+    }
+    window->tail = tail + 1;
+}
+
+/**
+ * @brief     push a sample to a sliding window
+ * @param[in] *window pointer to a window structure
+ * @param[in] timestamp_ms sample timestamp
+ * @param[in] *raw pointer to the raw values
+ * @note      deques 0 to 2 keep increasing values for the min, 3 to 5 decreasing values for the max
+ */
+static void a_sfa30_aggregate_slide(sfa30_aggregate_window_t *window, uint32_t timestamp_ms, const int16_t *raw)
+{
+    uint32_t c;
+    uint32_t dh;
+    uint32_t dt;
+    uint32_t entry;
+    uint32_t head;
+    uint32_t mask = window->mask;
+    sfa30_aggregate_slot_t *ring = window->slot;
+    sfa30_aggregate_slot_t *slot;
+
+    /* expire the samples that left the window, then make room */
+    while ((window->head != window->tail) &&
+           ((uint32_t)(timestamp_ms - ring[window->tail & mask].timestamp_ms) >= window->length_ms))
+    {
+        a_sfa30_aggregate_evict(window);
+    }
+    if ((window->head - window->tail) > mask)
+    {
+        a_sfa30_aggregate_evict(window);
+        window->evicted++;
+    }
+
+    /* store the sample */
+    head = window->head;
+    slot = &ring[head & mask];
+    slot->timestamp_ms = timestamp_ms;
+    for (c = 0; c < 3; c++)
+    {
+        slot->raw[c] = raw[c];
+        window->sum[c] += raw[c];
+        window->sum_sq[c] += (uint64_t)((int32_t)raw[c] * raw[c]);
+    }
+
+    /* drop the deque entries the new sample dominates, an entry is the value and the low sequence bits */
+    for (c = 0; c < 3; c++)
+    {
+        entry = ((uint32_t)(uint16_t)raw[c] << 16) | (head & 0xFFFFU);
+        dh = window->deque_head[c];
+        dt = window->deque_tail[c];
+        while ((dh != dt) && ((int16_t)(ring[(dh - 1) & mask].deque[c] >> 16) >= raw[c]))
+        {
+            dh--;
+        }
+        ring[dh & mask].deque[c] = entry;
+        window->deque_head[c] = dh + 1;
+        dh = window->deque_head[c + 3];
+        dt = window->deque_tail[c + 3];
+        while ((dh != dt) && ((int16_t)(ring[(dh - 1) & mask].deque[c + 3] >> 16) <= raw[c]))
+        {
+            dh--;
+        }
+        ring[dh & mask].deque[c + 3] = entry;
+        window->deque_head[c + 3] = dh + 1;
+    }
+    window->head = head + 1;
+}
+
+/**
+ * @brief     push a sample to a tumbling window
+ * @param[in] *window pointer to a window structure
+ * @param[in] timestamp_ms sample timestamp
+ * @param[in] *raw pointer to the raw values
+ * @return    1 if the open window closed, else 0
+ * @note      windows without samples are skipped
+ */
+static uint8_t a_sfa30_aggregate_tumble(sfa30_aggregate_window_t *window, uint32_t timestamp_ms, const int16_t *raw)
+{
+    uint32_t c;
+    uint8_t closed = 0;
+    sfa30_aggregate_bucket_t *open = &window->open;
+
+    if ((open->count != 0) && ((uint32_t)(timestamp_ms - open->start_ms) >= window->length_ms))
+    {
+        window->closed = *open;
+        open->count = 0;
+        closed = 1;
+    }
+    if (open->count == 0)
+    {
+        open->start_ms = timestamp_ms - (timestamp_ms % window->length_ms);
+        for (c = 0; c < 3; c++)
+        {
+            open->min[c] = raw[c];
+            open->max[c] = raw[c];
+            open->sum[c] = 0;
+            open->sum_sq[c] = 0;
+        }
+    }
+    for (c = 0; c < 3; c++)
+    {
+        open->min[c] = (raw[c] < open->min[c]) ? raw[c] : open->min[c];
+        open->max[c] = (raw[c] > open->max[c]) ? raw[c] : open->max[c];
+        open->sum[c] += raw[c];
+        open->sum_sq[c] += (uint64_t)((int32_t)raw[c] * raw[c]);
+    }
+    open->count++;
+
+    return closed;
+}
+
+/**
+ * @brief     init the aggregate
+ * @param[in] *aggregate pointer to an sfa30 aggregate structure
+ * @return    status code
+ *            - 0 success
+ *            - 2 aggregate is NULL
+ * @note      add the windows before the first push
+ */
+uint8_t sfa30_aggregate_init(sfa30_aggregate_t *aggregate)
+{
+    if (aggregate == NULL)
+    {
+        return 2;
+    }
+
+    memset(aggregate, 0, sizeof(sfa30_aggregate_t));
+
+    return 0;
+}
+
+/**
+ * @brief      add a window length
+ * @param[in]  *aggregate pointer to an sfa30 aggregate structure
+ * @param[in]  length_ms window length
+ * @param[in]  *slot pointer to a slot ring, NULL for a tumbling only window
+ * @param[in]  capacity slot ring capacity, at least length_ms / period_ms + 1 and at most 65536
+ * @param[out] *index pointer to a window index buffer
+ * @return     status code
+ *             - 0 success
+ *             - 2 aggregate or index is NULL
+ *             - 4 length_ms is 0 or capacity is not a power of two from 2 to 65536
+ *             - 5 windows are full
+ * @note       every window keeps both its tumbling and, with a slot ring, its sliding statistics
+ */
+uint8_t sfa30_aggregate_add_window(sfa30_aggregate_t *aggregate, uint32_t length_ms,
+                                   sfa30_aggregate_slot_t *slot, uint32_t capacity, uint32_t *index)
+{
+    sfa30_aggregate_window_t *window;
+
+    if ((aggregate == NULL) || (index == NULL))
+    {
+        return 2;
+    }
+    if ((length_ms == 0) || ((slot != NULL) && ((capacity < 2) || (capacity > 65536) || ((capacity & (capacity - 1)) != 0))))
+    {
+        return 4;
+    }
+    if (aggregate->windows >= SFA30_AGGREGATE_MAX_WINDOWS)
+    {
+        return 5;
+    }
+
+    window = &aggregate->window[aggregate->windows];
+    memset(window, 0, sizeof(sfa30_aggregate_window_t));
+    window->length_ms = length_ms;
+    window->slot = slot;
+    window->mask = (slot != NULL) ? (capacity - 1) : 0;
+    *index = aggregate->windows;
+    aggregate->windows++;
+
+    return 0;
+}
+
+/**
+ * @brief     push a sample
+ * @param[in] *aggregate pointer to an sfa30 aggregate structure
+ * @param[in] timestamp_ms sample timestamp, not older than the previous one
+ * @param[in] *data pointer to an sfa30_data_t structure
+ * @return    status code
+ *            - 0 success
+ *            - 2 aggregate or data is NULL
+ * @note      amortized constant time per window, a window whose ring is full
+ *            drops its oldest sample early and counts it in evicted
+ */
+uint8_t sfa30_aggregate_push(sfa30_aggregate_t *aggregate, uint32_t timestamp_ms, const sfa30_data_t *data)
+{
+    uint32_t i;
+    int16_t raw[3];
+
+    if ((aggregate == NULL) || (data == NULL))
+    {
+        return 2;
+    }
+
+    raw[0] = data->formaldehyde_raw;
+    raw[1] = data->humidity_raw;
+    raw[2] = data->temperature_raw;
+    aggregate->closed = 0;
+    for (i = 0; i < aggregate->windows; i++)
+    {
+        if (aggregate->window[i].slot != NULL)
+        {
+            a_sfa30_aggregate_slide(&aggregate->window[i], timestamp_ms, raw);
+        }
+        if (a_sfa30_aggregate_tumble(&aggregate->window[i], timestamp_ms, raw) != 0)
+        {
+            aggregate->closed |= 1U << i;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief      get the statistics of a window
+ * @param[in]  *aggregate pointer to an sfa30 aggregate structure
+ * @param[in]  index window index
+ * @param[in]  mode sliding, tumbling or partial window
+ * @param[out] *result pointer to a result buffer
+ * @return     status code
+ *             - 0 success
+ *             - 2 aggregate or result is NULL
+ *             - 4 index or mode is invalid or the window has no slot ring
+ * @note       constant time, only the owner of the pushes may call it
+ */
+uint8_t sfa30_aggregate_get(const sfa30_aggregate_t *aggregate, uint32_t index,
+                            sfa30_aggregate_mode_t mode, sfa30_aggregate_result_t *result)
+{
+    uint32_t c;
+    int16_t min[3];
+    int16_t max[3];
+    const sfa30_aggregate_window_t *window;
+    const sfa30_aggregate_bucket_t *bucket;
+    sfa30_aggregate_stat_t *stat[3];
+
+    if ((aggregate == NULL) || (result == NULL))
+    {
+        return 2;
+    }
+    if ((index >= aggregate->windows) || (mode > SFA30_AGGREGATE_MODE_PARTIAL) ||
+        ((mode == SFA30_AGGREGATE_MODE_SLIDING) && (aggregate->window[index].slot == NULL)))
+    {
+        return 4;
+    }
+
+    window = &aggregate->window[index];
+    stat[0] = &result->formaldehyde;
+    stat[1] = &result->humidity;
+    stat[2] = &result->temperature;
+    if (mode == SFA30_AGGREGATE_MODE_SLIDING)
+    {
+        result->count = window->head - window->tail;
+        result->start_ms = (result->count != 0) ? window->slot[window->tail & window->mask].timestamp_ms : 0;
+        for (c = 0; c < 3; c++)
+        {
+            min[c] = 0;
+            max[c] = 0;
+            if (result->count != 0)
+            {
+                min[c] = (int16_t)(window->slot[window->deque_tail[c] & window->mask].deque[c] >> 16);
+                max[c] = (int16_t)(window->slot[window->deque_tail[c + 3] & window->mask].deque[c + 3] >> 16);
+            }
+            a_sfa30_aggregate_stat(result->count, window->sum[c], window->sum_sq[c], min[c], max[c], stat[c]);
+        }
+
+        return 0;
+    }
+
+    bucket = (mode == SFA30_AGGREGATE_MODE_TUMBLING) ? &window->closed : &window->open;
+    result->count = bucket->count;
+    result->start_ms = (bucket->count != 0) ? bucket->start_ms : 0;
+    for (c = 0; c < 3; c++)
+    {
+        a_sfa30_aggregate_stat(bucket->count, bucket->sum[c], bucket->sum_sq[c], bucket->min[c], bucket->max[c], stat[c]);
+    }
+
+    return 0;
+}
@@ -0,0 +1,211 @@
+/**
+ * Copyright (c) 2015 - present LibDriver All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_sfa30_aggregate.h
+ * @brief     driver sfa30 aggregate header file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2023-07-30
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2023/07/30  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#ifndef DRIVER_SFA30_AGGREGATE_H
+#define DRIVER_SFA30_AGGREGATE_H
+
+#include "driver_sfa30.h"
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/**
+ * @defgroup sfa30_aggregate_driver sfa30 aggregate driver function
+ * @brief    sfa30 aggregate driver modules
+ * @ingroup  sfa30_example_driver
+ * @{
+ */
+
+/**
+ * @brief sfa30 aggregate max windows definition, define it to track more window lengths at once
+ */
+#ifndef SFA30_AGGREGATE_MAX_WINDOWS
+    #define SFA30_AGGREGATE_MAX_WINDOWS        4        /**< 4 window lengths by default */
+#endif
+
+/**
+ * @brief sfa30 aggregate mode enumeration definition
+ */
+typedef enum
+{
+    SFA30_AGGREGATE_MODE_SLIDING = 0x00,        /**< samples of the last window length, ending at the latest sample */
+    SFA30_AGGREGATE_MODE_TUMBLING = 0x01,       /**< last closed window aligned to a multiple of the window length */
+    SFA30_AGGREGATE_MODE_PARTIAL = 0x02,        /**< open aligned window, not closed yet */
+} sfa30_aggregate_mode_t;
+
+/**
+ * @brief sfa30 aggregate slot structure definition
+ * @note  the min and max deques of a sliding window share the slot ring, entry i of
+ *        deque k lives in slot i and packs the raw value above the low 16 sequence bits
+ */
+typedef struct sfa30_aggregate_slot_s
+{
+    uint32_t timestamp_ms;        /**< sample timestamp */
+    int16_t raw[3];               /**< formaldehyde, humidity and temperature raw */
+    uint16_t reserved;            /**< reserved */
+    uint32_t deque[6];            /**< min and max deque entries of the 3 channels */
+} sfa30_aggregate_slot_t;
+
+/**
+ * @brief sfa30 aggregate bucket structure definition
+ */
+typedef struct sfa30_aggregate_bucket_s
+{
+    uint32_t start_ms;            /**< aligned window begin */
+    uint32_t count;               /**< samples */
+    int16_t min[3];               /**< min raw values */
+    int16_t max[3];               /**< max raw values */
+    int64_t sum[3];               /**< sums of the raw values */
+    uint64_t sum_sq[3];           /**< sums of the squared raw values */
+} sfa30_aggregate_bucket_t;
+
+/**
+ * @brief sfa30 aggregate window structure definition
+ */
+typedef struct sfa30_aggregate_window_s
+{
+    uint32_t length_ms;                    /**< window length */
+    sfa30_aggregate_slot_t *slot;          /**< sliding window ring, NULL for a tumbling only window */
+    uint32_t mask;                         /**< capacity - 1 */
+    uint32_t head;                         /**< samples pushed */
+    uint32_t tail;                         /**< oldest sample in the sliding window */
+    uint32_t deque_head[6];                /**< deque push ends */
+    uint32_t deque_tail[6];                /**< deque fronts */
+    int64_t sum[3];                        /**< sliding sums of the raw values */
+    uint64_t sum_sq[3];                    /**< sliding sums of the squared raw values */
+    uint32_t evicted;                      /**< samples dropped early because the ring was full */
+    sfa30_aggregate_bucket_t open;         /**< open tumbling window */
+    sfa30_aggregate_bucket_t closed;       /**< last closed tumbling window */
+} sfa30_aggregate_window_t;
+
+/**
+ * @brief sfa30 aggregate structure definition
+ */
+typedef struct sfa30_aggregate_s
+{
+    sfa30_aggregate_window_t window[SFA30_AGGREGATE_MAX_WINDOWS];        /**< windows */
+    uint32_t windows;                                                    /**< windows in use */
+    uint32_t closed;                                                     /**< bit i is set when window i closed a tumbling window at the last push */
+} sfa30_aggregate_t;
+
+/**
+ * @brief sfa30 aggregate channel statistics structure definition
+ */
+typedef struct sfa30_aggregate_stat_s
+{
+    int16_t min_raw;              /**< min raw */
+    int16_t max_raw;              /**< max raw */
+    int32_t mean_q8;              /**< mean raw x 256, rounded */
+    uint32_t stddev_q8;           /**< population standard deviation raw x 256, rounded down */
+} sfa30_aggregate_stat_t;
+
+/**
+ * @brief sfa30 aggregate result structure definition
+ */
+typedef struct sfa30_aggregate_result_s
+{
+    uint32_t start_ms;                         /**< timestamp of the first sample, or the aligned begin of a tumbling window */
+    uint32_t count;                            /**< samples, the statistics are 0 without samples */
+    sfa30_aggregate_stat_t formaldehyde;       /**< formaldehyde raw statistics, ppb * 5 */
+    sfa30_aggregate_stat_t humidity;           /**< humidity raw statistics, % * 100 */
+    sfa30_aggregate_stat_t temperature;        /**< temperature raw statistics, C * 200 */
+} sfa30_aggregate_result_t;
+
+/**
+ * @brief     init the aggregate
+ * @param[in] *aggregate pointer to an sfa30 aggregate structure
+ * @return    status code
+ *            - 0 success
+ *            - 2 aggregate is NULL
+ * @note      add the windows before the first push
+ */
+uint8_t sfa30_aggregate_init(sfa30_aggregate_t *aggregate);
+
+/**
+ * @brief      add a window length
+ * @param[in]  *aggregate pointer to an sfa30 aggregate structure
+ * @param[in]  length_ms window length
+ * @param[in]  *slot pointer to a slot ring, NULL for a tumbling only window
+ * @param[in]  capacity slot ring capacity, at least length_ms / period_ms + 1 and at most 65536
+ * @param[out] *index pointer to a window index buffer
+ * @return     status code
+ *             - 0 success
+ *             - 2 aggregate or index is NULL
+ *             - 4 length_ms is 0 or capacity is not a power of two from 2 to 65536
+ *             - 5 windows are full
+ * @note       every window keeps both its tumbling and, with a slot ring, its sliding statistics
+ */
+uint8_t sfa30_aggregate_add_window(sfa30_aggregate_t *aggregate, uint32_t length_ms,
+                                   sfa30_aggregate_slot_t *slot, uint32_t capacity, uint32_t *index);
+
+/**
+ * @brief     push a sample
+ * @param[in] *aggregate pointer to an sfa30 aggregate structure
+ * @param[in] timestamp_ms sample timestamp, not older than the previous one
+ * @param[in] *data pointer to an sfa30_data_t structure
+ * @return    status code
+ *            - 0 success
+ *            - 2 aggregate or data is NULL
+ * @note      amortized constant time per window, a window whose ring is full
+ *            drops its oldest sample early and counts it in evicted
+ */
+uint8_t sfa30_aggregate_push(sfa30_aggregate_t *aggregate, uint32_t timestamp_ms, const sfa30_data_t *data);
+
+/**
+ * @brief      get the statistics of a window
+ * @param[in]  *aggregate pointer to an sfa30 aggregate structure
+ * @param[in]  index window index
+ * @param[in]  mode sliding, tumbling or partial window
+ * @param[out] *result pointer to a result buffer
+ * @return     status code
+ *             - 0 success
+ *             - 2 aggregate or result is NULL
+ *             - 4 index or mode is invalid or the window has no slot ring
+ * @note       constant time, only the owner of the pushes may call it
+ */
+uint8_t sfa30_aggregate_get(const sfa30_aggregate_t *aggregate, uint32_t index,
+                            sfa30_aggregate_mode_t mode, sfa30_aggregate_result_t *result);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
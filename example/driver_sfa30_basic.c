@@ -36,45 +36,79 @@
 
 #include "driver_sfa30_basic.h"
 
-static sfa30_handle_t gs_handle;        /**< sfa30 handle */
+static sfa30_basic_ctx_t gs_basic;                    /**< sfa30 basic context */
+static uint8_t gs_scratch[SFA30_SCRATCH_SIZE];        /**< sfa30 uart scratch buffer */
 
 /**
- * @brief     basic example init
+ * @brief     basic example create a context
+ * @param[in] *basic pointer to an sfa30 basic context structure
  * @param[in] interface chip interface
+ * @param[in] *user pointer to the user context of the bus or port, can be NULL
+ * @param[in] *scratch pointer to a SFA30_SCRATCH_SIZE bytes buffer, can be NULL for iic
  * @return    status code
  *            - 0 success
- *            - 1 init failed
- * @note      none
+ *            - 1 create failed
+ *            - 2 basic is NULL
+ * @note      the bus is not touched until sfa30_basic_ctx_init
  */
-uint8_t sfa30_basic_init(sfa30_interface_t interface)
+uint8_t sfa30_basic_ctx_create(sfa30_basic_ctx_t *basic, sfa30_interface_t interface, void *user, uint8_t *scratch)
 {
     uint8_t res;
     
+    if (basic == NULL)
+    {
+        return 2;
+    }
+    memset(basic, 0, sizeof(sfa30_basic_ctx_t));
+    
     /* link functions */
-    DRIVER_SFA30_LINK_INIT(&gs_handle, sfa30_handle_t);
-    DRIVER_SFA30_LINK_UART_INIT(&gs_handle, sfa30_interface_uart_init);
-    DRIVER_SFA30_LINK_UART_DEINIT(&gs_handle, sfa30_interface_uart_deinit);
-    DRIVER_SFA30_LINK_UART_READ(&gs_handle, sfa30_interface_uart_read);
-    DRIVER_SFA30_LINK_UART_WRITE(&gs_handle, sfa30_interface_uart_write);
-    DRIVER_SFA30_LINK_UART_FLUSH(&gs_handle, sfa30_interface_uart_flush);
-    DRIVER_SFA30_LINK_IIC_INIT(&gs_handle, sfa30_interface_iic_init);
-    DRIVER_SFA30_LINK_IIC_DEINIT(&gs_handle, sfa30_interface_iic_deinit);
-    DRIVER_SFA30_LINK_IIC_WRITE_COMMAND(&gs_handle, sfa30_interface_iic_write_cmd);
-    DRIVER_SFA30_LINK_IIC_READ_COMMAND(&gs_handle, sfa30_interface_iic_read_cmd);
-    DRIVER_SFA30_LINK_DELAY_MS(&gs_handle, sfa30_interface_delay_ms);
-    DRIVER_SFA30_LINK_DEBUG_PRINT(&gs_handle, sfa30_interface_debug_print);
+    DRIVER_SFA30_LINK_INIT(&basic->handle, sfa30_handle_t);
+    DRIVER_SFA30_LINK_UART_INIT(&basic->handle, sfa30_interface_uart_init);
+    DRIVER_SFA30_LINK_UART_DEINIT(&basic->handle, sfa30_interface_uart_deinit);
+    DRIVER_SFA30_LINK_UART_READ(&basic->handle, sfa30_interface_uart_read);
+    DRIVER_SFA30_LINK_UART_WRITE(&basic->handle, sfa30_interface_uart_write);
+    DRIVER_SFA30_LINK_UART_FLUSH(&basic->handle, sfa30_interface_uart_flush);
+    DRIVER_SFA30_LINK_IIC_INIT(&basic->handle, sfa30_interface_iic_init);
+    DRIVER_SFA30_LINK_IIC_DEINIT(&basic->handle, sfa30_interface_iic_deinit);
+    DRIVER_SFA30_LINK_IIC_WRITE_COMMAND(&basic->handle, sfa30_interface_iic_write_cmd);
+    DRIVER_SFA30_LINK_IIC_READ_COMMAND(&basic->handle, sfa30_interface_iic_read_cmd);
+    DRIVER_SFA30_LINK_DELAY_MS(&basic->handle, sfa30_interface_delay_ms);
+    DRIVER_SFA30_LINK_DEBUG_PRINT(&basic->handle, sfa30_interface_debug_print);
+    DRIVER_SFA30_LINK_USER(&basic->handle, user);
+    DRIVER_SFA30_LINK_SCRATCH(&basic->handle, scratch);
     
     /* set the interface */
-    res = sfa30_set_interface(&gs_handle, interface);
+    res = sfa30_set_interface(&basic->handle, interface);
     if (res != 0)
     {
         sfa30_interface_debug_print("sfa30: set interface failed.\n");
-    
+        
         return 1;
     }
     
+    return 0;
+}
+
+/**
+ * @brief     basic example init a context
+ * @param[in] *basic pointer to a created sfa30 basic context structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 init failed
+ *            - 2 basic is NULL
+ * @note      none
+ */
+uint8_t sfa30_basic_ctx_init(sfa30_basic_ctx_t *basic)
+{
+    uint8_t res;
+    
+    if (basic == NULL)
+    {
+        return 2;
+    }
+    
     /* init the chip */
-    res = sfa30_init(&gs_handle);
+    res = sfa30_init(&basic->handle);
     if (res != 0)
     {
         sfa30_interface_debug_print("sfa30: init failed.\n");
@@ -83,38 +117,50 @@ uint8_t sfa30_basic_init(sfa30_interface_t interface)
     }
     
     /* start measurement */
-    res = sfa30_start_measurement(&gs_handle);
+    res = sfa30_start_measurement(&basic->handle);
     if (res != 0)
     {
         sfa30_interface_debug_print("sfa30: start measurement failed.\n");
-        (void)sfa30_deinit(&gs_handle);
+        (void)sfa30_deinit(&basic->handle);
         
         return 1;
     }
+    basic->measuring = 1;
 
     return 0;
 }
 
 /**
- * @brief  basic example deinit
- * @return status code
- *         - 0 success
- *         - 1 deinit failed
- * @note   none
+ * @brief     basic example deinit a context
+ * @param[in] *basic pointer to an sfa30 basic context structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 deinit failed
+ *            - 2 basic is NULL
+ * @note      none
  */
-uint8_t sfa30_basic_deinit(void)
+uint8_t sfa30_basic_ctx_deinit(sfa30_basic_ctx_t *basic)
 {
     uint8_t res;
     
+    if (basic == NULL)
+    {
+        return 2;
+    }
+    
     /* stop measurement */
-    res = sfa30_stop_measurement(&gs_handle);
-    if (res != 0)
+    if (basic->measuring != 0)
     {
-        return 1;
+        res = sfa30_stop_measurement(&basic->handle);
+        if (res != 0)
+        {
+            return 1;
+        }
+        basic->measuring = 0;
     }
     
     /* deinit */
-    res = sfa30_deinit(&gs_handle);
+    res = sfa30_deinit(&basic->handle);
     if (res != 0)
     {
         return 1;
@@ -124,19 +170,26 @@ uint8_t sfa30_basic_deinit(void)
 }
 
 /**
- * @brief      basic example read
+ * @brief      basic example read a context
+ * @param[in]  *basic pointer to an sfa30 basic context structure
  * @param[out] *data pointer to a sfa30_data_t structure
  * @return     status code
  *             - 0 success
  *             - 1 read failed
+ *             - 2 basic is NULL
  * @note       none
  */
-uint8_t sfa30_basic_read(sfa30_data_t *data)
+uint8_t sfa30_basic_ctx_read(sfa30_basic_ctx_t *basic, sfa30_data_t *data)
 {
     uint8_t res;
     
+    if (basic == NULL)
+    {
+        return 2;
+    }
+    
     /* read data */
-    res = sfa30_read(&gs_handle, data);
+    res = sfa30_read(&basic->handle, data);
     if (res != 0)
     {
         return 1;
@@ -146,36 +199,117 @@ uint8_t sfa30_basic_read(sfa30_data_t *data)
 }
 
 /**
- * @brief  basic example reset
- * @return status code
- *         - 0 success
- *         - 1 reset failed
- * @note   none
+ * @brief     basic example reset a context
+ * @param[in] *basic pointer to an sfa30 basic context structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 reset failed
+ *            - 2 basic is NULL
+ * @note      the sensor stops measuring after the reset
  */
-uint8_t sfa30_basic_reset(void)
+uint8_t sfa30_basic_ctx_reset(sfa30_basic_ctx_t *basic)
 {
-    if (sfa30_reset(&gs_handle) != 0)
+    if (basic == NULL)
+    {
+        return 2;
+    }
+    if (sfa30_reset(&basic->handle) != 0)
     {
         return 1;
     }
+    basic->measuring = 0;
     
     return 0;
 }
 
 /**
- * @brief      basic example get device information
+ * @brief      basic example get the device information of a context
+ * @param[in]  *basic pointer to an sfa30 basic context structure
  * @param[out] *info pointer to a info buffer
  * @return     status code
  *             - 0 success
  *             - 1 get device information failed
+ *             - 2 basic is NULL
  * @note       none
  */
-uint8_t sfa30_basic_get_device_information(char info[32])
+uint8_t sfa30_basic_ctx_get_device_information(sfa30_basic_ctx_t *basic, char info[32])
 {
-    if (sfa30_get_device_information(&gs_handle, info) != 0)
+    if (basic == NULL)
+    {
+        return 2;
+    }
+    if (sfa30_get_device_information(&basic->handle, info) != 0)
     {
         return 1;
     }
     
     return 0;
 }
+
+/**
+ * @brief     basic example init
+ * @param[in] interface chip interface
+ * @return    status code
+ *            - 0 success
+ *            - 1 init failed
+ * @note      none
+ */
+uint8_t sfa30_basic_init(sfa30_interface_t interface)
+{
+    if (sfa30_basic_ctx_create(&gs_basic, interface, NULL, gs_scratch) != 0)
+    {
+        return 1;
+    }
+    
+    return sfa30_basic_ctx_init(&gs_basic);
+}
+
+/**
+ * @brief  basic example deinit
+ * @return status code
+ *         - 0 success
+ *         - 1 deinit failed
+ * @note   none
+ */
+uint8_t sfa30_basic_deinit(void)
+{
+    return sfa30_basic_ctx_deinit(&gs_basic);
+}
+
+/**
+ * @brief      basic example read
+ * @param[out] *data pointer to a sfa30_data_t structure
+ * @return     status code
+ *             - 0 success
+ *             - 1 read failed
+ * @note       none
+ */
+uint8_t sfa30_basic_read(sfa30_data_t *data)
+{
+    return sfa30_basic_ctx_read(&gs_basic, data);
+}
+
+/**
+ * @brief  basic example reset
+ * @return status code
+ *         - 0 success
+ *         - 1 reset failed
+ * @note   none
+ */
+uint8_t sfa30_basic_reset(void)
+{
+    return sfa30_basic_ctx_reset(&gs_basic);
+}
+
+/**
+ * @brief      basic example get device information
+ * @param[out] *info pointer to a info buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 get device information failed
+ * @note       none
+ */
+uint8_t sfa30_basic_get_device_information(char info[32])
+{
+    return sfa30_basic_ctx_get_device_information(&gs_basic, info);
+}
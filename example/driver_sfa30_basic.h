@@ -50,6 +50,89 @@ extern "C"{
  * @{
  */
 
+/**
+ * @brief sfa30 basic context structure definition
+ * @note  each context owns its handle and measurement state, contexts on different
+ *        buses may be driven from different threads without locking as long as they
+ *        do not share a scratch buffer
+ */
+typedef struct sfa30_basic_ctx_s
+{
+    sfa30_handle_t handle;        /**< sensor handle */
+    uint8_t measuring;            /**< measuring flag */
+} sfa30_basic_ctx_t;
+
+/**
+ * @brief     basic example create a context
+ * @param[in] *basic pointer to an sfa30 basic context structure
+ * @param[in] interface chip interface
+ * @param[in] *user pointer to the user context of the bus or port, can be NULL
+ * @param[in] *scratch pointer to a SFA30_SCRATCH_SIZE bytes buffer, can be NULL for iic
+ * @return    status code
+ *            - 0 success
+ *            - 1 create failed
+ *            - 2 basic is NULL
+ * @note      the bus is not touched until sfa30_basic_ctx_init
+ */
+uint8_t sfa30_basic_ctx_create(sfa30_basic_ctx_t *basic, sfa30_interface_t interface, void *user, uint8_t *scratch);
+
+/**
+ * @brief     basic example init a context
+ * @param[in] *basic pointer to a created sfa30 basic context structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 init failed
+ *            - 2 basic is NULL
+ * @note      none
+ */
+uint8_t sfa30_basic_ctx_init(sfa30_basic_ctx_t *basic);
+
+/**
+ * @brief     basic example deinit a context
+ * @param[in] *basic pointer to an sfa30 basic context structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 deinit failed
+ *            - 2 basic is NULL
+ * @note      none
+ */
+uint8_t sfa30_basic_ctx_deinit(sfa30_basic_ctx_t *basic);
+
+/**
+ * @brief      basic example read a context
+ * @param[in]  *basic pointer to an sfa30 basic context structure
+ * @param[out] *data pointer to a sfa30_data_t structure
+ * @return     status code
+ *             - 0 success
+ *             - 1 read failed
+ *             - 2 basic is NULL
+ * @note       none
+ */
+uint8_t sfa30_basic_ctx_read(sfa30_basic_ctx_t *basic, sfa30_data_t *data);
+
+/**
+ * @brief     basic example reset a context
+ * @param[in] *basic pointer to an sfa30 basic context structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 reset failed
+ *            - 2 basic is NULL
+ * @note      the sensor stops measuring after the reset
+ */
+uint8_t sfa30_basic_ctx_reset(sfa30_basic_ctx_t *basic);
+
+/**
+ * @brief      basic example get the device information of a context
+ * @param[in]  *basic pointer to an sfa30 basic context structure
+ * @param[out] *info pointer to a info buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 get device information failed
+ *             - 2 basic is NULL
+ * @note       none
+ */
+uint8_t sfa30_basic_ctx_get_device_information(sfa30_basic_ctx_t *basic, char info[32]);
+
 /**
  * @brief     basic example init
  * @param[in] interface chip interface
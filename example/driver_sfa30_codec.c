@@ -0,0 +1,744 @@
+/**
+ * Copyright (c) 2015 - present LibDriver All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_sfa30_codec.c
+ * @brief     driver sfa30 codec source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2023-07-30
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2023/07/30  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#include "driver_sfa30_codec.h"
+#include <string.h>
+
+/**
+ * @brief sfa30 codec frame lane definition
+ */
+#define SFA30_CODEC_LANE_SAMPLES        (SFA30_CODEC_FRAME_SAMPLES / SFA30_CODEC_LANES)        /**< samples per lane of a full frame */
+
+/**
+ * @brief sfa30 codec unrolled loop definition
+ */
+#if (SFA30_CODEC_UNROLL != 0) && defined(__clang__)
+    #define SFA30_CODEC_UNROLL_LOOP        _Pragma("clang loop unroll(full)")
+#elif (SFA30_CODEC_UNROLL != 0) && defined(__GNUC__) && (__GNUC__ >= 8)
+    #define SFA30_CODEC_UNROLL_LOOP        _Pragma("GCC unroll 32")
+#else
+    #define SFA30_CODEC_UNROLL_LOOP
+#endif
+
+/**
+ * @brief unpack kernel definition
+ */
+typedef void (*sfa30_codec_unpack_fn_t)(const uint8_t *in, uint32_t *out);
+
+/**
+ * @brief     bit width of a value
+ * @param[in] x value
+ * @return    bits up to the highest set one
+ * @note      none
+ */
+static uint32_t a_sfa30_codec_width(uint32_t x)
+{
+#if defined(__GNUC__)
+    return (x == 0) ? 0 : (uint32_t)(32 - __builtin_clz(x));
+#else
+    uint32_t w = 0;
+
+    while (x != 0)
+    {
+        x >>= 1;
+        w++;
+    }
+
+    return w;
+#endif
+}
+
+/**
+ * @brief     zig-zag code a signed delta
+ * @param[in] x delta
+ * @return    small deltas of either sign as small unsigned values
+ * @note      none
+ */
+static uint32_t a_sfa30_codec_zigzag(int32_t x)
+{
+    return ((uint32_t)x << 1) ^ (0U - ((uint32_t)x >> 31));
+}
+
+/**
+ * @brief     undo the zig-zag code
+ * @param[in] x zig-zag value
+ * @return    delta
+ * @note      none
+ */
+static inline int32_t a_sfa30_codec_unzigzag(uint32_t x)
+{
+    return (int32_t)((x >> 1) ^ (0U - (x & 1)));
+}
+
+/**
+ * @brief     read a little endian 32 bits lane word
+ * @param[in] *p pointer to the bytes
+ * @return    value
+ * @note      none
+ */
+static inline uint32_t a_sfa30_codec_load32(const uint8_t *p)
+{
+    uint32_t x;
+
+    memcpy(&x, p, 4);
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+    x = __builtin_bswap32(x);
+#endif
+
+    return x;
+}
+
+/**
+ * @brief     write a little endian word
+ * @param[in] *p pointer to the bytes
+ * @param[in] x value
+ * @param[in] n bytes
+ * @note      none
+ */
+static void a_sfa30_codec_put(uint8_t *p, uint32_t x, uint8_t n)
+{
+    uint8_t i;
+
+    for (i = 0; i < n; i++)
+    {
+        p[i] = (uint8_t)(x >> (8 * i));
+    }
+}
+
+/**
+ * @brief     read a little endian word
+ * @param[in] *p pointer to the bytes
+ * @param[in] n bytes
+ * @return    value
+ * @note      none
+ */
+static uint32_t a_sfa30_codec_get(const uint8_t *p, uint8_t n)
+{
+    uint32_t x = 0;
+    uint8_t i;
+
+    for (i = 0; i < n; i++)
+    {
+        x |= (uint32_t)p[i] << (8 * i);
+    }
+
+    return x;
+}
+
+/**
+ * @brief     packed bytes of one stream
+ * @param[in] n samples in the frame
+ * @param[in] w bit width
+ * @return    bytes
+ * @note      each lane holds (n + 3) / 4 values and the lanes advance one 16 bytes word at a time
+ */
+static uint32_t a_sfa30_codec_stream_size(uint32_t n, uint32_t w)
+{
+    uint32_t m = (n + SFA30_CODEC_LANES - 1) / SFA30_CODEC_LANES;
+
+    return ((m * w + 31) / 32) * 4 * SFA30_CODEC_LANES;
+}
+
+/**
+ * @brief     packed bytes of a frame
+ * @param[in] n samples in the frame
+ * @param[in] *bits pointer to the or of the residuals of each stream
+ * @return    bytes
+ * @note      none
+ */
+static uint32_t a_sfa30_codec_frame_size(uint32_t n, const uint32_t bits[4])
+{
+    return SFA30_CODEC_FRAME_HEADER_SIZE +
+           a_sfa30_codec_stream_size(n, a_sfa30_codec_width(bits[0])) +
+               a_sfa30_codec_stream_size(n, a_sfa30_codec_width(bits[1])) +
+               a_sfa30_codec_stream_size(n, a_sfa30_codec_width(bits[2])) +
+               a_sfa30_codec_stream_size(n, a_sfa30_codec_width(bits[3]));
+}
+
+/**
+ * @brief     pack the open frame
+ * @param[in] *encoder pointer to an sfa30 codec encoder structure
+ * @note      the space was reserved by the append
+ */
+static void a_sfa30_codec_pack(sfa30_codec_encoder_t *encoder)
+{
+    uint32_t words[SFA30_CODEC_FRAME_SAMPLES];
+    uint8_t *p = &encoder->buf[encoder->len];
+    uint32_t n = encoder->pending;
+    uint32_t s;
+    uint32_t k;
+
+    for (s = 0; s < 4; s++)
+    {
+        p[s] = (uint8_t)a_sfa30_codec_width(encoder->bits[s]);
+    }
+    a_sfa30_codec_put(&p[4], encoder->frame_ms + (uint32_t)encoder->low, 4);
+    p += SFA30_CODEC_FRAME_HEADER_SIZE;
+    for (k = 0; k < n; k++)
+    {
+        encoder->residual[0][k] -= (uint32_t)encoder->low;
+    }
+    for (s = 0; s < 4; s++)
+    {
+        uint32_t w = a_sfa30_codec_width(encoder->bits[s]);
+        uint32_t size = a_sfa30_codec_stream_size(n, w);
+
+        /* value j of lane l starts at bit j * w of lane l */
+        memset(words, 0, size);
+        for (k = 0; k < n; k++)
+        {
+            uint32_t bit = (k / SFA30_CODEC_LANES) * w;
+            uint32_t word = (bit / 32) * SFA30_CODEC_LANES + (k % SFA30_CODEC_LANES);
+            uint32_t shift = bit % 32;
+            uint32_t r = encoder->residual[s][k];
+
+            words[word] |= r << shift;
+            if ((shift != 0) && (shift + w > 32))
+            {
+                words[word + SFA30_CODEC_LANES] |= r >> (32 - shift);
+            }
+        }
+        for (k = 0; k < size / 4; k++)
+        {
+            a_sfa30_codec_put(&p[k * 4], words[k], 4);
+        }
+        p += size;
+    }
+    encoder->len = (uint32_t)(p - encoder->buf);
+    encoder->pending = 0;
+    memset(encoder->bits, 0, sizeof(encoder->bits));
+}
+
+/**
+ * @brief      unpack the first n values of a stream
+ * @param[in]  *in pointer to the packed stream
+ * @param[in]  n values
+ * @param[in]  w bit width
+ * @param[out] *out pointer to the values
+ * @note       the next lane word is always read and masked off when unused, so the 4 lanes
+ *             wide inner loop has no branch and compiles to vector code, a width 0 stream
+ *             has no words and reads nothing since the pad only covers one next lane word
+ */
+static inline void a_sfa30_codec_unpack(const uint8_t *in, uint32_t n, uint32_t w, uint32_t *out)
+{
+    const uint32_t mask = (w >= 32) ? 0xFFFFFFFFU : ((1U << w) - 1);
+    uint32_t j;
+    uint32_t l;
+
+    if (w == 0)
+    {
+        memset(out, 0, ((n + SFA30_CODEC_LANES - 1) / SFA30_CODEC_LANES) * SFA30_CODEC_LANES * sizeof(uint32_t));
+
+        return;
+    }
+    for (j = 0; j < (n + SFA30_CODEC_LANES - 1) / SFA30_CODEC_LANES; j++)
+    {
+        const uint32_t bit = j * w;
+        const uint8_t *word = &in[(bit / 32) * 4 * SFA30_CODEC_LANES];
+        const uint32_t shift = bit % 32;
+        uint32_t lo[SFA30_CODEC_LANES];
+        uint32_t hi[SFA30_CODEC_LANES];
+
+        for (l = 0; l < SFA30_CODEC_LANES; l++)
+        {
+            lo[l] = a_sfa30_codec_load32(&word[l * 4]);
+            hi[l] = a_sfa30_codec_load32(&word[(SFA30_CODEC_LANES + l) * 4]);
+        }
+        for (l = 0; l < SFA30_CODEC_LANES; l++)
+        {
+            out[j * SFA30_CODEC_LANES + l] = ((lo[l] >> shift) | ((hi[l] << 1) << (31 - shift))) & mask;
+        }
+    }
+}
+
+/**
+ * @brief      unpack a full frame stream
+ * @param[in]  *in pointer to the packed stream
+ * @param[in]  w bit width
+ * @param[out] *out pointer to the values
+ * @note       with SFA30_CODEC_UNROLL every shift and offset is a constant of w,
+ *             which leaves 5 vector operations per 4 values, a width 0 stream reads nothing
+ */
+static inline void a_sfa30_codec_unpack_frame(const uint8_t *in, uint32_t w, uint32_t *out)
+{
+    const uint32_t mask = (w >= 32) ? 0xFFFFFFFFU : ((1U << w) - 1);
+    uint32_t j;
+    uint32_t l;
+
+    if (w == 0)
+    {
+        memset(out, 0, SFA30_CODEC_FRAME_SAMPLES * sizeof(uint32_t));
+
+        return;
+    }
+    SFA30_CODEC_UNROLL_LOOP
+    for (j = 0; j < SFA30_CODEC_LANE_SAMPLES; j++)
+    {
+        const uint32_t bit = j * w;
+        const uint8_t *word = &in[(bit / 32) * 4 * SFA30_CODEC_LANES];
+        const uint32_t shift = bit % 32;
+        uint32_t lo[SFA30_CODEC_LANES];
+        uint32_t hi[SFA30_CODEC_LANES];
+
+        for (l = 0; l < SFA30_CODEC_LANES; l++)
+        {
+            lo[l] = a_sfa30_codec_load32(&word[l * 4]);
+            hi[l] = a_sfa30_codec_load32(&word[(SFA30_CODEC_LANES + l) * 4]);
+        }
+        for (l = 0; l < SFA30_CODEC_LANES; l++)
+        {
+            out[j * SFA30_CODEC_LANES + l] = ((lo[l] >> shift) | ((hi[l] << 1) << (31 - shift))) & mask;
+        }
+    }
+}
+
+/**
+ * @brief full frame unpack kernel of one width
+ */
+#define SFA30_CODEC_UNPACK(w)                                                  \
+static void a_sfa30_codec_unpack_##w(const uint8_t *in, uint32_t *out)         \
+{                                                                              \
+    a_sfa30_codec_unpack_frame(in, w, out);                                    \
+}
+
+SFA30_CODEC_UNPACK(0)  SFA30_CODEC_UNPACK(1)  SFA30_CODEC_UNPACK(2)  SFA30_CODEC_UNPACK(3)
+SFA30_CODEC_UNPACK(4)  SFA30_CODEC_UNPACK(5)  SFA30_CODEC_UNPACK(6)  SFA30_CODEC_UNPACK(7)
+SFA30_CODEC_UNPACK(8)  SFA30_CODEC_UNPACK(9)  SFA30_CODEC_UNPACK(10) SFA30_CODEC_UNPACK(11)
+SFA30_CODEC_UNPACK(12) SFA30_CODEC_UNPACK(13) SFA30_CODEC_UNPACK(14) SFA30_CODEC_UNPACK(15)
+SFA30_CODEC_UNPACK(16) SFA30_CODEC_UNPACK(17) SFA30_CODEC_UNPACK(18) SFA30_CODEC_UNPACK(19)
+SFA30_CODEC_UNPACK(20) SFA30_CODEC_UNPACK(21) SFA30_CODEC_UNPACK(22) SFA30_CODEC_UNPACK(23)
+SFA30_CODEC_UNPACK(24) SFA30_CODEC_UNPACK(25) SFA30_CODEC_UNPACK(26) SFA30_CODEC_UNPACK(27)
+SFA30_CODEC_UNPACK(28) SFA30_CODEC_UNPACK(29) SFA30_CODEC_UNPACK(30) SFA30_CODEC_UNPACK(31)
+SFA30_CODEC_UNPACK(32)
+
+/**
+ * @brief full frame unpack kernels indexed by the width
+ */
+static const sfa30_codec_unpack_fn_t gs_codec_unpack[33] =
+{
+    a_sfa30_codec_unpack_0,  a_sfa30_codec_unpack_1,  a_sfa30_codec_unpack_2,  a_sfa30_codec_unpack_3,
+    a_sfa30_codec_unpack_4,  a_sfa30_codec_unpack_5,  a_sfa30_codec_unpack_6,  a_sfa30_codec_unpack_7,
+    a_sfa30_codec_unpack_8,  a_sfa30_codec_unpack_9,  a_sfa30_codec_unpack_10, a_sfa30_codec_unpack_11,
+    a_sfa30_codec_unpack_12, a_sfa30_codec_unpack_13, a_sfa30_codec_unpack_14, a_sfa30_codec_unpack_15,
+    a_sfa30_codec_unpack_16, a_sfa30_codec_unpack_17, a_sfa30_codec_unpack_18, a_sfa30_codec_unpack_19,
+    a_sfa30_codec_unpack_20, a_sfa30_codec_unpack_21, a_sfa30_codec_unpack_22, a_sfa30_codec_unpack_23,
+    a_sfa30_codec_unpack_24, a_sfa30_codec_unpack_25, a_sfa30_codec_unpack_26, a_sfa30_codec_unpack_27,
+    a_sfa30_codec_unpack_28, a_sfa30_codec_unpack_29, a_sfa30_codec_unpack_30, a_sfa30_codec_unpack_31,
+    a_sfa30_codec_unpack_32,
+};
+
+/**
+ * @brief         sum the raw value deltas of a full frame
+ * @param[in]     *r pointer to the zig-zag coded deltas
+ * @param[in,out] *lane pointer to the last raw value of each lane
+ * @param[out]    *v pointer to the raw values
+ * @note          sample k only depends on sample k - 4, so 4 lanes add as one vector
+ */
+static void a_sfa30_codec_prefix(const uint32_t *r, int32_t lane[SFA30_CODEC_LANES], int16_t *v)
+{
+    int32_t x[SFA30_CODEC_LANES + SFA30_CODEC_FRAME_SAMPLES];
+    uint32_t k;
+
+    for (k = 0; k < SFA30_CODEC_LANES; k++)
+    {
+        x[k] = lane[k];
+    }
+    for (k = 0; k < SFA30_CODEC_FRAME_SAMPLES; k++)
+    {
+        x[k + SFA30_CODEC_LANES] = x[k] + a_sfa30_codec_unzigzag(r[k]);
+    }
+    for (k = 0; k < SFA30_CODEC_FRAME_SAMPLES; k++)
+    {
+        v[k] = (int16_t)x[k + SFA30_CODEC_LANES];
+    }
+    for (k = 0; k < SFA30_CODEC_LANES; k++)
+    {
+        lane[k] = x[SFA30_CODEC_FRAME_SAMPLES + k];
+    }
+}
+
+/**
+ * @brief      set the lane state of the first sample
+ * @param[in]  *raw pointer to the first raw values
+ * @param[out] *value pointer to the lane raw values
+ * @note       every lane starts from the first sample
+ */
+static void a_sfa30_codec_lanes(const int32_t raw[3], int32_t value[3][SFA30_CODEC_LANES])
+{
+    uint32_t l;
+
+    for (l = 0; l < SFA30_CODEC_LANES; l++)
+    {
+        value[0][l] = raw[0];
+        value[1][l] = raw[1];
+        value[2][l] = raw[2];
+    }
+}
+
+/**
+ * @brief     init an encoder for a new block
+ * @param[in] *encoder pointer to an sfa30 codec encoder structure
+ * @param[in] *buf pointer to a block buffer
+ * @param[in] cap block buffer size
+ * @param[in] period_ms nominal sampling period
+ * @return    status code
+ *            - 0 success
+ *            - 2 encoder or buf is NULL
+ *            - 4 cap is less than SFA30_CODEC_MIN_BLOCK_SIZE
+ * @note      timestamps are coded against period_ms, which is clamped to 65535, samples
+ *            on the period grid cost no timestamp bits
+ */
+uint8_t sfa30_codec_encoder_init(sfa30_codec_encoder_t *encoder, uint8_t *buf, uint32_t cap, uint32_t period_ms)
+{
+    if ((encoder == NULL) || (buf == NULL))
+    {
+        return 2;
+    }
+    if (cap < SFA30_CODEC_MIN_BLOCK_SIZE)
+    {
+        return 4;
+    }
+
+    encoder->buf = buf;
+    encoder->cap = cap;
+    encoder->len = SFA30_CODEC_HEADER_SIZE;
+    encoder->count = 0;
+    encoder->period_ms = (period_ms > 0xFFFF) ? 0xFFFF : period_ms;
+    encoder->sealed = 0;
+    encoder->pending = 0;
+    memset(encoder->bits, 0, sizeof(encoder->bits));
+
+    return 0;
+}
+
+/**
+ * @brief     append a sample to the block
+ * @param[in] *encoder pointer to an sfa30 codec encoder structure
+ * @param[in] timestamp_ms sample timestamp
+ * @param[in] *data pointer to an sfa30_data_t structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 block is full, the sample is not appended
+ *            - 2 encoder or data is NULL
+ *            - 4 block is sealed
+ * @note      only the open frame is kept in the encoder, a full block must be sealed
+ *            and the sample appended to a new one
+ */
+uint8_t sfa30_codec_encoder_append(sfa30_codec_encoder_t *encoder, uint32_t timestamp_ms, const sfa30_data_t *data)
+{
+    int32_t raw[3];
+    uint32_t r[4];
+    uint32_t bits[4];
+    int32_t offset;
+    int32_t low;
+    int32_t high;
+    uint32_t l;
+    uint32_t s;
+
+    if ((encoder == NULL) || (data == NULL))
+    {
+        return 2;
+    }
+    if (encoder->sealed != 0)
+    {
+        return 4;
+    }
+
+    raw[0] = data->formaldehyde_raw;
+    raw[1] = data->humidity_raw;
+    raw[2] = data->temperature_raw;
+    if (encoder->count == 0)
+    {
+        /* the first sample goes to the header */
+        a_sfa30_codec_put(&encoder->buf[8], timestamp_ms, 4);
+        a_sfa30_codec_put(&encoder->buf[12], encoder->period_ms, 2);
+        a_sfa30_codec_put(&encoder->buf[14], (uint16_t)raw[0], 2);
+        a_sfa30_codec_put(&encoder->buf[16], (uint16_t)raw[1], 2);
+        a_sfa30_codec_put(&encoder->buf[18], (uint16_t)raw[2], 2);
+        a_sfa30_codec_lanes(raw, encoder->raw);
+        encoder->count = 1;
+
+        return 0;
+    }
+
+    /* the timestamp offset from the frame grid wraps like the timestamps */
+    if (encoder->pending == 0)
+    {
+        encoder->frame_ms = timestamp_ms;
+        encoder->low = 0;
+        encoder->high = 0;
+    }
+    offset = (int32_t)(timestamp_ms - encoder->frame_ms - encoder->pending * encoder->period_ms);
+    low = (offset < encoder->low) ? offset : encoder->low;
+    high = (offset > encoder->high) ? offset : encoder->high;
+    r[0] = (uint32_t)offset;
+    bits[0] = (uint32_t)high - (uint32_t)low;
+
+    /* raw value deltas against the lane */
+    l = encoder->pending % SFA30_CODEC_LANES;
+    for (s = 0; s < 3; s++)
+    {
+        r[s + 1] = a_sfa30_codec_zigzag(raw[s] - encoder->raw[s][l]);
+        bits[s + 1] = encoder->bits[s + 1] | r[s + 1];
+    }
+
+    /* the open frame must still fit at its new widths */
+    if (encoder->len + a_sfa30_codec_frame_size(encoder->pending + 1, bits) + SFA30_CODEC_PAD_SIZE > encoder->cap)
+    {
+        return 1;
+    }
+    for (s = 0; s < 4; s++)
+    {
+        encoder->residual[s][encoder->pending] = r[s];
+        encoder->bits[s] = bits[s];
+    }
+    for (s = 0; s < 3; s++)
+    {
+        encoder->raw[s][l] = raw[s];
+    }
+    encoder->low = low;
+    encoder->high = high;
+    encoder->pending++;
+    encoder->count++;
+    if (encoder->pending == SFA30_CODEC_FRAME_SAMPLES)
+    {
+        a_sfa30_codec_pack(encoder);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief      seal the block
+ * @param[in]  *encoder pointer to an sfa30 codec encoder structure
+ * @param[out] *size pointer to a block size buffer
+ * @return     status code
+ *             - 0 success
+ *             - 2 encoder or size is NULL
+ *             - 4 block is empty
+ * @note       the open frame is packed and the header is written, sealing twice
+ *             returns the same size
+ */
+uint8_t sfa30_codec_encoder_seal(sfa30_codec_encoder_t *encoder, uint32_t *size)
+{
+    if ((encoder == NULL) || (size == NULL))
+    {
+        return 2;
+    }
+    if (encoder->count == 0)
+    {
+        return 4;
+    }
+
+    if (encoder->sealed == 0)
+    {
+        if (encoder->pending != 0)
+        {
+            a_sfa30_codec_pack(encoder);
+        }
+        memset(&encoder->buf[encoder->len], 0, SFA30_CODEC_PAD_SIZE);
+        encoder->len += SFA30_CODEC_PAD_SIZE;
+        a_sfa30_codec_put(&encoder->buf[0], encoder->count, 4);
+        a_sfa30_codec_put(&encoder->buf[4], encoder->len, 4);
+        encoder->sealed = 1;
+    }
+    *size = encoder->len;
+
+    return 0;
+}
+
+/**
+ * @brief      get the sample count of a sealed block
+ * @param[in]  *block pointer to a block
+ * @param[in]  size block size
+ * @param[out] *count pointer to a count buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 block is corrupt
+ *             - 2 block or count is NULL
+ * @note       none
+ */
+uint8_t sfa30_codec_get_count(const uint8_t *block, uint32_t size, uint32_t *count)
+{
+    if ((block == NULL) || (count == NULL))
+    {
+        return 2;
+    }
+    if ((size < SFA30_CODEC_MIN_BLOCK_SIZE) || (a_sfa30_codec_get(&block[4], 4) != size) ||
+        (a_sfa30_codec_get(&block[0], 4) == 0))
+    {
+        return 1;
+    }
+    *count = a_sfa30_codec_get(&block[0], 4);
+
+    return 0;
+}
+
+/**
+ * @brief      decode a sealed block
+ * @param[in]  *block pointer to a block
+ * @param[in]  size block size
+ * @param[in]  max max samples
+ * @param[out] *timestamp_ms pointer to a max timestamps array
+ * @param[out] *formaldehyde_raw pointer to a max formaldehyde raw array
+ * @param[out] *humidity_raw pointer to a max humidity raw array
+ * @param[out] *temperature_raw pointer to a max temperature raw array
+ * @param[out] *count pointer to a decoded count buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 block is corrupt
+ *             - 2 a pointer is NULL
+ *             - 4 max is less than the block count
+ * @note       timestamps wrap like the uint32_t they are coded from
+ */
+uint8_t sfa30_codec_decode(const uint8_t *block, uint32_t size, uint32_t max,
+                           uint32_t *timestamp_ms, int16_t *formaldehyde_raw,
+                           int16_t *humidity_raw, int16_t *temperature_raw, uint32_t *count)
+{
+    uint32_t r[4][SFA30_CODEC_FRAME_SAMPLES];
+    int32_t value[3][SFA30_CODEC_LANES];
+    int16_t *out[3];
+    int32_t raw[3];
+    const uint8_t *p;
+    const uint8_t *end;
+    uint32_t period;
+    uint32_t total;
+    uint32_t done;
+
+    if ((block == NULL) || (timestamp_ms == NULL) || (formaldehyde_raw == NULL) ||
+        (humidity_raw == NULL) || (temperature_raw == NULL) || (count == NULL))
+    {
+        return 2;
+    }
+    if (sfa30_codec_get_count(block, size, &total) != 0)
+    {
+        return 1;
+    }
+    if (max < total)
+    {
+        return 4;
+    }
+
+    /* first sample */
+    out[0] = formaldehyde_raw;
+    out[1] = humidity_raw;
+    out[2] = temperature_raw;
+    raw[0] = (int16_t)a_sfa30_codec_get(&block[14], 2);
+    raw[1] = (int16_t)a_sfa30_codec_get(&block[16], 2);
+    raw[2] = (int16_t)a_sfa30_codec_get(&block[18], 2);
+    timestamp_ms[0] = a_sfa30_codec_get(&block[8], 4);
+    formaldehyde_raw[0] = (int16_t)raw[0];
+    humidity_raw[0] = (int16_t)raw[1];
+    temperature_raw[0] = (int16_t)raw[2];
+    period = a_sfa30_codec_get(&block[12], 2);
+    a_sfa30_codec_lanes(raw, value);
+
+    /* frames, the pad keeps the next lane word loads of the last stream inside the block */
+    p = &block[SFA30_CODEC_HEADER_SIZE];
+    end = &block[size - SFA30_CODEC_PAD_SIZE];
+    for (done = 1; done < total; )
+    {
+        const uint8_t *q;
+        uint32_t *t = &timestamp_ms[done];
+        uint32_t n = total - done;
+        uint32_t base;
+        uint32_t j;
+        uint32_t l;
+        uint8_t s;
+
+        if (n > SFA30_CODEC_FRAME_SAMPLES)
+        {
+            n = SFA30_CODEC_FRAME_SAMPLES;
+        }
+        if ((end - p < SFA30_CODEC_FRAME_HEADER_SIZE) || (p[0] > 32) || (p[1] > 17) || (p[2] > 17) || (p[3] > 17) ||
+            ((uint32_t)(end - p) < SFA30_CODEC_FRAME_HEADER_SIZE +
+             a_sfa30_codec_stream_size(n, p[0]) + a_sfa30_codec_stream_size(n, p[1]) +
+             a_sfa30_codec_stream_size(n, p[2]) + a_sfa30_codec_stream_size(n, p[3])))
+        {
+            return 1;
+        }
+        base = a_sfa30_codec_get(&p[4], 4);
+        q = &p[SFA30_CODEC_FRAME_HEADER_SIZE];
+        if (n == SFA30_CODEC_FRAME_SAMPLES)
+        {
+            /* timestamps straight from their offsets, the values through 4 lane prefix sums */
+            gs_codec_unpack[p[0]](q, t);
+            q += a_sfa30_codec_stream_size(n, p[0]);
+            for (s = 0; s < 3; s++)
+            {
+                gs_codec_unpack[p[s + 1]](q, r[s]);
+                q += a_sfa30_codec_stream_size(n, p[s + 1]);
+            }
+            for (j = 0; j < SFA30_CODEC_FRAME_SAMPLES; j++)
+            {
+                t[j] += base;
+                base += period;
+            }
+            for (s = 0; s < 3; s++)
+            {
+                a_sfa30_codec_prefix(r[s], value[s], &out[s][done]);
+            }
+        }
+        else
+        {
+            /* the last frame unpacks whole lane words, so it goes through r */
+            for (s = 0; s < 4; s++)
+            {
+                a_sfa30_codec_unpack(q, n, p[s], r[s]);
+                q += a_sfa30_codec_stream_size(n, p[s]);
+            }
+            for (j = 0; j < n; j++)
+            {
+                l = j % SFA30_CODEC_LANES;
+                t[j] = base + j * period + r[0][j];
+                for (s = 0; s < 3; s++)
+                {
+                    value[s][l] += a_sfa30_codec_unzigzag(r[s + 1][j]);
+                    out[s][done + j] = (int16_t)value[s][l];
+                }
+            }
+        }
+        p = q;
+        done += n;
+    }
+    if (p != end)
+    {
+        return 1;
+    }
+    *count = total;
+
+    return 0;
+}
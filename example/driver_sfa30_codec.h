@@ -0,0 +1,183 @@
+/**
+ * Copyright (c) 2015 - present LibDriver All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_sfa30_codec.h
+ * @brief     driver sfa30 codec header file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2023-07-30
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2023/07/30  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#ifndef DRIVER_SFA30_CODEC_H
+#define DRIVER_SFA30_CODEC_H
+
+#include "driver_sfa30.h"
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/**
+ * @defgroup sfa30_codec_driver sfa30 codec driver function
+ * @brief    sfa30 codec driver modules
+ * @ingroup  sfa30_example_driver
+ * @{
+ */
+
+/**
+ * @brief sfa30 codec unroll selection, define it as 0 to save about 30 kB of decoder code
+ *        on small targets at about two thirds of the decode speed
+ */
+#ifndef SFA30_CODEC_UNROLL
+    #define SFA30_CODEC_UNROLL        1                           /**< unrolled decode kernels by default */
+#endif
+
+/**
+ * @brief sfa30 codec block layout definition
+ * @note  a block is a 20 bytes little endian header with the sample count, the block size,
+ *        the first timestamp, the nominal period and the first raw values, then one frame
+ *        per 128 samples and 16 zero bytes, a frame is 4 bit widths and the frame base
+ *        timestamp followed by 4 streams bit packed at their frame width into 4 interleaved
+ *        32 bits lanes, the timestamp offsets from base + k x period, which are the running
+ *        sums of the delta of deltas against the period, and the zig-zag coded raw value
+ *        deltas against sample i - 4, so the lanes decode independently
+ */
+#define SFA30_CODEC_FRAME_SAMPLES        128        /**< samples per frame */
+#define SFA30_CODEC_LANES                4          /**< interleaved lanes */
+#define SFA30_CODEC_HEADER_SIZE          20         /**< block header size */
+#define SFA30_CODEC_FRAME_HEADER_SIZE    8          /**< frame widths and base timestamp */
+#define SFA30_CODEC_PAD_SIZE             16         /**< zero bytes after the last frame */
+#define SFA30_CODEC_MIN_BLOCK_SIZE       (SFA30_CODEC_HEADER_SIZE + SFA30_CODEC_PAD_SIZE)        /**< smallest block */
+
+/**
+ * @brief sfa30 codec encoder structure definition
+ */
+typedef struct sfa30_codec_encoder_s
+{
+    uint8_t *buf;                                             /**< caller provided block buffer */
+    uint32_t cap;                                             /**< block buffer size */
+    uint32_t len;                                             /**< bytes of the header and the packed frames */
+    uint32_t count;                                           /**< samples in the block */
+    uint32_t period_ms;                                       /**< nominal period */
+    uint32_t frame_ms;                                        /**< first timestamp of the open frame */
+    int32_t low;                                              /**< lowest timestamp offset of the open frame */
+    int32_t high;                                             /**< highest timestamp offset of the open frame */
+    int32_t raw[3][SFA30_CODEC_LANES];                        /**< last raw values of each lane */
+    uint8_t sealed;                                           /**< sealed flag */
+    uint32_t pending;                                         /**< samples in the open frame */
+    uint32_t bits[4];                                         /**< offset range and or of the open frame residuals */
+    uint32_t residual[4][SFA30_CODEC_FRAME_SAMPLES];          /**< open frame residuals */
+} sfa30_codec_encoder_t;
+
+/**
+ * @brief     init an encoder for a new block
+ * @param[in] *encoder pointer to an sfa30 codec encoder structure
+ * @param[in] *buf pointer to a block buffer
+ * @param[in] cap block buffer size
+ * @param[in] period_ms nominal sampling period
+ * @return    status code
+ *            - 0 success
+ *            - 2 encoder or buf is NULL
+ *            - 4 cap is less than SFA30_CODEC_MIN_BLOCK_SIZE
+ * @note      timestamps are coded against period_ms, which is clamped to 65535, samples
+ *            on the period grid cost no timestamp bits
+ */
+uint8_t sfa30_codec_encoder_init(sfa30_codec_encoder_t *encoder, uint8_t *buf, uint32_t cap, uint32_t period_ms);
+
+/**
+ * @brief     append a sample to the block
+ * @param[in] *encoder pointer to an sfa30 codec encoder structure
+ * @param[in] timestamp_ms sample timestamp
+ * @param[in] *data pointer to an sfa30_data_t structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 block is full, the sample is not appended
+ *            - 2 encoder or data is NULL
+ *            - 4 block is sealed
+ * @note      only the open frame is kept in the encoder, a full block must be sealed
+ *            and the sample appended to a new one
+ */
+uint8_t sfa30_codec_encoder_append(sfa30_codec_encoder_t *encoder, uint32_t timestamp_ms, const sfa30_data_t *data);
+
+/**
+ * @brief      seal the block
+ * @param[in]  *encoder pointer to an sfa30 codec encoder structure
+ * @param[out] *size pointer to a block size buffer
+ * @return     status code
+ *             - 0 success
+ *             - 2 encoder or size is NULL
+ *             - 4 block is empty
+ * @note       the open frame is packed and the header is written, sealing twice
+ *             returns the same size
+ */
+uint8_t sfa30_codec_encoder_seal(sfa30_codec_encoder_t *encoder, uint32_t *size);
+
+/**
+ * @brief      get the sample count of a sealed block
+ * @param[in]  *block pointer to a block
+ * @param[in]  size block size
+ * @param[out] *count pointer to a count buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 block is corrupt
+ *             - 2 block or count is NULL
+ * @note       none
+ */
+uint8_t sfa30_codec_get_count(const uint8_t *block, uint32_t size, uint32_t *count);
+
+/**
+ * @brief      decode a sealed block
+ * @param[in]  *block pointer to a block
+ * @param[in]  size block size
+ * @param[in]  max max samples
+ * @param[out] *timestamp_ms pointer to a max timestamps array
+ * @param[out] *formaldehyde_raw pointer to a max formaldehyde raw array
+ * @param[out] *humidity_raw pointer to a max humidity raw array
+ * @param[out] *temperature_raw pointer to a max temperature raw array
+ * @param[out] *count pointer to a decoded count buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 block is corrupt
+ *             - 2 a pointer is NULL
+ *             - 4 max is less than the block count
+ * @note       timestamps wrap like the uint32_t they are coded from
+ */
+uint8_t sfa30_codec_decode(const uint8_t *block, uint32_t size, uint32_t max,
+                           uint32_t *timestamp_ms, int16_t *formaldehyde_raw,
+                           int16_t *humidity_raw, int16_t *temperature_raw, uint32_t *count);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,203 @@
+/**
+ * Copyright (c) 2015 - present LibDriver All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_sfa30_deadband.c
+ * @brief     driver sfa30 deadband source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2023-07-30
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2023/07/30  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#include "driver_sfa30_deadband.h"
+
+/**
+ * @brief     get the band around a reported value
+ * @param[in] *channel pointer to a channel structure
+ * @param[in] raw reported raw value
+ * @return    band in raw units
+ * @note      computed once per report, so a dropped sample costs no division
+ */
+static uint16_t a_sfa30_deadband_band(const sfa30_deadband_channel_t *channel, int16_t raw)
+{
+    uint32_t magnitude = (raw < 0) ? (uint32_t)(-(int32_t)raw) : (uint32_t)raw;
+    uint32_t relative = (magnitude * channel->relative_bp) / 10000U;
+
+    relative = (relative > 0xFFFFU) ? 0xFFFFU : relative;
+
+    return (relative > channel->absolute_raw) ? (uint16_t)relative : channel->absolute_raw;
+}
+
+/**
+ * @brief     init the deadband filter
+ * @param[in] *filter pointer to an sfa30 deadband structure
+ * @param[in] *config pointer to a config structure
+ * @return    status code
+ *            - 0 success
+ *            - 2 filter or config is NULL
+ * @note      the first filtered sample is always reported
+ */
+uint8_t sfa30_deadband_init(sfa30_deadband_t *filter, const sfa30_deadband_config_t *config)
+{
+    uint8_t c;
+
+    if ((filter == NULL) || (config == NULL))
+    {
+        return 2;
+    }
+
+    filter->channel[0] = config->formaldehyde;
+    filter->channel[1] = config->humidity;
+    filter->channel[2] = config->temperature;
+    filter->heartbeat_ms = config->heartbeat_ms;
+    filter->last_ms = 0;
+    for (c = 0; c < 3; c++)
+    {
+        filter->last_raw[c] = 0;
+        filter->band[c] = 0;
+        filter->direction[c] = 0;
+    }
+    filter->reported = 0;
+    filter->samples = 0;
+    filter->reports = 0;
+    filter->heartbeats = 0;
+
+    return 0;
+}
+
+/**
+ * @brief      filter a sample
+ * @param[in]  *filter pointer to an sfa30 deadband structure
+ * @param[in]  timestamp_ms sample timestamp
+ * @param[in]  *data pointer to an sfa30_data_t structure
+ * @param[out] *report pointer to a report buffer, a mask of sfa30_deadband_report_t, 0 drops the sample
+ * @return     status code
+ *             - 0 success
+ *             - 2 filter, data or report is NULL
+ * @note       holding the last reported sample reconstructs every dropped sample within
+ *             band + hysteresis_raw of each channel, where band is taken at the last report
+ */
+uint8_t sfa30_deadband_filter(sfa30_deadband_t *filter, uint32_t timestamp_ms, const sfa30_data_t *data, uint8_t *report)
+{
+    uint8_t c;
+    uint8_t mask = 0;
+    int8_t direction;
+    int32_t delta;
+    int32_t limit;
+    int16_t raw[3];
+
+    if ((filter == NULL) || (data == NULL) || (report == NULL))
+    {
+        return 2;
+    }
+
+    raw[0] = data->formaldehyde_raw;
+    raw[1] = data->humidity_raw;
+    raw[2] = data->temperature_raw;
+    filter->samples++;
+    if (filter->reported == 0)
+    {
+        mask = SFA30_DEADBAND_REPORT_FIRST;
+    }
+    else
+    {
+        /* a reversal must also clear the hysteresis, so a 1 lsb flicker stays quiet */
+        for (c = 0; c < 3; c++)
+        {
+            delta = (int32_t)raw[c] - (int32_t)filter->last_raw[c];
+            limit = filter->band[c];
+            if (((delta > 0) && (filter->direction[c] < 0)) || ((delta < 0) && (filter->direction[c] > 0)))
+            {
+                limit += filter->channel[c].hysteresis_raw;
+            }
+            if ((delta > limit) || (delta < -limit))
+            {
+                mask |= (uint8_t)(SFA30_DEADBAND_REPORT_FORMALDEHYDE << c);
+            }
+        }
+        if ((filter->heartbeat_ms != 0) && ((uint32_t)(timestamp_ms - filter->last_ms) >= filter->heartbeat_ms))
+        {
+            mask |= SFA30_DEADBAND_REPORT_HEARTBEAT;
+            filter->heartbeats += (mask == SFA30_DEADBAND_REPORT_HEARTBEAT) ? 1U : 0U;
+        }
+    }
+
+    /* a report moves the reference of every channel */
+    if (mask != 0)
+    {
+        for (c = 0; c < 3; c++)
+        {
+            if (raw[c] != filter->last_raw[c])
+            {
+                direction = (raw[c] > filter->last_raw[c]) ? 1 : -1;
+                filter->direction[c] = (filter->reported != 0) ? direction : 0;
+                filter->last_raw[c] = raw[c];
+            }
+            filter->band[c] = a_sfa30_deadband_band(&filter->channel[c], raw[c]);
+        }
+        filter->last_ms = timestamp_ms;
+        filter->reported = 1;
+        filter->reports++;
+    }
+    *report = mask;
+
+    return 0;
+}
+
+/**
+ * @brief      get the achieved reduction
+ * @param[in]  *filter pointer to an sfa30 deadband structure
+ * @param[out] *samples pointer to a filtered samples buffer
+ * @param[out] *reports pointer to a reported samples buffer
+ * @param[out] *ratio_q8 pointer to a samples per report x 256 buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 nothing was reported yet
+ *             - 2 filter, samples, reports or ratio_q8 is NULL
+ * @note       a ratio of 2560 means 1 of 10 samples went downstream
+ */
+uint8_t sfa30_deadband_get_reduction(const sfa30_deadband_t *filter, uint32_t *samples,
+                                     uint32_t *reports, uint32_t *ratio_q8)
+{
+    if ((filter == NULL) || (samples == NULL) || (reports == NULL) || (ratio_q8 == NULL))
+    {
+        return 2;
+    }
+
+    *samples = filter->samples;
+    *reports = filter->reports;
+    if (filter->reports == 0)
+    {
+        *ratio_q8 = 0;
+
+        return 1;
+    }
+    *ratio_q8 = (uint32_t)(((uint64_t)filter->samples << 8) / filter->reports);
+
+    return 0;
+}
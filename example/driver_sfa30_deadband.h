@@ -0,0 +1,154 @@
+/**
+ * Copyright (c) 2015 - present LibDriver All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_sfa30_deadband.h
+ * @brief     driver sfa30 deadband header file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2023-07-30
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2023/07/30  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#ifndef DRIVER_SFA30_DEADBAND_H
+#define DRIVER_SFA30_DEADBAND_H
+
+#include "driver_sfa30.h"
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/**
+ * @defgroup sfa30_deadband_driver sfa30 deadband driver function
+ * @brief    sfa30 deadband driver modules
+ * @ingroup  sfa30_example_driver
+ * @{
+ */
+
+/**
+ * @brief sfa30 deadband report enumeration definition
+ */
+typedef enum
+{
+    SFA30_DEADBAND_REPORT_FIRST = 0x01,               /**< first sample */
+    SFA30_DEADBAND_REPORT_FORMALDEHYDE = 0x02,        /**< formaldehyde left its band */
+    SFA30_DEADBAND_REPORT_HUMIDITY = 0x04,            /**< humidity left its band */
+    SFA30_DEADBAND_REPORT_TEMPERATURE = 0x08,         /**< temperature left its band */
+    SFA30_DEADBAND_REPORT_HEARTBEAT = 0x10,           /**< max silence elapsed */
+} sfa30_deadband_report_t;
+
+/**
+ * @brief sfa30 deadband channel structure definition
+ * @note  the band around the last reported value is the larger of absolute_raw and
+ *        relative_bp of that value, a change against the direction of the last
+ *        reported change must also clear hysteresis_raw
+ */
+typedef struct sfa30_deadband_channel_s
+{
+    uint16_t absolute_raw;          /**< absolute band in raw units */
+    uint16_t relative_bp;           /**< relative band in 0.01 % of the last reported value */
+    uint16_t hysteresis_raw;        /**< extra band against a change of direction in raw units */
+} sfa30_deadband_channel_t;
+
+/**
+ * @brief sfa30 deadband config structure definition
+ */
+typedef struct sfa30_deadband_config_s
+{
+    sfa30_deadband_channel_t formaldehyde;        /**< formaldehyde band, raw is ppb * 5 */
+    sfa30_deadband_channel_t humidity;            /**< humidity band, raw is % * 100 */
+    sfa30_deadband_channel_t temperature;         /**< temperature band, raw is C * 200 */
+    uint32_t heartbeat_ms;                        /**< max silence between reports, 0 disables it */
+} sfa30_deadband_config_t;
+
+/**
+ * @brief sfa30 deadband structure definition
+ */
+typedef struct sfa30_deadband_s
+{
+    sfa30_deadband_channel_t channel[3];        /**< bands of the 3 channels */
+    uint32_t heartbeat_ms;                      /**< max silence between reports */
+    uint32_t last_ms;                           /**< timestamp of the last report */
+    int16_t last_raw[3];                        /**< last reported raw values */
+    uint16_t band[3];                           /**< bands around the last reported values */
+    int8_t direction[3];                        /**< sign of the last reported change */
+    uint8_t reported;                           /**< a sample was reported */
+    uint32_t samples;                           /**< filtered samples */
+    uint32_t reports;                           /**< reported samples */
+    uint32_t heartbeats;                        /**< reports caused by the heartbeat only */
+} sfa30_deadband_t;
+
+/**
+ * @brief     init the deadband filter
+ * @param[in] *filter pointer to an sfa30 deadband structure
+ * @param[in] *config pointer to a config structure
+ * @return    status code
+ *            - 0 success
+ *            - 2 filter or config is NULL
+ * @note      the first filtered sample is always reported
+ */
+uint8_t sfa30_deadband_init(sfa30_deadband_t *filter, const sfa30_deadband_config_t *config);
+
+/**
+ * @brief      filter a sample
+ * @param[in]  *filter pointer to an sfa30 deadband structure
+ * @param[in]  timestamp_ms sample timestamp
+ * @param[in]  *data pointer to an sfa30_data_t structure
+ * @param[out] *report pointer to a report buffer, a mask of sfa30_deadband_report_t, 0 drops the sample
+ * @return     status code
+ *             - 0 success
+ *             - 2 filter, data or report is NULL
+ * @note       holding the last reported sample reconstructs every dropped sample within
+ *             band + hysteresis_raw of each channel, where band is taken at the last report
+ */
+uint8_t sfa30_deadband_filter(sfa30_deadband_t *filter, uint32_t timestamp_ms, const sfa30_data_t *data, uint8_t *report);
+
+/**
+ * @brief      get the achieved reduction
+ * @param[in]  *filter pointer to an sfa30 deadband structure
+ * @param[out] *samples pointer to a filtered samples buffer
+ * @param[out] *reports pointer to a reported samples buffer
+ * @param[out] *ratio_q8 pointer to a samples per report x 256 buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 nothing was reported yet
+ *             - 2 filter, samples, reports or ratio_q8 is NULL
+ * @note       a ratio of 2560 means 1 of 10 samples went downstream
+ */
+uint8_t sfa30_deadband_get_reduction(const sfa30_deadband_t *filter, uint32_t *samples,
+                                     uint32_t *reports, uint32_t *ratio_q8);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,485 @@
+/**
+ * Copyright (c) 2015 - present LibDriver All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_sfa30_decode.c
+ * @brief     driver sfa30 decode source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2023-07-30
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2023/07/30  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#include "driver_sfa30_decode.h"
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    #define SFA30_DECODE_X86        1
+    #include <immintrin.h>
+#endif
+#if defined(__aarch64__) && defined(__ARM_NEON)
+    #define SFA30_DECODE_NEON       1
+    #include <arm_neon.h>
+#endif
+#if defined(__GNUC__)
+    #define SFA30_DECODE_ALIGN16                __attribute__((aligned(16)))
+    #define SFA30_DECODE_LOAD(VAR)              __atomic_load_n(&(VAR), __ATOMIC_ACQUIRE)
+    #define SFA30_DECODE_STORE(VAR, VALUE)      __atomic_store_n(&(VAR), (VALUE), __ATOMIC_RELEASE)
+#else
+    #define SFA30_DECODE_ALIGN16
+    #define SFA30_DECODE_LOAD(VAR)              (VAR)
+    #define SFA30_DECODE_STORE(VAR, VALUE)      ((VAR) = (VALUE))
+#endif
+
+/**
+ * @brief decode kernel definition
+ */
+typedef uint32_t (*sfa30_decode_fn_t)(const uint8_t *frames, uint32_t n,
+                                      float *formaldehyde, float *humidity, float *temperature,
+                                      uint8_t *crc_mask);
+
+/**
+ * @brief crc nibble tables
+ * @note  the crc T with init 0 and polynomial 0x31 is linear, so crc(b0, b1) with init 0xFF is
+ *        T(T(b0 ^ 0xFF)) ^ T(b1) and each byte map splits into two nibble lookups
+ */
+static const uint8_t gsc_crc_tt_lo[16] SFA30_DECODE_ALIGN16 =        /**< T(T(x)) of the low nibble */
+{
+    0x00, 0xF4, 0xD9, 0x2D, 0x83, 0x77, 0x5A, 0xAE, 0x37, 0xC3, 0xEE, 0x1A, 0xB4, 0x40, 0x6D, 0x99,
+};
+static const uint8_t gsc_crc_tt_hi[16] SFA30_DECODE_ALIGN16 =        /**< T(T(x)) of the high nibble */
+{
+    0x00, 0x6E, 0xDC, 0xB2, 0x89, 0xE7, 0x55, 0x3B, 0x23, 0x4D, 0xFF, 0x91, 0xAA, 0xC4, 0x76, 0x18,
+};
+static const uint8_t gsc_crc_t_lo[16] SFA30_DECODE_ALIGN16 =         /**< T(x) of the low nibble */
+{
+    0x00, 0x31, 0x62, 0x53, 0xC4, 0xF5, 0xA6, 0x97, 0xB9, 0x88, 0xDB, 0xEA, 0x7D, 0x4C, 0x1F, 0x2E,
+};
+static const uint8_t gsc_crc_t_hi[16] SFA30_DECODE_ALIGN16 =         /**< T(x) of the high nibble */
+{
+    0x00, 0x43, 0x86, 0xC5, 0x3D, 0x7E, 0xBB, 0xF8, 0x7A, 0x39, 0xFC, 0xBF, 0x47, 0x04, 0xC1, 0x82,
+};
+
+/**
+ * @brief kernel in use
+ * @note  published with a release store after its id, read with an acquire load,
+ *        so concurrent first calls may both pick it and agree
+ */
+static sfa30_decode_fn_t gs_decode_fn = NULL;                                   /**< kernel in use */
+static sfa30_decode_kernel_t gs_decode_kernel = SFA30_DECODE_KERNEL_SCALAR;     /**< kernel id in use */
+
+/**
+ * @brief     decode frames first to n - 1 one by one
+ * @param[in] first first frame
+ * @note      the vector kernels leave the tail to it
+ */
+static void a_sfa30_decode_range(const uint8_t *frames, uint32_t first, uint32_t n,
+                                 float *formaldehyde, float *humidity, float *temperature,
+                                 uint8_t *crc_mask)
+{
+    uint32_t i;
+
+    for (i = first; i < n; i++)
+    {
+        const uint8_t *p = &frames[i * SFA30_DECODE_FRAME_SIZE];
+
+        if ((sfa30_crc8(&p[0], 2) == p[2]) &&
+            (sfa30_crc8(&p[3], 2) == p[5]) &&
+            (sfa30_crc8(&p[6], 2) == p[8]))
+        {
+            crc_mask[i >> 3] |= (uint8_t)(1 << (i & 7));
+        }
+        formaldehyde[i] = (float)((int16_t)(((uint16_t)p[0] << 8) | p[1])) / 5.0f;
+        humidity[i] = (float)((int16_t)(((uint16_t)p[3] << 8) | p[4])) / 100.0f;
+        temperature[i] = (float)((int16_t)(((uint16_t)p[6] << 8) | p[7])) / 200.0f;
+    }
+}
+
+/**
+ * @brief scalar kernel
+ * @note  none
+ */
+static uint32_t a_sfa30_decode_scalar(const uint8_t *frames, uint32_t n,
+                                      float *formaldehyde, float *humidity, float *temperature,
+                                      uint8_t *crc_mask)
+{
+    a_sfa30_decode_range(frames, 0, n, formaldehyde, humidity, temperature, crc_mask);
+
+    return n;
+}
+
+#ifdef SFA30_DECODE_X86
+/**
+ * @brief     check and convert one word of 4 frames
+ * @param[in] w one word per 32 bits lane, byte 0 msb, byte 1 lsb, byte 2 crc
+ * @param[in] scale raw to unit divisor
+ * @param[in] *out pointer to 4 output floats
+ * @return    crc ok bits of the 4 frames
+ * @note      none
+ */
+__attribute__((target("sse4.1")))
+static inline uint32_t a_sfa30_decode_word_sse41(__m128i w, float scale, float *out)
+{
+    const __m128i nib = _mm_set1_epi32(0x0F);
+    __m128i b0 = _mm_xor_si128(_mm_and_si128(w, _mm_set1_epi32(0xFF)), _mm_set1_epi32(0xFF));
+    __m128i b1 = _mm_and_si128(_mm_srli_epi32(w, 8), _mm_set1_epi32(0xFF));
+    __m128i c = _mm_and_si128(_mm_srli_epi32(w, 16), _mm_set1_epi32(0xFF));
+    __m128i crc;
+    __m128i v;
+
+    crc = _mm_xor_si128(_mm_shuffle_epi8(_mm_load_si128((const __m128i *)gsc_crc_tt_lo), _mm_and_si128(b0, nib)),
+                        _mm_shuffle_epi8(_mm_load_si128((const __m128i *)gsc_crc_tt_hi), _mm_srli_epi32(b0, 4)));
+    crc = _mm_xor_si128(crc, _mm_shuffle_epi8(_mm_load_si128((const __m128i *)gsc_crc_t_lo), _mm_and_si128(b1, nib)));
+    crc = _mm_xor_si128(crc, _mm_shuffle_epi8(_mm_load_si128((const __m128i *)gsc_crc_t_hi), _mm_srli_epi32(b1, 4)));
+    v = _mm_or_si128(_mm_slli_epi32(w, 24), _mm_slli_epi32(_mm_and_si128(w, _mm_set1_epi32(0xFF00)), 8));
+    v = _mm_srai_epi32(v, 16);
+    _mm_storeu_ps(out, _mm_div_ps(_mm_cvtepi32_ps(v), _mm_set1_ps(scale)));
+
+    return (uint32_t)_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(crc, c)));
+}
+
+/**
+ * @brief sse4.1 kernel
+ * @note  4 frames per step, each frame is loaded with 16 bytes so one frame
+ *        more than the step must follow
+ */
+__attribute__((target("sse4.1")))
+static uint32_t a_sfa30_decode_sse41(const uint8_t *frames, uint32_t n,
+                                     float *formaldehyde, float *humidity, float *temperature,
+                                     uint8_t *crc_mask)
+{
+    const __m128i spread = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, -1, -1, -1, -1);
+    uint32_t i;
+
+    for (i = 0; i + 4 < n; i += 4)
+    {
+        const uint8_t *p = &frames[i * SFA30_DECODE_FRAME_SIZE];
+        __m128i r0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(p + 0)), spread);
+        __m128i r1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(p + 9)), spread);
+        __m128i r2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(p + 18)), spread);
+        __m128i r3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(p + 27)), spread);
+        __m128i t0 = _mm_unpacklo_epi32(r0, r1);
+        __m128i t1 = _mm_unpacklo_epi32(r2, r3);
+        __m128i t2 = _mm_unpackhi_epi32(r0, r1);
+        __m128i t3 = _mm_unpackhi_epi32(r2, r3);
+        uint32_t ok;
+
+        ok = a_sfa30_decode_word_sse41(_mm_unpacklo_epi64(t0, t1), 5.0f, &formaldehyde[i]);
+        ok &= a_sfa30_decode_word_sse41(_mm_unpackhi_epi64(t0, t1), 100.0f, &humidity[i]);
+        ok &= a_sfa30_decode_word_sse41(_mm_unpacklo_epi64(t2, t3), 200.0f, &temperature[i]);
+        crc_mask[i >> 3] |= (uint8_t)(ok << (i & 7));
+    }
+
+    return i;
+}
+
+/**
+ * @brief     check and convert one word of 8 frames
+ * @param[in] w one word per 32 bits lane, byte 0 msb, byte 1 lsb, byte 2 crc
+ * @param[in] scale raw to unit divisor
+ * @param[in] *out pointer to 8 output floats
+ * @return    crc ok bits of the 8 frames
+ * @note      none
+ */
+__attribute__((target("avx2")))
+static inline uint32_t a_sfa30_decode_word_avx2(__m256i w, float scale, float *out)
+{
+    const __m256i nib = _mm256_set1_epi32(0x0F);
+    __m256i b0 = _mm256_xor_si256(_mm256_and_si256(w, _mm256_set1_epi32(0xFF)), _mm256_set1_epi32(0xFF));
+    __m256i b1 = _mm256_and_si256(_mm256_srli_epi32(w, 8), _mm256_set1_epi32(0xFF));
+    __m256i c = _mm256_and_si256(_mm256_srli_epi32(w, 16), _mm256_set1_epi32(0xFF));
+    __m256i crc;
+    __m256i v;
+
+    crc = _mm256_xor_si256(_mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_load_si128((const __m128i *)gsc_crc_tt_lo)), _mm256_and_si256(b0, nib)),
+                           _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_load_si128((const __m128i *)gsc_crc_tt_hi)), _mm256_srli_epi32(b0, 4)));
+    crc = _mm256_xor_si256(crc, _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_load_si128((const __m128i *)gsc_crc_t_lo)), _mm256_and_si256(b1, nib)));
+    crc = _mm256_xor_si256(crc, _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_load_si128((const __m128i *)gsc_crc_t_hi)), _mm256_srli_epi32(b1, 4)));
+    v = _mm256_or_si256(_mm256_slli_epi32(w, 24), _mm256_slli_epi32(_mm256_and_si256(w, _mm256_set1_epi32(0xFF00)), 8));
+    v = _mm256_srai_epi32(v, 16);
+    _mm256_storeu_ps(out, _mm256_div_ps(_mm256_cvtepi32_ps(v), _mm256_set1_ps(scale)));
+
+    return (uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(crc, c)));
+}
+
+/**
+ * @brief avx2 kernel
+ * @note  8 frames per step, the gather reads one byte past the last word so
+ *        one frame more than the step must follow
+ */
+__attribute__((target("avx2")))
+static uint32_t a_sfa30_decode_avx2(const uint8_t *frames, uint32_t n,
+                                    float *formaldehyde, float *humidity, float *temperature,
+                                    uint8_t *crc_mask)
+{
+    const __m256i index = _mm256_setr_epi32(0, 9, 18, 27, 36, 45, 54, 63);
+    uint32_t i;
+
+    for (i = 0; i + 8 < n; i += 8)
+    {
+        const uint8_t *p = &frames[i * SFA30_DECODE_FRAME_SIZE];
+        uint32_t ok;
+
+        ok = a_sfa30_decode_word_avx2(_mm256_i32gather_epi32((const int *)(p + 0), index, 1), 5.0f, &formaldehyde[i]);
+        ok &= a_sfa30_decode_word_avx2(_mm256_i32gather_epi32((const int *)(p + 3), index, 1), 100.0f, &humidity[i]);
+        ok &= a_sfa30_decode_word_avx2(_mm256_i32gather_epi32((const int *)(p + 6), index, 1), 200.0f, &temperature[i]);
+        crc_mask[i >> 3] = (uint8_t)ok;
+    }
+
+    return i;
+}
+#endif
+
+#ifdef SFA30_DECODE_NEON
+/**
+ * @brief     check and convert one word of 16 frames
+ * @param[in] b0 msb of each frame
+ * @param[in] b1 lsb of each frame
+ * @param[in] c crc of each frame
+ * @param[in] scale raw to unit divisor
+ * @param[in] *out pointer to 16 output floats
+ * @return    0xFF in the lanes whose crc is right
+ * @note      none
+ */
+static inline uint8x16_t a_sfa30_decode_word_neon(uint8x16_t b0, uint8x16_t b1, uint8x16_t c, float scale, float *out)
+{
+    const uint8x16_t nib = vdupq_n_u8(0x0F);
+    const float32x4_t s = vdupq_n_f32(scale);
+    uint8x16_t x = veorq_u8(b0, vdupq_n_u8(0xFF));
+    uint8x16_t crc;
+    int16x8_t lo;
+    int16x8_t hi;
+
+    crc = veorq_u8(vqtbl1q_u8(vld1q_u8(gsc_crc_tt_lo), vandq_u8(x, nib)),
+                   vqtbl1q_u8(vld1q_u8(gsc_crc_tt_hi), vshrq_n_u8(x, 4)));
+    crc = veorq_u8(crc, vqtbl1q_u8(vld1q_u8(gsc_crc_t_lo), vandq_u8(b1, nib)));
+    crc = veorq_u8(crc, vqtbl1q_u8(vld1q_u8(gsc_crc_t_hi), vshrq_n_u8(b1, 4)));
+    lo = vreinterpretq_s16_u8(vzip1q_u8(b1, b0));
+    hi = vreinterpretq_s16_u8(vzip2q_u8(b1, b0));
+    vst1q_f32(&out[0], vdivq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(lo))), s));
+    vst1q_f32(&out[4], vdivq_f32(vcvtq_f32_s32(vmovl_high_s16(lo)), s));
+    vst1q_f32(&out[8], vdivq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(hi))), s));
+    vst1q_f32(&out[12], vdivq_f32(vcvtq_f32_s32(vmovl_high_s16(hi)), s));
+
+    return vceqq_u8(crc, c);
+}
+
+/**
+ * @brief neon kernel
+ * @note  16 frames per step, three vld3 split the 144 bytes into msb, lsb and
+ *        crc of 48 words, a three table lookup then picks each field
+ */
+static uint32_t a_sfa30_decode_neon(const uint8_t *frames, uint32_t n,
+                                    float *formaldehyde, float *humidity, float *temperature,
+                                    uint8_t *crc_mask)
+{
+    static const uint8_t bits[16] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+    static const uint8_t index[3][16] =
+    {
+        {0, 3, 6, 9, 12, 15, 18, 21, 24, 27, 30, 33, 36, 39, 42, 45},
+        {1, 4, 7, 10, 13, 16, 19, 22, 25, 28, 31, 34, 37, 40, 43, 46},
+        {2, 5, 8, 11, 14, 17, 20, 23, 26, 29, 32, 35, 38, 41, 44, 47},
+    };
+    const float scale[3] = {5.0f, 100.0f, 200.0f};
+    float *out[3];
+    uint32_t i;
+    uint8_t f;
+
+    out[0] = formaldehyde;
+    out[1] = humidity;
+    out[2] = temperature;
+    for (i = 0; i + 16 <= n; i += 16)
+    {
+        const uint8_t *p = &frames[i * SFA30_DECODE_FRAME_SIZE];
+        uint8x16x3_t w0 = vld3q_u8(p + 0);
+        uint8x16x3_t w1 = vld3q_u8(p + 48);
+        uint8x16x3_t w2 = vld3q_u8(p + 96);
+        uint8x16x3_t msb = {{w0.val[0], w1.val[0], w2.val[0]}};
+        uint8x16x3_t lsb = {{w0.val[1], w1.val[1], w2.val[1]}};
+        uint8x16x3_t crc = {{w0.val[2], w1.val[2], w2.val[2]}};
+        uint8x16_t ok = vdupq_n_u8(0xFF);
+
+        for (f = 0; f < 3; f++)
+        {
+            uint8x16_t idx = vld1q_u8(index[f]);
+
+            ok = vandq_u8(ok, a_sfa30_decode_word_neon(vqtbl3q_u8(msb, idx), vqtbl3q_u8(lsb, idx),
+                                                       vqtbl3q_u8(crc, idx), scale[f], &out[f][i]));
+        }
+        ok = vandq_u8(ok, vld1q_u8(bits));
+        crc_mask[(i >> 3) + 0] = vaddv_u8(vget_low_u8(ok));
+        crc_mask[(i >> 3) + 1] = vaddv_u8(vget_high_u8(ok));
+    }
+
+    return i;
+}
+#endif
+
+/**
+ * @brief     check if a kernel runs on this build and cpu
+ * @param[in] kernel decode kernel
+ * @return    kernel function or NULL
+ * @note      none
+ */
+static sfa30_decode_fn_t a_sfa30_decode_lookup(sfa30_decode_kernel_t kernel)
+{
+    switch (kernel)
+    {
+        case SFA30_DECODE_KERNEL_SCALAR :
+        {
+            return a_sfa30_decode_scalar;
+        }
+#ifdef SFA30_DECODE_X86
+        case SFA30_DECODE_KERNEL_SSE41 :
+        {
+            return (__builtin_cpu_supports("sse4.1") != 0) ? a_sfa30_decode_sse41 : NULL;
+        }
+        case SFA30_DECODE_KERNEL_AVX2 :
+        {
+            return (__builtin_cpu_supports("avx2") != 0) ? a_sfa30_decode_avx2 : NULL;
+        }
+#endif
+#ifdef SFA30_DECODE_NEON
+        case SFA30_DECODE_KERNEL_NEON :
+        {
+            return a_sfa30_decode_neon;
+        }
+#endif
+        default :
+        {
+            return NULL;
+        }
+    }
+}
+
+/**
+ * @brief  pick the best kernel
+ * @return kernel in use
+ * @note   none
+ */
+static sfa30_decode_fn_t a_sfa30_decode_init(void)
+{
+    static const sfa30_decode_kernel_t order[] =
+    {
+        SFA30_DECODE_KERNEL_NEON,
+        SFA30_DECODE_KERNEL_AVX2,
+        SFA30_DECODE_KERNEL_SSE41,
+        SFA30_DECODE_KERNEL_SCALAR,
+    };
+    sfa30_decode_fn_t fn = NULL;
+    uint8_t i;
+
+    for (i = 0; (i < sizeof(order) / sizeof(order[0])) && (fn == NULL); i++)
+    {
+        fn = a_sfa30_decode_lookup(order[i]);
+        if (fn != NULL)
+        {
+            SFA30_DECODE_STORE(gs_decode_kernel, order[i]);
+            SFA30_DECODE_STORE(gs_decode_fn, fn);
+        }
+    }
+
+    return fn;
+}
+
+/**
+ * @brief      decode a batch of iic read measured values responses
+ * @param[in]  *frames pointer to n back to back 9 bytes responses
+ * @param[in]  n number of responses
+ * @param[out] *formaldehyde pointer to an n floats formaldehyde array in ppb
+ * @param[out] *humidity pointer to an n floats humidity array in %
+ * @param[out] *temperature pointer to an n floats temperature array in C
+ * @param[out] *crc_mask pointer to an (n + 7) / 8 bytes mask, bit i % 8 of byte i / 8
+ *                       is set when all three crcs of response i are right
+ * @return     status code
+ *             - 0 success
+ *             - 2 a pointer is NULL
+ * @note       values are written for every response, crc_mask tells which are valid,
+ *             the floats are bit exact with sfa30_read
+ */
+uint8_t sfa30_decode_batch(const uint8_t *frames, uint32_t n,
+                           float *formaldehyde, float *humidity, float *temperature,
+                           uint8_t *crc_mask)
+{
+    sfa30_decode_fn_t fn;
+    uint32_t done;
+
+    if ((frames == NULL) || (formaldehyde == NULL) || (humidity == NULL) ||
+        (temperature == NULL) || (crc_mask == NULL))
+    {
+        return 2;
+    }
+    fn = SFA30_DECODE_LOAD(gs_decode_fn);
+    if (fn == NULL)
+    {
+        fn = a_sfa30_decode_init();
+    }
+
+    memset(crc_mask, 0, (n + 7) / 8);
+    done = fn(frames, n, formaldehyde, humidity, temperature, crc_mask);
+    a_sfa30_decode_range(frames, done, n, formaldehyde, humidity, temperature, crc_mask);
+
+    return 0;
+}
+
+/**
+ * @brief     force a decode kernel
+ * @param[in] kernel decode kernel
+ * @return    status code
+ *            - 0 success
+ *            - 1 kernel is not supported by this build or cpu
+ * @note      the best supported kernel is used by default
+ */
+uint8_t sfa30_decode_set_kernel(sfa30_decode_kernel_t kernel)
+{
+    sfa30_decode_fn_t fn;
+
+    fn = a_sfa30_decode_lookup(kernel);
+    if (fn == NULL)
+    {
+        return 1;
+    }
+    SFA30_DECODE_STORE(gs_decode_kernel, kernel);
+    SFA30_DECODE_STORE(gs_decode_fn, fn);
+
+    return 0;
+}
+
+/**
+ * @brief  get the decode kernel in use
+ * @return decode kernel
+ * @note   none
+ */
+sfa30_decode_kernel_t sfa30_decode_get_kernel(void)
+{
+    if (SFA30_DECODE_LOAD(gs_decode_fn) == NULL)
+    {
+        (void)a_sfa30_decode_init();
+    }
+
+    return SFA30_DECODE_LOAD(gs_decode_kernel);
+}
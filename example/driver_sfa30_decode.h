@@ -0,0 +1,113 @@
+/**
+ * Copyright (c) 2015 - present LibDriver All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_sfa30_decode.h
+ * @brief     driver sfa30 decode header file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2023-07-30
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2023/07/30  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#ifndef DRIVER_SFA30_DECODE_H
+#define DRIVER_SFA30_DECODE_H
+
+#include "driver_sfa30.h"
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/**
+ * @defgroup sfa30_decode_driver sfa30 decode driver function
+ * @brief    sfa30 decode driver modules
+ * @ingroup  sfa30_example_driver
+ * @{
+ */
+
+/**
+ * @brief sfa30 iic read measured values response length
+ */
+#define SFA30_DECODE_FRAME_SIZE        9        /**< three words, each followed by its crc */
+
+/**
+ * @brief sfa30 decode kernel enumeration definition
+ */
+typedef enum
+{
+    SFA30_DECODE_KERNEL_SCALAR = 0x00,        /**< portable c */
+    SFA30_DECODE_KERNEL_SSE41  = 0x01,        /**< x86 sse4.1, 4 frames per step */
+    SFA30_DECODE_KERNEL_AVX2   = 0x02,        /**< x86 avx2, 8 frames per step */
+    SFA30_DECODE_KERNEL_NEON   = 0x03,        /**< aarch64 neon, 16 frames per step */
+} sfa30_decode_kernel_t;
+
+/**
+ * @brief      decode a batch of iic read measured values responses
+ * @param[in]  *frames pointer to n back to back 9 bytes responses
+ * @param[in]  n number of responses
+ * @param[out] *formaldehyde pointer to an n floats formaldehyde array in ppb
+ * @param[out] *humidity pointer to an n floats humidity array in %
+ * @param[out] *temperature pointer to an n floats temperature array in C
+ * @param[out] *crc_mask pointer to an (n + 7) / 8 bytes mask, bit i % 8 of byte i / 8
+ *                       is set when all three crcs of response i are right
+ * @return     status code
+ *             - 0 success
+ *             - 2 a pointer is NULL
+ * @note       values are written for every response, crc_mask tells which are valid,
+ *             the floats are bit exact with sfa30_read
+ */
+uint8_t sfa30_decode_batch(const uint8_t *frames, uint32_t n,
+                           float *formaldehyde, float *humidity, float *temperature,
+                           uint8_t *crc_mask);
+
+/**
+ * @brief     force a decode kernel
+ * @param[in] kernel decode kernel
+ * @return    status code
+ *            - 0 success
+ *            - 1 kernel is not supported by this build or cpu
+ * @note      the best supported kernel is used by default
+ */
+uint8_t sfa30_decode_set_kernel(sfa30_decode_kernel_t kernel);
+
+/**
+ * @brief  get the decode kernel in use
+ * @return decode kernel
+ * @note   none
+ */
+sfa30_decode_kernel_t sfa30_decode_get_kernel(void);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,174 @@
+/**
+ * Copyright (c) 2015 - present LibDriver All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_sfa30_history.c
+ * @brief     driver sfa30 history source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2023-07-30
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2023/07/30  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#include "driver_sfa30_history.h"
+
+/**
+ * @brief     init the history
+ * @param[in] *history pointer to an sfa30 history structure
+ * @param[in] *buf pointer to a ring buffer
+ * @param[in] capacity ring buffer capacity
+ * @return    status code
+ *            - 0 success
+ *            - 2 history or buf is NULL
+ *            - 4 capacity is not a power of two or less than 2
+ * @note      the ring keeps the last capacity - 1 samples, older ones are overwritten
+ */
+uint8_t sfa30_history_init(sfa30_history_t *history, sfa30_history_sample_t *buf, uint32_t capacity)
+{
+    if ((history == NULL) || (buf == NULL))
+    {
+        return 2;
+    }
+    if ((capacity < 2) || ((capacity & (capacity - 1)) != 0))
+    {
+        return 4;
+    }
+
+    history->buf = buf;
+    history->mask = capacity - 1;
+    history->head = 0;
+    history->tail = 0;
+    history->lost = 0;
+
+    return 0;
+}
+
+/**
+ * @brief     push a sample
+ * @param[in] *history pointer to an sfa30 history structure
+ * @param[in] timestamp_ms sample timestamp
+ * @param[in] *data pointer to an sfa30_data_t structure
+ * @return    status code
+ *            - 0 success
+ *            - 2 history or data is NULL
+ * @note      only one producer thread may call it, it never waits for the consumer
+ */
+uint8_t sfa30_history_push(sfa30_history_t *history, uint32_t timestamp_ms, const sfa30_data_t *data)
+{
+    uint32_t head;
+    sfa30_history_sample_t *slot;
+
+    if ((history == NULL) || (data == NULL))
+    {
+        return 2;
+    }
+
+    /* the slot may hold an unread sample, order the last head store before overwriting it */
+    head = history->head;
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    slot = &history->buf[head & history->mask];
+    __atomic_store_n(&slot->timestamp_ms, timestamp_ms, __ATOMIC_RELAXED);
+    __atomic_store_n(&slot->formaldehyde_raw, data->formaldehyde_raw, __ATOMIC_RELAXED);
+    __atomic_store_n(&slot->humidity_raw, data->humidity_raw, __ATOMIC_RELAXED);
+    __atomic_store_n(&slot->temperature_raw, data->temperature_raw, __ATOMIC_RELAXED);
+
+    /* publish the sample */
+    __atomic_store_n(&history->head, head + 1, __ATOMIC_RELEASE);
+
+    return 0;
+}
+
+/**
+ * @brief      drain the samples pushed since the last drain
+ * @param[in]  *history pointer to an sfa30 history structure
+ * @param[out] *out pointer to a sample buffer
+ * @param[in]  max max samples to drain
+ * @param[out] *len pointer to a drained samples buffer
+ * @return     status code
+ *             - 0 success
+ *             - 2 history, out or len is NULL
+ * @note       only one consumer thread may call it, samples are drained oldest first
+ *             and samples overwritten by the producer are counted in lost
+ */
+uint8_t sfa30_history_drain(sfa30_history_t *history, sfa30_history_sample_t *out, uint32_t max, uint32_t *len)
+{
+    uint32_t i;
+    uint32_t n;
+    uint32_t head;
+    uint32_t tail;
+    uint32_t clobbered;
+
+    if ((history == NULL) || (out == NULL) || (len == NULL))
+    {
+        return 2;
+    }
+
+    /* skip the samples the producer already overwrote */
+    head = __atomic_load_n(&history->head, __ATOMIC_ACQUIRE);
+    tail = history->tail;
+    if ((head - tail) > history->mask)
+    {
+        history->lost += head - history->mask - tail;
+        tail = head - history->mask;
+    }
+
+    /* copy in one pass */
+    n = head - tail;
+    if (n > max)
+    {
+        n = max;
+    }
+    for (i = 0; i < n; i++)
+    {
+        const sfa30_history_sample_t *slot = &history->buf[(tail + i) & history->mask];
+
+        out[i].timestamp_ms = __atomic_load_n(&slot->timestamp_ms, __ATOMIC_RELAXED);
+        out[i].formaldehyde_raw = __atomic_load_n(&slot->formaldehyde_raw, __ATOMIC_RELAXED);
+        out[i].humidity_raw = __atomic_load_n(&slot->humidity_raw, __ATOMIC_RELAXED);
+        out[i].temperature_raw = __atomic_load_n(&slot->temperature_raw, __ATOMIC_RELAXED);
+    }
+
+    /* drop the samples the producer may have overwritten during the copy */
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    head = __atomic_load_n(&history->head, __ATOMIC_RELAXED);
+    clobbered = head - history->mask - tail;
+    if ((int32_t)clobbered > 0)
+    {
+        if (clobbered > n)
+        {
+            clobbered = n;
+        }
+        memmove(out, &out[clobbered], sizeof(sfa30_history_sample_t) * (n - clobbered));
+        n -= clobbered;
+        tail += clobbered;
+        history->lost += clobbered;
+    }
+    history->tail = tail + n;
+    *len = n;
+
+    return 0;
+}
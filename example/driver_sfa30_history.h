@@ -0,0 +1,123 @@
+/**
+ * Copyright (c) 2015 - present LibDriver All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_sfa30_history.h
+ * @brief     driver sfa30 history header file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2023-07-30
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2023/07/30  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#ifndef DRIVER_SFA30_HISTORY_H
+#define DRIVER_SFA30_HISTORY_H
+
+#include "driver_sfa30.h"
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/**
+ * @defgroup sfa30_history_driver sfa30 history driver function
+ * @brief    sfa30 history driver modules
+ * @ingroup  sfa30_example_driver
+ * @{
+ */
+
+/**
+ * @brief sfa30 history sample structure definition
+ */
+typedef struct sfa30_history_sample_s
+{
+    uint32_t timestamp_ms;           /**< sample timestamp */
+    int16_t formaldehyde_raw;        /**< formaldehyde raw */
+    int16_t humidity_raw;            /**< humidity raw */
+    int16_t temperature_raw;         /**< temperature raw */
+} sfa30_history_sample_t;
+
+/**
+ * @brief sfa30 history structure definition
+ */
+typedef struct sfa30_history_s
+{
+    sfa30_history_sample_t *buf;        /**< caller provided ring buffer */
+    uint32_t mask;                      /**< capacity - 1 */
+    uint32_t head;                      /**< samples pushed, written by the producer */
+    uint32_t tail;                      /**< samples drained, written by the consumer */
+    uint32_t lost;                      /**< samples overwritten before drained, written by the consumer */
+} sfa30_history_t;
+
+/**
+ * @brief     init the history
+ * @param[in] *history pointer to an sfa30 history structure
+ * @param[in] *buf pointer to a ring buffer
+ * @param[in] capacity ring buffer capacity
+ * @return    status code
+ *            - 0 success
+ *            - 2 history or buf is NULL
+ *            - 4 capacity is not a power of two or less than 2
+ * @note      the ring keeps the last capacity - 1 samples, older ones are overwritten
+ */
+uint8_t sfa30_history_init(sfa30_history_t *history, sfa30_history_sample_t *buf, uint32_t capacity);
+
+/**
+ * @brief     push a sample
+ * @param[in] *history pointer to an sfa30 history structure
+ * @param[in] timestamp_ms sample timestamp
+ * @param[in] *data pointer to an sfa30_data_t structure
+ * @return    status code
+ *            - 0 success
+ *            - 2 history or data is NULL
+ * @note      only one producer thread may call it, it never waits for the consumer
+ */
+uint8_t sfa30_history_push(sfa30_history_t *history, uint32_t timestamp_ms, const sfa30_data_t *data);
+
+/**
+ * @brief      drain the samples pushed since the last drain
+ * @param[in]  *history pointer to an sfa30 history structure
+ * @param[out] *out pointer to a sample buffer
+ * @param[in]  max max samples to drain
+ * @param[out] *len pointer to a drained samples buffer
+ * @return     status code
+ *             - 0 success
+ *             - 2 history, out or len is NULL
+ * @note       only one consumer thread may call it, samples are drained oldest first
+ *             and samples overwritten by the producer are counted in lost
+ */
+uint8_t sfa30_history_drain(sfa30_history_t *history, sfa30_history_sample_t *out, uint32_t max, uint32_t *len);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
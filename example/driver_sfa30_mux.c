@@ -0,0 +1,411 @@
+/**
+ * Copyright (c) 2015 - present LibDriver All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_sfa30_mux.c
+ * @brief     driver sfa30 mux source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2023-07-30
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2023/07/30  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#include "driver_sfa30_mux.h"
+
+/**
+ * @brief sfa30 mux timing definition
+ */
+#define SFA30_MUX_READ_DELAY_MS        5         /**< iic read command to response delay */
+#define SFA30_MUX_SELECT_BITS          20        /**< start, address, control byte and stop */
+#define SFA30_MUX_COMMAND_BITS         29        /**< start, address, 2 command bytes and stop */
+#define SFA30_MUX_READ_BITS            92        /**< start, address, 9 data bytes and stop */
+
+/**
+ * @brief     select a mux channel
+ * @param[in] *mux pointer to an sfa30 mux structure
+ * @param[in] channel mux channel
+ * @return    status code
+ *            - 0 success
+ *            - 1 select failed
+ * @note      none
+ */
+static uint8_t a_sfa30_mux_select(sfa30_mux_t *mux, uint8_t channel)
+{
+    uint8_t reg;
+
+    /* skip the redundant select */
+    reg = (uint8_t)(1 << channel);
+    if ((mux->selected_valid != 0) && (mux->selected == reg))
+    {
+        return 0;
+    }
+
+    /* write the control register */
+    mux->selects++;
+    if (mux->iic_write_cmd(mux->user, mux->addr, &reg, 1) != 0)
+    {
+        mux->selected_valid = 0;
+
+        return 1;
+    }
+    mux->selected = reg;
+    mux->selected_valid = 1;
+
+    return 0;
+}
+
+/**
+ * @brief     init the mux
+ * @param[in] *mux pointer to an sfa30 mux structure
+ * @param[in] addr mux iic address
+ * @param[in] *iic_write_cmd pointer to the iic write function of the bus
+ * @param[in] *delay_ms pointer to a delay function
+ * @param[in] *user pointer to the user context of the bus
+ * @return    status code
+ *            - 0 success
+ *            - 2 mux or function is NULL
+ * @note      the attached sensors must be linked to the same bus and user context
+ */
+uint8_t sfa30_mux_init(sfa30_mux_t *mux, uint8_t addr,
+                       uint8_t (*iic_write_cmd)(void *user, uint8_t addr, uint8_t *buf, uint16_t len),
+                       void (*delay_ms)(void *user, uint32_t ms), void *user)
+{
+    if ((mux == NULL) || (iic_write_cmd == NULL) || (delay_ms == NULL))
+    {
+        return 2;
+    }
+
+    memset(mux, 0, sizeof(sfa30_mux_t));
+    mux->iic_write_cmd = iic_write_cmd;
+    mux->delay_ms = delay_ms;
+    mux->user = user;
+    mux->addr = addr;
+
+    return 0;
+}
+
+/**
+ * @brief     attach a sensor to a mux channel
+ * @param[in] *mux pointer to an sfa30 mux structure
+ * @param[in] channel mux channel
+ * @param[in] *handle pointer to a linked sfa30 handle structure with the iic interface
+ * @return    status code
+ *            - 0 success
+ *            - 1 attach failed
+ *            - 2 mux or handle is NULL
+ *            - 4 channel is invalid or already attached
+ * @note      selects the channel, inits the sensor and starts the measurement,
+ *            the bus init and deinit hooks run once per sensor so they must
+ *            tolerate several sensors sharing one bus
+ */
+uint8_t sfa30_mux_attach(sfa30_mux_t *mux, uint8_t channel, sfa30_handle_t *handle)
+{
+    if ((mux == NULL) || (handle == NULL))
+    {
+        return 2;
+    }
+    if ((channel >= SFA30_MUX_MAX_CHANNELS) || (mux->handle[channel] != NULL))
+    {
+        return 4;
+    }
+
+    /* select the channel */
+    if (a_sfa30_mux_select(mux, channel) != 0)
+    {
+        return 1;
+    }
+
+    /* init the chip */
+    if (sfa30_set_interface(handle, SFA30_INTERFACE_IIC) != 0)
+    {
+        return 1;
+    }
+    if (sfa30_init(handle) != 0)
+    {
+        return 1;
+    }
+
+    /* start measurement */
+    if (sfa30_start_measurement(handle) != 0)
+    {
+        (void)sfa30_deinit(handle);
+
+        return 1;
+    }
+    mux->handle[channel] = handle;
+
+    return 0;
+}
+
+/**
+ * @brief     detach a sensor from a mux channel
+ * @param[in] *mux pointer to an sfa30 mux structure
+ * @param[in] channel mux channel
+ * @return    status code
+ *            - 0 success
+ *            - 1 detach failed
+ *            - 2 mux is NULL
+ *            - 4 channel is invalid or not attached
+ * @note      stops the measurement and deinits the sensor
+ */
+uint8_t sfa30_mux_detach(sfa30_mux_t *mux, uint8_t channel)
+{
+    sfa30_handle_t *handle;
+
+    if (mux == NULL)
+    {
+        return 2;
+    }
+    if ((channel >= SFA30_MUX_MAX_CHANNELS) || (mux->handle[channel] == NULL))
+    {
+        return 4;
+    }
+
+    /* the channel is free whether the sensor answers or not */
+    handle = mux->handle[channel];
+    mux->handle[channel] = NULL;
+    if (a_sfa30_mux_select(mux, channel) != 0)
+    {
+        return 1;
+    }
+    (void)sfa30_read_cancel(handle);
+    if (sfa30_stop_measurement(handle) != 0)
+    {
+        (void)sfa30_deinit(handle);
+
+        return 1;
+    }
+    if (sfa30_deinit(handle) != 0)
+    {
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief     select a mux channel
+ * @param[in] *mux pointer to an sfa30 mux structure
+ * @param[in] channel mux channel
+ * @return    status code
+ *            - 0 success
+ *            - 1 select failed
+ *            - 2 mux is NULL
+ *            - 4 channel is invalid
+ * @note      the control register write is skipped when the channel is already selected,
+ *            call it before any other driver function on a sensor behind the mux
+ */
+uint8_t sfa30_mux_select(sfa30_mux_t *mux, uint8_t channel)
+{
+    if (mux == NULL)
+    {
+        return 2;
+    }
+    if (channel >= SFA30_MUX_MAX_CHANNELS)
+    {
+        return 4;
+    }
+
+    return a_sfa30_mux_select(mux, channel);
+}
+
+/**
+ * @brief      read all attached sensors
+ * @param[in]  *mux pointer to an sfa30 mux structure
+ * @param[out] *data pointer to an sfa30_data_t array indexed by channel
+ * @param[out] *status pointer to a status array indexed by channel, 0 means success
+ * @return     status code
+ *             - 0 success
+ *             - 1 one or more reads failed
+ *             - 2 mux, data or status is NULL
+ * @note       the read commands go out from the end of the channel range that is already
+ *             selected and the responses are collected in the opposite order, so the command
+ *             delay of every sensor overlaps the traffic of the others and one sweep of n
+ *             sensors costs 2n - 2 channel selects, commands are never broadcast to several
+ *             channels because one sensor's ack would hide a missing sensor on another channel
+ */
+uint8_t sfa30_mux_read_all(sfa30_mux_t *mux, sfa30_data_t data[SFA30_MUX_MAX_CHANNELS],
+                           uint8_t status[SFA30_MUX_MAX_CHANNELS])
+{
+    uint8_t i;
+    uint8_t ch;
+    uint8_t ret;
+    uint8_t first;
+    uint8_t descending;
+    uint32_t t;
+    sfa30_read_state_t state;
+
+    if ((mux == NULL) || (data == NULL) || (status == NULL))
+    {
+        return 2;
+    }
+
+    /* start at the end of the channel range that is already selected */
+    descending = 0;
+    for (i = SFA30_MUX_MAX_CHANNELS; i > 0; i--)
+    {
+        if (mux->handle[i - 1] != NULL)
+        {
+            descending = (uint8_t)((mux->selected_valid != 0) && (mux->selected == (uint8_t)(1 << (i - 1))) &&
+                                   (mux->selected != 0x01));
+
+            break;
+        }
+    }
+
+    /* issue the read commands, all reads begin at the local time 0 */
+    first = SFA30_MUX_MAX_CHANNELS;
+    for (i = 0; i < SFA30_MUX_MAX_CHANNELS; i++)
+    {
+        ch = (descending != 0) ? (uint8_t)(SFA30_MUX_MAX_CHANNELS - 1 - i) : i;
+        status[ch] = 1;
+        if (mux->handle[ch] == NULL)
+        {
+            continue;
+        }
+        if (a_sfa30_mux_select(mux, ch) != 0)
+        {
+            continue;
+        }
+        if (sfa30_read_begin(mux->handle[ch], 0) != 0)
+        {
+            continue;
+        }
+        status[ch] = 0;
+        if (first == SFA30_MUX_MAX_CHANNELS)
+        {
+            first = ch;
+        }
+    }
+    if (first == SFA30_MUX_MAX_CHANNELS)
+    {
+        return 1;
+    }
+
+    /* wait once, the earlier commands have been waiting during the later ones */
+    t = 0;
+    while (1)
+    {
+        (void)sfa30_read_poll(mux->handle[first], t, &state);
+        if (state == SFA30_READ_STATE_READY)
+        {
+            break;
+        }
+        mux->delay_ms(mux->user, 1);
+        t++;
+    }
+
+    /* collect the responses in the opposite order starting at the selected channel */
+    ret = 0;
+    for (i = 0; i < SFA30_MUX_MAX_CHANNELS; i++)
+    {
+        ch = (descending != 0) ? i : (uint8_t)(SFA30_MUX_MAX_CHANNELS - 1 - i);
+        if (mux->handle[ch] == NULL)
+        {
+            continue;
+        }
+        if (status[ch] != 0)
+        {
+            ret = 1;
+
+            continue;
+        }
+        if (a_sfa30_mux_select(mux, ch) != 0)
+        {
+            (void)sfa30_read_cancel(mux->handle[ch]);
+            status[ch] = 1;
+            ret = 1;
+
+            continue;
+        }
+        (void)sfa30_read_poll(mux->handle[ch], t, &state);
+        if (sfa30_read_finish(mux->handle[ch], &data[ch]) != 0)
+        {
+            status[ch] = 1;
+            ret = 1;
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * @brief      get the achievable aggregate sample rate of the bus
+ * @param[in]  *mux pointer to an sfa30 mux structure
+ * @param[in]  bus_hz iic clock in Hz
+ * @param[out] *rate pointer to a samples per second buffer
+ * @return     status code
+ *             - 0 success
+ *             - 2 mux or rate is NULL
+ *             - 4 bus_hz is 0
+ * @note       estimated from the bits on the wire of one sweep plus one command delay,
+ *             capped by the 500 ms update period of each sensor
+ */
+uint8_t sfa30_mux_get_rate(sfa30_mux_t *mux, uint32_t bus_hz, float *rate)
+{
+    uint8_t ch;
+    uint32_t n;
+    uint32_t bits;
+    float sweep_s;
+
+    if ((mux == NULL) || (rate == NULL))
+    {
+        return 2;
+    }
+    if (bus_hz == 0)
+    {
+        return 4;
+    }
+
+    /* count the sensors */
+    n = 0;
+    for (ch = 0; ch < SFA30_MUX_MAX_CHANNELS; ch++)
+    {
+        if (mux->handle[ch] != NULL)
+        {
+            n++;
+        }
+    }
+    if (n == 0)
+    {
+        *rate = 0.0f;
+
+        return 0;
+    }
+
+    /* one steady state sweep */
+    bits = ((n > 1) ? (2 * n - 2) : 0) * SFA30_MUX_SELECT_BITS +
+           n * (SFA30_MUX_COMMAND_BITS + SFA30_MUX_READ_BITS);
+    sweep_s = (float)bits / (float)bus_hz + (float)SFA30_MUX_READ_DELAY_MS / 1000.0f;
+    *rate = (float)n / sweep_s;
+    if (*rate > (float)n * 2.0f)
+    {
+        *rate = (float)n * 2.0f;
+    }
+
+    return 0;
+}
@@ -0,0 +1,173 @@
+/**
+ * Copyright (c) 2015 - present LibDriver All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_sfa30_mux.h
+ * @brief     driver sfa30 mux header file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2023-07-30
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2023/07/30  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#ifndef DRIVER_SFA30_MUX_H
+#define DRIVER_SFA30_MUX_H
+
+#include "driver_sfa30.h"
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/**
+ * @defgroup sfa30_mux_driver sfa30 mux driver function
+ * @brief    sfa30 mux driver modules
+ * @ingroup  sfa30_example_driver
+ * @{
+ */
+
+/**
+ * @brief sfa30 mux definition
+ */
+#define SFA30_MUX_ADDRESS             (0x70 << 1)        /**< tca9548a iic address with a0 - a2 low */
+#define SFA30_MUX_MAX_CHANNELS        8                  /**< tca9548a channels */
+
+/**
+ * @brief sfa30 mux structure definition
+ */
+typedef struct sfa30_mux_s
+{
+    uint8_t (*iic_write_cmd)(void *user, uint8_t addr, uint8_t *buf, uint16_t len);        /**< point to an iic_write_cmd function address */
+    void (*delay_ms)(void *user, uint32_t ms);                                             /**< point to a delay_ms function address */
+    void *user;                                                                            /**< user context of the bus */
+    uint8_t addr;                                                                          /**< mux iic address */
+    uint8_t selected;                                                                      /**< mux control register */
+    uint8_t selected_valid;                                                                /**< mux control register is known */
+    uint32_t selects;                                                                      /**< control register writes */
+    sfa30_handle_t *handle[SFA30_MUX_MAX_CHANNELS];                                        /**< sensor handle of each channel */
+} sfa30_mux_t;
+
+/**
+ * @brief     init the mux
+ * @param[in] *mux pointer to an sfa30 mux structure
+ * @param[in] addr mux iic address
+ * @param[in] *iic_write_cmd pointer to the iic write function of the bus
+ * @param[in] *delay_ms pointer to a delay function
+ * @param[in] *user pointer to the user context of the bus
+ * @return    status code
+ *            - 0 success
+ *            - 2 mux or function is NULL
+ * @note      the attached sensors must be linked to the same bus and user context
+ */
+uint8_t sfa30_mux_init(sfa30_mux_t *mux, uint8_t addr,
+                       uint8_t (*iic_write_cmd)(void *user, uint8_t addr, uint8_t *buf, uint16_t len),
+                       void (*delay_ms)(void *user, uint32_t ms), void *user);
+
+/**
+ * @brief     attach a sensor to a mux channel
+ * @param[in] *mux pointer to an sfa30 mux structure
+ * @param[in] channel mux channel
+ * @param[in] *handle pointer to a linked sfa30 handle structure with the iic interface
+ * @return    status code
+ *            - 0 success
+ *            - 1 attach failed
+ *            - 2 mux or handle is NULL
+ *            - 4 channel is invalid or already attached
+ * @note      selects the channel, inits the sensor and starts the measurement,
+ *            the bus init and deinit hooks run once per sensor so they must
+ *            tolerate several sensors sharing one bus
+ */
+uint8_t sfa30_mux_attach(sfa30_mux_t *mux, uint8_t channel, sfa30_handle_t *handle);
+
+/**
+ * @brief     detach a sensor from a mux channel
+ * @param[in] *mux pointer to an sfa30 mux structure
+ * @param[in] channel mux channel
+ * @return    status code
+ *            - 0 success
+ *            - 1 detach failed
+ *            - 2 mux is NULL
+ *            - 4 channel is invalid or not attached
+ * @note      stops the measurement and deinits the sensor
+ */
+uint8_t sfa30_mux_detach(sfa30_mux_t *mux, uint8_t channel);
+
+/**
+ * @brief     select a mux channel
+ * @param[in] *mux pointer to an sfa30 mux structure
+ * @param[in] channel mux channel
+ * @return    status code
+ *            - 0 success
+ *            - 1 select failed
+ *            - 2 mux is NULL
+ *            - 4 channel is invalid
+ * @note      the control register write is skipped when the channel is already selected,
+ *            call it before any other driver function on a sensor behind the mux
+ */
+uint8_t sfa30_mux_select(sfa30_mux_t *mux, uint8_t channel);
+
+/**
+ * @brief      read all attached sensors
+ * @param[in]  *mux pointer to an sfa30 mux structure
+ * @param[out] *data pointer to an sfa30_data_t array indexed by channel
+ * @param[out] *status pointer to a status array indexed by channel, 0 means success
+ * @return     status code
+ *             - 0 success
+ *             - 1 one or more reads failed
+ *             - 2 mux, data or status is NULL
+ * @note       the read commands go out from the end of the channel range that is already
+ *             selected and the responses are collected in the opposite order, so the command
+ *             delay of every sensor overlaps the traffic of the others and one sweep of n
+ *             sensors costs 2n - 2 channel selects, commands are never broadcast to several
+ *             channels because one sensor's ack would hide a missing sensor on another channel
+ */
+uint8_t sfa30_mux_read_all(sfa30_mux_t *mux, sfa30_data_t data[SFA30_MUX_MAX_CHANNELS],
+                           uint8_t status[SFA30_MUX_MAX_CHANNELS]);
+
+/**
+ * @brief      get the achievable aggregate sample rate of the bus
+ * @param[in]  *mux pointer to an sfa30 mux structure
+ * @param[in]  bus_hz iic clock in Hz
+ * @param[out] *rate pointer to a samples per second buffer
+ * @return     status code
+ *             - 0 success
+ *             - 2 mux or rate is NULL
+ *             - 4 bus_hz is 0
+ * @note       estimated from the bits on the wire of one sweep plus one command delay,
+ *             capped by the 500 ms update period of each sensor
+ */
+uint8_t sfa30_mux_get_rate(sfa30_mux_t *mux, uint32_t bus_hz, float *rate);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,242 @@
+/**
+ * Copyright (c) 2015 - present LibDriver All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_sfa30_quantile.c
+ * @brief     driver sfa30 quantile source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2023-07-30
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2023/07/30  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#include "driver_sfa30_quantile.h"
+
+/**
+ * @brief sfa30 quantile bucket layout definition
+ */
+#define SFA30_QUANTILE_EXACT        (1U << SFA30_QUANTILE_PRECISION_BITS)               /**< exact buckets */
+#define SFA30_QUANTILE_HALF         (1U << (SFA30_QUANTILE_PRECISION_BITS - 1))         /**< buckets per octave */
+
+/**
+ * @brief     get the bucket of a raw value
+ * @param[in] raw raw value
+ * @return    bucket index
+ * @note      the bucket is the top precision bits of the value and its octave
+ */
+static inline uint32_t a_sfa30_quantile_index(int16_t raw)
+{
+    uint32_t v = (raw > 0) ? (uint32_t)raw : 0;
+    uint32_t k;
+
+    if (v < SFA30_QUANTILE_EXACT)
+    {
+        return v;
+    }
+    k = 31U - (uint32_t)__builtin_clz(v);
+
+    return SFA30_QUANTILE_EXACT + ((k - SFA30_QUANTILE_PRECISION_BITS) * SFA30_QUANTILE_HALF) +
+           ((v >> (k - SFA30_QUANTILE_PRECISION_BITS + 1)) - SFA30_QUANTILE_HALF);
+}
+
+/**
+ * @brief     get the middle of a bucket
+ * @param[in] index bucket index
+ * @return    middle raw value
+ * @note      none
+ */
+static int32_t a_sfa30_quantile_middle(uint32_t index)
+{
+    uint32_t j;
+    uint32_t shift;
+
+    if (index < SFA30_QUANTILE_EXACT)
+    {
+        return (int32_t)index;
+    }
+    j = index - SFA30_QUANTILE_EXACT;
+    shift = (j / SFA30_QUANTILE_HALF) + 1;
+
+    return (int32_t)(((SFA30_QUANTILE_HALF + (j % SFA30_QUANTILE_HALF)) << shift) + ((1U << shift) >> 1));
+}
+
+/**
+ * @brief     init the sketch
+ * @param[in] *sketch pointer to an sfa30 quantile structure
+ * @return    status code
+ *            - 0 success
+ *            - 2 sketch is NULL
+ * @note      call it again to start the next day
+ */
+uint8_t sfa30_quantile_init(sfa30_quantile_t *sketch)
+{
+    if (sketch == NULL)
+    {
+        return 2;
+    }
+
+    memset(sketch, 0, sizeof(sfa30_quantile_t));
+
+    return 0;
+}
+
+/**
+ * @brief     add a sample
+ * @param[in] *sketch pointer to an sfa30 quantile structure
+ * @param[in] *data pointer to an sfa30_data_t structure
+ * @return    status code
+ *            - 0 success
+ *            - 2 sketch or data is NULL
+ * @note      the formaldehyde raw value, ppb * 5, is added in constant time
+ */
+uint8_t sfa30_quantile_add(sfa30_quantile_t *sketch, const sfa30_data_t *data)
+{
+    int16_t raw;
+
+    if ((sketch == NULL) || (data == NULL))
+    {
+        return 2;
+    }
+
+    raw = data->formaldehyde_raw;
+    if ((sketch->count == 0) || (raw < sketch->min_raw))
+    {
+        sketch->min_raw = raw;
+    }
+    if ((sketch->count == 0) || (raw > sketch->max_raw))
+    {
+        sketch->max_raw = raw;
+    }
+    sketch->bucket[a_sfa30_quantile_index(raw)]++;
+    sketch->count++;
+
+    return 0;
+}
+
+/**
+ * @brief     merge a sketch
+ * @param[in] *sketch pointer to an sfa30 quantile structure
+ * @param[in] *other pointer to the sfa30 quantile structure merged into sketch
+ * @return    status code
+ *            - 0 success
+ *            - 2 sketch or other is NULL
+ * @note      the result equals the sketch of both sample sets, so sensors and days
+ *            merge in any order
+ */
+uint8_t sfa30_quantile_merge(sfa30_quantile_t *sketch, const sfa30_quantile_t *other)
+{
+    uint32_t i;
+
+    if ((sketch == NULL) || (other == NULL))
+    {
+        return 2;
+    }
+    if (other->count == 0)
+    {
+        return 0;
+    }
+
+    if ((sketch->count == 0) || (other->min_raw < sketch->min_raw))
+    {
+        sketch->min_raw = other->min_raw;
+    }
+    if ((sketch->count == 0) || (other->max_raw > sketch->max_raw))
+    {
+        sketch->max_raw = other->max_raw;
+    }
+    for (i = 0; i < SFA30_QUANTILE_BUCKETS; i++)
+    {
+        sketch->bucket[i] += other->bucket[i];
+    }
+    sketch->count += other->count;
+
+    return 0;
+}
+
+/**
+ * @brief      get a quantile
+ * @param[in]  *sketch pointer to an sfa30 quantile structure
+ * @param[in]  quantile quantile in 1 / 10000, 9500 is p95
+ * @param[out] *raw pointer to a formaldehyde raw buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 sketch is empty
+ *             - 2 sketch or raw is NULL
+ *             - 4 quantile is over 10000
+ * @note       nearest rank quantile, 0 and 10000 return the exact min and max, any other
+ *             is the middle of its bucket kept within them
+ */
+uint8_t sfa30_quantile_get(const sfa30_quantile_t *sketch, uint32_t quantile, int16_t *raw)
+{
+    uint32_t i;
+    uint64_t rank;
+    uint64_t seen = 0;
+    int32_t value;
+
+    if ((sketch == NULL) || (raw == NULL))
+    {
+        return 2;
+    }
+    if (quantile > 10000)
+    {
+        return 4;
+    }
+    if (sketch->count == 0)
+    {
+        return 1;
+    }
+
+    if (quantile == 0)
+    {
+        *raw = sketch->min_raw;
+
+        return 0;
+    }
+
+    /* rank = ceil(quantile x count / 10000) without overflowing 64 bits */
+    rank = ((sketch->count / 10000) * quantile) + ((((sketch->count % 10000) * quantile) + 9999) / 10000);
+    if (rank >= sketch->count)
+    {
+        *raw = sketch->max_raw;
+
+        return 0;
+    }
+    for (i = 0; i < SFA30_QUANTILE_BUCKETS - 1; i++)
+    {
+        seen += sketch->bucket[i];
+        if (seen >= rank)
+        {
+            break;
+        }
+    }
+    value = a_sfa30_quantile_middle(i);
+    value = (value < sketch->min_raw) ? sketch->min_raw : value;
+    value = (value > sketch->max_raw) ? sketch->max_raw : value;
+    *raw = (int16_t)value;
+
+    return 0;
+}
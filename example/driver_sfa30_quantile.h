@@ -0,0 +1,141 @@
+/**
+ * Copyright (c) 2015 - present LibDriver All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_sfa30_quantile.h
+ * @brief     driver sfa30 quantile header file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2023-07-30
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2023/07/30  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#ifndef DRIVER_SFA30_QUANTILE_H
+#define DRIVER_SFA30_QUANTILE_H
+
+#include "driver_sfa30.h"
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/**
+ * @defgroup sfa30_quantile_driver sfa30 quantile driver function
+ * @brief    sfa30 quantile driver modules
+ * @ingroup  sfa30_example_driver
+ * @{
+ */
+
+/**
+ * @brief sfa30 quantile precision definition, a quantile is within 1 / 2^bits of the exact
+ *        value and raw values below 2^bits are exact, each bit doubles the sketch size
+ */
+#ifndef SFA30_QUANTILE_PRECISION_BITS
+    #define SFA30_QUANTILE_PRECISION_BITS        6        /**< 1.6 % and 352 buckets by default */
+#endif
+#if (SFA30_QUANTILE_PRECISION_BITS < 2) || (SFA30_QUANTILE_PRECISION_BITS > 14)
+    #error "sfa30: SFA30_QUANTILE_PRECISION_BITS is invalid."
+#endif
+
+/**
+ * @brief sfa30 quantile buckets definition
+ * @note  2^bits exact buckets, then 2^(bits - 1) buckets per octave up to 32767
+ */
+#define SFA30_QUANTILE_BUCKETS        ((1 << SFA30_QUANTILE_PRECISION_BITS) + \
+                                       (15 - SFA30_QUANTILE_PRECISION_BITS) * (1 << (SFA30_QUANTILE_PRECISION_BITS - 1)))        /**< buckets */
+
+/**
+ * @brief sfa30 quantile structure definition
+ * @note  the layout only depends on SFA30_QUANTILE_PRECISION_BITS, so any two sketches
+ *        built with the same precision merge without loss
+ */
+typedef struct sfa30_quantile_s
+{
+    uint64_t count;                                      /**< samples */
+    int16_t min_raw;                                     /**< exact min formaldehyde raw */
+    int16_t max_raw;                                     /**< exact max formaldehyde raw */
+    uint32_t reserved;                                   /**< reserved */
+    uint64_t bucket[SFA30_QUANTILE_BUCKETS];             /**< samples per bucket, negative raw values count as 0 */
+} sfa30_quantile_t;
+
+/**
+ * @brief     init the sketch
+ * @param[in] *sketch pointer to an sfa30 quantile structure
+ * @return    status code
+ *            - 0 success
+ *            - 2 sketch is NULL
+ * @note      call it again to start the next day
+ */
+uint8_t sfa30_quantile_init(sfa30_quantile_t *sketch);
+
+/**
+ * @brief     add a sample
+ * @param[in] *sketch pointer to an sfa30 quantile structure
+ * @param[in] *data pointer to an sfa30_data_t structure
+ * @return    status code
+ *            - 0 success
+ *            - 2 sketch or data is NULL
+ * @note      the formaldehyde raw value, ppb * 5, is added in constant time
+ */
+uint8_t sfa30_quantile_add(sfa30_quantile_t *sketch, const sfa30_data_t *data);
+
+/**
+ * @brief     merge a sketch
+ * @param[in] *sketch pointer to an sfa30 quantile structure
+ * @param[in] *other pointer to the sfa30 quantile structure merged into sketch
+ * @return    status code
+ *            - 0 success
+ *            - 2 sketch or other is NULL
+ * @note      the result equals the sketch of both sample sets, so sensors and days
+ *            merge in any order
+ */
+uint8_t sfa30_quantile_merge(sfa30_quantile_t *sketch, const sfa30_quantile_t *other);
+
+/**
+ * @brief      get a quantile
+ * @param[in]  *sketch pointer to an sfa30 quantile structure
+ * @param[in]  quantile quantile in 1 / 10000, 9500 is p95
+ * @param[out] *raw pointer to a formaldehyde raw buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 sketch is empty
+ *             - 2 sketch or raw is NULL
+ *             - 4 quantile is over 10000
+ * @note       nearest rank quantile, 0 and 10000 return the exact min and max, any other
+ *             is the middle of its bucket kept within them
+ */
+uint8_t sfa30_quantile_get(const sfa30_quantile_t *sketch, uint32_t quantile, int16_t *raw);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
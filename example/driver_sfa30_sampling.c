@@ -0,0 +1,264 @@
+/**
+ * Copyright (c) 2015 - present LibDriver All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_sfa30_sampling.c
+ * @brief     driver sfa30 sampling source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2023-07-30
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2023/07/30  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#include "driver_sfa30_sampling.h"
+
+/**
+ * @brief     publish a sample to the snapshot
+ * @param[in] *sampling pointer to an sfa30 sampling structure
+ * @param[in] *data pointer to an sfa30_data_t structure
+ * @param[in] timestamp_ms sample timestamp
+ * @note      seqlock writer, the sequence is odd while the words are written
+ */
+static void a_sfa30_sampling_publish(sfa30_sampling_t *sampling, const sfa30_data_t *data, uint32_t timestamp_ms)
+{
+    uint32_t i;
+    uint32_t seq;
+    uint32_t words[SFA30_SAMPLING_SNAPSHOT_WORDS];
+
+    /* pack the sample */
+    words[SFA30_SAMPLING_SNAPSHOT_WORDS - 1] = 0;
+    memcpy(words, data, sizeof(sfa30_data_t));
+
+    /* mark the snapshot as being written */
+    seq = __atomic_load_n(&sampling->sequence, __ATOMIC_RELAXED);
+    __atomic_store_n(&sampling->sequence, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    /* write the snapshot */
+    __atomic_store_n(&sampling->timestamp_ms, timestamp_ms, __ATOMIC_RELAXED);
+    for (i = 0; i < SFA30_SAMPLING_SNAPSHOT_WORDS; i++)
+    {
+        __atomic_store_n(&sampling->words[i], words[i], __ATOMIC_RELAXED);
+    }
+
+    /* mark the snapshot as stable */
+    __atomic_store_n(&sampling->sequence, seq + 2, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief     init the sampling
+ * @param[in] *sampling pointer to an sfa30 sampling structure
+ * @param[in] *handle pointer to an inited and measuring sfa30 handle structure
+ * @param[in] period_ms sampling period in ms, 0 means the default period
+ * @param[in] now_ms current time of a monotonic millisecond clock
+ * @return    status code
+ *            - 0 success
+ *            - 2 sampling or handle is NULL
+ * @note      the first read begins at the first poll
+ */
+uint8_t sfa30_sampling_init(sfa30_sampling_t *sampling, sfa30_handle_t *handle, uint32_t period_ms, uint32_t now_ms)
+{
+    if ((sampling == NULL) || (handle == NULL))
+    {
+        return 2;
+    }
+
+    memset(sampling, 0, sizeof(sfa30_sampling_t));
+    sampling->handle = handle;
+    sampling->period_ms = (period_ms != 0) ? period_ms : SFA30_SAMPLING_DEFAULT_PERIOD_MS;
+    sampling->next_ms = now_ms;
+
+    return 0;
+}
+
+/**
+ * @brief     attach a history to the sampling
+ * @param[in] *sampling pointer to an sfa30 sampling structure
+ * @param[in] *history pointer to an inited sfa30 history structure, NULL detaches it
+ * @return    status code
+ *            - 0 success
+ *            - 2 sampling is NULL
+ * @note      the sampling owner becomes the history producer
+ */
+uint8_t sfa30_sampling_set_history(sfa30_sampling_t *sampling, sfa30_history_t *history)
+{
+    if (sampling == NULL)
+    {
+        return 2;
+    }
+
+    sampling->history = history;
+
+    return 0;
+}
+
+/**
+ * @brief     attach an aggregate to the sampling
+ * @param[in] *sampling pointer to an sfa30 sampling structure
+ * @param[in] *aggregate pointer to an inited sfa30 aggregate structure, NULL detaches it
+ * @return    status code
+ *            - 0 success
+ *            - 2 sampling is NULL
+ * @note      the aggregate is pushed and read by the sampling owner only
+ */
+uint8_t sfa30_sampling_set_aggregate(sfa30_sampling_t *sampling, sfa30_aggregate_t *aggregate)
+{
+    if (sampling == NULL)
+    {
+        return 2;
+    }
+
+    sampling->aggregate = aggregate;
+
+    return 0;
+}
+
+/**
+ * @brief     poll the sampling
+ * @param[in] *sampling pointer to an sfa30 sampling structure
+ * @param[in] now_ms current time of a monotonic millisecond clock
+ * @return    status code
+ *            - 0 success
+ *            - 1 read failed
+ *            - 2 sampling is NULL
+ * @note      only the owner thread may call it, it never blocks and publishes
+ *            each decoded sample to the snapshot and the attached history and aggregate
+ */
+uint8_t sfa30_sampling_poll(sfa30_sampling_t *sampling, uint32_t now_ms)
+{
+    uint8_t res;
+    sfa30_read_state_t state;
+    sfa30_data_t data;
+
+    if (sampling == NULL)
+    {
+        return 2;
+    }
+
+    /* check the read in flight */
+    res = sfa30_read_poll(sampling->handle, now_ms, &state);
+    if (res != 0)
+    {
+        return 1;
+    }
+
+    /* collect a finished read */
+    if (state == SFA30_READ_STATE_READY)
+    {
+        res = sfa30_read_finish(sampling->handle, &data);
+        if (res != 0)
+        {
+            sampling->errors++;
+
+            return 1;
+        }
+        a_sfa30_sampling_publish(sampling, &data, sampling->begin_ms);
+        if (sampling->history != NULL)
+        {
+            (void)sfa30_history_push(sampling->history, sampling->begin_ms, &data);
+        }
+        if (sampling->aggregate != NULL)
+        {
+            (void)sfa30_aggregate_push(sampling->aggregate, sampling->begin_ms, &data);
+        }
+
+        return 0;
+    }
+
+    /* begin the next read when it is due */
+    if ((state == SFA30_READ_STATE_IDLE) && ((int32_t)(now_ms - sampling->next_ms) >= 0))
+    {
+        sampling->begin_ms = now_ms;
+        sampling->next_ms += sampling->period_ms;
+        if ((int32_t)(now_ms - sampling->next_ms) >= 0)
+        {
+            /* skip the missed periods instead of bursting */
+            sampling->next_ms = now_ms + sampling->period_ms;
+        }
+        res = sfa30_read_begin(sampling->handle, now_ms);
+        if (res != 0)
+        {
+            sampling->errors++;
+
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief      load the latest sample
+ * @param[in]  *sampling pointer to an sfa30 sampling structure
+ * @param[out] *data pointer to an sfa30_data_t structure
+ * @param[out] *timestamp_ms pointer to a sample timestamp buffer, can be NULL
+ * @return     status code
+ *             - 0 success
+ *             - 1 no sample yet
+ *             - 2 sampling or data is NULL
+ * @note       any thread may call it, it never touches the bus or the handle and
+ *             retries only when it races the owner publishing a sample
+ */
+uint8_t sfa30_sampling_load(const sfa30_sampling_t *sampling, sfa30_data_t *data, uint32_t *timestamp_ms)
+{
+    uint32_t i;
+    uint32_t seq0;
+    uint32_t seq1;
+    uint32_t timestamp;
+    uint32_t words[SFA30_SAMPLING_SNAPSHOT_WORDS];
+
+    if ((sampling == NULL) || (data == NULL))
+    {
+        return 2;
+    }
+
+    /* seqlock reader */
+    do
+    {
+        seq0 = __atomic_load_n(&sampling->sequence, __ATOMIC_ACQUIRE);
+        if (seq0 == 0)
+        {
+            return 1;
+        }
+        timestamp = __atomic_load_n(&sampling->timestamp_ms, __ATOMIC_RELAXED);
+        for (i = 0; i < SFA30_SAMPLING_SNAPSHOT_WORDS; i++)
+        {
+            words[i] = __atomic_load_n(&sampling->words[i], __ATOMIC_RELAXED);
+        }
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        seq1 = __atomic_load_n(&sampling->sequence, __ATOMIC_RELAXED);
+    } while (((seq0 & 1) != 0) || (seq0 != seq1));
+
+    /* unpack the sample */
+    memcpy(data, words, sizeof(sfa30_data_t));
+    if (timestamp_ms != NULL)
+    {
+        *timestamp_ms = timestamp;
+    }
+
+    return 0;
+}
@@ -0,0 +1,151 @@
+/**
+ * Copyright (c) 2015 - present LibDriver All rights reserved
+ * 
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE. 
+ *
+ * @file      driver_sfa30_sampling.h
+ * @brief     driver sfa30 sampling header file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2023-07-30
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2023/07/30  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#ifndef DRIVER_SFA30_SAMPLING_H
+#define DRIVER_SFA30_SAMPLING_H
+
+#include "driver_sfa30_history.h"
+#include "driver_sfa30_aggregate.h"
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/**
+ * @defgroup sfa30_sampling_driver sfa30 sampling driver function
+ * @brief    sfa30 sampling driver modules
+ * @ingroup  sfa30_example_driver
+ * @{
+ */
+
+/**
+ * @brief sfa30 sampling default period definition
+ */
+#define SFA30_SAMPLING_DEFAULT_PERIOD_MS        500        /**< the sensor updates its values every 500 ms */
+
+/**
+ * @brief sfa30 sampling snapshot words definition
+ */
+#define SFA30_SAMPLING_SNAPSHOT_WORDS           ((sizeof(sfa30_data_t) + 3) / 4)        /**< sfa30_data_t in 32 bit words */
+
+/**
+ * @brief sfa30 sampling structure definition
+ */
+typedef struct sfa30_sampling_s
+{
+    sfa30_handle_t *handle;                                   /**< sensor handle owned by the sampling thread */
+    sfa30_history_t *history;                                 /**< optional history fed with each sample */
+    sfa30_aggregate_t *aggregate;                             /**< optional aggregate fed with each sample */
+    uint32_t period_ms;                                       /**< sampling period */
+    uint32_t next_ms;                                         /**< next read begin time */
+    uint32_t begin_ms;                                        /**< begin time of the read in flight */
+    uint32_t errors;                                          /**< failed reads */
+    uint32_t sequence;                                        /**< snapshot sequence, odd while the owner writes */
+    uint32_t timestamp_ms;                                    /**< snapshot timestamp */
+    uint32_t words[SFA30_SAMPLING_SNAPSHOT_WORDS];            /**< snapshot data */
+} sfa30_sampling_t;
+
+/**
+ * @brief     init the sampling
+ * @param[in] *sampling pointer to an sfa30 sampling structure
+ * @param[in] *handle pointer to an inited and measuring sfa30 handle structure
+ * @param[in] period_ms sampling period in ms, 0 means the default period
+ * @param[in] now_ms current time of a monotonic millisecond clock
+ * @return    status code
+ *            - 0 success
+ *            - 2 sampling or handle is NULL
+ * @note      the first read begins at the first poll
+ */
+uint8_t sfa30_sampling_init(sfa30_sampling_t *sampling, sfa30_handle_t *handle, uint32_t period_ms, uint32_t now_ms);
+
+/**
+ * @brief     attach a history to the sampling
+ * @param[in] *sampling pointer to an sfa30 sampling structure
+ * @param[in] *history pointer to an inited sfa30 history structure, NULL detaches it
+ * @return    status code
+ *            - 0 success
+ *            - 2 sampling is NULL
+ * @note      the sampling owner becomes the history producer
+ */
+uint8_t sfa30_sampling_set_history(sfa30_sampling_t *sampling, sfa30_history_t *history);
+
+/**
+ * @brief     attach an aggregate to the sampling
+ * @param[in] *sampling pointer to an sfa30 sampling structure
+ * @param[in] *aggregate pointer to an inited sfa30 aggregate structure, NULL detaches it
+ * @return    status code
+ *            - 0 success
+ *            - 2 sampling is NULL
+ * @note      the aggregate is pushed and read by the sampling owner only
+ */
+uint8_t sfa30_sampling_set_aggregate(sfa30_sampling_t *sampling, sfa30_aggregate_t *aggregate);
+
+/**
+ * @brief     poll the sampling
+ * @param[in] *sampling pointer to an sfa30 sampling structure
+ * @param[in] now_ms current time of a monotonic millisecond clock
+ * @return    status code
+ *            - 0 success
+ *            - 1 read failed
+ *            - 2 sampling is NULL
+ * @note      only the owner thread may call it, it never blocks and publishes
+ *            each decoded sample to the snapshot and the attached history and aggregate
+ */
+uint8_t sfa30_sampling_poll(sfa30_sampling_t *sampling, uint32_t now_ms);
+
+/**
+ * @brief      load the latest sample
+ * @param[in]  *sampling pointer to an sfa30 sampling structure
+ * @param[out] *data pointer to an sfa30_data_t structure
+ * @param[out] *timestamp_ms pointer to a sample timestamp buffer, can be NULL
+ * @return     status code
+ *             - 0 success
+ *             - 1 no sample yet
+ *             - 2 sampling or data is NULL
+ * @note       any thread may call it, it never touches the bus or the handle and
+ *             retries only when it races the owner publishing a sample
+ */
+uint8_t sfa30_sampling_load(const sfa30_sampling_t *sampling, sfa30_data_t *data, uint32_t *timestamp_ms);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
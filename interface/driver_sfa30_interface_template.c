@@ -37,31 +37,34 @@
 #include "driver_sfa30_interface.h"
 
 /**
- * @brief  interface iic bus init
- * @return status code
- *         - 0 success
- *         - 1 iic init failed
- * @note   none
+ * @brief     interface iic bus init
+ * @param[in] *user pointer to the user context
+ * @return    status code
+ *            - 0 success
+ *            - 1 iic init failed
+ * @note      none
  */
-uint8_t sfa30_interface_iic_init(void)
+uint8_t sfa30_interface_iic_init(void *user)
 {
     return 0;
 }
 
 /**
- * @brief  interface iic bus deinit
- * @return status code
- *         - 0 success
- *         - 1 iic deinit failed
- * @note   none
+ * @brief     interface iic bus deinit
+ * @param[in] *user pointer to the user context
+ * @return    status code
+ *            - 0 success
+ *            - 1 iic deinit failed
+ * @note      none
  */
-uint8_t sfa30_interface_iic_deinit(void)
+uint8_t sfa30_interface_iic_deinit(void *user)
 {
     return 0;
 }
 
 /**
  * @brief      interface iic bus read
+ * @param[in]  *user pointer to the user context
  * @param[in]  addr iic device write address
  * @param[out] *buf pointer to a data buffer
  * @param[in]  len length of the data buffer
@@ -70,13 +73,14 @@ uint8_t sfa30_interface_iic_deinit(void)
  *             - 1 read failed
  * @note       none
  */
-uint8_t sfa30_interface_iic_read_cmd(uint8_t addr, uint8_t *buf, uint16_t len)
+uint8_t sfa30_interface_iic_read_cmd(void *user, uint8_t addr, uint8_t *buf, uint16_t len)
 {
     return 0;
 }
 
 /**
  * @brief     interface iic bus write
+ * @param[in] *user pointer to the user context
  * @param[in] addr iic device write address
  * @param[in] *buf pointer to a data buffer
  * @param[in] len length of the data buffer
@@ -85,37 +89,40 @@ uint8_t sfa30_interface_iic_read_cmd(uint8_t addr, uint8_t *buf, uint16_t len)
  *            - 1 write failed
  * @note      none
  */
-uint8_t sfa30_interface_iic_write_cmd(uint8_t addr, uint8_t *buf, uint16_t len)
+uint8_t sfa30_interface_iic_write_cmd(void *user, uint8_t addr, uint8_t *buf, uint16_t len)
 {
     return 0;
 }
 
 /**
- * @brief  interface uart init
- * @return status code
- *         - 0 success
- *         - 1 uart init failed
- * @note   none
+ * @brief     interface uart init
+ * @param[in] *user pointer to the user context
+ * @return    status code
+ *            - 0 success
+ *            - 1 uart init failed
+ * @note      none
  */
-uint8_t sfa30_interface_uart_init(void)
+uint8_t sfa30_interface_uart_init(void *user)
 {
     return 0;
 }
 
 /**
- * @brief  interface uart deinit
- * @return status code
- *         - 0 success
- *         - 1 uart deinit failed
- * @note   none
+ * @brief     interface uart deinit
+ * @param[in] *user pointer to the user context
+ * @return    status code
+ *            - 0 success
+ *            - 1 uart deinit failed
+ * @note      none
  */
-uint8_t sfa30_interface_uart_deinit(void)
+uint8_t sfa30_interface_uart_deinit(void *user)
 {
     return 0;
 }
 
 /**
  * @brief      interface uart read
+ * @param[in]  *user pointer to the user context
  * @param[out] *buf pointer to a data buffer
  * @param[in]  len length of the data buffer
  * @return     status code
@@ -123,13 +130,14 @@ uint8_t sfa30_interface_uart_deinit(void)
  *             - 1 read failed
  * @note       none
  */
-uint16_t sfa30_interface_uart_read(uint8_t *buf, uint16_t len)
+uint16_t sfa30_interface_uart_read(void *user, uint8_t *buf, uint16_t len)
 {
     return 0;
 }
 
 /**
  * @brief     interface uart write
+ * @param[in] *user pointer to the user context
  * @param[in] *buf pointer to a data buffer
  * @param[in] len length of the data buffer
  * @return    status code
@@ -137,29 +145,31 @@ uint16_t sfa30_interface_uart_read(uint8_t *buf, uint16_t len)
  *            - 1 write failed
  * @note      none
  */
-uint8_t sfa30_interface_uart_write(uint8_t *buf, uint16_t len)
+uint8_t sfa30_interface_uart_write(void *user, uint8_t *buf, uint16_t len)
 {
     return 0;
 }
 
 /**
- * @brief  interface uart flush
- * @return status code
- *         - 0 success
- *         - 1 uart flush failed
- * @note   none
+ * @brief     interface uart flush
+ * @param[in] *user pointer to the user context
+ * @return    status code
+ *            - 0 success
+ *            - 1 uart flush failed
+ * @note      none
  */
-uint8_t sfa30_interface_uart_flush(void)
+uint8_t sfa30_interface_uart_flush(void *user)
 {
     return 0;
 }
 
 /**
  * @brief     interface delay ms
+ * @param[in] *user pointer to the user context
  * @param[in] ms time
  * @note      none
  */
-void sfa30_interface_delay_ms(uint32_t ms)
+void sfa30_interface_delay_ms(void *user, uint32_t ms)
 {
 
 }
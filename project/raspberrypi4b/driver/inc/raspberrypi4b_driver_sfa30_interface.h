@@ -0,0 +1,87 @@
+/**
+ * Copyright (c) 2015 - present LibDriver All rights reserved
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @file      raspberrypi4b_driver_sfa30_interface.h
+ * @brief     raspberrypi4b driver sfa30 interface header file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2023-07-30
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2023/07/30  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#ifndef RASPBERRYPI4B_DRIVER_SFA30_INTERFACE_H
+#define RASPBERRYPI4B_DRIVER_SFA30_INTERFACE_H
+
+#include "driver_sfa30_interface.h"
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/**
+ * @defgroup raspberrypi4b_sfa30_interface raspberrypi4b sfa30 interface function
+ * @brief    raspberrypi4b sfa30 interface modules
+ * @ingroup  sfa30_interface_driver
+ * @{
+ */
+
+/**
+ * @brief raspberrypi4b sfa30 port structure definition
+ * @note  link one port per sensor with DRIVER_SFA30_LINK_USER,
+ *        a handle without a user context uses /dev/i2c-1 and /dev/ttyS0
+ */
+typedef struct sfa30_interface_port_s
+{
+    char iic_name[32];         /**< iic device name */
+    char uart_name[32];        /**< uart device name */
+    int iic_fd;                /**< iic device handle */
+    int uart_fd;               /**< uart device handle */
+} sfa30_interface_port_t;
+
+/**
+ * @brief     initialize a port structure
+ * @param[in] *port pointer to a port structure
+ * @param[in] *iic_name pointer to an iic device name, can be NULL for a uart only port
+ * @param[in] *uart_name pointer to a uart device name, can be NULL for an iic only port
+ * @return    status code
+ *            - 0 success
+ *            - 1 name is too long
+ *            - 2 port is NULL
+ * @note      the devices are opened by sfa30_init
+ */
+uint8_t sfa30_interface_port_init(sfa30_interface_port_t *port, const char *iic_name, const char *uart_name);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -34,7 +34,7 @@
  * </table>
  */
 
-#include "driver_sfa30_interface.h"
+#include "raspberrypi4b_driver_sfa30_interface.h"
 #include "iic.h"
 #include "uart.h"
 #include <stdarg.h>
@@ -45,46 +45,107 @@
 #define IIC_DEVICE_NAME "/dev/i2c-1"        /**< iic device name */
 
 /**
- * @brief iic device handle definition
+ * @brief uart device name definition
  */
-static int iic_gs_fd;                       /**< iic handle */
+#define UART_DEVICE_NAME "/dev/ttyS0"       /**< uart device name */
 
 /**
- * @brief uart device name definition
+ * @brief default port definition
  */
-#define UART_DEVICE_NAME "/dev/ttyS0"       /**< uart device name */
+static sfa30_interface_port_t gs_port =
+{
+    .iic_name = IIC_DEVICE_NAME,
+    .uart_name = UART_DEVICE_NAME,
+    .iic_fd = -1,
+    .uart_fd = -1,
+};                                          /**< port of the handles without a user context */
 
 /**
- * @brief uart device handle definition
+ * @brief     get the port of a user context
+ * @param[in] *user pointer to the user context
+ * @return    pointer to a port structure
+ * @note      none
  */
-static int uart_gs_fd;                      /**< uart handle */
+static inline sfa30_interface_port_t *a_sfa30_interface_port(void *user)
+{
+    return (user != NULL) ? (sfa30_interface_port_t *)user : &gs_port;
+}
 
 /**
- * @brief  interface iic bus init
- * @return status code
- *         - 0 success
- *         - 1 iic init failed
- * @note   none
+ * @brief     initialize a port structure
+ * @param[in] *port pointer to a port structure
+ * @param[in] *iic_name pointer to an iic device name, can be NULL for a uart only port
+ * @param[in] *uart_name pointer to a uart device name, can be NULL for an iic only port
+ * @return    status code
+ *            - 0 success
+ *            - 1 name is too long
+ *            - 2 port is NULL
+ * @note      the devices are opened by sfa30_init
  */
-uint8_t sfa30_interface_iic_init(void)
+uint8_t sfa30_interface_port_init(sfa30_interface_port_t *port, const char *iic_name, const char *uart_name)
 {
-    return iic_init(IIC_DEVICE_NAME, &iic_gs_fd);
+    if (port == NULL)
+    {
+        return 2;
+    }
+    if (((iic_name != NULL) && (strlen(iic_name) >= sizeof(port->iic_name))) ||
+        ((uart_name != NULL) && (strlen(uart_name) >= sizeof(port->uart_name))))
+    {
+        return 1;
+    }
+
+    memset(port, 0, sizeof(sfa30_interface_port_t));
+    if (iic_name != NULL)
+    {
+        strcpy(port->iic_name, iic_name);
+    }
+    if (uart_name != NULL)
+    {
+        strcpy(port->uart_name, uart_name);
+    }
+    port->iic_fd = -1;
+    port->uart_fd = -1;
+
+    return 0;
 }
 
 /**
- * @brief  interface iic bus deinit
- * @return status code
- *         - 0 success
- *         - 1 iic deinit failed
- * @note   none
+ * @brief     interface iic bus init
+ * @param[in] *user pointer to the user context
+ * @return    status code
+ *            - 0 success
+ *            - 1 iic init failed
+ * @note      none
  */
-uint8_t sfa30_interface_iic_deinit(void)
+uint8_t sfa30_interface_iic_init(void *user)
 {
-    return iic_deinit(iic_gs_fd);
+    sfa30_interface_port_t *port = a_sfa30_interface_port(user);
+
+    return iic_init(port->iic_name, &port->iic_fd);
+}
+
+/**
+ * @brief     interface iic bus deinit
+ * @param[in] *user pointer to the user context
+ * @return    status code
+ *            - 0 success
+ *            - 1 iic deinit failed
+ * @note      none
+ */
+uint8_t sfa30_interface_iic_deinit(void *user)
+{
+    sfa30_interface_port_t *port = a_sfa30_interface_port(user);
+    uint8_t res;
+
+    res = iic_deinit(port->iic_fd);
+    port->iic_fd = -1;
+
+    return res;
 }
 
 /**
  * @brief      interface iic bus read
+ * @param[in]  *user pointer to the user context
  * @param[in]  addr iic device write address
  * @param[out] *buf pointer to a data buffer
  * @param[in]  len length of the data buffer
@@ -93,13 +154,14 @@ uint8_t sfa30_interface_iic_deinit(void)
  *             - 1 read failed
  * @note       none
  */
-uint8_t sfa30_interface_iic_read_cmd(uint8_t addr, uint8_t *buf, uint16_t len)
+uint8_t sfa30_interface_iic_read_cmd(void *user, uint8_t addr, uint8_t *buf, uint16_t len)
 {
-    return iic_read_cmd(iic_gs_fd, addr, buf, len);
+    return iic_read_cmd(a_sfa30_interface_port(user)->iic_fd, addr, buf, len);
 }
 
 /**
  * @brief     interface iic bus write
+ * @param[in] *user pointer to the user context
  * @param[in] addr iic device write address
  * @param[in] *buf pointer to a data buffer
  * @param[in] len length of the data buffer
@@ -108,37 +170,48 @@ uint8_t sfa30_interface_iic_read_cmd(uint8_t addr, uint8_t *buf, uint16_t len)
  *            - 1 write failed
  * @note      none
  */
-uint8_t sfa30_interface_iic_write_cmd(uint8_t addr, uint8_t *buf, uint16_t len)
+uint8_t sfa30_interface_iic_write_cmd(void *user, uint8_t addr, uint8_t *buf, uint16_t len)
 {
-    return iic_write_cmd(iic_gs_fd, addr, buf, len);
+    return iic_write_cmd(a_sfa30_interface_port(user)->iic_fd, addr, buf, len);
 }
 
 /**
- * @brief  interface uart init
- * @return status code
- *         - 0 success
- *         - 1 uart init failed
- * @note   none
+ * @brief     interface uart init
+ * @param[in] *user pointer to the user context
+ * @return    status code
+ *            - 0 success
+ *            - 1 uart init failed
+ * @note      none
  */
-uint8_t sfa30_interface_uart_init(void)
+uint8_t sfa30_interface_uart_init(void *user)
 {
-    return uart_init(UART_DEVICE_NAME, &uart_gs_fd, 115200, 8, 'N', 1);
+    sfa30_interface_port_t *port = a_sfa30_interface_port(user);
+
+    return uart_init(port->uart_name, &port->uart_fd, 115200, 8, 'N', 1);
 }
 
 /**
- * @brief  interface uart deinit
- * @return status code
- *         - 0 success
- *         - 1 uart deinit failed
- * @note   none
+ * @brief     interface uart deinit
+ * @param[in] *user pointer to the user context
+ * @return    status code
+ *            - 0 success
+ *            - 1 uart deinit failed
+ * @note      none
  */
-uint8_t sfa30_interface_uart_deinit(void)
+uint8_t sfa30_interface_uart_deinit(void *user)
 {
-    return uart_deinit(uart_gs_fd);
+    sfa30_interface_port_t *port = a_sfa30_interface_port(user);
+    uint8_t res;
+
+    res = uart_deinit(port->uart_fd);
+    port->uart_fd = -1;
+
+    return res;
 }
 
 /**
  * @brief      interface uart read
+ * @param[in]  *user pointer to the user context
  * @param[out] *buf pointer to a data buffer
  * @param[in]  len length of the data buffer
  * @return     status code
@@ -146,11 +219,11 @@ uint8_t sfa30_interface_uart_deinit(void)
  *             - 1 read failed
  * @note       none
  */
-uint16_t sfa30_interface_uart_read(uint8_t *buf, uint16_t len)
+uint16_t sfa30_interface_uart_read(void *user, uint8_t *buf, uint16_t len)
 {
     uint32_t l = len;
 
-    if (uart_read(uart_gs_fd, buf, (uint32_t *)&l) != 0)
+    if (uart_read(a_sfa30_interface_port(user)->uart_fd, buf, (uint32_t *)&l) != 0)
     {
         return 0;
     }
@@ -162,6 +235,7 @@ uint16_t sfa30_interface_uart_read(uint8_t *buf, uint16_t len)
 
 /**
  * @brief     interface uart write
+ * @param[in] *user pointer to the user context
  * @param[in] *buf pointer to a data buffer
  * @param[in] len length of the data buffer
  * @return    status code
@@ -169,11 +243,11 @@ uint16_t sfa30_interface_uart_read(uint8_t *buf, uint16_t len)
  *            - 1 write failed
  * @note      none
  */
-uint8_t sfa30_interface_uart_write(uint8_t *buf, uint16_t len)
+uint8_t sfa30_interface_uart_write(void *user, uint8_t *buf, uint16_t len)
 {
     uint32_t l = len;
 
-    if (uart_write(uart_gs_fd, buf, (uint32_t)l) != 0)
+    if (uart_write(a_sfa30_interface_port(user)->uart_fd, buf, (uint32_t)l) != 0)
     {
         return 1;
     }
@@ -184,24 +258,28 @@ uint8_t sfa30_interface_uart_write(uint8_t *buf, uint16_t len)
 }
 
 /**
- * @brief  interface uart flush
- * @return status code
- *         - 0 success
- *         - 1 uart flush failed
- * @note   none
+ * @brief     interface uart flush
+ * @param[in] *user pointer to the user context
+ * @return    status code
+ *            - 0 success
+ *            - 1 uart flush failed
+ * @note      none
  */
-uint8_t sfa30_interface_uart_flush(void)
+uint8_t sfa30_interface_uart_flush(void *user)
 {
-    return uart_flush(uart_gs_fd);
+    return uart_flush(a_sfa30_interface_port(user)->uart_fd);
 }
 
 /**
  * @brief     interface delay ms
+ * @param[in] *user pointer to the user context
  * @param[in] ms time
- * @note      none
+ * @note      the delay is the same for every port
  */
-void sfa30_interface_delay_ms(uint32_t ms)
+void sfa30_interface_delay_ms(void *user, uint32_t ms)
 {
+    (void)user;
+
     usleep(1000 * ms);
 }
 
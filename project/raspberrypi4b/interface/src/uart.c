@@ -35,6 +35,7 @@
  */
 
 #include "uart.h"
+#include <errno.h>
 #include <fcntl.h>
 #include <string.h>
 #include <termios.h>
@@ -394,7 +395,14 @@ uint8_t uart_read(int fd, uint8_t *buf, uint32_t *len)
     
     /* read data */
     l = read(fd, buf, *len);
-    if (l < 0) 
+    if ((l < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK)))
+    {
+        /* nothing has arrived yet */
+        *len = 0;
+        
+        return 0;
+    }
+    else if (l < 0) 
     {
         perror("uart: read failed.\n");
         
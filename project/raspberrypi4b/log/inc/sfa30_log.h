@@ -0,0 +1,248 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @file      sfa30_log.h
+ * @brief     sfa30 binary sample log header file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2023-07-30
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2023/07/30  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#ifndef SFA30_LOG_H
+#define SFA30_LOG_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup sfa30_log sfa30 log function
+ * @brief    sfa30 binary sample log modules
+ * @{
+ */
+
+/**
+ * @brief sfa30 log format definition
+ * @note  a little endian header followed by 10 byte records, a record whose sensor is
+ *        SFA30_LOG_CHECKPOINT carries the absolute time the following deltas refer to
+ */
+#define SFA30_LOG_MAGIC                  "SFA30LOG"        /**< 8 byte file magic */
+#define SFA30_LOG_VERSION                1                 /**< format version */
+#define SFA30_LOG_CHECKPOINT             0xFFFF            /**< checkpoint marker in the sensor field */
+#define SFA30_LOG_CHECKPOINT_INTERVAL    4096              /**< max records between two checkpoints */
+#define SFA30_LOG_CHECKPOINT_SLACK_MS    1000              /**< a checkpoint is dated this much before its first record */
+#define SFA30_LOG_DEFAULT_BUFFER         6144              /**< default writer buffer in records, 60 KB */
+#define SFA30_LOG_FLUSH_MS               1000              /**< max log time a record waits in the writer buffer */
+
+/**
+ * @brief sfa30 log header structure definition
+ */
+typedef struct sfa30_log_header_s
+{
+    char magic[8];                       /**< SFA30_LOG_MAGIC */
+    uint16_t version;                    /**< SFA30_LOG_VERSION */
+    uint16_t header_size;                /**< sizeof(sfa30_log_header_t) */
+    uint16_t record_size;                /**< sizeof(sfa30_log_record_t) */
+    uint16_t checkpoint_interval;        /**< max records between two checkpoints */
+    uint64_t created_ms;                 /**< creation time in ms since the epoch */
+    uint32_t reserved[2];                /**< reserved, 0 */
+} sfa30_log_header_t;
+
+/**
+ * @brief sfa30 log record structure definition
+ * @note  in a checkpoint delta_ms and the raw values hold the absolute time in ms,
+ *        least significant 16 bits first
+ */
+typedef struct sfa30_log_record_s
+{
+    uint16_t sensor;                     /**< sensor index or SFA30_LOG_CHECKPOINT */
+    uint16_t delta_ms;                   /**< ms since the last checkpoint */
+    int16_t formaldehyde_raw;            /**< formaldehyde raw, ppb * 5 */
+    int16_t humidity_raw;                /**< humidity raw, % * 100 */
+    int16_t temperature_raw;             /**< temperature raw, C * 200 */
+} sfa30_log_record_t;
+
+/**
+ * @brief sfa30 log sample structure definition
+ */
+typedef struct sfa30_log_sample_s
+{
+    uint64_t time_ms;                    /**< absolute time in ms */
+    uint16_t sensor;                     /**< sensor index */
+    int16_t formaldehyde_raw;            /**< formaldehyde raw, ppb * 5 */
+    int16_t humidity_raw;                /**< humidity raw, % * 100 */
+    int16_t temperature_raw;             /**< temperature raw, C * 200 */
+} sfa30_log_sample_t;
+
+/**
+ * @brief sfa30 log writer structure definition
+ */
+typedef struct sfa30_log_writer_s
+{
+    int fd;                              /**< log file */
+    sfa30_log_record_t *buf;             /**< batched records */
+    uint32_t len;                        /**< batched records */
+    uint32_t cap;                        /**< buffer capacity in records */
+    uint32_t since_checkpoint;           /**< records since the last checkpoint */
+    uint8_t based;                       /**< a checkpoint is in effect */
+    uint64_t base_ms;                    /**< time of the last checkpoint */
+    uint64_t first_ms;                   /**< time of the oldest batched record */
+    uint64_t records;                    /**< records written including checkpoints */
+} sfa30_log_writer_t;
+
+/**
+ * @brief sfa30 log reader structure definition
+ */
+typedef struct sfa30_log_reader_s
+{
+    const uint8_t *map;                  /**< mapped file */
+    size_t size;                         /**< mapped bytes */
+    const sfa30_log_record_t *records;   /**< records, scan them directly for full speed */
+    uint64_t count;                      /**< whole records in the file */
+    uint64_t index;                      /**< next record */
+    uint64_t base_ms;                    /**< time of the last checkpoint read */
+    uint8_t based;                       /**< a checkpoint has been read */
+    sfa30_log_header_t header;           /**< file header */
+} sfa30_log_reader_t;
+
+/**
+ * @brief     open a log for writing
+ * @param[in] *writer pointer to an sfa30 log writer structure
+ * @param[in] *path pointer to a file path, an existing log is appended to
+ * @param[in] buffer_records records batched per write, 0 means the default
+ * @param[in] now_ms current time in ms since the epoch
+ * @return    status code
+ *            - 0 success
+ *            - 1 open failed
+ *            - 2 writer or path is NULL
+ *            - 4 existing file is not a supported log
+ * @note      a torn record left by a crash is cut off before appending, and the appended samples
+ *            may not be older than the last checkpoint of the file
+ */
+uint8_t sfa30_log_writer_open(sfa30_log_writer_t *writer, const char *path, uint32_t buffer_records, uint64_t now_ms);
+
+/**
+ * @brief     append a sample
+ * @param[in] *writer pointer to an sfa30 log writer structure
+ * @param[in] *sample pointer to a sample
+ * @return    status code
+ *            - 0 success
+ *            - 1 write failed
+ *            - 2 writer or sample is NULL
+ *            - 3 writer is not opened
+ *            - 4 sensor is SFA30_LOG_CHECKPOINT
+ *            - 5 sample is older than the last checkpoint
+ * @note      the batch is written when it is full or its oldest record is SFA30_LOG_FLUSH_MS old,
+ *            samples may step back by up to SFA30_LOG_CHECKPOINT_SLACK_MS so checkpoints never do
+ */
+uint8_t sfa30_log_writer_append(sfa30_log_writer_t *writer, const sfa30_log_sample_t *sample);
+
+/**
+ * @brief     write the batched records
+ * @param[in] *writer pointer to an sfa30 log writer structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 write failed
+ *            - 2 writer is NULL
+ *            - 3 writer is not opened
+ * @note      none
+ */
+uint8_t sfa30_log_writer_flush(sfa30_log_writer_t *writer);
+
+/**
+ * @brief     flush and close a log writer
+ * @param[in] *writer pointer to an sfa30 log writer structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 write failed
+ *            - 2 writer is NULL
+ * @note      none
+ */
+uint8_t sfa30_log_writer_close(sfa30_log_writer_t *writer);
+
+/**
+ * @brief     map a log for reading
+ * @param[in] *reader pointer to an sfa30 log reader structure
+ * @param[in] *path pointer to a file path
+ * @return    status code
+ *            - 0 success
+ *            - 1 open failed
+ *            - 2 reader or path is NULL
+ *            - 4 file is not a supported log
+ * @note      records appended after the open are not seen
+ */
+uint8_t sfa30_log_reader_open(sfa30_log_reader_t *reader, const char *path);
+
+/**
+ * @brief     unmap a log
+ * @param[in] *reader pointer to an sfa30 log reader structure
+ * @return    status code
+ *            - 0 success
+ *            - 2 reader is NULL
+ * @note      none
+ */
+uint8_t sfa30_log_reader_close(sfa30_log_reader_t *reader);
+
+/**
+ * @brief      read the next sample
+ * @param[in]  *reader pointer to an sfa30 log reader structure
+ * @param[out] *sample pointer to a sample buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 end of the log
+ *             - 2 reader or sample is NULL
+ *             - 3 reader is not opened
+ * @note       checkpoints are consumed on the way
+ */
+uint8_t sfa30_log_reader_next(sfa30_log_reader_t *reader, sfa30_log_sample_t *sample);
+
+/**
+ * @brief     move to the checkpoint at or before a time
+ * @param[in] *reader pointer to an sfa30 log reader structure
+ * @param[in] time_ms time in ms since the epoch
+ * @return    status code
+ *            - 0 success
+ *            - 2 reader is NULL
+ *            - 3 reader is not opened
+ * @note      bisects the checkpoints, so it touches O(log n) pages
+ */
+uint8_t sfa30_log_reader_seek(sfa30_log_reader_t *reader, uint64_t time_ms);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,621 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @file      sfa30_log.c
+ * @brief     sfa30 binary sample log source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2023-07-30
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2023/07/30  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#include "sfa30_log.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/**
+ * @brief     check a log header
+ * @param[in] *header pointer to a header
+ * @return    status code
+ *            - 0 success
+ *            - 1 header is not supported
+ * @note      none
+ */
+static uint8_t a_sfa30_log_check_header(const sfa30_log_header_t *header)
+{
+    if ((memcmp(header->magic, SFA30_LOG_MAGIC, sizeof(header->magic)) != 0) ||
+        (header->version != SFA30_LOG_VERSION) ||
+        (header->header_size != sizeof(sfa30_log_header_t)) ||
+        (header->record_size != sizeof(sfa30_log_record_t)) ||
+        (header->checkpoint_interval == 0))
+    {
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief     get the time of a checkpoint
+ * @param[in] *record pointer to a checkpoint record
+ * @return    time in ms
+ * @note      none
+ */
+static uint64_t a_sfa30_log_checkpoint_ms(const sfa30_log_record_t *record)
+{
+    return (uint64_t)record->delta_ms |
+           ((uint64_t)(uint16_t)record->formaldehyde_raw << 16) |
+           ((uint64_t)(uint16_t)record->humidity_raw << 32) |
+           ((uint64_t)(uint16_t)record->temperature_raw << 48);
+}
+
+/**
+ * @brief     write a whole buffer
+ * @param[in] fd file
+ * @param[in] *buf pointer to a data buffer
+ * @param[in] len bytes
+ * @return    status code
+ *            - 0 success
+ *            - 1 write failed
+ * @note      none
+ */
+static uint8_t a_sfa30_log_write(int fd, const void *buf, size_t len)
+{
+    ssize_t l;
+    const uint8_t *p = (const uint8_t *)buf;
+
+    while (len != 0)
+    {
+        l = write(fd, p, len);
+        if (l < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            return 1;
+        }
+        p += l;
+        len -= (size_t)l;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief     take the time of the last checkpoint of an existing log
+ * @param[in] *writer pointer to an sfa30 log writer structure with its buffer
+ * @param[in] end end of the records
+ * @return    status code
+ *            - 0 success
+ *            - 1 read failed
+ * @note      a checkpoint leads every SFA30_LOG_CHECKPOINT_INTERVAL records, so only the tail is read
+ */
+static uint8_t a_sfa30_log_writer_seed(sfa30_log_writer_t *writer, off_t end)
+{
+    off_t limit;
+    off_t pos = end;
+    uint32_t n;
+    uint32_t i;
+
+    limit = end - (off_t)((SFA30_LOG_CHECKPOINT_INTERVAL + 1) * sizeof(sfa30_log_record_t));
+    if (limit < (off_t)sizeof(sfa30_log_header_t))
+    {
+        limit = (off_t)sizeof(sfa30_log_header_t);
+    }
+    while (pos > limit)
+    {
+        n = writer->cap;
+        if ((off_t)(n * sizeof(sfa30_log_record_t)) > pos - limit)
+        {
+            n = (uint32_t)((pos - limit) / (off_t)sizeof(sfa30_log_record_t));
+        }
+        pos -= (off_t)(n * sizeof(sfa30_log_record_t));
+        if (pread(writer->fd, writer->buf, n * sizeof(sfa30_log_record_t), pos) != (ssize_t)(n * sizeof(sfa30_log_record_t)))
+        {
+            return 1;
+        }
+        for (i = n; i > 0; i--)
+        {
+            if (writer->buf[i - 1].sensor == SFA30_LOG_CHECKPOINT)
+            {
+                writer->base_ms = a_sfa30_log_checkpoint_ms(&writer->buf[i - 1]);
+
+                return 0;
+            }
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief     open a log for writing
+ * @param[in] *writer pointer to an sfa30 log writer structure
+ * @param[in] *path pointer to a file path, an existing log is appended to
+ * @param[in] buffer_records records batched per write, 0 means the default
+ * @param[in] now_ms current time in ms since the epoch
+ * @return    status code
+ *            - 0 success
+ *            - 1 open failed
+ *            - 2 writer or path is NULL
+ *            - 4 existing file is not a supported log
+ * @note      a torn record left by a crash is cut off before appending, and the appended samples
+ *            may not be older than the last checkpoint of the file
+ */
+uint8_t sfa30_log_writer_open(sfa30_log_writer_t *writer, const char *path, uint32_t buffer_records, uint64_t now_ms)
+{
+    struct stat st;
+    off_t end = 0;
+    sfa30_log_header_t header;
+
+    if ((writer == NULL) || (path == NULL))
+    {
+        return 2;
+    }
+
+    memset(writer, 0, sizeof(sfa30_log_writer_t));
+    writer->cap = (buffer_records >= 2) ? buffer_records : SFA30_LOG_DEFAULT_BUFFER;
+    writer->fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (writer->fd < 0)
+    {
+        return 1;
+    }
+    if (fstat(writer->fd, &st) != 0)
+    {
+        (void)close(writer->fd);
+        writer->fd = -1;
+
+        return 1;
+    }
+    if (st.st_size == 0)
+    {
+        /* a new log */
+        memset(&header, 0, sizeof(sfa30_log_header_t));
+        memcpy(header.magic, SFA30_LOG_MAGIC, sizeof(header.magic));
+        header.version = SFA30_LOG_VERSION;
+        header.header_size = sizeof(sfa30_log_header_t);
+        header.record_size = sizeof(sfa30_log_record_t);
+        header.checkpoint_interval = SFA30_LOG_CHECKPOINT_INTERVAL;
+        header.created_ms = now_ms;
+        if (a_sfa30_log_write(writer->fd, &header, sizeof(sfa30_log_header_t)) != 0)
+        {
+            (void)close(writer->fd);
+            writer->fd = -1;
+
+            return 1;
+        }
+    }
+    else
+    {
+        /* an existing log, cut a torn record off its end */
+        if (((size_t)st.st_size < sizeof(sfa30_log_header_t)) ||
+            (pread(writer->fd, &header, sizeof(sfa30_log_header_t), 0) != (ssize_t)sizeof(sfa30_log_header_t)) ||
+            (a_sfa30_log_check_header(&header) != 0))
+        {
+            (void)close(writer->fd);
+            writer->fd = -1;
+
+            return 4;
+        }
+        end = st.st_size - (off_t)((st.st_size - sizeof(sfa30_log_header_t)) % sizeof(sfa30_log_record_t));
+        if ((end != st.st_size) && (ftruncate(writer->fd, end) != 0))
+        {
+            (void)close(writer->fd);
+            writer->fd = -1;
+
+            return 1;
+        }
+        if (lseek(writer->fd, end, SEEK_SET) != end)
+        {
+            (void)close(writer->fd);
+            writer->fd = -1;
+
+            return 1;
+        }
+    }
+    writer->buf = (sfa30_log_record_t *)malloc(writer->cap * sizeof(sfa30_log_record_t));
+    if (writer->buf == NULL)
+    {
+        (void)close(writer->fd);
+        writer->fd = -1;
+
+        return 1;
+    }
+
+    /* the checkpoints of the new session carry on from the file, whatever the clock says */
+    if (a_sfa30_log_writer_seed(writer, end) != 0)
+    {
+        free(writer->buf);
+        writer->buf = NULL;
+        (void)close(writer->fd);
+        writer->fd = -1;
+
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief     append a sample
+ * @param[in] *writer pointer to an sfa30 log writer structure
+ * @param[in] *sample pointer to a sample
+ * @return    status code
+ *            - 0 success
+ *            - 1 write failed
+ *            - 2 writer or sample is NULL
+ *            - 3 writer is not opened
+ *            - 4 sensor is SFA30_LOG_CHECKPOINT
+ *            - 5 sample is older than the last checkpoint
+ * @note      the batch is written when it is full or its oldest record is SFA30_LOG_FLUSH_MS old,
+ *            samples may step back by up to SFA30_LOG_CHECKPOINT_SLACK_MS so checkpoints never do
+ */
+uint8_t sfa30_log_writer_append(sfa30_log_writer_t *writer, const sfa30_log_sample_t *sample)
+{
+    uint64_t base_ms;
+    sfa30_log_record_t *record;
+
+    if ((writer == NULL) || (sample == NULL))
+    {
+        return 2;
+    }
+    if (writer->buf == NULL)
+    {
+        return 3;
+    }
+    if (sample->sensor == SFA30_LOG_CHECKPOINT)
+    {
+        return 4;
+    }
+    if (sample->time_ms < writer->base_ms)
+    {
+        return 5;
+    }
+
+    /* keep room for a checkpoint and the record */
+    if ((writer->len + 2 > writer->cap) && (sfa30_log_writer_flush(writer) != 0))
+    {
+        return 1;
+    }
+    if (writer->len == 0)
+    {
+        writer->first_ms = sample->time_ms;
+    }
+
+    /* a checkpoint when the delta would not fit or the interval is up, dated a little
+       early so samples arriving slightly out of order still fit behind it, but never
+       before the last one so the seek can bisect them */
+    if ((writer->based == 0) || (writer->since_checkpoint >= SFA30_LOG_CHECKPOINT_INTERVAL) ||
+        (sample->time_ms - writer->base_ms > 0xFFFF))
+    {
+        base_ms = (sample->time_ms > SFA30_LOG_CHECKPOINT_SLACK_MS) ? (sample->time_ms - SFA30_LOG_CHECKPOINT_SLACK_MS) : 0;
+        base_ms = (base_ms > writer->base_ms) ? base_ms : writer->base_ms;
+        record = &writer->buf[writer->len++];
+        record->sensor = SFA30_LOG_CHECKPOINT;
+        record->delta_ms = (uint16_t)base_ms;
+        record->formaldehyde_raw = (int16_t)(uint16_t)(base_ms >> 16);
+        record->humidity_raw = (int16_t)(uint16_t)(base_ms >> 32);
+        record->temperature_raw = (int16_t)(uint16_t)(base_ms >> 48);
+        writer->base_ms = base_ms;
+        writer->based = 1;
+        writer->since_checkpoint = 0;
+    }
+    record = &writer->buf[writer->len++];
+    record->sensor = sample->sensor;
+    record->delta_ms = (uint16_t)(sample->time_ms - writer->base_ms);
+    record->formaldehyde_raw = sample->formaldehyde_raw;
+    record->humidity_raw = sample->humidity_raw;
+    record->temperature_raw = sample->temperature_raw;
+    writer->since_checkpoint++;
+
+    /* one large write per batch */
+    if ((writer->len == writer->cap) || (sample->time_ms - writer->first_ms >= SFA30_LOG_FLUSH_MS))
+    {
+        return sfa30_log_writer_flush(writer);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief     write the batched records
+ * @param[in] *writer pointer to an sfa30 log writer structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 write failed
+ *            - 2 writer is NULL
+ *            - 3 writer is not opened
+ * @note      none
+ */
+uint8_t sfa30_log_writer_flush(sfa30_log_writer_t *writer)
+{
+    uint32_t len;
+
+    if (writer == NULL)
+    {
+        return 2;
+    }
+    if (writer->buf == NULL)
+    {
+        return 3;
+    }
+
+    /* the batch is dropped on failure so a full disk cannot grow it */
+    len = writer->len;
+    writer->len = 0;
+    if (len == 0)
+    {
+        return 0;
+    }
+    if (a_sfa30_log_write(writer->fd, writer->buf, len * sizeof(sfa30_log_record_t)) != 0)
+    {
+        writer->based = 0;
+
+        return 1;
+    }
+    writer->records += len;
+
+    return 0;
+}
+
+/**
+ * @brief     flush and close a log writer
+ * @param[in] *writer pointer to an sfa30 log writer structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 write failed
+ *            - 2 writer is NULL
+ * @note      none
+ */
+uint8_t sfa30_log_writer_close(sfa30_log_writer_t *writer)
+{
+    uint8_t res = 0;
+
+    if (writer == NULL)
+    {
+        return 2;
+    }
+
+    if (writer->buf != NULL)
+    {
+        res = sfa30_log_writer_flush(writer);
+        free(writer->buf);
+        (void)close(writer->fd);
+    }
+    memset(writer, 0, sizeof(sfa30_log_writer_t));
+    writer->fd = -1;
+
+    return res;
+}
+
+/**
+ * @brief     map a log for reading
+ * @param[in] *reader pointer to an sfa30 log reader structure
+ * @param[in] *path pointer to a file path
+ * @return    status code
+ *            - 0 success
+ *            - 1 open failed
+ *            - 2 reader or path is NULL
+ *            - 4 file is not a supported log
+ * @note      records appended after the open are not seen
+ */
+uint8_t sfa30_log_reader_open(sfa30_log_reader_t *reader, const char *path)
+{
+    int fd;
+    struct stat st;
+    void *map;
+
+    if ((reader == NULL) || (path == NULL))
+    {
+        return 2;
+    }
+
+    memset(reader, 0, sizeof(sfa30_log_reader_t));
+    fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return 1;
+    }
+    if (fstat(fd, &st) != 0)
+    {
+        (void)close(fd);
+
+        return 1;
+    }
+    if ((size_t)st.st_size < sizeof(sfa30_log_header_t))
+    {
+        (void)close(fd);
+
+        return 4;
+    }
+    map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    (void)close(fd);
+    if (map == MAP_FAILED)
+    {
+        return 1;
+    }
+    memcpy(&reader->header, map, sizeof(sfa30_log_header_t));
+    if (a_sfa30_log_check_header(&reader->header) != 0)
+    {
+        (void)munmap(map, (size_t)st.st_size);
+
+        return 4;
+    }
+    (void)madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+    reader->map = (const uint8_t *)map;
+    reader->size = (size_t)st.st_size;
+    reader->records = (const sfa30_log_record_t *)(reader->map + sizeof(sfa30_log_header_t));
+    reader->count = (reader->size - sizeof(sfa30_log_header_t)) / sizeof(sfa30_log_record_t);
+
+    return 0;
+}
+
+/**
+ * @brief     unmap a log
+ * @param[in] *reader pointer to an sfa30 log reader structure
+ * @return    status code
+ *            - 0 success
+ *            - 2 reader is NULL
+ * @note      none
+ */
+uint8_t sfa30_log_reader_close(sfa30_log_reader_t *reader)
+{
+    if (reader == NULL)
+    {
+        return 2;
+    }
+
+    if (reader->map != NULL)
+    {
+        (void)munmap((void *)reader->map, reader->size);
+    }
+    memset(reader, 0, sizeof(sfa30_log_reader_t));
+
+    return 0;
+}
+
+/**
+ * @brief      read the next sample
+ * @param[in]  *reader pointer to an sfa30 log reader structure
+ * @param[out] *sample pointer to a sample buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 end of the log
+ *             - 2 reader or sample is NULL
+ *             - 3 reader is not opened
+ * @note       checkpoints are consumed on the way
+ */
+uint8_t sfa30_log_reader_next(sfa30_log_reader_t *reader, sfa30_log_sample_t *sample)
+{
+    const sfa30_log_record_t *record;
+
+    if ((reader == NULL) || (sample == NULL))
+    {
+        return 2;
+    }
+    if (reader->map == NULL)
+    {
+        return 3;
+    }
+
+    while (reader->index < reader->count)
+    {
+        record = &reader->records[reader->index++];
+        if (record->sensor == SFA30_LOG_CHECKPOINT)
+        {
+            reader->base_ms = a_sfa30_log_checkpoint_ms(record);
+            reader->based = 1;
+        }
+        else if (reader->based != 0)
+        {
+            sample->time_ms = reader->base_ms + record->delta_ms;
+            sample->sensor = record->sensor;
+            sample->formaldehyde_raw = record->formaldehyde_raw;
+            sample->humidity_raw = record->humidity_raw;
+            sample->temperature_raw = record->temperature_raw;
+
+            return 0;
+        }
+        else
+        {
+            /* no time base yet, which only a damaged log has */
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * @brief     move to the checkpoint at or before a time
+ * @param[in] *reader pointer to an sfa30 log reader structure
+ * @param[in] time_ms time in ms since the epoch
+ * @return    status code
+ *            - 0 success
+ *            - 2 reader is NULL
+ *            - 3 reader is not opened
+ * @note      bisects the checkpoints, so it touches O(log n) pages
+ */
+uint8_t sfa30_log_reader_seek(sfa30_log_reader_t *reader, uint64_t time_ms)
+{
+    uint64_t lo = 0;
+    uint64_t hi;
+    uint64_t mid;
+    uint64_t i;
+    uint64_t span;
+
+    if (reader == NULL)
+    {
+        return 2;
+    }
+    if (reader->map == NULL)
+    {
+        return 3;
+    }
+
+    /* a checkpoint follows any record within the interval */
+    span = (uint64_t)reader->header.checkpoint_interval + 1;
+    hi = reader->count;
+    while (hi - lo > 2 * span)
+    {
+        mid = lo + (hi - lo) / 2;
+        i = mid;
+        while ((i < hi) && (reader->records[i].sensor != SFA30_LOG_CHECKPOINT))
+        {
+            i++;
+        }
+        if ((i < hi) && (a_sfa30_log_checkpoint_ms(&reader->records[i]) <= time_ms))
+        {
+            lo = i;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+
+    /* the last checkpoint not after the time in what is left */
+    reader->index = lo;
+    for (i = lo; i < hi; i++)
+    {
+        if ((reader->records[i].sensor == SFA30_LOG_CHECKPOINT) &&
+            (a_sfa30_log_checkpoint_ms(&reader->records[i]) <= time_ms))
+        {
+            reader->index = i;
+        }
+    }
+    reader->based = 0;
+
+    return 0;
+}
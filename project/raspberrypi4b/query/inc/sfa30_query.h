@@ -0,0 +1,227 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @file      sfa30_query.h
+ * @brief     sfa30 query server header file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2023-07-30
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2023/07/30  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#ifndef SFA30_QUERY_H
+#define SFA30_QUERY_H
+
+#include "driver_sfa30_history.h"
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup sfa30_query sfa30 query function
+ * @brief    sfa30 unix domain socket query server modules
+ * @{
+ */
+
+/**
+ * @brief sfa30 query protocol definition
+ * @note  a request starting with SFA30_QUERY_MAGIC is a binary request answered in
+ *        binary, any other request is a text line answered with one json line:
+ *        "latest <sensors>", "range <sensors> <span_ms> [<step_ms>]" or
+ *        "aggregate <sensors> <span_ms>", where sensors is "all", "3" or "3-7"
+ */
+#define SFA30_QUERY_MAGIC              0xA5                  /**< binary request and reply marker */
+#define SFA30_QUERY_MAX_CLIENTS        32                    /**< max connected clients */
+#define SFA30_QUERY_MAX_REPLY          (1024 * 1024)         /**< max reply bytes */
+#define SFA30_QUERY_LINE_SIZE          128                   /**< max text request bytes */
+#define SFA30_QUERY_REQUESTS_PER_POLL  16                    /**< max requests served per client per poll */
+
+/**
+ * @brief sfa30 query type enumeration definition
+ */
+typedef enum
+{
+    SFA30_QUERY_LATEST    = 0x01,        /**< latest sample of each sensor */
+    SFA30_QUERY_RANGE     = 0x02,        /**< samples of the last span_ms, averaged per step_ms */
+    SFA30_QUERY_AGGREGATE = 0x03,        /**< min, max and mean of the last span_ms */
+} sfa30_query_type_t;
+
+/**
+ * @brief sfa30 query status enumeration definition
+ */
+typedef enum
+{
+    SFA30_QUERY_STATUS_OK          = 0x00,        /**< success */
+    SFA30_QUERY_STATUS_BAD_REQUEST = 0x01,        /**< request is malformed */
+    SFA30_QUERY_STATUS_BAD_SENSOR  = 0x04,        /**< sensor range is invalid */
+    SFA30_QUERY_STATUS_TOO_LARGE   = 0x05,        /**< reply exceeds SFA30_QUERY_MAX_REPLY */
+} sfa30_query_status_t;
+
+/**
+ * @brief sfa30 query binary request structure definition
+ */
+typedef struct sfa30_query_request_s
+{
+    uint8_t magic;              /**< SFA30_QUERY_MAGIC */
+    uint8_t type;               /**< sfa30_query_type_t */
+    uint16_t first;             /**< first sensor */
+    uint16_t count;             /**< sensors, 0 means up to the last sensor */
+    uint16_t reserved;          /**< reserved, 0 */
+    uint32_t span_ms;           /**< window ending now, unused by latest */
+    uint32_t step_ms;           /**< range resolution, 0 returns every sample */
+} sfa30_query_request_t;
+
+/**
+ * @brief sfa30 query binary reply header structure definition
+ * @note  followed by length bytes holding count sensor blocks
+ */
+typedef struct sfa30_query_reply_s
+{
+    uint8_t magic;              /**< SFA30_QUERY_MAGIC */
+    uint8_t type;               /**< request type */
+    uint8_t status;             /**< sfa30_query_status_t */
+    uint8_t reserved;           /**< reserved, 0 */
+    uint16_t first;             /**< first sensor */
+    uint16_t count;             /**< sensor blocks */
+    uint32_t now_ms;            /**< server time of the reply */
+    uint32_t length;            /**< bytes after the header */
+} sfa30_query_reply_t;
+
+/**
+ * @brief sfa30 query binary sensor block structure definition
+ * @note  followed by samples sfa30_query_sample_t for latest and range,
+ *        or one sfa30_query_aggregate_t for aggregate
+ */
+typedef struct sfa30_query_block_s
+{
+    uint16_t sensor;            /**< sensor index */
+    uint16_t reserved;          /**< reserved, 0 */
+    uint32_t samples;           /**< samples that follow, or samples aggregated */
+} sfa30_query_block_t;
+
+/**
+ * @brief sfa30 query binary sample structure definition
+ */
+typedef struct sfa30_query_sample_s
+{
+    uint32_t timestamp_ms;      /**< sample or step begin timestamp */
+    int16_t formaldehyde_raw;   /**< formaldehyde raw, ppb * 5 */
+    int16_t humidity_raw;       /**< humidity raw, % * 100 */
+    int16_t temperature_raw;    /**< temperature raw, C * 200 */
+    uint16_t reserved;          /**< reserved, 0 */
+} sfa30_query_sample_t;
+
+/**
+ * @brief sfa30 query binary aggregate structure definition
+ * @note  index 0 is formaldehyde, 1 humidity and 2 temperature, all raw
+ */
+typedef struct sfa30_query_aggregate_s
+{
+    int16_t min[3];             /**< min raw values */
+    int16_t max[3];             /**< max raw values */
+    int16_t mean[3];            /**< mean raw values */
+    uint16_t reserved;          /**< reserved, 0 */
+} sfa30_query_aggregate_t;
+
+/**
+ * @brief sfa30 query client structure definition
+ */
+typedef struct sfa30_query_client_s
+{
+    int fd;                                     /**< socket, -1 when free */
+    uint32_t in_len;                            /**< buffered request bytes */
+    uint8_t in[SFA30_QUERY_LINE_SIZE];          /**< request buffer */
+    uint8_t *out;                               /**< reply buffer */
+    size_t out_len;                             /**< buffered reply bytes */
+    size_t out_sent;                            /**< reply bytes sent */
+    size_t out_cap;                             /**< reply buffer capacity */
+} sfa30_query_client_t;
+
+/**
+ * @brief sfa30 query server structure definition
+ */
+typedef struct sfa30_query_server_s
+{
+    int epoll_fd;                                                /**< server epoll, watch it from the main loop */
+    int listen_fd;                                               /**< listening socket */
+    sfa30_history_t *const *histories;                           /**< history of each sensor */
+    uint32_t sensor_count;                                       /**< sensors */
+    uint32_t queries;                                            /**< queries served */
+    sfa30_query_client_t clients[SFA30_QUERY_MAX_CLIENTS];       /**< clients */
+    char path[108];                                              /**< socket path */
+} sfa30_query_server_t;
+
+/**
+ * @brief     init the query server
+ * @param[in] *server pointer to an sfa30 query server structure
+ * @param[in] *path pointer to a socket path, an existing socket is replaced
+ * @param[in] *histories pointer to the history of each sensor
+ * @param[in] sensor_count sensors
+ * @return    status code
+ *            - 0 success
+ *            - 1 init failed
+ *            - 2 server, path or histories is NULL
+ *            - 4 path is too long
+ * @note      the histories must be written by the thread that polls the server
+ */
+uint8_t sfa30_query_server_init(sfa30_query_server_t *server, const char *path,
+                                sfa30_history_t *const *histories, uint32_t sensor_count);
+
+/**
+ * @brief     deinit the query server
+ * @param[in] *server pointer to an sfa30 query server structure
+ * @return    status code
+ *            - 0 success
+ *            - 2 server is NULL
+ * @note      the clients are disconnected and the socket path is removed
+ */
+uint8_t sfa30_query_server_deinit(sfa30_query_server_t *server);
+
+/**
+ * @brief     serve the ready clients
+ * @param[in] *server pointer to an sfa30 query server structure
+ * @param[in] now_ms current time of the history clock
+ * @return    status code
+ *            - 0 success
+ *            - 2 server is NULL
+ * @note      it never blocks, call it when server->epoll_fd is readable,
+ *            a client whose replies are not drained is not read until they are
+ */
+uint8_t sfa30_query_server_poll(sfa30_query_server_t *server, uint32_t now_ms);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,882 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @file      sfa30_query.c
+ * @brief     sfa30 query server source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2023-07-30
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2023/07/30  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#include "sfa30_query.h"
+#include <errno.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+/**
+ * @brief sfa30 query limits definition
+ */
+#define SFA30_QUERY_MAX_EVENTS        16             /**< max events handled per poll */
+#define SFA30_QUERY_KEEP_CAPACITY     65536          /**< reply buffer kept after a large reply */
+
+/**
+ * @brief     reserve reply bytes
+ * @param[in] *client pointer to a client structure
+ * @param[in] len bytes to append
+ * @return    pointer to the reserved bytes, NULL if the reply is too large
+ * @note      the pointer is valid until the next reserve
+ */
+static uint8_t *a_sfa30_query_reserve(sfa30_query_client_t *client, size_t len)
+{
+    size_t cap;
+    uint8_t *out;
+
+    if (client->out_len + len > SFA30_QUERY_MAX_REPLY)
+    {
+        return NULL;
+    }
+    if (client->out_len + len > client->out_cap)
+    {
+        cap = (client->out_cap != 0) ? client->out_cap : 4096;
+        while (cap < client->out_len + len)
+        {
+            cap *= 2;
+        }
+        out = (uint8_t *)realloc(client->out, cap);
+        if (out == NULL)
+        {
+            return NULL;
+        }
+        client->out = out;
+        client->out_cap = cap;
+    }
+    out = client->out + client->out_len;
+    client->out_len += len;
+
+    return out;
+}
+
+/**
+ * @brief     append formatted text to the reply
+ * @param[in] *client pointer to a client structure
+ * @param[in] *fmt pointer to a format string
+ * @return    status code
+ *            - 0 success
+ *            - 1 reply is too large
+ * @note      none
+ */
+static uint8_t a_sfa30_query_printf(sfa30_query_client_t *client, const char *fmt, ...)
+{
+    char str[128];
+    int len;
+    uint8_t *out;
+    va_list args;
+
+    va_start(args, fmt);
+    len = vsnprintf(str, sizeof(str), fmt, args);
+    va_end(args);
+    if ((len < 0) || ((size_t)len >= sizeof(str)))
+    {
+        return 1;
+    }
+    out = a_sfa30_query_reserve(client, (size_t)len);
+    if (out == NULL)
+    {
+        return 1;
+    }
+    memcpy(out, str, (size_t)len);
+
+    return 0;
+}
+
+/**
+ * @brief      find the samples of a window ending now
+ * @param[in]  *history pointer to an sfa30 history structure
+ * @param[in]  now_ms current time
+ * @param[in]  span_ms window length
+ * @param[out] *begin pointer to the first sample index buffer
+ * @return     samples in the window
+ * @note       the history is written by the polling thread, so every slot is readable
+ */
+static uint32_t a_sfa30_query_window(const sfa30_history_t *history, uint32_t now_ms, uint32_t span_ms, uint32_t *begin)
+{
+    uint32_t n = 0;
+    uint32_t avail;
+
+    avail = (history->head <= history->mask) ? history->head : (history->mask + 1);
+    while ((n < avail) &&
+           ((uint32_t)(now_ms - history->buf[(history->head - 1 - n) & history->mask].timestamp_ms) <= span_ms))
+    {
+        n++;
+    }
+    *begin = history->head - n;
+
+    return n;
+}
+
+/**
+ * @brief     append one sample to the reply
+ * @param[in] *client pointer to a client structure
+ * @param[in] json json reply flag
+ * @param[in] comma json separator flag
+ * @param[in] timestamp_ms sample timestamp
+ * @param[in] *raw pointer to the formaldehyde, humidity and temperature raw values
+ * @return    status code
+ *            - 0 success
+ *            - 1 reply is too large
+ * @note      none
+ */
+static uint8_t a_sfa30_query_sample(sfa30_query_client_t *client, uint8_t json, uint8_t comma,
+                                    uint32_t timestamp_ms, const int16_t raw[3])
+{
+    sfa30_query_sample_t sample;
+    uint8_t *out;
+
+    if (json != 0)
+    {
+        return a_sfa30_query_printf(client, "%s[%u,%0.1f,%0.2f,%0.3f]", (comma != 0) ? "," : "", timestamp_ms,
+                                    (double)raw[0] / 5.0, (double)raw[1] / 100.0, (double)raw[2] / 200.0);
+    }
+    out = a_sfa30_query_reserve(client, sizeof(sfa30_query_sample_t));
+    if (out == NULL)
+    {
+        return 1;
+    }
+    sample.timestamp_ms = timestamp_ms;
+    sample.formaldehyde_raw = raw[0];
+    sample.humidity_raw = raw[1];
+    sample.temperature_raw = raw[2];
+    sample.reserved = 0;
+    memcpy(out, &sample, sizeof(sfa30_query_sample_t));
+
+    return 0;
+}
+
+/**
+ * @brief     append the answer for one sensor to the reply
+ * @param[in] *client pointer to a client structure
+ * @param[in] *history pointer to the sensor history
+ * @param[in] sensor sensor index
+ * @param[in] *request pointer to a request
+ * @param[in] json json reply flag
+ * @param[in] now_ms current time
+ * @return    status code
+ *            - 0 success
+ *            - 1 reply is too large
+ * @note      range steps are aligned to multiples of step_ms, averaged with 64 bit integer
+ *            means and stamped with the step begin
+ */
+static uint8_t a_sfa30_query_sensor(sfa30_query_client_t *client, const sfa30_history_t *history, uint32_t sensor,
+                                    const sfa30_query_request_t *request, uint8_t json, uint32_t now_ms)
+{
+    uint32_t i;
+    uint32_t j;
+    uint32_t n;
+    uint32_t begin;
+    uint32_t points = 0;
+    uint32_t step;
+    uint32_t bucket = 0;
+    uint32_t bucket_count = 0;
+    int64_t sum[3] = {0, 0, 0};
+    int16_t raw[3];
+    int16_t min[3] = {0, 0, 0};
+    int16_t max[3] = {0, 0, 0};
+    size_t block_offset;
+    sfa30_query_block_t block;
+    sfa30_query_aggregate_t aggregate;
+    const sfa30_history_sample_t *sample;
+    uint8_t *out;
+
+    if (request->type == SFA30_QUERY_LATEST)
+    {
+        n = (history->head != 0) ? 1 : 0;
+        begin = history->head - n;
+    }
+    else
+    {
+        n = a_sfa30_query_window(history, now_ms, request->span_ms, &begin);
+    }
+
+    /* block header, the sample count is patched at the end */
+    block_offset = client->out_len;
+    if (json != 0)
+    {
+        if (a_sfa30_query_printf(client, "%s{\"sensor\":%u", (sensor != request->first) ? "," : "", sensor) != 0)
+        {
+            return 1;
+        }
+    }
+    else if (a_sfa30_query_reserve(client, sizeof(sfa30_query_block_t)) == NULL)
+    {
+        return 1;
+    }
+
+    if (request->type == SFA30_QUERY_AGGREGATE)
+    {
+        for (i = 0; i < n; i++)
+        {
+            sample = &history->buf[(begin + i) & history->mask];
+            raw[0] = sample->formaldehyde_raw;
+            raw[1] = sample->humidity_raw;
+            raw[2] = sample->temperature_raw;
+            for (j = 0; j < 3; j++)
+            {
+                min[j] = ((i == 0) || (raw[j] < min[j])) ? raw[j] : min[j];
+                max[j] = ((i == 0) || (raw[j] > max[j])) ? raw[j] : max[j];
+                sum[j] += raw[j];
+            }
+        }
+        points = n;
+        memset(&aggregate, 0, sizeof(sfa30_query_aggregate_t));
+        for (j = 0; (j < 3) && (n != 0); j++)
+        {
+            aggregate.min[j] = min[j];
+            aggregate.max[j] = max[j];
+            aggregate.mean[j] = (int16_t)(sum[j] / (int64_t)n);
+        }
+        if (json != 0)
+        {
+            if ((a_sfa30_query_printf(client, ",\"samples\":%u", n) != 0) ||
+                ((n != 0) &&
+                 ((a_sfa30_query_printf(client, ",\"min\":[%0.1f,%0.2f,%0.3f]", (double)min[0] / 5.0,
+                                        (double)min[1] / 100.0, (double)min[2] / 200.0) != 0) ||
+                  (a_sfa30_query_printf(client, ",\"max\":[%0.1f,%0.2f,%0.3f]", (double)max[0] / 5.0,
+                                        (double)max[1] / 100.0, (double)max[2] / 200.0) != 0) ||
+                  (a_sfa30_query_printf(client, ",\"mean\":[%0.1f,%0.2f,%0.3f]", (double)aggregate.mean[0] / 5.0,
+                                        (double)aggregate.mean[1] / 100.0, (double)aggregate.mean[2] / 200.0) != 0))) ||
+                (a_sfa30_query_printf(client, "}") != 0))
+            {
+                return 1;
+            }
+
+            return 0;
+        }
+        out = a_sfa30_query_reserve(client, sizeof(sfa30_query_aggregate_t));
+        if (out == NULL)
+        {
+            return 1;
+        }
+        memcpy(out, &aggregate, sizeof(sfa30_query_aggregate_t));
+    }
+    else
+    {
+        if ((json != 0) && (a_sfa30_query_printf(client, ",\"samples\":[") != 0))
+        {
+            return 1;
+        }
+        step = (request->type == SFA30_QUERY_RANGE) ? request->step_ms : 0;
+        for (i = 0; i < n; i++)
+        {
+            sample = &history->buf[(begin + i) & history->mask];
+            raw[0] = sample->formaldehyde_raw;
+            raw[1] = sample->humidity_raw;
+            raw[2] = sample->temperature_raw;
+            if (step == 0)
+            {
+                if (a_sfa30_query_sample(client, json, (points != 0) ? 1 : 0, sample->timestamp_ms, raw) != 0)
+                {
+                    return 1;
+                }
+                points++;
+
+                continue;
+            }
+
+            /* close the bucket before a sample of a later step */
+            if ((bucket_count != 0) && (sample->timestamp_ms / step != bucket))
+            {
+                for (j = 0; j < 3; j++)
+                {
+                    raw[j] = (int16_t)(sum[j] / (int64_t)bucket_count);
+                    sum[j] = 0;
+                }
+                if (a_sfa30_query_sample(client, json, (points != 0) ? 1 : 0, bucket * step, raw) != 0)
+                {
+                    return 1;
+                }
+                points++;
+                bucket_count = 0;
+                raw[0] = sample->formaldehyde_raw;
+                raw[1] = sample->humidity_raw;
+                raw[2] = sample->temperature_raw;
+            }
+            bucket = sample->timestamp_ms / step;
+            for (j = 0; j < 3; j++)
+            {
+                sum[j] += raw[j];
+            }
+            bucket_count++;
+        }
+        if (bucket_count != 0)
+        {
+            for (j = 0; j < 3; j++)
+            {
+                raw[j] = (int16_t)(sum[j] / (int64_t)bucket_count);
+            }
+            if (a_sfa30_query_sample(client, json, (points != 0) ? 1 : 0, bucket * step, raw) != 0)
+            {
+                return 1;
+            }
+            points++;
+        }
+        if ((json != 0) && (a_sfa30_query_printf(client, "]}") != 0))
+        {
+            return 1;
+        }
+    }
+
+    /* patch the block header */
+    if (json == 0)
+    {
+        block.sensor = (uint16_t)sensor;
+        block.reserved = 0;
+        block.samples = points;
+        memcpy(client->out + block_offset, &block, sizeof(sfa30_query_block_t));
+    }
+
+    return 0;
+}
+
+/**
+ * @brief     append a reply to a request
+ * @param[in] *server pointer to an sfa30 query server structure
+ * @param[in] *client pointer to a client structure
+ * @param[in] *request pointer to a request, NULL for a malformed one
+ * @param[in] json json reply flag
+ * @param[in] now_ms current time
+ * @note      a reply that grows too large is replaced by an error reply
+ */
+static void a_sfa30_query_answer(sfa30_query_server_t *server, sfa30_query_client_t *client,
+                                 const sfa30_query_request_t *request, uint8_t json, uint32_t now_ms)
+{
+    static const char *const type_names[] = {"", "latest", "range", "aggregate"};
+    static const char *const status_names[] = {"ok", "bad request", "", "", "bad sensor", "too large"};
+    uint32_t i;
+    uint32_t count = 0;
+    uint8_t status = SFA30_QUERY_STATUS_OK;
+    size_t start;
+    sfa30_query_request_t req;
+    sfa30_query_reply_t reply;
+    uint8_t *out;
+
+    /* check the request */
+    memset(&req, 0, sizeof(sfa30_query_request_t));
+    if (request == NULL)
+    {
+        status = SFA30_QUERY_STATUS_BAD_REQUEST;
+    }
+    else
+    {
+        req = *request;
+        count = (req.count != 0) ? req.count : ((req.first < server->sensor_count) ? (server->sensor_count - req.first) : 0);
+        if ((req.type < SFA30_QUERY_LATEST) || (req.type > SFA30_QUERY_AGGREGATE) ||
+            ((req.type == SFA30_QUERY_RANGE) && (req.step_ms != 0) && (req.step_ms > req.span_ms)))
+        {
+            status = SFA30_QUERY_STATUS_BAD_REQUEST;
+        }
+        else if ((count == 0) || ((uint32_t)req.first + count > server->sensor_count))
+        {
+            status = SFA30_QUERY_STATUS_BAD_SENSOR;
+        }
+    }
+    server->queries++;
+
+    /* answer */
+    start = client->out_len;
+    if (status == SFA30_QUERY_STATUS_OK)
+    {
+        if (json != 0)
+        {
+            if (a_sfa30_query_printf(client, "{\"type\":\"%s\",\"now_ms\":%u,\"sensors\":[", type_names[req.type], now_ms) != 0)
+            {
+                status = SFA30_QUERY_STATUS_TOO_LARGE;
+            }
+        }
+        else if (a_sfa30_query_reserve(client, sizeof(sfa30_query_reply_t)) == NULL)
+        {
+            status = SFA30_QUERY_STATUS_TOO_LARGE;
+        }
+        for (i = req.first; (i < (uint32_t)req.first + count) && (status == SFA30_QUERY_STATUS_OK); i++)
+        {
+            if (a_sfa30_query_sensor(client, server->histories[i], i, &req, json, now_ms) != 0)
+            {
+                status = SFA30_QUERY_STATUS_TOO_LARGE;
+            }
+        }
+        if ((status == SFA30_QUERY_STATUS_OK) && (json != 0) && (a_sfa30_query_printf(client, "]}\n") != 0))
+        {
+            status = SFA30_QUERY_STATUS_TOO_LARGE;
+        }
+    }
+    if (status != SFA30_QUERY_STATUS_OK)
+    {
+        client->out_len = start;
+        count = 0;
+        if (json != 0)
+        {
+            (void)a_sfa30_query_printf(client, "{\"error\":\"%s\"}\n", status_names[status]);
+
+            return;
+        }
+        if (a_sfa30_query_reserve(client, sizeof(sfa30_query_reply_t)) == NULL)
+        {
+            return;
+        }
+    }
+    if (json == 0)
+    {
+        reply.magic = SFA30_QUERY_MAGIC;
+        reply.type = req.type;
+        reply.status = status;
+        reply.reserved = 0;
+        reply.first = req.first;
+        reply.count = (uint16_t)count;
+        reply.now_ms = now_ms;
+        reply.length = (uint32_t)(client->out_len - start - sizeof(sfa30_query_reply_t));
+        out = client->out + start;
+        memcpy(out, &reply, sizeof(sfa30_query_reply_t));
+    }
+}
+
+/**
+ * @brief     parse a text request
+ * @param[in] *line pointer to a nul terminated line
+ * @param[out] *request pointer to a request buffer
+ * @return    status code
+ *            - 0 success
+ *            - 1 line is malformed
+ * @note      none
+ */
+static uint8_t a_sfa30_query_parse(const char *line, sfa30_query_request_t *request)
+{
+    int n;
+    unsigned int first;
+    unsigned int last;
+    unsigned int span = 0;
+    unsigned int step = 0;
+    char cmd[16];
+    char sensors[16];
+
+    memset(request, 0, sizeof(sfa30_query_request_t));
+    n = sscanf(line, "%15s %15s %u %u", cmd, sensors, &span, &step);
+    if (n < 2)
+    {
+        return 1;
+    }
+    if ((strcmp(cmd, "latest") == 0) && (n == 2))
+    {
+        request->type = SFA30_QUERY_LATEST;
+    }
+    else if ((strcmp(cmd, "range") == 0) && (n >= 3))
+    {
+        request->type = SFA30_QUERY_RANGE;
+    }
+    else if ((strcmp(cmd, "aggregate") == 0) && (n == 3))
+    {
+        request->type = SFA30_QUERY_AGGREGATE;
+    }
+    else
+    {
+        return 1;
+    }
+    request->span_ms = span;
+    request->step_ms = step;
+    if (strcmp(sensors, "all") == 0)
+    {
+        return 0;
+    }
+    n = sscanf(sensors, "%u-%u", &first, &last);
+    if (n == 1)
+    {
+        last = first;
+    }
+    if ((n < 1) || (last < first) || (last > 0xFFFE))
+    {
+        return 1;
+    }
+    request->first = (uint16_t)first;
+    request->count = (uint16_t)(last - first + 1);
+
+    return 0;
+}
+
+/**
+ * @brief     answer the buffered requests of a client
+ * @param[in] *server pointer to an sfa30 query server structure
+ * @param[in] *client pointer to a client structure
+ * @param[in] now_ms current time
+ * @return    1 if a complete request is still buffered, else 0
+ * @note      at most SFA30_QUERY_REQUESTS_PER_POLL requests are answered per call
+ */
+static uint8_t a_sfa30_query_process(sfa30_query_server_t *server, sfa30_query_client_t *client, uint32_t now_ms)
+{
+    uint32_t i;
+    uint32_t used;
+    uint8_t *end;
+    sfa30_query_request_t request;
+
+    for (i = 0; i <= SFA30_QUERY_REQUESTS_PER_POLL; i++)
+    {
+        used = 0;
+        if ((client->in_len >= 1) && (client->in[0] == SFA30_QUERY_MAGIC))
+        {
+            if (client->in_len >= sizeof(sfa30_query_request_t))
+            {
+                used = sizeof(sfa30_query_request_t);
+            }
+        }
+        else
+        {
+            end = (uint8_t *)memchr(client->in, '\n', client->in_len);
+            if (end != NULL)
+            {
+                used = (uint32_t)(end - client->in) + 1;
+            }
+            else if (client->in_len == SFA30_QUERY_LINE_SIZE)
+            {
+                /* an overlong line can never complete, reject and drop it */
+                used = SFA30_QUERY_LINE_SIZE;
+                a_sfa30_query_answer(server, client, NULL, 1, now_ms);
+                client->in_len = 0;
+
+                continue;
+            }
+        }
+        if (used == 0)
+        {
+            return 0;
+        }
+        if (i == SFA30_QUERY_REQUESTS_PER_POLL)
+        {
+            return 1;
+        }
+        if (client->in[0] == SFA30_QUERY_MAGIC)
+        {
+            memcpy(&request, client->in, sizeof(sfa30_query_request_t));
+            a_sfa30_query_answer(server, client, &request, 0, now_ms);
+        }
+        else
+        {
+            client->in[used - 1] = '\0';
+            if (a_sfa30_query_parse((const char *)client->in, &request) != 0)
+            {
+                a_sfa30_query_answer(server, client, NULL, 1, now_ms);
+            }
+            else
+            {
+                a_sfa30_query_answer(server, client, &request, 1, now_ms);
+            }
+        }
+        client->in_len -= used;
+        memmove(client->in, client->in + used, client->in_len);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief     send the buffered reply
+ * @param[in] *client pointer to a client structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 client is gone
+ * @note      a full socket leaves the rest buffered
+ */
+static uint8_t a_sfa30_query_flush(sfa30_query_client_t *client)
+{
+    ssize_t l;
+
+    while (client->out_sent < client->out_len)
+    {
+        l = send(client->fd, client->out + client->out_sent, client->out_len - client->out_sent, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (l < 0)
+        {
+            if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
+            {
+                return 0;
+            }
+            else if (errno == EINTR)
+            {
+                continue;
+            }
+
+            return 1;
+        }
+        client->out_sent += (size_t)l;
+    }
+    client->out_len = 0;
+    client->out_sent = 0;
+    if (client->out_cap > SFA30_QUERY_KEEP_CAPACITY)
+    {
+        free(client->out);
+        client->out = NULL;
+        client->out_cap = 0;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief     disconnect a client
+ * @param[in] *client pointer to a client structure
+ * @note      none
+ */
+static void a_sfa30_query_close(sfa30_query_client_t *client)
+{
+    if (client->fd >= 0)
+    {
+        (void)close(client->fd);
+    }
+    free(client->out);
+    memset(client, 0, sizeof(sfa30_query_client_t));
+    client->fd = -1;
+}
+
+/**
+ * @brief     serve one client
+ * @param[in] *server pointer to an sfa30 query server structure
+ * @param[in] index client index
+ * @param[in] now_ms current time
+ * @note      the client is read only once its replies are drained
+ */
+static void a_sfa30_query_service(sfa30_query_server_t *server, uint32_t index, uint32_t now_ms)
+{
+    ssize_t l;
+    uint8_t more = 0;
+    struct epoll_event ev;
+    sfa30_query_client_t *client = &server->clients[index];
+
+    if (a_sfa30_query_flush(client) != 0)
+    {
+        a_sfa30_query_close(client);
+
+        return;
+    }
+    if (client->out_len == 0)
+    {
+        more = a_sfa30_query_process(server, client, now_ms);
+        if ((more == 0) && (client->out_len == 0))
+        {
+            l = recv(client->fd, client->in + client->in_len, SFA30_QUERY_LINE_SIZE - client->in_len, MSG_DONTWAIT);
+            if ((l == 0) || ((l < 0) && (errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR)))
+            {
+                a_sfa30_query_close(client);
+
+                return;
+            }
+            if (l > 0)
+            {
+                client->in_len += (uint32_t)l;
+                more = a_sfa30_query_process(server, client, now_ms);
+            }
+        }
+        if (a_sfa30_query_flush(client) != 0)
+        {
+            a_sfa30_query_close(client);
+
+            return;
+        }
+    }
+
+    /* wait for room to send, or come back at once for the requests left over */
+    ev.events = ((client->out_len != 0) || (more != 0)) ? EPOLLOUT : EPOLLIN;
+    ev.data.u32 = index;
+    (void)epoll_ctl(server->epoll_fd, EPOLL_CTL_MOD, client->fd, &ev);
+}
+
+/**
+ * @brief     init the query server
+ * @param[in] *server pointer to an sfa30 query server structure
+ * @param[in] *path pointer to a socket path, an existing socket is replaced
+ * @param[in] *histories pointer to the history of each sensor
+ * @param[in] sensor_count sensors
+ * @return    status code
+ *            - 0 success
+ *            - 1 init failed
+ *            - 2 server, path or histories is NULL
+ *            - 4 path is too long
+ * @note      the histories must be written by the thread that polls the server
+ */
+uint8_t sfa30_query_server_init(sfa30_query_server_t *server, const char *path,
+                                sfa30_history_t *const *histories, uint32_t sensor_count)
+{
+    uint32_t i;
+    struct sockaddr_un addr;
+    struct epoll_event ev;
+
+    if ((server == NULL) || (path == NULL) || (histories == NULL))
+    {
+        return 2;
+    }
+    if (strlen(path) >= sizeof(addr.sun_path))
+    {
+        return 4;
+    }
+
+    memset(server, 0, sizeof(sfa30_query_server_t));
+    for (i = 0; i < SFA30_QUERY_MAX_CLIENTS; i++)
+    {
+        server->clients[i].fd = -1;
+    }
+    server->histories = histories;
+    server->sensor_count = sensor_count;
+    (void)strcpy(server->path, path);
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    (void)strcpy(addr.sun_path, path);
+    (void)unlink(path);
+    server->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    server->listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    ev.events = EPOLLIN;
+    ev.data.u32 = SFA30_QUERY_MAX_CLIENTS;
+    if ((server->epoll_fd < 0) || (server->listen_fd < 0) ||
+        (bind(server->listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) ||
+        (listen(server->listen_fd, SFA30_QUERY_MAX_CLIENTS) != 0) ||
+        (epoll_ctl(server->epoll_fd, EPOLL_CTL_ADD, server->listen_fd, &ev) != 0))
+    {
+        if (server->listen_fd >= 0)
+        {
+            (void)close(server->listen_fd);
+        }
+        if (server->epoll_fd >= 0)
+        {
+            (void)close(server->epoll_fd);
+        }
+        (void)unlink(path);
+        server->listen_fd = -1;
+        server->epoll_fd = -1;
+
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief     deinit the query server
+ * @param[in] *server pointer to an sfa30 query server structure
+ * @return    status code
+ *            - 0 success
+ *            - 2 server is NULL
+ * @note      the clients are disconnected and the socket path is removed
+ */
+uint8_t sfa30_query_server_deinit(sfa30_query_server_t *server)
+{
+    uint32_t i;
+
+    if (server == NULL)
+    {
+        return 2;
+    }
+
+    for (i = 0; i < SFA30_QUERY_MAX_CLIENTS; i++)
+    {
+        a_sfa30_query_close(&server->clients[i]);
+    }
+    if (server->listen_fd >= 0)
+    {
+        (void)close(server->listen_fd);
+        (void)unlink(server->path);
+        server->listen_fd = -1;
+    }
+    if (server->epoll_fd >= 0)
+    {
+        (void)close(server->epoll_fd);
+        server->epoll_fd = -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief     serve the ready clients
+ * @param[in] *server pointer to an sfa30 query server structure
+ * @param[in] now_ms current time of the history clock
+ * @return    status code
+ *            - 0 success
+ *            - 2 server is NULL
+ * @note      it never blocks, call it when server->epoll_fd is readable,
+ *            a client whose replies are not drained is not read until they are
+ */
+uint8_t sfa30_query_server_poll(sfa30_query_server_t *server, uint32_t now_ms)
+{
+    int i;
+    int n;
+    int fd;
+    uint32_t j;
+    struct epoll_event ev;
+    struct epoll_event events[SFA30_QUERY_MAX_EVENTS];
+
+    if (server == NULL)
+    {
+        return 2;
+    }
+
+    n = epoll_wait(server->epoll_fd, events, SFA30_QUERY_MAX_EVENTS, 0);
+    for (i = 0; i < n; i++)
+    {
+        if (events[i].data.u32 < SFA30_QUERY_MAX_CLIENTS)
+        {
+            if (server->clients[events[i].data.u32].fd >= 0)
+            {
+                a_sfa30_query_service(server, events[i].data.u32, now_ms);
+            }
+
+            continue;
+        }
+
+        /* accept every pending connection */
+        while ((fd = accept(server->listen_fd, NULL, NULL)) >= 0)
+        {
+            /* every send and recv passes MSG_DONTWAIT, so the socket may stay blocking */
+            j = 0;
+            while ((j < SFA30_QUERY_MAX_CLIENTS) && (server->clients[j].fd >= 0))
+            {
+                j++;
+            }
+            ev.events = EPOLLIN;
+            ev.data.u32 = j;
+            if ((j == SFA30_QUERY_MAX_CLIENTS) || (epoll_ctl(server->epoll_fd, EPOLL_CTL_ADD, fd, &ev) != 0))
+            {
+                (void)close(fd);
+
+                continue;
+            }
+            server->clients[j].fd = fd;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,196 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @file      sfa30_ring.h
+ * @brief     sfa30 shared memory ring header file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2023-07-30
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2023/07/30  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#ifndef SFA30_RING_H
+#define SFA30_RING_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup sfa30_ring sfa30 ring function
+ * @brief    sfa30 shared memory ring modules
+ * @{
+ */
+
+/**
+ * @brief sfa30 ring layout definition
+ */
+#define SFA30_RING_MAGIC                0x52414653U        /**< "SFAR" */
+#define SFA30_RING_VERSION              1                  /**< layout version */
+#define SFA30_RING_DEFAULT_CAPACITY     1024               /**< default records, a power of two */
+#define SFA30_RING_RECORD_WORDS         4                  /**< sfa30_ring_record_t in 32 bit words */
+
+/**
+ * @brief sfa30 ring record structure definition
+ * @note  raw values keep the layout independent of the driver float option
+ */
+typedef struct sfa30_ring_record_s
+{
+    uint32_t sensor;                  /**< sensor index in the producer */
+    uint32_t timestamp_ms;            /**< producer monotonic timestamp */
+    int16_t formaldehyde_raw;         /**< formaldehyde raw, ppb * 5 */
+    int16_t humidity_raw;             /**< humidity raw, % * 100 */
+    int16_t temperature_raw;          /**< temperature raw, C * 200 */
+    uint16_t reserved;                /**< reserved, written as 0 */
+} sfa30_ring_record_t;
+
+/**
+ * @brief sfa30 ring slot structure definition
+ */
+typedef struct sfa30_ring_slot_s
+{
+    uint64_t sequence;                                /**< 2 * index + 1 while written, 2 * index + 2 once stable */
+    uint32_t words[SFA30_RING_RECORD_WORDS];          /**< sfa30_ring_record_t */
+    uint64_t reserved;                                /**< pads the slot to 32 bytes */
+} sfa30_ring_slot_t;
+
+/**
+ * @brief sfa30 ring shared header structure definition
+ */
+typedef struct sfa30_ring_header_s
+{
+    uint32_t magic;                   /**< SFA30_RING_MAGIC, stored last by the producer */
+    uint16_t version;                 /**< SFA30_RING_VERSION */
+    uint16_t slot_size;               /**< sizeof(sfa30_ring_slot_t) */
+    uint32_t capacity;                /**< slots, a power of two */
+    uint32_t reserved[13];            /**< keeps head on its own cache line */
+    uint64_t head;                    /**< records ever published */
+    uint64_t padding[7];              /**< pads the header to 128 bytes */
+} sfa30_ring_header_t;
+
+/**
+ * @brief sfa30 ring structure definition
+ * @note  one per process, the mapping is shared and the cursor is private
+ */
+typedef struct sfa30_ring_s
+{
+    sfa30_ring_header_t *header;      /**< mapped header */
+    sfa30_ring_slot_t *slots;         /**< mapped slots */
+    size_t size;                      /**< mapped bytes */
+    uint64_t cursor;                  /**< next record to read */
+    uint64_t lost;                    /**< records overwritten before this reader got them */
+    uint8_t producer;                 /**< producer flag */
+    char name[64];                    /**< shared memory name */
+} sfa30_ring_t;
+
+/**
+ * @brief     create a ring as its producer
+ * @param[in] *ring pointer to an sfa30 ring structure
+ * @param[in] *name pointer to a shared memory name such as "/sfa30", it lives in /dev/shm
+ * @param[in] capacity records, a power of two, 0 means the default capacity
+ * @return    status code
+ *            - 0 success
+ *            - 1 create failed
+ *            - 2 ring or name is NULL
+ *            - 4 capacity or name is invalid
+ * @note      an existing ring of the same name is replaced
+ */
+uint8_t sfa30_ring_create(sfa30_ring_t *ring, const char *name, uint32_t capacity);
+
+/**
+ * @brief     open a ring as a consumer
+ * @param[in] *ring pointer to an sfa30 ring structure
+ * @param[in] *name pointer to a shared memory name
+ * @return    status code
+ *            - 0 success
+ *            - 1 open failed
+ *            - 2 ring or name is NULL
+ *            - 4 ring layout is not supported
+ * @note      the cursor starts at the next record published
+ */
+uint8_t sfa30_ring_open(sfa30_ring_t *ring, const char *name);
+
+/**
+ * @brief     close a ring
+ * @param[in] *ring pointer to an sfa30 ring structure
+ * @return    status code
+ *            - 0 success
+ *            - 2 ring is NULL
+ * @note      the producer also removes the name, mapped consumers keep reading the old ring
+ */
+uint8_t sfa30_ring_close(sfa30_ring_t *ring);
+
+/**
+ * @brief     publish a record
+ * @param[in] *ring pointer to an sfa30 ring structure
+ * @param[in] *record pointer to a record
+ * @return    status code
+ *            - 0 success
+ *            - 2 ring or record is NULL
+ *            - 3 ring is not opened as the producer
+ * @note      only one producer may publish, it never waits for the consumers
+ */
+uint8_t sfa30_ring_publish(sfa30_ring_t *ring, const sfa30_ring_record_t *record);
+
+/**
+ * @brief      read the next record
+ * @param[in]  *ring pointer to an sfa30 ring structure
+ * @param[out] *record pointer to a record buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 no new record
+ *             - 2 ring or record is NULL
+ *             - 3 ring is not opened
+ * @note       no system call, a reader that falls a whole ring behind skips to
+ *             the oldest record still present and adds the gap to ring->lost
+ */
+uint8_t sfa30_ring_read(sfa30_ring_t *ring, sfa30_ring_record_t *record);
+
+/**
+ * @brief     move the cursor to the oldest record still present
+ * @param[in] *ring pointer to an sfa30 ring structure
+ * @return    status code
+ *            - 0 success
+ *            - 2 ring is NULL
+ *            - 3 ring is not opened
+ * @note      none
+ */
+uint8_t sfa30_ring_rewind(sfa30_ring_t *ring);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,383 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @file      sfa30_ring.c
+ * @brief     sfa30 shared memory ring source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2023-07-30
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2023/07/30  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#include "sfa30_ring.h"
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/**
+ * @brief     check a ring name
+ * @param[in] *name pointer to a shared memory name
+ * @return    status code
+ *            - 0 success
+ *            - 1 name is invalid
+ * @note      none
+ */
+static uint8_t a_sfa30_ring_check_name(const char *name)
+{
+    size_t len;
+
+    len = strlen(name);
+    if ((len < 2) || (len >= sizeof(((sfa30_ring_t *)0)->name)) || (name[0] != '/') ||
+        (strchr(name + 1, '/') != NULL))
+    {
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief     create a ring as its producer
+ * @param[in] *ring pointer to an sfa30 ring structure
+ * @param[in] *name pointer to a shared memory name such as "/sfa30", it lives in /dev/shm
+ * @param[in] capacity records, a power of two, 0 means the default capacity
+ * @return    status code
+ *            - 0 success
+ *            - 1 create failed
+ *            - 2 ring or name is NULL
+ *            - 4 capacity or name is invalid
+ * @note      an existing ring of the same name is replaced
+ */
+uint8_t sfa30_ring_create(sfa30_ring_t *ring, const char *name, uint32_t capacity)
+{
+    int fd;
+    size_t size;
+    void *map;
+
+    if ((ring == NULL) || (name == NULL))
+    {
+        return 2;
+    }
+    if (capacity == 0)
+    {
+        capacity = SFA30_RING_DEFAULT_CAPACITY;
+    }
+    if (((capacity & (capacity - 1)) != 0) || (a_sfa30_ring_check_name(name) != 0))
+    {
+        return 4;
+    }
+
+    /* replace the old ring, its consumers keep their own mapping */
+    memset(ring, 0, sizeof(sfa30_ring_t));
+    (void)shm_unlink(name);
+    fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd < 0)
+    {
+        return 1;
+    }
+    size = sizeof(sfa30_ring_header_t) + (size_t)capacity * sizeof(sfa30_ring_slot_t);
+    if (ftruncate(fd, (off_t)size) != 0)
+    {
+        (void)close(fd);
+        (void)shm_unlink(name);
+
+        return 1;
+    }
+    map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    (void)close(fd);
+    if (map == MAP_FAILED)
+    {
+        (void)shm_unlink(name);
+
+        return 1;
+    }
+
+    /* the pages are zero, so every slot sequence is older than any record */
+    ring->header = (sfa30_ring_header_t *)map;
+    ring->slots = (sfa30_ring_slot_t *)((uint8_t *)map + sizeof(sfa30_ring_header_t));
+    ring->size = size;
+    ring->producer = 1;
+    (void)strcpy(ring->name, name);
+    ring->header->version = SFA30_RING_VERSION;
+    ring->header->slot_size = (uint16_t)sizeof(sfa30_ring_slot_t);
+    ring->header->capacity = capacity;
+    __atomic_store_n(&ring->header->magic, SFA30_RING_MAGIC, __ATOMIC_RELEASE);
+
+    return 0;
+}
+
+/**
+ * @brief     open a ring as a consumer
+ * @param[in] *ring pointer to an sfa30 ring structure
+ * @param[in] *name pointer to a shared memory name
+ * @return    status code
+ *            - 0 success
+ *            - 1 open failed
+ *            - 2 ring or name is NULL
+ *            - 4 ring layout is not supported
+ * @note      the cursor starts at the next record published
+ */
+uint8_t sfa30_ring_open(sfa30_ring_t *ring, const char *name)
+{
+    int fd;
+    uint32_t capacity;
+    struct stat st;
+    void *map;
+    sfa30_ring_header_t *header;
+
+    if ((ring == NULL) || (name == NULL))
+    {
+        return 2;
+    }
+    if (a_sfa30_ring_check_name(name) != 0)
+    {
+        return 4;
+    }
+
+    memset(ring, 0, sizeof(sfa30_ring_t));
+    fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0)
+    {
+        return 1;
+    }
+    if ((fstat(fd, &st) != 0) || ((size_t)st.st_size < sizeof(sfa30_ring_header_t)))
+    {
+        (void)close(fd);
+
+        return 1;
+    }
+    map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    (void)close(fd);
+    if (map == MAP_FAILED)
+    {
+        return 1;
+    }
+
+    /* check the layout */
+    header = (sfa30_ring_header_t *)map;
+    capacity = header->capacity;
+    if ((__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) != SFA30_RING_MAGIC) ||
+        (header->version != SFA30_RING_VERSION) ||
+        (header->slot_size != sizeof(sfa30_ring_slot_t)) ||
+        (capacity == 0) || ((capacity & (capacity - 1)) != 0) ||
+        ((size_t)st.st_size != sizeof(sfa30_ring_header_t) + (size_t)capacity * sizeof(sfa30_ring_slot_t)))
+    {
+        (void)munmap(map, (size_t)st.st_size);
+
+        return 4;
+    }
+    ring->header = header;
+    ring->slots = (sfa30_ring_slot_t *)((uint8_t *)map + sizeof(sfa30_ring_header_t));
+    ring->size = (size_t)st.st_size;
+    ring->cursor = __atomic_load_n(&header->head, __ATOMIC_ACQUIRE);
+    (void)strcpy(ring->name, name);
+
+    return 0;
+}
+
+/**
+ * @brief     close a ring
+ * @param[in] *ring pointer to an sfa30 ring structure
+ * @return    status code
+ *            - 0 success
+ *            - 2 ring is NULL
+ * @note      the producer also removes the name, mapped consumers keep reading the old ring
+ */
+uint8_t sfa30_ring_close(sfa30_ring_t *ring)
+{
+    if (ring == NULL)
+    {
+        return 2;
+    }
+
+    if (ring->header != NULL)
+    {
+        (void)munmap(ring->header, ring->size);
+        if (ring->producer != 0)
+        {
+            (void)shm_unlink(ring->name);
+        }
+    }
+    memset(ring, 0, sizeof(sfa30_ring_t));
+
+    return 0;
+}
+
+/**
+ * @brief     publish a record
+ * @param[in] *ring pointer to an sfa30 ring structure
+ * @param[in] *record pointer to a record
+ * @return    status code
+ *            - 0 success
+ *            - 2 ring or record is NULL
+ *            - 3 ring is not opened as the producer
+ * @note      only one producer may publish, it never waits for the consumers
+ */
+uint8_t sfa30_ring_publish(sfa30_ring_t *ring, const sfa30_ring_record_t *record)
+{
+    uint32_t i;
+    uint64_t index;
+    uint32_t words[SFA30_RING_RECORD_WORDS];
+    sfa30_ring_slot_t *slot;
+
+    if ((ring == NULL) || (record == NULL))
+    {
+        return 2;
+    }
+    if ((ring->header == NULL) || (ring->producer == 0))
+    {
+        return 3;
+    }
+
+    /* pack the record */
+    memcpy(words, record, sizeof(sfa30_ring_record_t));
+    index = __atomic_load_n(&ring->header->head, __ATOMIC_RELAXED);
+    slot = &ring->slots[index & (ring->header->capacity - 1)];
+
+    /* mark the slot as being written */
+    __atomic_store_n(&slot->sequence, 2 * index + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    /* write the slot */
+    for (i = 0; i < SFA30_RING_RECORD_WORDS; i++)
+    {
+        __atomic_store_n(&slot->words[i], words[i], __ATOMIC_RELAXED);
+    }
+
+    /* mark the slot as stable and make it visible */
+    __atomic_store_n(&slot->sequence, 2 * index + 2, __ATOMIC_RELEASE);
+    __atomic_store_n(&ring->header->head, index + 1, __ATOMIC_RELEASE);
+
+    return 0;
+}
+
+/**
+ * @brief      read the next record
+ * @param[in]  *ring pointer to an sfa30 ring structure
+ * @param[out] *record pointer to a record buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 no new record
+ *             - 2 ring or record is NULL
+ *             - 3 ring is not opened
+ * @note       no system call, a reader that falls a whole ring behind skips to
+ *             the oldest record still present and adds the gap to ring->lost
+ */
+uint8_t sfa30_ring_read(sfa30_ring_t *ring, sfa30_ring_record_t *record)
+{
+    uint32_t i;
+    uint64_t head;
+    uint64_t capacity;
+    uint64_t seq;
+    uint64_t oldest;
+    uint32_t words[SFA30_RING_RECORD_WORDS];
+    const sfa30_ring_slot_t *slot;
+
+    if ((ring == NULL) || (record == NULL))
+    {
+        return 2;
+    }
+    if (ring->header == NULL)
+    {
+        return 3;
+    }
+
+    capacity = ring->header->capacity;
+    while (1)
+    {
+        head = __atomic_load_n(&ring->header->head, __ATOMIC_ACQUIRE);
+        if (ring->cursor == head)
+        {
+            return 1;
+        }
+        if (head - ring->cursor > capacity)
+        {
+            /* lapped, skip to the oldest record */
+            ring->lost += head - capacity - ring->cursor;
+            ring->cursor = head - capacity;
+        }
+
+        /* seqlock read of the slot */
+        slot = &ring->slots[ring->cursor & (capacity - 1)];
+        seq = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+        if (seq == 2 * ring->cursor + 2)
+        {
+            for (i = 0; i < SFA30_RING_RECORD_WORDS; i++)
+            {
+                words[i] = __atomic_load_n(&slot->words[i], __ATOMIC_RELAXED);
+            }
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            if (__atomic_load_n(&slot->sequence, __ATOMIC_RELAXED) == seq)
+            {
+                memcpy(record, words, sizeof(sfa30_ring_record_t));
+                ring->cursor++;
+
+                return 0;
+            }
+            seq = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+        }
+
+        /* the producer reused the slot for index (seq - 1) / 2, skip past its lap */
+        oldest = (seq - 1) / 2 - capacity + 1;
+        if ((seq > 2 * ring->cursor + 2) && (oldest > ring->cursor))
+        {
+            ring->lost += oldest - ring->cursor;
+            ring->cursor = oldest;
+        }
+    }
+}
+
+/**
+ * @brief     move the cursor to the oldest record still present
+ * @param[in] *ring pointer to an sfa30 ring structure
+ * @return    status code
+ *            - 0 success
+ *            - 2 ring is NULL
+ *            - 3 ring is not opened
+ * @note      none
+ */
+uint8_t sfa30_ring_rewind(sfa30_ring_t *ring)
+{
+    uint64_t head;
+
+    if (ring == NULL)
+    {
+        return 2;
+    }
+    if (ring->header == NULL)
+    {
+        return 3;
+    }
+
+    head = __atomic_load_n(&ring->header->head, __ATOMIC_ACQUIRE);
+    ring->cursor = (head > ring->header->capacity) ? (head - ring->header->capacity) : 0;
+
+    return 0;
+}
@@ -0,0 +1,212 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @file      sfa30_rrd.h
+ * @brief     sfa30 round robin database header file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2023-07-30
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2023/07/30  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#ifndef SFA30_RRD_H
+#define SFA30_RRD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup sfa30_rrd sfa30 rrd function
+ * @brief    sfa30 round robin database modules
+ * @{
+ */
+
+/**
+ * @brief sfa30 rrd format definition
+ * @note  a little endian header holding the state of every ring, then the slots of each
+ *        ring, a slot covers step_ms aligned to the unix epoch and lives at
+ *        (begin_ms / step_ms) % slots, so the file never grows
+ */
+#define SFA30_RRD_MAGIC                  "SFA30RRD"        /**< 8 byte file magic */
+#define SFA30_RRD_VERSION                1                 /**< format version */
+#define SFA30_RRD_RINGS                  4                 /**< 1 s, 1 min, 1 h and 1 day rings */
+#define SFA30_RRD_DEFAULT_SLOTS_1S       3600              /**< default 1 s slots, 1 hour */
+#define SFA30_RRD_DEFAULT_SLOTS_1MIN     10080             /**< default 1 min slots, 1 week */
+#define SFA30_RRD_DEFAULT_SLOTS_1H       8784              /**< default 1 h slots, 1 leap year */
+#define SFA30_RRD_DEFAULT_SLOTS_1DAY     3660              /**< default 1 day slots, 10 years */
+#define SFA30_RRD_SYNC_MS                60000             /**< max sample time between two msync */
+
+/**
+ * @brief sfa30 rrd slot structure definition
+ */
+typedef struct sfa30_rrd_slot_s
+{
+    uint32_t count;                      /**< samples consolidated, 0 means no data */
+    int16_t mean[3];                     /**< rounded mean formaldehyde, humidity and temperature raw */
+    int16_t min[3];                      /**< min raw values */
+    int16_t max[3];                      /**< max raw values */
+    uint16_t reserved;                   /**< reserved, 0 */
+} sfa30_rrd_slot_t;
+
+/**
+ * @brief sfa30 rrd ring structure definition
+ * @note  stored in the file header, the newest slot is consolidated in place as samples arrive
+ */
+typedef struct sfa30_rrd_ring_s
+{
+    uint64_t offset;                     /**< byte offset of the first slot */
+    uint64_t last_ms;                    /**< begin of the newest slot, 0 before the first sample */
+    int64_t sum[3];                      /**< sums of the raw values of the newest slot */
+    uint32_t step_ms;                    /**< slot length */
+    uint32_t slots;                      /**< slots */
+    uint32_t count;                      /**< samples in the newest slot */
+    int16_t min[3];                      /**< min raw values of the newest slot */
+    int16_t max[3];                      /**< max raw values of the newest slot */
+} sfa30_rrd_ring_t;
+
+/**
+ * @brief sfa30 rrd header structure definition
+ */
+typedef struct sfa30_rrd_header_s
+{
+    char magic[8];                            /**< SFA30_RRD_MAGIC */
+    uint16_t version;                         /**< SFA30_RRD_VERSION */
+    uint16_t header_size;                     /**< sizeof(sfa30_rrd_header_t) */
+    uint16_t slot_size;                       /**< sizeof(sfa30_rrd_slot_t) */
+    uint16_t rings;                           /**< SFA30_RRD_RINGS */
+    uint64_t created_ms;                      /**< creation time in ms since the epoch */
+    uint64_t file_size;                       /**< total file size */
+    uint64_t reserved;                        /**< reserved, 0 */
+    sfa30_rrd_ring_t ring[SFA30_RRD_RINGS];   /**< rings from the finest to the coarsest */
+} sfa30_rrd_header_t;
+
+/**
+ * @brief sfa30 rrd structure definition
+ */
+typedef struct sfa30_rrd_s
+{
+    int fd;                              /**< file */
+    uint8_t *map;                        /**< shared mapping of the whole file */
+    size_t size;                         /**< mapped bytes */
+    sfa30_rrd_header_t *header;          /**< header in the mapping */
+    uint64_t sync_ms;                    /**< sample time of the last msync */
+} sfa30_rrd_t;
+
+/**
+ * @brief     open or create a database
+ * @param[in] *rrd pointer to an sfa30 rrd structure
+ * @param[in] *path pointer to a file path
+ * @param[in] *slots pointer to the slots of each ring for a new file, NULL means the defaults
+ * @param[in] now_ms current time in ms since the epoch
+ * @return    status code
+ *            - 0 success
+ *            - 1 open failed
+ *            - 2 rrd or path is NULL
+ *            - 4 existing file is not a supported database or a slot count is 0
+ * @note      an existing file keeps its own layout and state
+ */
+uint8_t sfa30_rrd_open(sfa30_rrd_t *rrd, const char *path, const uint32_t *slots, uint64_t now_ms);
+
+/**
+ * @brief     sync and close a database
+ * @param[in] *rrd pointer to an sfa30 rrd structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 sync failed
+ *            - 2 rrd is NULL
+ * @note      closing an unopened rrd does nothing
+ */
+uint8_t sfa30_rrd_close(sfa30_rrd_t *rrd);
+
+/**
+ * @brief     consolidate a sample into every ring
+ * @param[in] *rrd pointer to an sfa30 rrd structure
+ * @param[in] time_ms sample time in ms since the epoch
+ * @param[in] formaldehyde_raw formaldehyde raw, ppb * 5
+ * @param[in] humidity_raw humidity raw, % * 100
+ * @param[in] temperature_raw temperature raw, C * 200
+ * @return    status code
+ *            - 0 success
+ *            - 1 sync failed
+ *            - 2 rrd is NULL
+ *            - 3 rrd is not opened
+ *            - 5 sample is older than the newest 1 s slot
+ * @note      stores into the mapping, skipped slots are cleared, and the dirty pages are
+ *            scheduled for writeback without waiting once SFA30_RRD_SYNC_MS of sample time
+ *            passed since the last sync, so many databases never block a sampling thread together
+ */
+uint8_t sfa30_rrd_update(sfa30_rrd_t *rrd, uint64_t time_ms, int16_t formaldehyde_raw,
+                         int16_t humidity_raw, int16_t temperature_raw);
+
+/**
+ * @brief     sync the mapping to the disk
+ * @param[in] *rrd pointer to an sfa30 rrd structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 sync failed
+ *            - 2 rrd is NULL
+ *            - 3 rrd is not opened
+ * @note      only the dirty pages are written, a few per ring
+ */
+uint8_t sfa30_rrd_sync(sfa30_rrd_t *rrd);
+
+/**
+ * @brief      fetch a time range
+ * @param[in]  *rrd pointer to an sfa30 rrd structure
+ * @param[in]  from_ms range begin in ms since the epoch
+ * @param[in]  to_ms range end in ms since the epoch
+ * @param[in]  resolution_ms coarsest acceptable slot length
+ * @param[out] *out pointer to a slot buffer
+ * @param[in]  max slot buffer length
+ * @param[out] *count pointer to a fetched slots buffer
+ * @param[out] *first_ms pointer to the begin of the first fetched slot buffer
+ * @param[out] *step_ms pointer to the slot length buffer
+ * @return     status code
+ *             - 0 success
+ *             - 2 rrd, out, count, first_ms or step_ms is NULL
+ *             - 3 rrd is not opened
+ *             - 4 to_ms is before from_ms or max is too small, count holds the slots needed
+ * @note       the coarsest ring not coarser than resolution_ms is read, or a coarser one
+ *             when it has already dropped from_ms, slots without data have a count of 0
+ */
+uint8_t sfa30_rrd_fetch(const sfa30_rrd_t *rrd, uint64_t from_ms, uint64_t to_ms, uint32_t resolution_ms,
+                        sfa30_rrd_slot_t *out, uint32_t max, uint32_t *count, uint64_t *first_ms, uint32_t *step_ms);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
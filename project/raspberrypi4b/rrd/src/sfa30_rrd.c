@@ -0,0 +1,499 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @file      sfa30_rrd.c
+ * @brief     sfa30 round robin database source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2023-07-30
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2023/07/30  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#include "sfa30_rrd.h"
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/**
+ * @brief sfa30 rrd ring steps definition
+ * @note  every step is a multiple of the finer ones, so a sample never lands
+ *        before the newest slot of a coarser ring when it does not in the 1 s ring
+ */
+static const uint32_t gs_rrd_step_ms[SFA30_RRD_RINGS] = {1000U, 60000U, 3600000U, 86400000U};
+
+/**
+ * @brief sfa30 rrd default slots definition
+ */
+static const uint32_t gs_rrd_default_slots[SFA30_RRD_RINGS] =
+{
+    SFA30_RRD_DEFAULT_SLOTS_1S, SFA30_RRD_DEFAULT_SLOTS_1MIN,
+    SFA30_RRD_DEFAULT_SLOTS_1H, SFA30_RRD_DEFAULT_SLOTS_1DAY,
+};
+
+/**
+ * @brief     check a database header
+ * @param[in] *header pointer to a header
+ * @param[in] size file size
+ * @return    status code
+ *            - 0 success
+ *            - 1 header is not supported
+ * @note      none
+ */
+static uint8_t a_sfa30_rrd_check_header(const sfa30_rrd_header_t *header, uint64_t size)
+{
+    uint32_t i;
+
+    if ((memcmp(header->magic, SFA30_RRD_MAGIC, sizeof(header->magic)) != 0) ||
+        (header->version != SFA30_RRD_VERSION) ||
+        (header->header_size != sizeof(sfa30_rrd_header_t)) ||
+        (header->slot_size != sizeof(sfa30_rrd_slot_t)) ||
+        (header->rings != SFA30_RRD_RINGS) ||
+        (header->file_size != size))
+    {
+        return 1;
+    }
+    for (i = 0; i < SFA30_RRD_RINGS; i++)
+    {
+        if ((header->ring[i].step_ms != gs_rrd_step_ms[i]) || (header->ring[i].slots == 0) ||
+            (header->ring[i].offset < sizeof(sfa30_rrd_header_t)) ||
+            (header->ring[i].offset + (uint64_t)header->ring[i].slots * sizeof(sfa30_rrd_slot_t) > size))
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief     get a slot of a ring
+ * @param[in] *rrd pointer to an sfa30 rrd structure
+ * @param[in] *ring pointer to a ring
+ * @param[in] begin_ms slot begin
+ * @return    pointer to the slot
+ * @note      none
+ */
+static sfa30_rrd_slot_t *a_sfa30_rrd_slot(const sfa30_rrd_t *rrd, const sfa30_rrd_ring_t *ring, uint64_t begin_ms)
+{
+    sfa30_rrd_slot_t *slots = (sfa30_rrd_slot_t *)(rrd->map + ring->offset);
+
+    return &slots[(begin_ms / ring->step_ms) % ring->slots];
+}
+
+/**
+ * @brief     get a rounded mean
+ * @param[in] sum sum of the values
+ * @param[in] count values
+ * @return    mean
+ * @note      rounds half away from zero
+ */
+static int16_t a_sfa30_rrd_mean(int64_t sum, uint32_t count)
+{
+    if (sum >= 0)
+    {
+        return (int16_t)((sum + (int64_t)(count / 2)) / (int64_t)count);
+    }
+
+    return (int16_t)(-((-sum + (int64_t)(count / 2)) / (int64_t)count));
+}
+
+/**
+ * @brief     consolidate a sample into one ring
+ * @param[in] *rrd pointer to an sfa30 rrd structure
+ * @param[in] *ring pointer to a ring
+ * @param[in] time_ms sample time
+ * @param[in] *raw pointer to the raw values
+ * @note      the newest slot is rewritten in place, so readers see it filling up
+ */
+static void a_sfa30_rrd_ring_update(sfa30_rrd_t *rrd, sfa30_rrd_ring_t *ring, uint64_t time_ms, const int16_t *raw)
+{
+    uint32_t c;
+    uint64_t t;
+    uint64_t begin_ms = time_ms - (time_ms % ring->step_ms);
+    sfa30_rrd_slot_t *slot;
+
+    if ((ring->last_ms == 0) || (begin_ms != ring->last_ms))
+    {
+        /* clear the slots skipped since the newest one, a long outage clears the ring */
+        if ((ring->last_ms != 0) && ((begin_ms - ring->last_ms) / ring->step_ms <= ring->slots))
+        {
+            for (t = ring->last_ms + ring->step_ms; t < begin_ms; t += ring->step_ms)
+            {
+                memset(a_sfa30_rrd_slot(rrd, ring, t), 0, sizeof(sfa30_rrd_slot_t));
+            }
+        }
+        else if (ring->last_ms != 0)
+        {
+            memset(rrd->map + ring->offset, 0, (size_t)ring->slots * sizeof(sfa30_rrd_slot_t));
+        }
+
+        /* open the next slot */
+        ring->last_ms = begin_ms;
+        ring->count = 0;
+        for (c = 0; c < 3; c++)
+        {
+            ring->sum[c] = 0;
+            ring->min[c] = raw[c];
+            ring->max[c] = raw[c];
+        }
+    }
+
+    /* consolidate */
+    ring->count++;
+    slot = a_sfa30_rrd_slot(rrd, ring, begin_ms);
+    slot->count = ring->count;
+    for (c = 0; c < 3; c++)
+    {
+        ring->sum[c] += raw[c];
+        ring->min[c] = (raw[c] < ring->min[c]) ? raw[c] : ring->min[c];
+        ring->max[c] = (raw[c] > ring->max[c]) ? raw[c] : ring->max[c];
+        slot->mean[c] = a_sfa30_rrd_mean(ring->sum[c], ring->count);
+        slot->min[c] = ring->min[c];
+        slot->max[c] = ring->max[c];
+    }
+    slot->reserved = 0;
+}
+
+/**
+ * @brief     open or create a database
+ * @param[in] *rrd pointer to an sfa30 rrd structure
+ * @param[in] *path pointer to a file path
+ * @param[in] *slots pointer to the slots of each ring for a new file, NULL means the defaults
+ * @param[in] now_ms current time in ms since the epoch
+ * @return    status code
+ *            - 0 success
+ *            - 1 open failed
+ *            - 2 rrd or path is NULL
+ *            - 4 existing file is not a supported database or a slot count is 0
+ * @note      an existing file keeps its own layout and state
+ */
+uint8_t sfa30_rrd_open(sfa30_rrd_t *rrd, const char *path, const uint32_t *slots, uint64_t now_ms)
+{
+    uint32_t i;
+    uint64_t size;
+    struct stat st;
+    sfa30_rrd_header_t header;
+
+    if ((rrd == NULL) || (path == NULL))
+    {
+        return 2;
+    }
+
+    memset(rrd, 0, sizeof(sfa30_rrd_t));
+    rrd->fd = -1;
+    slots = (slots != NULL) ? slots : gs_rrd_default_slots;
+    for (i = 0; i < SFA30_RRD_RINGS; i++)
+    {
+        if (slots[i] == 0)
+        {
+            return 4;
+        }
+    }
+    rrd->fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (rrd->fd < 0)
+    {
+        return 1;
+    }
+    if (fstat(rrd->fd, &st) != 0)
+    {
+        (void)close(rrd->fd);
+        rrd->fd = -1;
+
+        return 1;
+    }
+    if (st.st_size == 0)
+    {
+        /* a new database, the slots are sparse zeros until written */
+        memset(&header, 0, sizeof(sfa30_rrd_header_t));
+        memcpy(header.magic, SFA30_RRD_MAGIC, sizeof(header.magic));
+        header.version = SFA30_RRD_VERSION;
+        header.header_size = sizeof(sfa30_rrd_header_t);
+        header.slot_size = sizeof(sfa30_rrd_slot_t);
+        header.rings = SFA30_RRD_RINGS;
+        header.created_ms = now_ms;
+        size = sizeof(sfa30_rrd_header_t);
+        for (i = 0; i < SFA30_RRD_RINGS; i++)
+        {
+            header.ring[i].offset = size;
+            header.ring[i].step_ms = gs_rrd_step_ms[i];
+            header.ring[i].slots = slots[i];
+            size += (uint64_t)slots[i] * sizeof(sfa30_rrd_slot_t);
+        }
+        header.file_size = size;
+        if ((ftruncate(rrd->fd, (off_t)size) != 0) ||
+            (pwrite(rrd->fd, &header, sizeof(sfa30_rrd_header_t), 0) != (ssize_t)sizeof(sfa30_rrd_header_t)))
+        {
+            (void)close(rrd->fd);
+            rrd->fd = -1;
+
+            return 1;
+        }
+    }
+    else
+    {
+        /* an existing database */
+        size = (uint64_t)st.st_size;
+        if ((size < sizeof(sfa30_rrd_header_t)) ||
+            (pread(rrd->fd, &header, sizeof(sfa30_rrd_header_t), 0) != (ssize_t)sizeof(sfa30_rrd_header_t)) ||
+            (a_sfa30_rrd_check_header(&header, size) != 0))
+        {
+            (void)close(rrd->fd);
+            rrd->fd = -1;
+
+            return 4;
+        }
+    }
+    rrd->map = (uint8_t *)mmap(NULL, (size_t)size, PROT_READ | PROT_WRITE, MAP_SHARED, rrd->fd, 0);
+    if (rrd->map == MAP_FAILED)
+    {
+        rrd->map = NULL;
+        (void)close(rrd->fd);
+        rrd->fd = -1;
+
+        return 1;
+    }
+    rrd->size = (size_t)size;
+    rrd->header = (sfa30_rrd_header_t *)rrd->map;
+    rrd->sync_ms = now_ms;
+
+    return 0;
+}
+
+/**
+ * @brief     sync and close a database
+ * @param[in] *rrd pointer to an sfa30 rrd structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 sync failed
+ *            - 2 rrd is NULL
+ * @note      closing an unopened rrd does nothing
+ */
+uint8_t sfa30_rrd_close(sfa30_rrd_t *rrd)
+{
+    uint8_t res = 0;
+
+    if (rrd == NULL)
+    {
+        return 2;
+    }
+    if (rrd->map == NULL)
+    {
+        return 0;
+    }
+
+    if (msync(rrd->map, rrd->size, MS_SYNC) != 0)
+    {
+        res = 1;
+    }
+    (void)munmap(rrd->map, rrd->size);
+    (void)close(rrd->fd);
+    rrd->map = NULL;
+    rrd->header = NULL;
+    rrd->size = 0;
+    rrd->fd = -1;
+
+    return res;
+}
+
+/**
+ * @brief     consolidate a sample into every ring
+ * @param[in] *rrd pointer to an sfa30 rrd structure
+ * @param[in] time_ms sample time in ms since the epoch
+ * @param[in] formaldehyde_raw formaldehyde raw, ppb * 5
+ * @param[in] humidity_raw humidity raw, % * 100
+ * @param[in] temperature_raw temperature raw, C * 200
+ * @return    status code
+ *            - 0 success
+ *            - 1 sync failed
+ *            - 2 rrd is NULL
+ *            - 3 rrd is not opened
+ *            - 5 sample is older than the newest 1 s slot
+ * @note      stores into the mapping, skipped slots are cleared, and the dirty pages are
+ *            scheduled for writeback without waiting once SFA30_RRD_SYNC_MS of sample time
+ *            passed since the last sync, so many databases never block a sampling thread together
+ */
+uint8_t sfa30_rrd_update(sfa30_rrd_t *rrd, uint64_t time_ms, int16_t formaldehyde_raw,
+                         int16_t humidity_raw, int16_t temperature_raw)
+{
+    uint32_t i;
+    int16_t raw[3];
+
+    if (rrd == NULL)
+    {
+        return 2;
+    }
+    if (rrd->map == NULL)
+    {
+        return 3;
+    }
+    if ((rrd->header->ring[0].last_ms != 0) && (time_ms < rrd->header->ring[0].last_ms))
+    {
+        return 5;
+    }
+
+    raw[0] = formaldehyde_raw;
+    raw[1] = humidity_raw;
+    raw[2] = temperature_raw;
+    for (i = 0; i < SFA30_RRD_RINGS; i++)
+    {
+        a_sfa30_rrd_ring_update(rrd, &rrd->header->ring[i], time_ms, raw);
+    }
+    if ((time_ms < rrd->sync_ms) || (time_ms - rrd->sync_ms >= SFA30_RRD_SYNC_MS))
+    {
+        rrd->sync_ms = time_ms;
+        if (msync(rrd->map, rrd->size, MS_ASYNC) != 0)
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief     sync the mapping to the disk
+ * @param[in] *rrd pointer to an sfa30 rrd structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 sync failed
+ *            - 2 rrd is NULL
+ *            - 3 rrd is not opened
+ * @note      only the dirty pages are written, a few per ring
+ */
+uint8_t sfa30_rrd_sync(sfa30_rrd_t *rrd)
+{
+    if (rrd == NULL)
+    {
+        return 2;
+    }
+    if (rrd->map == NULL)
+    {
+        return 3;
+    }
+
+    if (msync(rrd->map, rrd->size, MS_SYNC) != 0)
+    {
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief      fetch a time range
+ * @param[in]  *rrd pointer to an sfa30 rrd structure
+ * @param[in]  from_ms range begin in ms since the epoch
+ * @param[in]  to_ms range end in ms since the epoch
+ * @param[in]  resolution_ms coarsest acceptable slot length
+ * @param[out] *out pointer to a slot buffer
+ * @param[in]  max slot buffer length
+ * @param[out] *count pointer to a fetched slots buffer
+ * @param[out] *first_ms pointer to the begin of the first fetched slot buffer
+ * @param[out] *step_ms pointer to the slot length buffer
+ * @return     status code
+ *             - 0 success
+ *             - 2 rrd, out, count, first_ms or step_ms is NULL
+ *             - 3 rrd is not opened
+ *             - 4 to_ms is before from_ms or max is too small, count holds the slots needed
+ * @note       the coarsest ring not coarser than resolution_ms is read, or a coarser one
+ *             when it has already dropped from_ms, slots without data have a count of 0
+ */
+uint8_t sfa30_rrd_fetch(const sfa30_rrd_t *rrd, uint64_t from_ms, uint64_t to_ms, uint32_t resolution_ms,
+                        sfa30_rrd_slot_t *out, uint32_t max, uint32_t *count, uint64_t *first_ms, uint32_t *step_ms)
+{
+    uint32_t i;
+    uint32_t r = 0;
+    uint64_t n;
+    uint64_t t;
+    uint64_t first;
+    uint64_t oldest;
+    const sfa30_rrd_ring_t *ring;
+
+    if ((rrd == NULL) || (out == NULL) || (count == NULL) || (first_ms == NULL) || (step_ms == NULL))
+    {
+        return 2;
+    }
+    if (rrd->map == NULL)
+    {
+        return 3;
+    }
+    if (to_ms < from_ms)
+    {
+        *count = 0;
+
+        return 4;
+    }
+
+    /* pick the ring */
+    for (i = 0; i < SFA30_RRD_RINGS; i++)
+    {
+        if (rrd->header->ring[i].step_ms <= resolution_ms)
+        {
+            r = i;
+        }
+    }
+    while (r + 1 < SFA30_RRD_RINGS)
+    {
+        ring = &rrd->header->ring[r];
+        oldest = ring->last_ms - (uint64_t)(ring->slots - 1) * ring->step_ms;
+        if ((ring->last_ms == 0) || (ring->last_ms < (uint64_t)(ring->slots - 1) * ring->step_ms) ||
+            (from_ms - (from_ms % ring->step_ms) >= oldest))
+        {
+            break;
+        }
+        r++;
+    }
+    ring = &rrd->header->ring[r];
+
+    /* copy the slots, the ones outside the ring have no data */
+    first = from_ms - (from_ms % ring->step_ms);
+    n = ((to_ms - (to_ms % ring->step_ms)) - first) / ring->step_ms + 1;
+    *count = (n > 0xFFFFFFFFULL) ? 0xFFFFFFFFU : (uint32_t)n;
+    *first_ms = first;
+    *step_ms = ring->step_ms;
+    if (n > max)
+    {
+        return 4;
+    }
+    for (i = 0, t = first; i < (uint32_t)n; i++, t += ring->step_ms)
+    {
+        if ((ring->last_ms == 0) || (t > ring->last_ms) ||
+            (ring->last_ms - t >= (uint64_t)ring->slots * ring->step_ms))
+        {
+            memset(&out[i], 0, sizeof(sfa30_rrd_slot_t));
+        }
+        else
+        {
+            out[i] = *a_sfa30_rrd_slot(rrd, ring, t);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,983 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @file      bench.c
+ * @brief     bench source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2023-07-30
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2023/07/30  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#include "driver_sfa30_emulator.h"
+#include "driver_sfa30_decode.h"
+#include "driver_sfa30_codec.h"
+#include "driver_sfa30_aggregate.h"
+#include "driver_sfa30_quantile.h"
+#include "driver_sfa30_deadband.h"
+#include <getopt.h>
+#include <stdlib.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/**
+ * @brief bench codec block definition
+ */
+#define BENCH_CODEC_SAMPLES        4096        /**< samples per codec block, 34 minutes at 2 Hz */
+
+/**
+ * @brief bench result structure definition
+ */
+typedef struct bench_result_s
+{
+    const char *name;             /**< benchmark name */
+    const char *interface;        /**< interface name */
+    uint32_t iterations;          /**< iterations */
+    double ns_per_op;             /**< mean ns per operation */
+    double bytes_per_op;          /**< bytes on the wire per operation */
+    uint64_t p50_ns;              /**< median latency */
+    uint64_t p99_ns;              /**< 99th percentile latency */
+    uint64_t p999_ns;             /**< 99.9th percentile latency */
+    double ops_per_sec;           /**< operations per second */
+    double cycles_per_byte;       /**< cpu cycles per payload byte, 0 if not measured */
+} bench_result_t;
+
+/**
+ * @brief bench operation definition
+ */
+typedef uint8_t (*bench_op_t)(void);
+
+static sfa30_handle_t gs_handle;                 /**< sfa30 handle */
+static uint8_t gs_scratch[SFA30_SCRATCH_SIZE];   /**< sfa30 uart scratch buffer */
+static uint64_t *gs_samples;                     /**< latency samples */
+static bench_result_t gs_results[32];            /**< results */
+static uint32_t gs_result_count;                 /**< result count */
+static uint8_t gs_json;                          /**< json output flag */
+static uint8_t gs_crc_buf[48];                   /**< 16 crc protected words as in a device information response */
+static volatile uint8_t gs_sink;                 /**< keeps the crc results alive */
+static uint8_t gs_decode_frames[256 * SFA30_DECODE_FRAME_SIZE];        /**< 256 iic read measured values responses */
+static float gs_decode_out[3][256];                                    /**< decoded values */
+static uint8_t gs_decode_mask[256 / 8];                                /**< decoded crc mask */
+static uint32_t gs_codec_timestamp[BENCH_CODEC_SAMPLES];               /**< codec input timestamps */
+static sfa30_data_t gs_codec_data[BENCH_CODEC_SAMPLES];                /**< codec input samples */
+static uint8_t gs_codec_block[BENCH_CODEC_SAMPLES * 12];               /**< codec block, room for the widest frames */
+static uint32_t gs_codec_size;                                         /**< codec block size */
+static sfa30_codec_encoder_t gs_codec_encoder;                         /**< codec encoder */
+static uint32_t gs_codec_out_timestamp[BENCH_CODEC_SAMPLES];           /**< codec decoded timestamps */
+static int16_t gs_codec_out_raw[3][BENCH_CODEC_SAMPLES];               /**< codec decoded raw values */
+static sfa30_aggregate_t gs_aggregate;                                 /**< aggregate */
+static sfa30_aggregate_slot_t gs_aggregate_slot[32 + 128 + 2048];      /**< aggregate 10 s, 1 min and 15 min slot rings */
+static sfa30_quantile_t gs_quantile[2];                                /**< quantile sketch and merge target */
+static sfa30_deadband_t gs_deadband;                                   /**< deadband filter */
+
+/**
+ * @brief  get the monotonic time
+ * @return time in ns
+ * @note   none
+ */
+static uint64_t a_bench_now_ns(void)
+{
+    struct timespec ts;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief     compare two latency samples
+ * @param[in] *a pointer to the first sample
+ * @param[in] *b pointer to the second sample
+ * @return    compare result
+ * @note      none
+ */
+static int a_bench_compare(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief     get a percentile of the sorted samples
+ * @param[in] n sample count
+ * @param[in] permille percentile in 1/1000
+ * @return    sample value
+ * @note      none
+ */
+static uint64_t a_bench_percentile(uint32_t n, uint32_t permille)
+{
+    uint64_t index;
+
+    index = ((uint64_t)n * permille) / 1000;
+    if (index >= n)
+    {
+        index = n - 1;
+    }
+
+    return gs_samples[index];
+}
+
+/**
+ * @brief     run one benchmark
+ * @param[in] *name pointer to a benchmark name
+ * @param[in] *interface pointer to an interface name
+ * @param[in] op timed operation
+ * @param[in] setup untimed operation run before each timed one, can be NULL
+ * @param[in] iterations iterations
+ * @return    status code
+ *            - 0 success
+ *            - 1 run failed
+ * @note      none
+ */
+static uint8_t a_bench_run(const char *name, const char *interface, bench_op_t op, bench_op_t setup, uint32_t iterations)
+{
+    uint32_t i;
+    uint32_t tx0, rx0, tx1, rx1;
+    uint64_t total;
+    bench_result_t *r;
+
+    if (gs_result_count >= (sizeof(gs_results) / sizeof(gs_results[0])))
+    {
+        return 1;
+    }
+
+    /* warm up */
+    for (i = 0; i < (iterations / 100) + 1; i++)
+    {
+        if ((setup != NULL) && (setup() != 0))
+        {
+            return 1;
+        }
+        if (op() != 0)
+        {
+            return 1;
+        }
+    }
+
+    /* timed loop */
+    sfa30_emulator_get_bytes(&tx0, &rx0);
+    total = 0;
+    for (i = 0; i < iterations; i++)
+    {
+        uint64_t t0;
+        uint64_t t1;
+
+        if (setup != NULL)
+        {
+            uint32_t stx, srx, etx, erx;
+
+            /* keep the setup traffic out of the byte count */
+            sfa30_emulator_get_bytes(&stx, &srx);
+            if (setup() != 0)
+            {
+                return 1;
+            }
+            sfa30_emulator_get_bytes(&etx, &erx);
+            tx0 += etx - stx;
+            rx0 += erx - srx;
+        }
+        t0 = a_bench_now_ns();
+        if (op() != 0)
+        {
+            return 1;
+        }
+        t1 = a_bench_now_ns();
+        gs_samples[i] = t1 - t0;
+        total += t1 - t0;
+    }
+    sfa30_emulator_get_bytes(&tx1, &rx1);
+
+    /* fill the result */
+    qsort(gs_samples, iterations, sizeof(uint64_t), a_bench_compare);
+    r = &gs_results[gs_result_count++];
+    r->name = name;
+    r->interface = interface;
+    r->iterations = iterations;
+    r->ns_per_op = (double)total / (double)iterations;
+    r->bytes_per_op = (double)((tx1 - tx0) + (rx1 - rx0)) / (double)iterations;
+    r->p50_ns = a_bench_percentile(iterations, 500);
+    r->p99_ns = a_bench_percentile(iterations, 990);
+    r->p999_ns = a_bench_percentile(iterations, 999);
+    r->ops_per_sec = (r->ns_per_op > 0.0) ? (1e9 / r->ns_per_op) : 0.0;
+    r->cycles_per_byte = 0.0;
+
+    return 0;
+}
+
+/**
+ * @brief  bench read operation
+ * @return status code
+ * @note   none
+ */
+static uint8_t a_bench_read(void)
+{
+    sfa30_data_t data;
+
+    return sfa30_read(&gs_handle, &data);
+}
+
+/**
+ * @brief  bench start measurement operation
+ * @return status code
+ * @note   none
+ */
+static uint8_t a_bench_start(void)
+{
+    return sfa30_start_measurement(&gs_handle);
+}
+
+/**
+ * @brief  bench stop measurement operation
+ * @return status code
+ * @note   none
+ */
+static uint8_t a_bench_stop(void)
+{
+    return sfa30_stop_measurement(&gs_handle);
+}
+
+/**
+ * @brief  bench get device information operation
+ * @return status code
+ * @note   none
+ */
+static uint8_t a_bench_device_information(void)
+{
+    char info[32];
+
+    return sfa30_get_device_information(&gs_handle, info);
+}
+
+/**
+ * @brief  bench shdlc encode and decode operation
+ * @return status code
+ * @note   a read measured values frame with stuffed bytes in the response
+ */
+static uint8_t a_bench_shdlc(void)
+{
+    uint8_t input[7] = {0x7E, 0x00, 0x03, 0x01, 0x02, 0xF9, 0x7E};
+    uint8_t output[13];
+
+    return sfa30_set_get_reg_uart(&gs_handle, input, 7, output, 13);
+}
+
+/**
+ * @brief     reference bitwise crc8
+ * @param[in] *data pointer to a data buffer
+ * @param[in] len data length
+ * @return    crc
+ * @note      the engine the driver used before the table, kept as the baseline
+ */
+static uint8_t a_bench_crc8_bitwise(const uint8_t *data, uint16_t len)
+{
+    uint16_t i;
+    uint8_t bit;
+    uint8_t crc = 0xFF;
+
+    for (i = 0; i < len; i++)
+    {
+        crc ^= data[i];
+        for (bit = 0; bit < 8; bit++)
+        {
+            crc = ((crc & 0x80) != 0) ? (uint8_t)((crc << 1) ^ 0x31) : (uint8_t)(crc << 1);
+        }
+    }
+
+    return crc;
+}
+
+/**
+ * @brief  bench crc8 operation
+ * @return status code
+ * @note   checks the 16 words of a device information response
+ */
+static uint8_t a_bench_crc8(void)
+{
+    uint8_t i;
+    uint8_t bad = 0;
+
+    for (i = 0; i < 16; i++)
+    {
+        bad |= (uint8_t)(sfa30_crc8(&gs_crc_buf[i * 3], 2) ^ gs_crc_buf[i * 3 + 2]);
+    }
+    gs_sink = bad;
+
+    return 0;
+}
+
+/**
+ * @brief  bench reference bitwise crc8 operation
+ * @return status code
+ * @note   checks the 16 words of a device information response
+ */
+static uint8_t a_bench_crc8_reference(void)
+{
+    uint8_t i;
+    uint8_t bad = 0;
+
+    for (i = 0; i < 16; i++)
+    {
+        bad |= (uint8_t)(a_bench_crc8_bitwise(&gs_crc_buf[i * 3], 2) ^ gs_crc_buf[i * 3 + 2]);
+    }
+    gs_sink = bad;
+
+    return 0;
+}
+
+/**
+ * @brief  bench shdlc checksum operation
+ * @return status code
+ * @note   covers the 22 checksummed bytes of a device information frame
+ */
+static uint8_t a_bench_shdlc_checksum(void)
+{
+    gs_sink = sfa30_shdlc_checksum(gs_crc_buf, 22);
+
+    return 0;
+}
+
+/**
+ * @brief     run one crc benchmark
+ * @param[in] *name pointer to a benchmark name
+ * @param[in] op timed operation
+ * @param[in] bytes payload bytes of one operation
+ * @param[in] iterations iterations
+ * @return    status code
+ *            - 0 success
+ *            - 1 run failed
+ * @note      cycles come from the time stamp counter on x86, it ticks at the nominal
+ *            frequency, other targets report the time only
+ */
+static uint8_t a_bench_crc_run(const char *name, bench_op_t op, uint32_t bytes, uint32_t iterations)
+{
+    bench_result_t *r;
+#if defined(__x86_64__) || defined(__i386__)
+    uint32_t i;
+    uint64_t c0;
+    uint64_t c1;
+#endif
+
+    if (a_bench_run(name, "none", op, NULL, iterations) != 0)
+    {
+        return 1;
+    }
+    r = &gs_results[gs_result_count - 1];
+    r->bytes_per_op = (double)bytes;
+#if defined(__x86_64__) || defined(__i386__)
+    c0 = __rdtsc();
+    for (i = 0; i < iterations; i++)
+    {
+        (void)op();
+    }
+    c1 = __rdtsc();
+    r->cycles_per_byte = (double)(c1 - c0) / ((double)iterations * (double)bytes);
+#endif
+
+    return 0;
+}
+
+/**
+ * @brief     run all crc benchmarks
+ * @param[in] iterations iterations
+ * @return    status code
+ *            - 0 success
+ *            - 1 run failed
+ * @note      none
+ */
+static uint8_t a_bench_crc(uint32_t iterations)
+{
+    uint8_t i;
+
+    for (i = 0; i < 16; i++)
+    {
+        gs_crc_buf[i * 3 + 0] = (uint8_t)('A' + i);
+        gs_crc_buf[i * 3 + 1] = (uint8_t)('a' + i);
+        gs_crc_buf[i * 3 + 2] = sfa30_crc8(&gs_crc_buf[i * 3], 2);
+    }
+    if (a_bench_crc_run("sfa30_crc8", a_bench_crc8, 32, iterations) != 0)
+    {
+        return 1;
+    }
+    if (a_bench_crc_run("crc8_bitwise_reference", a_bench_crc8_reference, 32, iterations) != 0)
+    {
+        return 1;
+    }
+    if (a_bench_crc_run("sfa30_shdlc_checksum", a_bench_shdlc_checksum, 22, iterations) != 0)
+    {
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief  bench batch decode operation
+ * @return status code
+ * @note   decodes 256 responses
+ */
+static uint8_t a_bench_decode_batch(void)
+{
+    return sfa30_decode_batch(gs_decode_frames, 256, gs_decode_out[0], gs_decode_out[1],
+                              gs_decode_out[2], gs_decode_mask);
+}
+
+/**
+ * @brief     run the batch decode benchmark of every supported kernel
+ * @param[in] iterations iterations
+ * @return    status code
+ *            - 0 success
+ *            - 1 run failed
+ * @note      ops_per_sec x 256 is the frames per second
+ */
+static uint8_t a_bench_decode(uint32_t iterations)
+{
+    static const char *const names[] =
+    {
+        "sfa30_decode_batch_scalar",
+        "sfa30_decode_batch_sse41",
+        "sfa30_decode_batch_avx2",
+        "sfa30_decode_batch_neon",
+    };
+    sfa30_decode_kernel_t best;
+    uint32_t i;
+    uint8_t k;
+
+    for (i = 0; i < 256 * 3; i++)
+    {
+        gs_decode_frames[i * 3 + 0] = (uint8_t)(i >> 1);
+        gs_decode_frames[i * 3 + 1] = (uint8_t)(i * 7);
+        gs_decode_frames[i * 3 + 2] = sfa30_crc8(&gs_decode_frames[i * 3], 2);
+    }
+    best = sfa30_decode_get_kernel();
+    for (k = SFA30_DECODE_KERNEL_SCALAR; k <= SFA30_DECODE_KERNEL_NEON; k++)
+    {
+        if (sfa30_decode_set_kernel((sfa30_decode_kernel_t)k) != 0)
+        {
+            continue;
+        }
+        if (a_bench_crc_run(names[k], a_bench_decode_batch, 256 * SFA30_DECODE_FRAME_SIZE, iterations) != 0)
+        {
+            (void)sfa30_decode_set_kernel(best);
+
+            return 1;
+        }
+    }
+    (void)sfa30_decode_set_kernel(best);
+
+    return 0;
+}
+
+/**
+ * @brief  bench codec encode operation
+ * @return status code
+ * @note   fills and seals one block
+ */
+static uint8_t a_bench_codec_encode(void)
+{
+    uint32_t i;
+
+    (void)sfa30_codec_encoder_init(&gs_codec_encoder, gs_codec_block, sizeof(gs_codec_block), 500);
+    for (i = 0; i < BENCH_CODEC_SAMPLES; i++)
+    {
+        if (sfa30_codec_encoder_append(&gs_codec_encoder, gs_codec_timestamp[i], &gs_codec_data[i]) != 0)
+        {
+            return 1;
+        }
+    }
+
+    return sfa30_codec_encoder_seal(&gs_codec_encoder, &gs_codec_size);
+}
+
+/**
+ * @brief  bench codec decode operation
+ * @return status code
+ * @note   decodes one block
+ */
+static uint8_t a_bench_codec_decode(void)
+{
+    uint32_t count;
+
+    if (sfa30_codec_decode(gs_codec_block, gs_codec_size, BENCH_CODEC_SAMPLES, gs_codec_out_timestamp,
+                           gs_codec_out_raw[0], gs_codec_out_raw[1], gs_codec_out_raw[2], &count) != 0)
+    {
+        return 1;
+    }
+
+    return (count == BENCH_CODEC_SAMPLES) ? 0 : 1;
+}
+
+/**
+ * @brief     run the block codec benchmarks
+ * @param[in] iterations iterations
+ * @return    status code
+ *            - 0 success
+ *            - 1 run failed
+ * @note      the samples are the emulator waveforms every 500 ms with the 0 or 1 ms
+ *            timestamp jitter of the daemon and a late sample every 256, ops_per_sec x 4096
+ *            is the samples per second and bytes_per_op / 4096 the bytes per sample
+ */
+static uint8_t a_bench_codec(uint32_t iterations)
+{
+    uint32_t seed = 0x2545F491U;
+    uint32_t i;
+
+    sfa30_emulator_power_on();
+    for (i = 0; i < BENCH_CODEC_SAMPLES; i++)
+    {
+        seed = seed * 1664525U + 1013904223U;
+        sfa30_emulator_get_expected(&gs_codec_data[i]);
+        gs_codec_timestamp[i] = sfa30_emulator_get_time_ms() + (seed >> 31) + ((((seed >> 8) & 255U) == 0) ? 5U : 0U);
+        sfa30_emulator_advance_ms(500);
+    }
+    iterations = (iterations / 16) + 1;
+    if (a_bench_codec_encode() != 0)
+    {
+        return 1;
+    }
+    if (a_bench_crc_run("sfa30_codec_encode", a_bench_codec_encode, gs_codec_size, iterations) != 0)
+    {
+        return 1;
+    }
+    if (a_bench_crc_run("sfa30_codec_decode", a_bench_codec_decode, gs_codec_size, iterations) != 0)
+    {
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief  bench aggregate push operation
+ * @return status code
+ * @note   pushes the codec samples to the 10 s, 1 min and 15 min windows
+ */
+static uint8_t a_bench_aggregate_push(void)
+{
+    uint32_t i;
+
+    for (i = 0; i < BENCH_CODEC_SAMPLES; i++)
+    {
+        (void)sfa30_aggregate_push(&gs_aggregate, gs_codec_timestamp[i], &gs_codec_data[i]);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief  bench aggregate get operation
+ * @return status code
+ * @note   reads every window in every mode
+ */
+static uint8_t a_bench_aggregate_get(void)
+{
+    uint32_t i;
+    uint32_t mode;
+    sfa30_aggregate_result_t result;
+
+    for (i = 0; i < gs_aggregate.windows; i++)
+    {
+        for (mode = SFA30_AGGREGATE_MODE_SLIDING; mode <= SFA30_AGGREGATE_MODE_PARTIAL; mode++)
+        {
+            if (sfa30_aggregate_get(&gs_aggregate, i, (sfa30_aggregate_mode_t)mode, &result) != 0)
+            {
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief     run the windowed aggregate benchmarks
+ * @param[in] iterations iterations
+ * @return    status code
+ *            - 0 success
+ *            - 1 run failed
+ * @note      run it after a_bench_codec, it pushes the codec samples, ops_per_sec x 4096
+ *            is the samples per second, a get reads the 9 results of the 3 windows in the 3 modes
+ */
+static uint8_t a_bench_aggregate(uint32_t iterations)
+{
+    uint32_t index;
+
+    if ((sfa30_aggregate_init(&gs_aggregate) != 0) ||
+        (sfa30_aggregate_add_window(&gs_aggregate, 10000, &gs_aggregate_slot[0], 32, &index) != 0) ||
+        (sfa30_aggregate_add_window(&gs_aggregate, 60000, &gs_aggregate_slot[32], 128, &index) != 0) ||
+        (sfa30_aggregate_add_window(&gs_aggregate, 900000, &gs_aggregate_slot[160], 2048, &index) != 0))
+    {
+        return 1;
+    }
+    if (a_bench_crc_run("sfa30_aggregate_push", a_bench_aggregate_push, BENCH_CODEC_SAMPLES * 6,
+                        (iterations / 16) + 1) != 0)
+    {
+        return 1;
+    }
+    if (a_bench_crc_run("sfa30_aggregate_get", a_bench_aggregate_get, 9 * sizeof(sfa30_aggregate_result_t), iterations) != 0)
+    {
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief  bench quantile add operation
+ * @return status code
+ * @note   adds the codec samples
+ */
+static uint8_t a_bench_quantile_add(void)
+{
+    uint32_t i;
+
+    for (i = 0; i < BENCH_CODEC_SAMPLES; i++)
+    {
+        (void)sfa30_quantile_add(&gs_quantile[0], &gs_codec_data[i]);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief  bench quantile get operation
+ * @return status code
+ * @note   reads p50, p95 and p99
+ */
+static uint8_t a_bench_quantile_get(void)
+{
+    int16_t raw;
+
+    if ((sfa30_quantile_get(&gs_quantile[0], 5000, &raw) != 0) ||
+        (sfa30_quantile_get(&gs_quantile[0], 9500, &raw) != 0) ||
+        (sfa30_quantile_get(&gs_quantile[0], 9900, &raw) != 0))
+    {
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief  bench quantile merge operation
+ * @return status code
+ * @note   merges one sketch into another
+ */
+static uint8_t a_bench_quantile_merge(void)
+{
+    return sfa30_quantile_merge(&gs_quantile[1], &gs_quantile[0]);
+}
+
+/**
+ * @brief     run the quantile sketch benchmarks
+ * @param[in] iterations iterations
+ * @return    status code
+ *            - 0 success
+ *            - 1 run failed
+ * @note      run it after a_bench_codec, it adds the codec samples, ops_per_sec x 4096
+ *            is the samples per second
+ */
+static uint8_t a_bench_quantile(uint32_t iterations)
+{
+    (void)sfa30_quantile_init(&gs_quantile[0]);
+    (void)sfa30_quantile_init(&gs_quantile[1]);
+    if (a_bench_crc_run("sfa30_quantile_add", a_bench_quantile_add, BENCH_CODEC_SAMPLES * 2,
+                        (iterations / 16) + 1) != 0)
+    {
+        return 1;
+    }
+    if (a_bench_crc_run("sfa30_quantile_get", a_bench_quantile_get, 3 * sizeof(int16_t), iterations) != 0)
+    {
+        return 1;
+    }
+    if (a_bench_crc_run("sfa30_quantile_merge", a_bench_quantile_merge, sizeof(sfa30_quantile_t), iterations) != 0)
+    {
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief  bench deadband filter operation
+ * @return status code
+ * @note   filters the codec samples
+ */
+static uint8_t a_bench_deadband_filter(void)
+{
+    uint32_t i;
+    uint8_t report;
+
+    for (i = 0; i < BENCH_CODEC_SAMPLES; i++)
+    {
+        (void)sfa30_deadband_filter(&gs_deadband, gs_codec_timestamp[i], &gs_codec_data[i], &report);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief     run the deadband filter benchmark
+ * @param[in] iterations iterations
+ * @return    status code
+ *            - 0 success
+ *            - 1 run failed
+ * @note      run it after a_bench_codec, it filters the codec samples with a 1 ppb,
+ *            0.5 % and 0.1 C band, ops_per_sec x 4096 is the samples per second
+ */
+static uint8_t a_bench_deadband(uint32_t iterations)
+{
+    const sfa30_deadband_config_t config = {{5, 0, 1}, {50, 0, 1}, {20, 0, 1}, 60000};
+
+    (void)sfa30_deadband_init(&gs_deadband, &config);
+    if (a_bench_crc_run("sfa30_deadband_filter", a_bench_deadband_filter, BENCH_CODEC_SAMPLES * 6,
+                        (iterations / 16) + 1) != 0)
+    {
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief     run all benchmarks of one interface
+ * @param[in] interface chip interface
+ * @param[in] iterations iterations
+ * @return    status code
+ *            - 0 success
+ *            - 1 run failed
+ * @note      none
+ */
+static uint8_t a_bench_interface(sfa30_interface_t interface, uint32_t iterations)
+{
+    const char *name = (interface == SFA30_INTERFACE_IIC) ? "iic" : "uart";
+
+    /* link functions */
+    DRIVER_SFA30_LINK_INIT(&gs_handle, sfa30_handle_t);
+    DRIVER_SFA30_LINK_UART_INIT(&gs_handle, sfa30_emulator_uart_init);
+    DRIVER_SFA30_LINK_UART_DEINIT(&gs_handle, sfa30_emulator_uart_deinit);
+    DRIVER_SFA30_LINK_UART_READ(&gs_handle, sfa30_emulator_uart_read);
+    DRIVER_SFA30_LINK_UART_WRITE(&gs_handle, sfa30_emulator_uart_write);
+    DRIVER_SFA30_LINK_UART_FLUSH(&gs_handle, sfa30_emulator_uart_flush);
+    DRIVER_SFA30_LINK_IIC_INIT(&gs_handle, sfa30_emulator_iic_init);
+    DRIVER_SFA30_LINK_IIC_DEINIT(&gs_handle, sfa30_emulator_iic_deinit);
+    DRIVER_SFA30_LINK_IIC_WRITE_COMMAND(&gs_handle, sfa30_emulator_iic_write_cmd);
+    DRIVER_SFA30_LINK_IIC_READ_COMMAND(&gs_handle, sfa30_emulator_iic_read_cmd);
+    DRIVER_SFA30_LINK_DELAY_MS(&gs_handle, sfa30_emulator_delay_ms);
+    DRIVER_SFA30_LINK_DEBUG_PRINT(&gs_handle, sfa30_emulator_debug_print);
+    DRIVER_SFA30_LINK_SCRATCH(&gs_handle, gs_scratch);
+
+    /* zero latency sensor */
+    sfa30_emulator_power_on();
+    if (sfa30_set_interface(&gs_handle, interface) != 0)
+    {
+        return 1;
+    }
+    if (sfa30_init(&gs_handle) != 0)
+    {
+        return 1;
+    }
+
+    /* measurement is stopped before each start */
+    if (a_bench_run("sfa30_start_measurement", name, a_bench_start, a_bench_stop, iterations) != 0)
+    {
+        (void)sfa30_deinit(&gs_handle);
+
+        return 1;
+    }
+    if (a_bench_run("sfa30_read", name, a_bench_read, NULL, iterations) != 0)
+    {
+        (void)sfa30_deinit(&gs_handle);
+
+        return 1;
+    }
+    if (a_bench_run("sfa30_get_device_information", name, a_bench_device_information, NULL, iterations) != 0)
+    {
+        (void)sfa30_deinit(&gs_handle);
+
+        return 1;
+    }
+    if (interface == SFA30_INTERFACE_UART)
+    {
+        if (a_bench_run("shdlc_encode_decode", name, a_bench_shdlc, NULL, iterations) != 0)
+        {
+            (void)sfa30_deinit(&gs_handle);
+
+            return 1;
+        }
+    }
+    (void)sfa30_stop_measurement(&gs_handle);
+    (void)sfa30_deinit(&gs_handle);
+
+    return 0;
+}
+
+/**
+ * @brief print the results
+ * @note  none
+ */
+static void a_bench_print(void)
+{
+    uint32_t i;
+
+    if (gs_json != 0)
+    {
+        (void)printf("{\n  \"benchmarks\": [\n");
+        for (i = 0; i < gs_result_count; i++)
+        {
+            bench_result_t *r = &gs_results[i];
+
+            (void)printf("    {\"name\": \"%s\", \"interface\": \"%s\", \"iterations\": %u, "
+                         "\"ns_per_op\": %.1f, \"bytes_per_op\": %.1f, \"p50_ns\": %llu, "
+                         "\"p99_ns\": %llu, \"p999_ns\": %llu, \"ops_per_sec\": %.0f, \"cycles_per_byte\": %.2f}%s\n",
+                         r->name, r->interface, r->iterations, r->ns_per_op, r->bytes_per_op,
+                         (unsigned long long)r->p50_ns, (unsigned long long)r->p99_ns,
+                         (unsigned long long)r->p999_ns, r->ops_per_sec, r->cycles_per_byte,
+                         (i + 1 < gs_result_count) ? "," : "");
+        }
+        (void)printf("  ]\n}\n");
+    }
+    else
+    {
+        (void)printf("%-32s %-6s %10s %10s %8s %8s %8s %12s %12s\n",
+                     "benchmark", "bus", "ns/op", "bytes/op", "p50", "p99", "p99.9", "ops/s", "cycles/byte");
+        for (i = 0; i < gs_result_count; i++)
+        {
+            bench_result_t *r = &gs_results[i];
+
+            (void)printf("%-32s %-6s %10.1f %10.1f %8llu %8llu %8llu %12.0f %12.2f\n",
+                         r->name, r->interface, r->ns_per_op, r->bytes_per_op,
+                         (unsigned long long)r->p50_ns, (unsigned long long)r->p99_ns,
+                         (unsigned long long)r->p999_ns, r->ops_per_sec, r->cycles_per_byte);
+        }
+    }
+}
+
+/**
+ * @brief     main function
+ * @param[in] argc arg numbers
+ * @param[in] **argv arg address
+ * @return    status code
+ *            - 0 success
+ *            - 1 run failed
+ *            - 5 param is invalid
+ * @note      none
+ */
+int main(int argc, char **argv)
+{
+    int c;
+    int longindex = 0;
+    uint32_t iterations = 100000;
+    const char short_options[] = "hjn:";
+    const struct option long_options[] =
+    {
+        {"help", no_argument, NULL, 'h'},
+        {"json", no_argument, NULL, 'j'},
+        {"iterations", required_argument, NULL, 'n'},
+        {NULL, 0, NULL, 0},
+    };
+
+    /* parse */
+    do
+    {
+        c = getopt_long(argc, argv, short_options, long_options, &longindex);
+        switch (c)
+        {
+            case 'h' :
+            {
+                (void)printf("Usage:\n");
+                (void)printf("  sfa30_bench [-j | --json] [-n <num> | --iterations=<num>]\n");
+                (void)printf("\n");
+                (void)printf("Options:\n");
+                (void)printf("  -h, --help                              Show the help.\n");
+                (void)printf("  -j, --json                              Output machine readable json.\n");
+                (void)printf("  -n <num>, --iterations=<num>            Set the iterations of each benchmark.([default: 100000])\n");
+
+                return 0;
+            }
+            case 'j' :
+            {
+                gs_json = 1;
+
+                break;
+            }
+            case 'n' :
+            {
+                iterations = (uint32_t)atol(optarg);
+
+                break;
+            }
+            case -1 :
+            {
+                break;
+            }
+            default :
+            {
+                (void)printf("sfa30_bench: param is invalid.\n");
+
+                return 5;
+            }
+        }
+    } while (c != -1);
+    if (iterations == 0)
+    {
+        (void)printf("sfa30_bench: param is invalid.\n");
+
+        return 5;
+    }
+
+    /* run */
+    gs_samples = (uint64_t *)malloc(sizeof(uint64_t) * iterations);
+    if (gs_samples == NULL)
+    {
+        (void)printf("sfa30_bench: malloc failed.\n");
+
+        return 1;
+    }
+    if ((a_bench_interface(SFA30_INTERFACE_IIC, iterations) != 0) ||
+        (a_bench_interface(SFA30_INTERFACE_UART, iterations) != 0) ||
+        (a_bench_crc(iterations) != 0) ||
+        (a_bench_decode(iterations) != 0) ||
+        (a_bench_codec(iterations) != 0) ||
+        (a_bench_aggregate(iterations) != 0) ||
+        (a_bench_quantile(iterations) != 0) ||
+        (a_bench_deadband(iterations) != 0))
+    {
+        (void)printf("sfa30_bench: run failed.\n");
+        free(gs_samples);
+
+        return 1;
+    }
+    a_bench_print();
+    free(gs_samples);
+
+    return 0;
+}
@@ -0,0 +1,327 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @file      log_test.c
+ * @brief     sfa30 binary sample log test source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2023-07-30
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2023/07/30  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#include "sfa30_log.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+/**
+ * @brief log test definition
+ */
+#define LOG_TEST_SENSORS         3                      /**< interleaved sensors */
+#define LOG_TEST_SAMPLES         300000                 /**< samples of the first session */
+#define LOG_TEST_MORE            30000                  /**< samples appended by the second session */
+#define LOG_TEST_GAP_AT          100000                 /**< sample followed by a 100 s outage */
+#define LOG_TEST_EPOCH_MS        1690675200000ULL       /**< 2023-07-30 00:00:00 utc */
+
+/**
+ * @brief      make the sample with an index
+ * @param[in]  index sample index
+ * @param[out] *sample pointer to a sample buffer
+ * @note       sensors report 2 ms apart in reverse order, so the log sees small steps back in time
+ */
+static void a_log_test_make(uint32_t index, sfa30_log_sample_t *sample)
+{
+    uint32_t sensor = index % LOG_TEST_SENSORS;
+
+    sample->sensor = (uint16_t)sensor;
+    sample->time_ms = LOG_TEST_EPOCH_MS + (uint64_t)(index / LOG_TEST_SENSORS) * 500 +
+                      (LOG_TEST_SENSORS - 1 - sensor) * 2 + ((index > LOG_TEST_GAP_AT) ? 100000 : 0);
+    sample->formaldehyde_raw = (int16_t)((index * 7) & 0x7FFF);
+    sample->humidity_raw = (int16_t)(4500 + (index % 100));
+    sample->temperature_raw = (int16_t)(-200 + (int32_t)(index % 9000));
+}
+
+/**
+ * @brief     write samples through a writer
+ * @param[in] *path pointer to a log path
+ * @param[in] first first sample index
+ * @param[in] count samples
+ * @return    status code
+ *            - 0 success
+ *            - 1 write failed
+ * @note      none
+ */
+static uint8_t a_log_test_write(const char *path, uint32_t first, uint32_t count)
+{
+    uint32_t i;
+    sfa30_log_writer_t writer;
+    sfa30_log_sample_t sample;
+
+    if (sfa30_log_writer_open(&writer, path, 0, LOG_TEST_EPOCH_MS) != 0)
+    {
+        return 1;
+    }
+    for (i = first; i < first + count; i++)
+    {
+        a_log_test_make(i, &sample);
+        if (sfa30_log_writer_append(&writer, &sample) != 0)
+        {
+            (void)sfa30_log_writer_close(&writer);
+
+            return 1;
+        }
+    }
+    sample.sensor = SFA30_LOG_CHECKPOINT;
+    if (sfa30_log_writer_append(&writer, &sample) != 4)
+    {
+        (void)sfa30_log_writer_close(&writer);
+
+        return 1;
+    }
+
+    /* a 32 bit ms clock wrapping steps back by 2^32 ms */
+    a_log_test_make(first + count - 1, &sample);
+    sample.time_ms -= 0x100000000ULL;
+    if (sfa30_log_writer_append(&writer, &sample) != 5)
+    {
+        (void)sfa30_log_writer_close(&writer);
+
+        return 1;
+    }
+
+    return sfa30_log_writer_close(&writer);
+}
+
+/**
+ * @brief     append a session whose clock trails the log
+ * @param[in] *path pointer to a log path
+ * @param[in] index sample index of the trailing clock
+ * @return    status code
+ *            - 0 success
+ *            - 1 the sample was not rejected
+ * @note      a board without a real time clock starts behind until its time is synced
+ */
+static uint8_t a_log_test_behind(const char *path, uint32_t index)
+{
+    sfa30_log_writer_t writer;
+    sfa30_log_sample_t sample;
+    uint8_t res;
+
+    if (sfa30_log_writer_open(&writer, path, 0, LOG_TEST_EPOCH_MS) != 0)
+    {
+        return 1;
+    }
+    a_log_test_make(index, &sample);
+    res = sfa30_log_writer_append(&writer, &sample);
+    if (sfa30_log_writer_close(&writer) != 0)
+    {
+        return 1;
+    }
+
+    return (res == 5) ? 0 : 1;
+}
+
+/**
+ * @brief  get the monotonic time
+ * @return time in s
+ * @note   none
+ */
+static double a_log_test_now(void)
+{
+    struct timespec ts;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief     run the log test
+ * @param[in] *path pointer to a log path
+ * @return    status code
+ *            - 0 success
+ *            - 1 test failed
+ * @note      none
+ */
+static uint8_t a_log_test_run(const char *path)
+{
+    int fd;
+    uint32_t i;
+    uint32_t checkpoints = 0;
+    uint64_t j;
+    int64_t sum = 0;
+    double t;
+    double bytes_per_sample;
+    struct stat st;
+    sfa30_log_reader_t reader;
+    sfa30_log_sample_t sample;
+    sfa30_log_sample_t expected;
+
+    /* write, tear the tail as a crash would, then append */
+    (void)unlink(path);
+    if (a_log_test_write(path, 0, LOG_TEST_SAMPLES) != 0)
+    {
+        (void)printf("log_test: write failed.\n");
+
+        return 1;
+    }
+    fd = open(path, O_WRONLY | O_APPEND);
+    if ((fd < 0) || (write(fd, "torn", 3) != 3))
+    {
+        (void)printf("log_test: tear failed.\n");
+
+        return 1;
+    }
+    (void)close(fd);
+    if (a_log_test_write(path, LOG_TEST_SAMPLES, LOG_TEST_MORE) != 0)
+    {
+        (void)printf("log_test: append failed.\n");
+
+        return 1;
+    }
+    if (a_log_test_behind(path, LOG_TEST_SAMPLES) != 0)
+    {
+        (void)printf("log_test: trailing clock check failed.\n");
+
+        return 1;
+    }
+
+    /* read every sample back */
+    if (sfa30_log_reader_open(&reader, path) != 0)
+    {
+        (void)printf("log_test: open failed.\n");
+
+        return 1;
+    }
+    for (i = 0; i < LOG_TEST_SAMPLES + LOG_TEST_MORE; i++)
+    {
+        a_log_test_make(i, &expected);
+        if ((sfa30_log_reader_next(&reader, &sample) != 0) || (sample.time_ms != expected.time_ms) ||
+            (sample.sensor != expected.sensor) || (sample.formaldehyde_raw != expected.formaldehyde_raw) ||
+            (sample.humidity_raw != expected.humidity_raw) || (sample.temperature_raw != expected.temperature_raw))
+        {
+            (void)printf("log_test: sample %u is wrong.\n", i);
+            (void)sfa30_log_reader_close(&reader);
+
+            return 1;
+        }
+    }
+    if (sfa30_log_reader_next(&reader, &sample) != 1)
+    {
+        (void)printf("log_test: end is wrong.\n");
+        (void)sfa30_log_reader_close(&reader);
+
+        return 1;
+    }
+
+    /* size, only the interval, the 16 bit delta range, the outage and the reopen add checkpoints */
+    for (j = 0; j < reader.count; j++)
+    {
+        checkpoints += (reader.records[j].sensor == SFA30_LOG_CHECKPOINT) ? 1 : 0;
+    }
+    (void)stat(path, &st);
+    bytes_per_sample = (double)st.st_size / (LOG_TEST_SAMPLES + LOG_TEST_MORE);
+    (void)printf("log_test: %u samples, %u checkpoints, %0.3f bytes per sample.\n",
+                 LOG_TEST_SAMPLES + LOG_TEST_MORE, checkpoints, bytes_per_sample);
+    if ((checkpoints > (LOG_TEST_SAMPLES + LOG_TEST_MORE) / SFA30_LOG_CHECKPOINT_INTERVAL +
+                       (uint32_t)((expected.time_ms - LOG_TEST_EPOCH_MS) / (0xFFFF - SFA30_LOG_CHECKPOINT_SLACK_MS)) + 3) ||
+        (bytes_per_sample > sizeof(sfa30_log_record_t) * 1.01))
+    {
+        (void)printf("log_test: size check failed.\n");
+        (void)sfa30_log_reader_close(&reader);
+
+        return 1;
+    }
+
+    /* seek lands at a checkpoint before the time and within reach of it */
+    for (i = 0; i < LOG_TEST_SAMPLES + LOG_TEST_MORE; i += 12345)
+    {
+        a_log_test_make(i, &expected);
+        (void)sfa30_log_reader_seek(&reader, expected.time_ms);
+        j = 0;
+        while ((sfa30_log_reader_next(&reader, &sample) == 0) && (sample.formaldehyde_raw != expected.formaldehyde_raw))
+        {
+            j++;
+        }
+        if ((sample.time_ms != expected.time_ms) || (j > 2 * SFA30_LOG_CHECKPOINT_INTERVAL))
+        {
+            (void)printf("log_test: seek to sample %u failed.\n", i);
+            (void)sfa30_log_reader_close(&reader);
+
+            return 1;
+        }
+    }
+
+    /* scan speed of the mapped records */
+    t = a_log_test_now();
+    for (j = 0; j < reader.count; j++)
+    {
+        sum += reader.records[j].formaldehyde_raw;
+    }
+    t = a_log_test_now() - t;
+    (void)printf("log_test: scanned %llu records at %0.0f MB/s (sum %lld).\n", (unsigned long long)reader.count,
+                 (double)(reader.count * sizeof(sfa30_log_record_t)) / ((t > 0.0) ? t : 1e-9) / 1e6, (long long)sum);
+    (void)sfa30_log_reader_close(&reader);
+
+    return 0;
+}
+
+/**
+ * @brief  main function
+ * @return status code
+ *         - 0 success
+ *         - 1 run failed
+ * @note   none
+ */
+int main(void)
+{
+    uint8_t res;
+    char path[64];
+
+    (void)snprintf(path, sizeof(path), "/tmp/sfa30_log_test_%d.bin", (int)getpid());
+    if ((sizeof(sfa30_log_header_t) != 32) || (sizeof(sfa30_log_record_t) != 10))
+    {
+        (void)printf("log_test: layout is wrong.\n");
+
+        return 1;
+    }
+    res = a_log_test_run(path);
+    (void)unlink(path);
+    if (res != 0)
+    {
+        (void)printf("log_test: run failed.\n");
+
+        return 1;
+    }
+    (void)printf("log_test: finish log test.\n");
+
+    return 0;
+}
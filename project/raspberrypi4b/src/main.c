@@ -35,6 +35,7 @@
  */
 
 #include "driver_sfa30_read_test.h"
+#include "driver_sfa30_emulator_test.h"
 #include "driver_sfa30_basic.h"
 #include <getopt.h>
 #include <stdlib.h>
@@ -192,6 +193,16 @@ uint8_t sfa30(uint8_t argc, char **argv)
         
         return 0;
     }
+    else if (strcmp("t_emulator", type) == 0)
+    {
+        /* emulator test */
+        if (sfa30_emulator_test(interface, times) != 0)
+        {
+            return 1;
+        }
+        
+        return 0;
+    }
     else if (strcmp("e_read", type) == 0)
     {
         uint8_t res;
@@ -205,7 +216,7 @@ uint8_t sfa30(uint8_t argc, char **argv)
         }
         
         /* delay 2000 ms */
-        sfa30_interface_delay_ms(2000);
+        sfa30_interface_delay_ms(NULL, 2000);
         
         /* loop */
         for (i = 0; i < times; i++)
@@ -223,12 +234,24 @@ uint8_t sfa30(uint8_t argc, char **argv)
             
             /* print */
             sfa30_interface_debug_print("sfa30: %d/%d.\n", i + 1, times);
+#if (SFA30_FLOAT_DATA != 0)
             sfa30_interface_debug_print("sfa30: formaldehyde is %0.2fppb.\n", data.formaldehyde);
             sfa30_interface_debug_print("sfa30: humidity is %0.2f%%.\n", data.humidity);
             sfa30_interface_debug_print("sfa30: temperature is %0.2fC.\n", data.temperature);
+#else
+            sfa30_interface_debug_print("sfa30: formaldehyde is %d.%01dppb.\n",
+                                        (int)(sfa30_formaldehyde_convert_to_ppb_x10(data.formaldehyde_raw) / 10),
+                                        (int)(sfa30_formaldehyde_convert_to_ppb_x10(data.formaldehyde_raw) % 10));
+            sfa30_interface_debug_print("sfa30: humidity is %d.%02d%%.\n",
+                                        (int)(sfa30_humidity_convert_to_rh_x100(data.humidity_raw) / 100),
+                                        (int)(sfa30_humidity_convert_to_rh_x100(data.humidity_raw) % 100));
+            sfa30_interface_debug_print("sfa30: temperature is %s%d.%03dC.\n", (data.temperature_raw < 0) ? "-" : "",
+                                        (int)(labs(sfa30_temperature_convert_to_mc(data.temperature_raw)) / 1000),
+                                        (int)(labs(sfa30_temperature_convert_to_mc(data.temperature_raw)) % 1000));
+#endif
             
             /* delay 2000 ms */
-            sfa30_interface_delay_ms(2000);
+            sfa30_interface_delay_ms(NULL, 2000);
         }
         
         /* deinit */
@@ -272,6 +295,7 @@ uint8_t sfa30(uint8_t argc, char **argv)
         sfa30_interface_debug_print("  sfa30 (-h | --help)\n");
         sfa30_interface_debug_print("  sfa30 (-p | --port)\n");
         sfa30_interface_debug_print("  sfa30 (-t read | --test=read) [--interface=<iic | uart>] [--times=<num>]\n");
+        sfa30_interface_debug_print("  sfa30 (-t emulator | --test=emulator) [--interface=<iic | uart>] [--times=<num>]\n");
         sfa30_interface_debug_print("  sfa30 (-e read | --example=read) [--interface=<iic | uart>] [--times=<num>]\n");
         sfa30_interface_debug_print("  sfa30 (-e sn | --example=sn) [--interface=<iic | uart>]\n");
         sfa30_interface_debug_print("\n");
@@ -282,7 +306,8 @@ uint8_t sfa30(uint8_t argc, char **argv)
         sfa30_interface_debug_print("  -i, --information                       Show the chip information.\n");
         sfa30_interface_debug_print("      --interface=<iic | uart>            Set the chip interface.([default: iic])\n");
         sfa30_interface_debug_print("  -p, --port                              Display the pin connections of the current board.\n");
-        sfa30_interface_debug_print("  -t <read>, --test=<read>                Run the driver test.\n");
+        sfa30_interface_debug_print("  -t <read | emulator>, --test=<read | emulator>\n");
+        sfa30_interface_debug_print("                                          Run the driver test.\n");
         sfa30_interface_debug_print("      --times=<num>                       Set the running times.([default: 3])\n");
         
         return 0;
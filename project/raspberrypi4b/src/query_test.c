@@ -0,0 +1,412 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @file      query_test.c
+ * @brief     sfa30 query server test source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2023-07-30
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2023/07/30  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#include "sfa30_query.h"
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+/**
+ * @brief query test definition
+ */
+#define QUERY_TEST_SENSORS        8              /**< emulated sensors */
+#define QUERY_TEST_QUERIES        2000           /**< queries of the throughput test */
+#define QUERY_TEST_MIN_QPS        500            /**< min queries per second one client must get */
+
+static uint8_t gs_reply[SFA30_QUERY_MAX_REPLY];        /**< reply buffer */
+
+/**
+ * @brief  get the monotonic time
+ * @return time in ms
+ * @note   none
+ */
+static double a_query_test_now_ms(void)
+{
+    struct timespec ts;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (double)ts.tv_sec * 1000.0 + (double)ts.tv_nsec / 1e6;
+}
+
+/**
+ * @brief     read exactly len bytes
+ * @param[in] fd socket
+ * @param[out] *buf pointer to a data buffer
+ * @param[in] len bytes to read
+ * @return    status code
+ *            - 0 success
+ *            - 1 read failed
+ * @note      none
+ */
+static uint8_t a_query_test_read(int fd, uint8_t *buf, size_t len)
+{
+    ssize_t l;
+
+    while (len != 0)
+    {
+        l = read(fd, buf, len);
+        if (l <= 0)
+        {
+            return 1;
+        }
+        buf += l;
+        len -= (size_t)l;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief      run one binary query
+ * @param[in]  fd socket
+ * @param[in]  type query type
+ * @param[in]  first first sensor
+ * @param[in]  count sensors
+ * @param[in]  span_ms window
+ * @param[in]  step_ms range step
+ * @param[out] *reply pointer to a reply header buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 query failed
+ * @note       the reply body is left in gs_reply
+ */
+static uint8_t a_query_test_binary(int fd, uint8_t type, uint16_t first, uint16_t count,
+                                   uint32_t span_ms, uint32_t step_ms, sfa30_query_reply_t *reply)
+{
+    sfa30_query_request_t request;
+
+    memset(&request, 0, sizeof(request));
+    request.magic = SFA30_QUERY_MAGIC;
+    request.type = type;
+    request.first = first;
+    request.count = count;
+    request.span_ms = span_ms;
+    request.step_ms = step_ms;
+    if ((write(fd, &request, sizeof(request)) != (ssize_t)sizeof(request)) ||
+        (a_query_test_read(fd, (uint8_t *)reply, sizeof(sfa30_query_reply_t)) != 0) ||
+        (reply->magic != SFA30_QUERY_MAGIC) || (reply->length > sizeof(gs_reply)) ||
+        (a_query_test_read(fd, gs_reply, reply->length) != 0))
+    {
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief      run one text query
+ * @param[in]  fd socket
+ * @param[in]  *line pointer to a request line
+ * @param[out] *out pointer to a reply line buffer
+ * @param[in]  size buffer size
+ * @return     status code
+ *             - 0 success
+ *             - 1 query failed
+ * @note       none
+ */
+static uint8_t a_query_test_text(int fd, const char *line, char *out, size_t size)
+{
+    size_t len = 0;
+
+    if (write(fd, line, strlen(line)) != (ssize_t)strlen(line))
+    {
+        return 1;
+    }
+    while (len + 1 < size)
+    {
+        if (read(fd, out + len, 1) != 1)
+        {
+            return 1;
+        }
+        if (out[len++] == '\n')
+        {
+            break;
+        }
+    }
+    out[len] = '\0';
+
+    return 0;
+}
+
+/**
+ * @brief     check the sensor blocks of a binary reply
+ * @param[in] *reply pointer to a reply header
+ * @param[in] first expected first sensor
+ * @param[in] count expected sensors
+ * @param[in] min_samples min samples per sensor
+ * @param[in] step_ms range step, 0 for raw samples
+ * @return    status code
+ *            - 0 success
+ *            - 1 check failed
+ * @note      none
+ */
+static uint8_t a_query_test_blocks(const sfa30_query_reply_t *reply, uint16_t first, uint16_t count,
+                                   uint32_t min_samples, uint32_t step_ms)
+{
+    uint32_t i;
+    uint32_t j;
+    size_t offset = 0;
+    sfa30_query_block_t block;
+    sfa30_query_sample_t sample;
+    sfa30_query_sample_t last;
+
+    if ((reply->status != SFA30_QUERY_STATUS_OK) || (reply->first != first) || (reply->count != count))
+    {
+        return 1;
+    }
+    for (i = 0; i < count; i++)
+    {
+        memcpy(&block, gs_reply + offset, sizeof(block));
+        offset += sizeof(block);
+        if ((block.sensor != first + i) || (block.samples < min_samples))
+        {
+            return 1;
+        }
+        for (j = 0; j < block.samples; j++)
+        {
+            memcpy(&sample, gs_reply + offset, sizeof(sample));
+            offset += sizeof(sample);
+            if ((sample.formaldehyde_raw == 0) || (sample.timestamp_ms > reply->now_ms) ||
+                ((j != 0) && (sample.timestamp_ms <= last.timestamp_ms)) ||
+                ((j != 0) && (step_ms != 0) && ((sample.timestamp_ms - last.timestamp_ms) % step_ms != 0)))
+            {
+                return 1;
+            }
+            last = sample;
+        }
+    }
+
+    return (offset == reply->length) ? 0 : 1;
+}
+
+/**
+ * @brief     run the queries against a running daemon
+ * @param[in] fd socket
+ * @return    status code
+ *            - 0 success
+ *            - 1 test failed
+ * @note      none
+ */
+static uint8_t a_query_test_run(int fd)
+{
+    uint32_t i;
+    double start;
+    double qps;
+    char line[4096];
+    sfa30_query_reply_t reply;
+    sfa30_query_block_t block;
+    sfa30_query_aggregate_t aggregate;
+
+    /* latest of every sensor in one reply */
+    if ((a_query_test_binary(fd, SFA30_QUERY_LATEST, 0, 0, 0, 0, &reply) != 0) ||
+        (a_query_test_blocks(&reply, 0, QUERY_TEST_SENSORS, 1, 0) != 0))
+    {
+        (void)printf("query_test: latest failed.\n");
+
+        return 1;
+    }
+
+    /* range of sensors 3-7, raw and at 1 s resolution */
+    if ((a_query_test_binary(fd, SFA30_QUERY_RANGE, 3, 5, 60000, 0, &reply) != 0) ||
+        (a_query_test_blocks(&reply, 3, 5, 3, 0) != 0) ||
+        (a_query_test_binary(fd, SFA30_QUERY_RANGE, 3, 5, 60000, 1000, &reply) != 0) ||
+        (a_query_test_blocks(&reply, 3, 5, 1, 1000) != 0))
+    {
+        (void)printf("query_test: range failed.\n");
+
+        return 1;
+    }
+
+    /* aggregate */
+    if ((a_query_test_binary(fd, SFA30_QUERY_AGGREGATE, 2, 1, 60000, 0, &reply) != 0) ||
+        (reply.status != SFA30_QUERY_STATUS_OK) ||
+        (reply.length != sizeof(block) + sizeof(aggregate)))
+    {
+        (void)printf("query_test: aggregate failed.\n");
+
+        return 1;
+    }
+    memcpy(&block, gs_reply, sizeof(block));
+    memcpy(&aggregate, gs_reply + sizeof(block), sizeof(aggregate));
+    for (i = 0; i < 3; i++)
+    {
+        if ((block.samples < 3) || (aggregate.min[i] > aggregate.mean[i]) || (aggregate.mean[i] > aggregate.max[i]))
+        {
+            (void)printf("query_test: aggregate failed.\n");
+
+            return 1;
+        }
+    }
+
+    /* errors */
+    if ((a_query_test_binary(fd, SFA30_QUERY_LATEST, QUERY_TEST_SENSORS, 1, 0, 0, &reply) != 0) ||
+        (reply.status != SFA30_QUERY_STATUS_BAD_SENSOR) || (reply.length != 0) ||
+        (a_query_test_binary(fd, 9, 0, 1, 0, 0, &reply) != 0) || (reply.status != SFA30_QUERY_STATUS_BAD_REQUEST))
+    {
+        (void)printf("query_test: error reply failed.\n");
+
+        return 1;
+    }
+
+    /* json lines */
+    if ((a_query_test_text(fd, "latest 0-1\n", line, sizeof(line)) != 0) ||
+        (strncmp(line, "{\"type\":\"latest\"", 16) != 0) || (strstr(line, "\"sensor\":1,") == NULL))
+    {
+        (void)printf("query_test: json latest failed.\n");
+
+        return 1;
+    }
+    if ((a_query_test_text(fd, "aggregate all 60000\n", line, sizeof(line)) != 0) ||
+        (strstr(line, "\"mean\":[") == NULL) ||
+        (a_query_test_text(fd, "range 9 1000\n", line, sizeof(line)) != 0) ||
+        (strcmp(line, "{\"error\":\"bad sensor\"}\n") != 0) ||
+        (a_query_test_text(fd, "bogus\n", line, sizeof(line)) != 0) ||
+        (strcmp(line, "{\"error\":\"bad request\"}\n") != 0))
+    {
+        (void)printf("query_test: json query failed.\n");
+
+        return 1;
+    }
+
+    /* request and response throughput of one client */
+    start = a_query_test_now_ms();
+    for (i = 0; i < QUERY_TEST_QUERIES; i++)
+    {
+        if ((a_query_test_binary(fd, SFA30_QUERY_RANGE, 0, 0, 60000, 1000, &reply) != 0) ||
+            (reply.status != SFA30_QUERY_STATUS_OK))
+        {
+            (void)printf("query_test: throughput query failed.\n");
+
+            return 1;
+        }
+    }
+    qps = QUERY_TEST_QUERIES * 1000.0 / (a_query_test_now_ms() - start);
+    (void)printf("query_test: %0.0f queries/s.\n", qps);
+    if (qps < QUERY_TEST_MIN_QPS)
+    {
+        (void)printf("query_test: throughput is too low.\n");
+
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief     main function
+ * @param[in] argc arg numbers
+ * @param[in] **argv arg address
+ * @return    status code
+ *            - 0 success
+ *            - 1 run failed
+ *            - 5 param is invalid
+ * @note      argv[1] is the sfa30d binary
+ */
+int main(int argc, char **argv)
+{
+    int fd;
+    int status;
+    uint32_t i;
+    uint8_t res;
+    pid_t pid;
+    char path[64];
+    char sensors[16];
+    struct sockaddr_un addr;
+
+    if (argc != 2)
+    {
+        (void)printf("Usage:\n");
+        (void)printf("  sfa30_query_test <sfa30d>\n");
+
+        return 5;
+    }
+
+    /* start the daemon */
+    (void)snprintf(path, sizeof(path), "/tmp/sfa30_query_test_%d.sock", (int)getpid());
+    (void)snprintf(sensors, sizeof(sensors), "--emulate=%d", QUERY_TEST_SENSORS);
+    pid = fork();
+    if (pid < 0)
+    {
+        (void)printf("query_test: fork failed.\n");
+
+        return 1;
+    }
+    if (pid == 0)
+    {
+        (void)execl(argv[1], argv[1], sensors, "--stats=0", "--duration=60", "--socket", path, (char *)NULL);
+        _exit(127);
+    }
+
+    /* wait for the socket and a few samples */
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    (void)strcpy(addr.sun_path, path);
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    for (i = 0; (i < 500) && (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0); i++)
+    {
+        (void)usleep(10000);
+    }
+    if (i == 500)
+    {
+        (void)printf("query_test: connect failed.\n");
+        (void)kill(pid, SIGTERM);
+        (void)waitpid(pid, &status, 0);
+
+        return 1;
+    }
+    (void)usleep(1600 * 1000);
+
+    res = a_query_test_run(fd);
+    (void)close(fd);
+    (void)kill(pid, SIGTERM);
+    (void)waitpid(pid, &status, 0);
+    if ((res != 0) || (!WIFEXITED(status)) || (WEXITSTATUS(status) != 0))
+    {
+        (void)printf("query_test: run failed.\n");
+
+        return 1;
+    }
+    (void)printf("query_test: finish query test.\n");
+
+    return 0;
+}
@@ -0,0 +1,315 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @file      ring_test.c
+ * @brief     sfa30 shared memory ring test source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2023-07-30
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2023/07/30  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#include "sfa30_ring.h"
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+/**
+ * @brief ring test definition
+ */
+#define RING_TEST_CAPACITY        8              /**< small ring so the tests lap it */
+#define RING_TEST_RACE_CAPACITY   64             /**< ring of the concurrent test */
+#define RING_TEST_RECORDS         2000000        /**< records published by the concurrent test */
+
+/**
+ * @brief     make a record whose fields all derive from its index
+ * @param[in] index record index
+ * @param[out] *record pointer to a record buffer
+ * @note      none
+ */
+static void a_ring_test_make(uint32_t index, sfa30_ring_record_t *record)
+{
+    record->sensor = index;
+    record->timestamp_ms = index * 7;
+    record->formaldehyde_raw = (int16_t)index;
+    record->humidity_raw = (int16_t)(index >> 16);
+    record->temperature_raw = (int16_t)~index;
+    record->reserved = 0;
+}
+
+/**
+ * @brief     check a record against its index
+ * @param[in] *record pointer to a record
+ * @return    status code
+ *            - 0 success
+ *            - 1 record is torn
+ * @note      none
+ */
+static uint8_t a_ring_test_check(const sfa30_ring_record_t *record)
+{
+    sfa30_ring_record_t expected;
+
+    a_ring_test_make(record->sensor, &expected);
+
+    return (memcmp(record, &expected, sizeof(sfa30_ring_record_t)) == 0) ? 0 : 1;
+}
+
+/**
+ * @brief     read records and check their order
+ * @param[in] *ring pointer to an sfa30 ring structure
+ * @param[in] first expected first index
+ * @param[in] count expected records
+ * @return    status code
+ *            - 0 success
+ *            - 1 test failed
+ * @note      the ring must be empty afterwards
+ */
+static uint8_t a_ring_test_expect(sfa30_ring_t *ring, uint32_t first, uint32_t count)
+{
+    uint32_t i;
+    sfa30_ring_record_t record;
+
+    for (i = 0; i < count; i++)
+    {
+        if ((sfa30_ring_read(ring, &record) != 0) || (record.sensor != first + i) ||
+            (a_ring_test_check(&record) != 0))
+        {
+            return 1;
+        }
+    }
+
+    return (sfa30_ring_read(ring, &record) == 1) ? 0 : 1;
+}
+
+/**
+ * @brief     run the single process tests
+ * @param[in] *name pointer to a shared memory name
+ * @return    status code
+ *            - 0 success
+ *            - 1 test failed
+ * @note      none
+ */
+static uint8_t a_ring_test_basic(const char *name)
+{
+    uint32_t i;
+    sfa30_ring_t producer;
+    sfa30_ring_t a;
+    sfa30_ring_t b;
+    sfa30_ring_record_t record;
+
+    if ((sizeof(sfa30_ring_header_t) != 128) || (sizeof(sfa30_ring_slot_t) != 32) ||
+        (sizeof(sfa30_ring_record_t) != SFA30_RING_RECORD_WORDS * 4))
+    {
+        (void)printf("ring_test: layout is wrong.\n");
+
+        return 1;
+    }
+    if ((sfa30_ring_create(&producer, name, 6) != 4) || (sfa30_ring_create(&producer, "noslash", 8) != 4))
+    {
+        (void)printf("ring_test: invalid param is accepted.\n");
+
+        return 1;
+    }
+    if (sfa30_ring_create(&producer, name, RING_TEST_CAPACITY) != 0)
+    {
+        (void)printf("ring_test: create failed.\n");
+
+        return 1;
+    }
+    if ((sfa30_ring_open(&a, name) != 0) || (sfa30_ring_open(&b, name) != 0))
+    {
+        (void)printf("ring_test: open failed.\n");
+        (void)sfa30_ring_close(&producer);
+
+        return 1;
+    }
+
+    /* independent cursors */
+    for (i = 0; i < 5; i++)
+    {
+        a_ring_test_make(i, &record);
+        (void)sfa30_ring_publish(&producer, &record);
+    }
+    if ((sfa30_ring_publish(&a, &record) != 3) || (a_ring_test_expect(&a, 0, 5) != 0) || (a.lost != 0))
+    {
+        (void)printf("ring_test: read failed.\n");
+        (void)sfa30_ring_close(&producer);
+
+        return 1;
+    }
+
+    /* overrun, a was 20 behind and b 25 behind an 8 record ring */
+    for (i = 5; i < 25; i++)
+    {
+        a_ring_test_make(i, &record);
+        (void)sfa30_ring_publish(&producer, &record);
+    }
+    if ((a_ring_test_expect(&a, 17, 8) != 0) || (a.lost != 12) ||
+        (a_ring_test_expect(&b, 17, 8) != 0) || (b.lost != 17))
+    {
+        (void)printf("ring_test: overrun check failed.\n");
+        (void)sfa30_ring_close(&producer);
+
+        return 1;
+    }
+
+    /* rewind and close */
+    if ((sfa30_ring_rewind(&a) != 0) || (a_ring_test_expect(&a, 17, 8) != 0))
+    {
+        (void)printf("ring_test: rewind failed.\n");
+        (void)sfa30_ring_close(&producer);
+
+        return 1;
+    }
+    (void)sfa30_ring_close(&producer);
+    if ((sfa30_ring_read(&a, &record) != 1) || (sfa30_ring_open(&producer, name) != 1))
+    {
+        (void)printf("ring_test: close failed.\n");
+
+        return 1;
+    }
+    (void)sfa30_ring_close(&a);
+    (void)sfa30_ring_close(&b);
+    (void)printf("ring_test: basic test passed.\n");
+
+    return 0;
+}
+
+/**
+ * @brief     race a producer process against a consumer
+ * @param[in] *name pointer to a shared memory name
+ * @return    status code
+ *            - 0 success
+ *            - 1 test failed
+ * @note      every record read must be whole and in order, read plus lost must add up
+ */
+static uint8_t a_ring_test_race(const char *name)
+{
+    int status;
+    int exited = 0;
+    uint32_t i;
+    uint32_t next = 0;
+    uint32_t got = 0;
+    uint8_t res = 0;
+    pid_t pid;
+    sfa30_ring_t producer;
+    sfa30_ring_t consumer;
+    sfa30_ring_record_t record;
+
+    if ((sfa30_ring_create(&producer, name, RING_TEST_RACE_CAPACITY) != 0) || (sfa30_ring_open(&consumer, name) != 0))
+    {
+        (void)printf("ring_test: open failed.\n");
+        (void)sfa30_ring_close(&producer);
+
+        return 1;
+    }
+    pid = fork();
+    if (pid < 0)
+    {
+        (void)printf("ring_test: fork failed.\n");
+        (void)sfa30_ring_close(&producer);
+
+        return 1;
+    }
+    if (pid == 0)
+    {
+        for (i = 0; i < RING_TEST_RECORDS; i++)
+        {
+            a_ring_test_make(i, &record);
+            (void)sfa30_ring_publish(&producer, &record);
+        }
+        _exit(0);
+    }
+
+    /* consume until the last record */
+    while (next < RING_TEST_RECORDS)
+    {
+        if (sfa30_ring_read(&consumer, &record) != 0)
+        {
+            if (exited != 0)
+            {
+                /* the producer is gone and the last record never came */
+                res = 1;
+
+                break;
+            }
+            exited = (waitpid(pid, &status, WNOHANG) == pid) ? 1 : 0;
+
+            continue;
+        }
+        if ((record.sensor < next) || (a_ring_test_check(&record) != 0))
+        {
+            res = 1;
+
+            break;
+        }
+        next = record.sensor + 1;
+        got++;
+    }
+    if (exited == 0)
+    {
+        (void)waitpid(pid, &status, 0);
+    }
+    if ((res != 0) || (got + consumer.lost != RING_TEST_RECORDS))
+    {
+        (void)printf("ring_test: race test failed, %u read, %llu lost.\n", got, (unsigned long long)consumer.lost);
+        res = 1;
+    }
+    else
+    {
+        (void)printf("ring_test: race test passed, %u read, %llu lost.\n", got, (unsigned long long)consumer.lost);
+    }
+    (void)sfa30_ring_close(&consumer);
+    (void)sfa30_ring_close(&producer);
+
+    return res;
+}
+
+/**
+ * @brief  main function
+ * @return status code
+ *         - 0 success
+ *         - 1 run failed
+ * @note   none
+ */
+int main(void)
+{
+    char name[64];
+
+    (void)snprintf(name, sizeof(name), "/sfa30_ring_test_%d", (int)getpid());
+    if ((a_ring_test_basic(name) != 0) || (a_ring_test_race(name) != 0))
+    {
+        (void)printf("ring_test: run failed.\n");
+
+        return 1;
+    }
+    (void)printf("ring_test: finish ring test.\n");
+
+    return 0;
+}
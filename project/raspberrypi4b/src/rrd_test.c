@@ -0,0 +1,437 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @file      rrd_test.c
+ * @brief     sfa30 round robin database test source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2023-07-30
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2023/07/30  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#include "sfa30_rrd.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+/**
+ * @brief rrd test definition
+ */
+#define RRD_TEST_SAMPLES         518400                 /**< 3 days at 2 Hz */
+#define RRD_TEST_OUTAGE_AT       511200                 /**< sample followed by a 600 s outage, 1 h before the end */
+#define RRD_TEST_GAP_AT          518300                 /**< sample followed by a 30 s gap, 50 s before the end */
+#define RRD_TEST_EPOCH_MS        1690675200000ULL       /**< 2023-07-30 00:00:00 utc */
+#define RRD_TEST_DAY_MS          86400000ULL            /**< 1 day */
+#define RRD_TEST_MAX             512                    /**< fetch buffer slots */
+#define RRD_TEST_WRAP_MS         4294965296ULL          /**< daemon clock 2 s before the 32 bit ms wrap */
+
+/**
+ * @brief rrd test ring slots
+ */
+static const uint32_t gs_slots[SFA30_RRD_RINGS] = {120, 180, 48, 10};
+
+/**
+ * @brief rrd test fetch buffer
+ */
+static sfa30_rrd_slot_t gs_out[RRD_TEST_MAX];
+
+/**
+ * @brief      make the sample with an index
+ * @param[in]  index sample index
+ * @param[out] *raw pointer to a raw values buffer
+ * @return     sample time
+ * @note       none
+ */
+static uint64_t a_rrd_test_make(uint32_t index, int16_t *raw)
+{
+    raw[0] = (int16_t)((int32_t)((index * 37U) % 2001U) - 1000);
+    raw[1] = (int16_t)(4500 + (index % 700));
+    raw[2] = (int16_t)((int32_t)((index * 13U) % 9000U) - 2000);
+
+    return RRD_TEST_EPOCH_MS + (uint64_t)index * 500 + ((index > RRD_TEST_OUTAGE_AT) ? 600000 : 0) +
+           ((index > RRD_TEST_GAP_AT) ? 30000 : 0);
+}
+
+/**
+ * @brief     get the first sample at or after a time
+ * @param[in] time_ms time
+ * @return    sample index
+ * @note      none
+ */
+static uint32_t a_rrd_test_lower(uint64_t time_ms)
+{
+    uint32_t lo = 0;
+    uint32_t hi = RRD_TEST_SAMPLES;
+    uint32_t mid;
+    int16_t raw[3];
+
+    while (lo < hi)
+    {
+        mid = lo + (hi - lo) / 2;
+        if (a_rrd_test_make(mid, raw) < time_ms)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+
+    return lo;
+}
+
+/**
+ * @brief     check a slot against the samples it covers
+ * @param[in] *slot pointer to a slot
+ * @param[in] begin_ms slot begin
+ * @param[in] step_ms slot length
+ * @return    status code
+ *            - 0 success
+ *            - 1 slot is wrong
+ * @note      none
+ */
+static uint8_t a_rrd_test_check(const sfa30_rrd_slot_t *slot, uint64_t begin_ms, uint32_t step_ms)
+{
+    uint32_t i;
+    uint32_t c;
+    uint32_t first = a_rrd_test_lower(begin_ms);
+    uint32_t last = a_rrd_test_lower(begin_ms + step_ms);
+    int16_t raw[3];
+    int16_t min[3] = {0, 0, 0};
+    int16_t max[3] = {0, 0, 0};
+    int64_t sum[3] = {0, 0, 0};
+    int64_t mean;
+
+    if (slot->count != last - first)
+    {
+        return 1;
+    }
+    for (i = first; i < last; i++)
+    {
+        (void)a_rrd_test_make(i, raw);
+        for (c = 0; c < 3; c++)
+        {
+            min[c] = ((i == first) || (raw[c] < min[c])) ? raw[c] : min[c];
+            max[c] = ((i == first) || (raw[c] > max[c])) ? raw[c] : max[c];
+            sum[c] += raw[c];
+        }
+    }
+    for (c = 0; (c < 3) && (slot->count != 0); c++)
+    {
+        mean = (sum[c] >= 0) ? (sum[c] + slot->count / 2) / slot->count : -((-sum[c] + slot->count / 2) / slot->count);
+        if ((slot->mean[c] != mean) || (slot->min[c] != min[c]) || (slot->max[c] != max[c]))
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief     feed a database across the 32 bit ms wrap of the daemon clock
+ * @param[in] *path pointer to a database path
+ * @return    status code
+ *            - 0 success
+ *            - 1 wrap check failed
+ * @note      the daemon dates a sample with the wall clock at its start plus the 64 bit daemon
+ *            time elapsed since, the low 32 bits alone step back by 2^32 ms at the wrap
+ */
+static uint8_t a_rrd_test_wrap(const char *path)
+{
+    uint8_t res = 0;
+    uint32_t i;
+    uint32_t count;
+    uint32_t step_ms;
+    uint32_t samples = 0;
+    uint64_t clock_ms;
+    uint64_t first_ms;
+    sfa30_rrd_t rrd;
+
+    (void)unlink(path);
+    if (sfa30_rrd_open(&rrd, path, gs_slots, RRD_TEST_EPOCH_MS) != 0)
+    {
+        return 1;
+    }
+    for (i = 0; (i < 10) && (res == 0); i++)
+    {
+        clock_ms = RRD_TEST_WRAP_MS + (uint64_t)i * 500;
+        if (sfa30_rrd_update(&rrd, RRD_TEST_EPOCH_MS + (clock_ms - RRD_TEST_WRAP_MS), (int16_t)i, 5000, 5000) != 0)
+        {
+            res = 1;
+        }
+    }
+    if ((res == 0) &&
+        (sfa30_rrd_update(&rrd, RRD_TEST_EPOCH_MS + (uint32_t)clock_ms - RRD_TEST_WRAP_MS, 0, 0, 0) != 5))
+    {
+        res = 1;
+    }
+    if ((res == 0) &&
+        (sfa30_rrd_fetch(&rrd, RRD_TEST_EPOCH_MS, RRD_TEST_EPOCH_MS + 5000, 1000,
+                         gs_out, RRD_TEST_MAX, &count, &first_ms, &step_ms) != 0))
+    {
+        res = 1;
+    }
+    for (i = 0; (i < count) && (res == 0); i++)
+    {
+        samples += gs_out[i].count;
+    }
+    if ((res == 0) && (samples != 10))
+    {
+        res = 1;
+    }
+    if (sfa30_rrd_close(&rrd) != 0)
+    {
+        res = 1;
+    }
+
+    return res;
+}
+
+/**
+ * @brief     write samples into a database
+ * @param[in] *path pointer to a database path
+ * @param[in] first first sample index
+ * @param[in] count samples
+ * @return    status code
+ *            - 0 success
+ *            - 1 write failed
+ * @note      none
+ */
+static uint8_t a_rrd_test_write(const char *path, uint32_t first, uint32_t count)
+{
+    uint32_t i;
+    uint64_t time_ms;
+    int16_t raw[3];
+    sfa30_rrd_t rrd;
+
+    if (sfa30_rrd_open(&rrd, path, gs_slots, RRD_TEST_EPOCH_MS) != 0)
+    {
+        return 1;
+    }
+    for (i = first; i < first + count; i++)
+    {
+        time_ms = a_rrd_test_make(i, raw);
+        if (sfa30_rrd_update(&rrd, time_ms, raw[0], raw[1], raw[2]) != 0)
+        {
+            (void)sfa30_rrd_close(&rrd);
+
+            return 1;
+        }
+    }
+
+    return sfa30_rrd_close(&rrd);
+}
+
+/**
+ * @brief  get the monotonic time
+ * @return time in s
+ * @note   none
+ */
+static double a_rrd_test_now(void)
+{
+    struct timespec ts;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief     run the rrd test
+ * @param[in] *path pointer to a database path
+ * @return    status code
+ *            - 0 success
+ *            - 1 test failed
+ * @note      none
+ */
+static uint8_t a_rrd_test_run(const char *path)
+{
+    uint8_t res;
+    uint32_t r;
+    uint32_t i;
+    uint32_t count;
+    uint32_t step_ms;
+    uint64_t first_ms;
+    uint64_t last_ms;
+    double t;
+    struct stat st;
+    sfa30_rrd_t rrd;
+
+    /* write two sessions, the second one keeps the layout of the file */
+    (void)unlink(path);
+    if ((a_rrd_test_write(path, 0, RRD_TEST_SAMPLES / 2) != 0) ||
+        (a_rrd_test_write(path, RRD_TEST_SAMPLES / 2, RRD_TEST_SAMPLES / 2) != 0))
+    {
+        (void)printf("rrd_test: write failed.\n");
+
+        return 1;
+    }
+    if (sfa30_rrd_open(&rrd, path, NULL, RRD_TEST_EPOCH_MS) != 0)
+    {
+        (void)printf("rrd_test: open failed.\n");
+
+        return 1;
+    }
+    (void)stat(path, &st);
+    if ((rrd.header->ring[0].slots != gs_slots[0]) ||
+        ((uint64_t)st.st_size != sizeof(sfa30_rrd_header_t) + (120 + 180 + 48 + 10) * sizeof(sfa30_rrd_slot_t)))
+    {
+        (void)printf("rrd_test: layout is wrong.\n");
+        (void)sfa30_rrd_close(&rrd);
+
+        return 1;
+    }
+
+    /* every slot a ring keeps, wrapped many times and cleared over the outage and the gap */
+    for (r = 0; r < SFA30_RRD_RINGS; r++)
+    {
+        last_ms = rrd.header->ring[r].last_ms;
+        step_ms = rrd.header->ring[r].step_ms;
+        res = sfa30_rrd_fetch(&rrd, last_ms - (uint64_t)(gs_slots[r] - 1) * step_ms, last_ms + step_ms - 1,
+                              step_ms, gs_out, RRD_TEST_MAX, &count, &first_ms, &step_ms);
+        if ((res != 0) || (count != gs_slots[r]) || (step_ms != rrd.header->ring[r].step_ms))
+        {
+            (void)printf("rrd_test: fetch of ring %u failed.\n", r);
+            (void)sfa30_rrd_close(&rrd);
+
+            return 1;
+        }
+        for (i = 0; i < count; i++)
+        {
+            if (a_rrd_test_check(&gs_out[i], first_ms + (uint64_t)i * step_ms, step_ms) != 0)
+            {
+                (void)printf("rrd_test: ring %u slot %u is wrong.\n", r, i);
+                (void)sfa30_rrd_close(&rrd);
+
+                return 1;
+            }
+        }
+    }
+
+    /* a range the fine rings have dropped is read from a coarser ring */
+    res = sfa30_rrd_fetch(&rrd, RRD_TEST_EPOCH_MS, rrd.header->ring[0].last_ms, 1000,
+                          gs_out, RRD_TEST_MAX, &count, &first_ms, &step_ms);
+    if ((res != 0) || (step_ms != RRD_TEST_DAY_MS) || (count != 4) || (first_ms != RRD_TEST_EPOCH_MS) ||
+        (a_rrd_test_check(&gs_out[0], first_ms, step_ms) != 0) || (gs_out[0].count != 172800))
+    {
+        (void)printf("rrd_test: coarse fetch failed.\n");
+        (void)sfa30_rrd_close(&rrd);
+
+        return 1;
+    }
+
+    /* a short buffer reports the slots needed, older samples are refused */
+    last_ms = rrd.header->ring[0].last_ms;
+    if ((sfa30_rrd_fetch(&rrd, last_ms - 3600000, last_ms, 60000, gs_out, 60, &count, &first_ms, &step_ms) != 4) ||
+        (count != 61) || (sfa30_rrd_update(&rrd, last_ms - 1, 0, 0, 0) != 5))
+    {
+        (void)printf("rrd_test: limit check failed.\n");
+        (void)sfa30_rrd_close(&rrd);
+
+        return 1;
+    }
+    if (sfa30_rrd_close(&rrd) != 0)
+    {
+        (void)printf("rrd_test: close failed.\n");
+
+        return 1;
+    }
+
+    /* the samples of a daemon keep consolidating across its clock wrap */
+    if (a_rrd_test_wrap(path) != 0)
+    {
+        (void)printf("rrd_test: wrap check failed.\n");
+
+        return 1;
+    }
+
+    /* a default database charts a year from 366 day slots */
+    (void)unlink(path);
+    if (sfa30_rrd_open(&rrd, path, NULL, RRD_TEST_EPOCH_MS) != 0)
+    {
+        (void)printf("rrd_test: default open failed.\n");
+
+        return 1;
+    }
+    t = a_rrd_test_now();
+    for (i = 0; i < 1000000; i++)
+    {
+        (void)sfa30_rrd_update(&rrd, RRD_TEST_EPOCH_MS + (uint64_t)i * 500, (int16_t)(i & 0x3FF), 5000, 5000);
+    }
+    t = a_rrd_test_now() - t;
+    last_ms = RRD_TEST_EPOCH_MS + (uint64_t)(i - 1) * 500;
+    res = sfa30_rrd_fetch(&rrd, last_ms - 365 * RRD_TEST_DAY_MS, last_ms, RRD_TEST_DAY_MS,
+                          gs_out, RRD_TEST_MAX, &count, &first_ms, &step_ms);
+    (void)printf("rrd_test: %u byte database, %0.1f ns per update, a year in %u slots.\n",
+                 (uint32_t)rrd.size, t * 1e9 / i, count);
+    if ((res != 0) || (count != 366) || (step_ms != RRD_TEST_DAY_MS) || (gs_out[365].count == 0))
+    {
+        (void)printf("rrd_test: year fetch failed.\n");
+        (void)sfa30_rrd_close(&rrd);
+
+        return 1;
+    }
+
+    return sfa30_rrd_close(&rrd);
+}
+
+/**
+ * @brief  main function
+ * @return status code
+ *         - 0 success
+ *         - 1 run failed
+ * @note   none
+ */
+int main(void)
+{
+    uint8_t res;
+    char path[64];
+
+    (void)snprintf(path, sizeof(path), "/tmp/sfa30_rrd_test_%d.rrd", (int)getpid());
+    if ((sizeof(sfa30_rrd_slot_t) != 24) || (sizeof(sfa30_rrd_ring_t) != 64))
+    {
+        (void)printf("rrd_test: layout is wrong.\n");
+
+        return 1;
+    }
+    res = a_rrd_test_run(path);
+    (void)unlink(path);
+    if (res != 0)
+    {
+        (void)printf("rrd_test: run failed.\n");
+
+        return 1;
+    }
+    (void)printf("rrd_test: finish rrd test.\n");
+
+    return 0;
+}
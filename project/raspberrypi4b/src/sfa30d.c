@@ -0,0 +1,1095 @@
+/**
+ * Copyright (C) LibDriver 2015-2021 All rights reserved
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @file      sfa30d.c
+ * @brief     sfa30 sampling daemon source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2023-07-30
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2023/07/30  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#include "driver_sfa30_sampling.h"
+#include "driver_sfa30_emulator.h"
+#include "driver_sfa30_deadband.h"
+#include "raspberrypi4b_driver_sfa30_interface.h"
+#include "sfa30_ring.h"
+#include "sfa30_query.h"
+#include "sfa30_log.h"
+#include "sfa30_rrd.h"
+#include <getopt.h>
+#include <stdio.h>
+#include <limits.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/signalfd.h>
+#include <sys/timerfd.h>
+
+/**
+ * @brief sfa30d limits definition
+ */
+#define SFA30D_MAX_SENSORS        256        /**< max sensors served by one daemon */
+#define SFA30D_MAX_EVENTS         64         /**< max events handled per wakeup */
+#define SFA30D_POLL_MS            5          /**< poll interval of a uart without a file descriptor */
+#define SFA30D_SERVICE_LOOPS      4          /**< max state changes handled per wakeup */
+#define SFA30D_RING_SAMPLES       16         /**< ring records kept per sensor, 8 s at 2 Hz */
+#define SFA30D_HISTORY_SAMPLES    2048       /**< default history per sensor, 17 min at 2 Hz */
+
+/**
+ * @brief sfa30d event type enumeration definition
+ */
+typedef enum
+{
+    SFA30D_EVENT_TIMER  = 0x00,        /**< sensor deadline */
+    SFA30D_EVENT_TTY    = 0x01,        /**< sensor uart is readable */
+    SFA30D_EVENT_SIGNAL = 0x02,        /**< SIGINT or SIGTERM */
+    SFA30D_EVENT_STATS  = 0x03,        /**< statistics period */
+    SFA30D_EVENT_STOP   = 0x04,        /**< run duration elapsed */
+    SFA30D_EVENT_QUERY  = 0x05,        /**< query server has work */
+} sfa30d_event_t;
+
+/**
+ * @brief sfa30d sensor structure definition
+ */
+typedef struct sfa30d_sensor_s
+{
+    sfa30_handle_t handle;                /**< sfa30 handle */
+    sfa30_sampling_t sampling;            /**< sampling state */
+    sfa30_history_t history;              /**< recent samples answering the queries */
+    sfa30_history_sample_t *history_buf;  /**< history buffer, NULL without --socket */
+    sfa30_interface_port_t port;          /**< raspberrypi4b port, unused when emulated */
+    sfa30_rrd_t rrd;                      /**< round robin database, unused without --rrd */
+    sfa30_deadband_t deadband;            /**< report by exception filter, unused without --deadband */
+    uint8_t *scratch;                     /**< uart scratch buffer */
+    int timer_fd;                         /**< deadline timer */
+    uint32_t last_sequence;               /**< last published snapshot sequence */
+    uint32_t samples;                     /**< published samples */
+    uint32_t rrd_rejected;                /**< samples the rrd rejected as out of order */
+    uint32_t rrd_errors;                  /**< rrd sync failures */
+    uint8_t emulated;                     /**< emulated sensor flag */
+    char name[40];                        /**< sensor name */
+} sfa30d_sensor_t;
+
+static sfa30d_sensor_t *gs_sensors;                  /**< sensors */
+static uint32_t gs_sensor_count;                     /**< sensor count */
+static int gs_epoll_fd = -1;                         /**< epoll handle */
+static struct timespec gs_start;                     /**< daemon start time */
+static uint32_t gs_emulator_offset_ms;               /**< emulator clock at the daemon start */
+static uint8_t gs_emulate;                           /**< emulator flag */
+static uint8_t gs_print;                             /**< print each sample flag */
+static sfa30_ring_t gs_ring;                         /**< shared memory ring, unused without --ring */
+static sfa30_query_server_t gs_server;               /**< query server, unused without --socket */
+static sfa30_history_t **gs_histories;               /**< history of each sensor for the query server */
+static sfa30_log_writer_t gs_log;                    /**< binary log, unused without --log */
+static uint32_t gs_log_rejected;                     /**< samples the log rejected as out of order */
+static uint64_t gs_epoch_ms;                         /**< wall clock at the daemon start */
+static uint64_t gs_clock_start_ms;                   /**< daemon clock at the daemon start, 0 unless --clock */
+static uint8_t gs_deadband;                          /**< deadband filter flag */
+
+/**
+ * @brief  get the daemon time
+ * @return time in ms, gs_clock_start_ms at the daemon start
+ * @note   64 bit, only its low 32 bits go to the driver and the sampling, which compare wrap safely
+ */
+static uint64_t a_sfa30d_now_ms(void)
+{
+    struct timespec ts;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return gs_clock_start_ms + (uint64_t)((ts.tv_sec - gs_start.tv_sec) * 1000 + (ts.tv_nsec - gs_start.tv_nsec) / 1000000);
+}
+
+/**
+ * @brief     extend a 32 bit daemon time to 64 bits
+ * @param[in] now_ms daemon time in ms
+ * @param[in] ms low 32 bits of a daemon time within 24 days of now_ms
+ * @return    daemon time in ms
+ * @note      none
+ */
+static uint64_t a_sfa30d_extend_ms(uint64_t now_ms, uint32_t ms)
+{
+    return now_ms + (uint64_t)(int64_t)(int32_t)(ms - (uint32_t)now_ms);
+}
+
+/**
+ * @brief     arm a timer at an absolute daemon time
+ * @param[in] fd timer handle
+ * @param[in] at_ms daemon time in ms
+ * @param[in] interval_ms period in ms, 0 means one shot
+ * @return    status code
+ *            - 0 success
+ *            - 1 arm failed
+ * @note      a time in the past fires at once
+ */
+static uint8_t a_sfa30d_arm(int fd, uint64_t at_ms, uint32_t interval_ms)
+{
+    struct itimerspec its;
+    uint64_t ns;
+
+    at_ms = (at_ms > gs_clock_start_ms) ? (at_ms - gs_clock_start_ms) : 0;
+    ns = (uint64_t)gs_start.tv_nsec + at_ms * 1000000ULL;
+    its.it_value.tv_sec = gs_start.tv_sec + (time_t)(ns / 1000000000ULL);
+    its.it_value.tv_nsec = (long)(ns % 1000000000ULL);
+    its.it_interval.tv_sec = (time_t)(interval_ms / 1000);
+    its.it_interval.tv_nsec = (long)(interval_ms % 1000) * 1000000L;
+    if (timerfd_settime(fd, TFD_TIMER_ABSTIME, &its, NULL) != 0)
+    {
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief     add a file descriptor to the event loop
+ * @param[in] fd file descriptor
+ * @param[in] type event type
+ * @param[in] index sensor index
+ * @return    status code
+ *            - 0 success
+ *            - 1 add failed
+ * @note      none
+ */
+static uint8_t a_sfa30d_watch(int fd, sfa30d_event_t type, uint32_t index)
+{
+    struct epoll_event ev;
+
+    ev.events = EPOLLIN;
+    ev.data.u64 = ((uint64_t)type << 32) | index;
+    if (epoll_ctl(gs_epoll_fd, EPOLL_CTL_ADD, fd, &ev) != 0)
+    {
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief     publish a sample
+ * @param[in] *sensor pointer to a sensor structure
+ * @param[in] *data pointer to an sfa30_data_t structure
+ * @param[in] time_ms sample time in daemon time
+ * @note      the rrd consolidates every sample and the deadband filter drops the redundant ones
+ *            before the ring, the log and the printout, the history behind the queries is fed
+ *            by the sampling itself and also sees every sample, no sfa30_aggregate is attached
+ */
+static void a_sfa30d_publish(sfa30d_sensor_t *sensor, const sfa30_data_t *data, uint64_t time_ms)
+{
+    uint8_t report;
+    uint8_t res;
+    uint32_t timestamp_ms = (uint32_t)time_ms;
+    uint64_t epoch_ms = gs_epoch_ms + (time_ms - gs_clock_start_ms);
+    sfa30_ring_record_t record;
+    sfa30_log_sample_t sample;
+
+    sensor->samples++;
+    if (sensor->rrd.map != NULL)
+    {
+        res = sfa30_rrd_update(&sensor->rrd, epoch_ms, data->formaldehyde_raw,
+                               data->humidity_raw, data->temperature_raw);
+        if ((res == 5) && (sensor->rrd_rejected++ == 0))
+        {
+            (void)printf("sfa30d: rrd rejected an out of order sample of %s.\n", sensor->name);
+        }
+        else if ((res == 1) && (sensor->rrd_errors++ == 0))
+        {
+            (void)printf("sfa30d: rrd sync of %s failed.\n", sensor->name);
+        }
+    }
+    if ((gs_deadband != 0) && (sfa30_deadband_filter(&sensor->deadband, timestamp_ms, data, &report) == 0) &&
+        (report == 0))
+    {
+        return;
+    }
+    if (gs_ring.header != NULL)
+    {
+        record.sensor = (uint32_t)(sensor - gs_sensors);
+        record.timestamp_ms = timestamp_ms;
+        record.formaldehyde_raw = data->formaldehyde_raw;
+        record.humidity_raw = data->humidity_raw;
+        record.temperature_raw = data->temperature_raw;
+        record.reserved = 0;
+        (void)sfa30_ring_publish(&gs_ring, &record);
+    }
+    if (gs_log.buf != NULL)
+    {
+        sample.time_ms = epoch_ms;
+        sample.sensor = (uint16_t)(sensor - gs_sensors);
+        sample.formaldehyde_raw = data->formaldehyde_raw;
+        sample.humidity_raw = data->humidity_raw;
+        sample.temperature_raw = data->temperature_raw;
+        if ((sfa30_log_writer_append(&gs_log, &sample) == 5) && (gs_log_rejected++ == 0))
+        {
+            (void)printf("sfa30d: log rejected an out of order sample of %s.\n", sensor->name);
+        }
+    }
+    if (gs_print != 0)
+    {
+        (void)printf("%u.%03u %s: formaldehyde %0.1f ppb, humidity %0.2f %%, temperature %0.2f C.\n",
+                     timestamp_ms / 1000, timestamp_ms % 1000, sensor->name,
+                     (double)data->formaldehyde_raw / 5.0, (double)data->humidity_raw / 100.0,
+                     (double)data->temperature_raw / 200.0);
+    }
+}
+
+/**
+ * @brief     bring the emulator clock up to the daemon time
+ * @param[in] now_ms daemon time in ms
+ * @note      the blocking init leaves the emulator clock ahead, so it only moves forward
+ */
+static void a_sfa30d_emulator_sync(uint64_t now_ms)
+{
+    uint32_t target;
+    uint32_t emulator_ms;
+
+    target = gs_emulator_offset_ms + (uint32_t)(now_ms - gs_clock_start_ms);
+    emulator_ms = sfa30_emulator_get_time_ms();
+    if ((int32_t)(target - emulator_ms) > 0)
+    {
+        sfa30_emulator_advance_ms(target - emulator_ms);
+    }
+}
+
+/**
+ * @brief     service a sensor and rearm its deadline
+ * @param[in] *sensor pointer to a sensor structure
+ * @param[in] now_ms daemon time in ms
+ * @return    status code
+ *            - 0 success
+ *            - 1 service failed
+ * @note      it never blocks on a uart, an iic transfer is one short ioctl
+ */
+static uint8_t a_sfa30d_service(sfa30d_sensor_t *sensor, uint64_t now_ms)
+{
+    uint32_t i;
+    uint64_t wake_ms;
+    uint32_t timestamp_ms;
+    sfa30_read_state_t state;
+    sfa30_data_t data;
+
+    wake_ms = now_ms;
+    for (i = 0; i < SFA30D_SERVICE_LOOPS; i++)
+    {
+        /* advance the read, a failure is counted by the sampling */
+        (void)sfa30_sampling_poll(&sensor->sampling, (uint32_t)now_ms);
+
+        /* publish a new snapshot */
+        if (sensor->sampling.sequence != sensor->last_sequence)
+        {
+            sensor->last_sequence = sensor->sampling.sequence;
+            if (sfa30_sampling_load(&sensor->sampling, &data, &timestamp_ms) == 0)
+            {
+                a_sfa30d_publish(sensor, &data, a_sfa30d_extend_ms(now_ms, timestamp_ms));
+            }
+        }
+
+        /* work out the next wakeup */
+        if (sfa30_read_poll(&sensor->handle, (uint32_t)now_ms, &state) != 0)
+        {
+            return 1;
+        }
+        if (state == SFA30_READ_STATE_WAIT)
+        {
+            if (sensor->emulated != 0)
+            {
+                wake_ms = now_ms + SFA30D_POLL_MS;
+            }
+            else
+            {
+                /* sleep until the read deadline, a tty also wakes the loop as bytes arrive */
+                wake_ms = a_sfa30d_extend_ms(now_ms, sensor->handle.read_deadline);
+            }
+
+            break;
+        }
+        else if ((state == SFA30_READ_STATE_IDLE) && ((int32_t)((uint32_t)now_ms - sensor->sampling.next_ms) < 0))
+        {
+            wake_ms = a_sfa30d_extend_ms(now_ms, sensor->sampling.next_ms);
+
+            break;
+        }
+        else
+        {
+            /* ready to collect or already due, go round again */
+            wake_ms = now_ms;
+        }
+    }
+
+    return a_sfa30d_arm(sensor->timer_fd, wake_ms, 0);
+}
+
+/**
+ * @brief     open and start a sensor
+ * @param[in] *sensor pointer to a sensor structure
+ * @param[in] interface chip interface
+ * @param[in] *dev pointer to a device name, NULL for an emulated uart port
+ * @param[in] port emulator uart port
+ * @return    status code
+ *            - 0 success
+ *            - 1 open failed
+ * @note      init and start measurement block for a few seconds per sensor
+ */
+static uint8_t a_sfa30d_open(sfa30d_sensor_t *sensor, sfa30_interface_t interface, const char *dev, uint8_t port)
+{
+    uint8_t res;
+
+    memset(sensor, 0, sizeof(sfa30d_sensor_t));
+    sensor->timer_fd = -1;
+    DRIVER_SFA30_LINK_INIT(&sensor->handle, sfa30_handle_t);
+    if (dev == NULL)
+    {
+        sensor->emulated = 1;
+        (void)snprintf(sensor->name, sizeof(sensor->name), "emulator%u", port);
+        DRIVER_SFA30_LINK_UART_INIT(&sensor->handle, sfa30_emulator_uart_init);
+        DRIVER_SFA30_LINK_UART_DEINIT(&sensor->handle, sfa30_emulator_uart_deinit);
+        DRIVER_SFA30_LINK_UART_READ(&sensor->handle, sfa30_emulator_uart_read);
+        DRIVER_SFA30_LINK_UART_WRITE(&sensor->handle, sfa30_emulator_uart_write);
+        DRIVER_SFA30_LINK_UART_FLUSH(&sensor->handle, sfa30_emulator_uart_flush);
+        DRIVER_SFA30_LINK_IIC_INIT(&sensor->handle, sfa30_emulator_iic_init);
+        DRIVER_SFA30_LINK_IIC_DEINIT(&sensor->handle, sfa30_emulator_iic_deinit);
+        DRIVER_SFA30_LINK_IIC_READ_COMMAND(&sensor->handle, sfa30_emulator_iic_read_cmd);
+        DRIVER_SFA30_LINK_IIC_WRITE_COMMAND(&sensor->handle, sfa30_emulator_iic_write_cmd);
+        DRIVER_SFA30_LINK_DELAY_MS(&sensor->handle, sfa30_emulator_delay_ms);
+        DRIVER_SFA30_LINK_DEBUG_PRINT(&sensor->handle, sfa30_emulator_debug_print);
+        DRIVER_SFA30_LINK_USER(&sensor->handle, sfa30_emulator_get_uart_port(port));
+    }
+    else
+    {
+        (void)snprintf(sensor->name, sizeof(sensor->name), "%s", dev);
+        if (interface == SFA30_INTERFACE_IIC)
+        {
+            res = sfa30_interface_port_init(&sensor->port, dev, NULL);
+        }
+        else
+        {
+            res = sfa30_interface_port_init(&sensor->port, NULL, dev);
+        }
+        if (res != 0)
+        {
+            (void)printf("sfa30d: %s name is too long.\n", dev);
+
+            return 1;
+        }
+        DRIVER_SFA30_LINK_UART_INIT(&sensor->handle, sfa30_interface_uart_init);
+        DRIVER_SFA30_LINK_UART_DEINIT(&sensor->handle, sfa30_interface_uart_deinit);
+        DRIVER_SFA30_LINK_UART_READ(&sensor->handle, sfa30_interface_uart_read);
+        DRIVER_SFA30_LINK_UART_WRITE(&sensor->handle, sfa30_interface_uart_write);
+        DRIVER_SFA30_LINK_UART_FLUSH(&sensor->handle, sfa30_interface_uart_flush);
+        DRIVER_SFA30_LINK_IIC_INIT(&sensor->handle, sfa30_interface_iic_init);
+        DRIVER_SFA30_LINK_IIC_DEINIT(&sensor->handle, sfa30_interface_iic_deinit);
+        DRIVER_SFA30_LINK_IIC_READ_COMMAND(&sensor->handle, sfa30_interface_iic_read_cmd);
+        DRIVER_SFA30_LINK_IIC_WRITE_COMMAND(&sensor->handle, sfa30_interface_iic_write_cmd);
+        DRIVER_SFA30_LINK_DELAY_MS(&sensor->handle, sfa30_interface_delay_ms);
+        DRIVER_SFA30_LINK_DEBUG_PRINT(&sensor->handle, sfa30_interface_debug_print);
+        DRIVER_SFA30_LINK_USER(&sensor->handle, &sensor->port);
+    }
+    if (interface == SFA30_INTERFACE_UART)
+    {
+        sensor->scratch = (uint8_t *)malloc(SFA30_SCRATCH_SIZE);
+        if (sensor->scratch == NULL)
+        {
+            (void)printf("sfa30d: malloc failed.\n");
+
+            return 1;
+        }
+        DRIVER_SFA30_LINK_SCRATCH(&sensor->handle, sensor->scratch);
+    }
+
+    /* init and start measurement */
+    if (sfa30_set_interface(&sensor->handle, interface) != 0)
+    {
+        (void)printf("sfa30d: %s set interface failed.\n", sensor->name);
+
+        return 1;
+    }
+    if (sfa30_init(&sensor->handle) != 0)
+    {
+        (void)printf("sfa30d: %s init failed.\n", sensor->name);
+
+        return 1;
+    }
+    if (sfa30_start_measurement(&sensor->handle) != 0)
+    {
+        (void)printf("sfa30d: %s start measurement failed.\n", sensor->name);
+        (void)sfa30_deinit(&sensor->handle);
+
+        return 1;
+    }
+
+    /* the deadline timer */
+    sensor->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (sensor->timer_fd < 0)
+    {
+        (void)printf("sfa30d: timerfd create failed.\n");
+        (void)sfa30_stop_measurement(&sensor->handle);
+        (void)sfa30_deinit(&sensor->handle);
+
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief     stop and close a sensor
+ * @param[in] *sensor pointer to a sensor structure
+ * @note      none
+ */
+static void a_sfa30d_close(sfa30d_sensor_t *sensor)
+{
+    if (sensor->timer_fd >= 0)
+    {
+        (void)sfa30_read_cancel(&sensor->handle);
+        (void)sfa30_stop_measurement(&sensor->handle);
+        (void)sfa30_deinit(&sensor->handle);
+        (void)close(sensor->timer_fd);
+        sensor->timer_fd = -1;
+    }
+    free(sensor->scratch);
+    sensor->scratch = NULL;
+    free(sensor->history_buf);
+    sensor->history_buf = NULL;
+    (void)sfa30_rrd_close(&sensor->rrd);
+}
+
+/**
+ * @brief  get the cpu time
+ * @return user and system time in s
+ * @note   none
+ */
+static double a_sfa30d_cpu_s(void)
+{
+    struct rusage usage;
+
+    (void)getrusage(RUSAGE_SELF, &usage);
+
+    return (double)usage.ru_utime.tv_sec + (double)usage.ru_utime.tv_usec / 1e6 +
+           (double)usage.ru_stime.tv_sec + (double)usage.ru_stime.tv_usec / 1e6;
+}
+
+/**
+ * @brief     print the statistics
+ * @param[in] now_ms daemon time in ms
+ * @note      none
+ */
+static void a_sfa30d_print_stats(uint64_t now_ms)
+{
+    uint32_t i;
+    uint64_t samples = 0;
+    uint64_t errors = 0;
+    uint64_t reports = 0;
+    double wall_s;
+
+    for (i = 0; i < gs_sensor_count; i++)
+    {
+        samples += gs_sensors[i].samples;
+        errors += gs_sensors[i].sampling.errors;
+        reports += gs_sensors[i].deadband.reports;
+    }
+    wall_s = (now_ms != gs_clock_start_ms) ? ((double)(now_ms - gs_clock_start_ms) / 1000.0) : 1.0;
+    (void)printf("sfa30d: %u sensors, %llu samples, %llu errors, %0.1f samples/s, %0.2f%% cpu",
+                 gs_sensor_count, (unsigned long long)samples, (unsigned long long)errors,
+                 (double)samples / wall_s, 100.0 * a_sfa30d_cpu_s() / wall_s);
+    if (gs_histories != NULL)
+    {
+        (void)printf(", %u queries", gs_server.queries);
+    }
+    if ((gs_deadband != 0) && (reports != 0))
+    {
+        (void)printf(", %llu reported, %0.2fx reduction", (unsigned long long)reports,
+                     (double)samples / (double)reports);
+    }
+    (void)printf(".\n");
+    (void)fflush(stdout);
+}
+
+/**
+ * @brief     run the event loop
+ * @param[in] signal_fd signal handle
+ * @return    status code
+ *            - 0 success
+ *            - 1 run failed
+ * @note      one thread serves every sensor, it sleeps only in epoll_wait
+ */
+static uint8_t a_sfa30d_loop(int signal_fd)
+{
+    int i;
+    int n;
+    uint32_t index;
+    uint64_t now_ms;
+    uint64_t expirations;
+    sfa30d_event_t type;
+    sfa30_read_state_t state;
+    struct signalfd_siginfo info;
+    struct epoll_event events[SFA30D_MAX_EVENTS];
+
+    while (1)
+    {
+        n = epoll_wait(gs_epoll_fd, events, SFA30D_MAX_EVENTS, -1);
+        if (n < 0)
+        {
+            (void)printf("sfa30d: epoll wait failed.\n");
+
+            return 1;
+        }
+        now_ms = a_sfa30d_now_ms();
+        if (gs_emulate != 0)
+        {
+            a_sfa30d_emulator_sync(now_ms);
+        }
+        for (i = 0; i < n; i++)
+        {
+            type = (sfa30d_event_t)(events[i].data.u64 >> 32);
+            index = (uint32_t)(events[i].data.u64 & 0xFFFFFFFFU);
+            if (type == SFA30D_EVENT_TIMER)
+            {
+                (void)read(gs_sensors[index].timer_fd, &expirations, sizeof(expirations));
+                if (a_sfa30d_service(&gs_sensors[index], now_ms) != 0)
+                {
+                    (void)printf("sfa30d: %s service failed.\n", gs_sensors[index].name);
+
+                    return 1;
+                }
+            }
+            else if (type == SFA30D_EVENT_TTY)
+            {
+                if ((sfa30_read_poll(&gs_sensors[index].handle, (uint32_t)now_ms, &state) == 0) &&
+                    (state == SFA30_READ_STATE_IDLE))
+                {
+                    /* drop a late or unsolicited response so the level triggered fd goes quiet */
+                    (void)sfa30_interface_uart_flush(&gs_sensors[index].port);
+                }
+                else if (a_sfa30d_service(&gs_sensors[index], now_ms) != 0)
+                {
+                    (void)printf("sfa30d: %s service failed.\n", gs_sensors[index].name);
+
+                    return 1;
+                }
+            }
+            else if (type == SFA30D_EVENT_QUERY)
+            {
+                (void)sfa30_query_server_poll(&gs_server, (uint32_t)now_ms);
+            }
+            else if (type == SFA30D_EVENT_STATS)
+            {
+                (void)read((int)index, &expirations, sizeof(expirations));
+                a_sfa30d_print_stats(now_ms);
+            }
+            else if (type == SFA30D_EVENT_SIGNAL)
+            {
+                (void)read(signal_fd, &info, sizeof(info));
+
+                return 0;
+            }
+            else
+            {
+                return 0;
+            }
+        }
+    }
+}
+
+/**
+ * @brief     main function
+ * @param[in] argc arg numbers
+ * @param[in] **argv arg address
+ * @return    status code
+ *            - 0 success
+ *            - 1 run failed
+ *            - 5 param is invalid
+ * @note      none
+ */
+int main(int argc, char **argv)
+{
+    int c;
+    int longindex = 0;
+    int signal_fd = -1;
+    int stats_fd = -1;
+    int stop_fd = -1;
+    uint8_t res = 0;
+    uint32_t i;
+    uint64_t now_ms;
+    uint32_t period_ms = SFA30_SAMPLING_DEFAULT_PERIOD_MS;
+    uint32_t duration_s = 0;
+    uint32_t stats_s = 10;
+    uint32_t emulate = 0;
+    uint32_t iic_count = 0;
+    uint32_t uart_count = 0;
+    uint32_t expected;
+    uint32_t capacity;
+    double cpu_s;
+    uint32_t history = SFA30D_HISTORY_SAMPLES;
+    const char *ring_name = NULL;
+    const char *socket_name = NULL;
+    const char *log_name = NULL;
+    const char *rrd_dir = NULL;
+    char rrd_path[PATH_MAX];
+    double band[3];
+    sfa30_deadband_config_t deadband;
+    struct timespec wall;
+    const char *iic_names[SFA30D_MAX_SENSORS];
+    const char *uart_names[SFA30D_MAX_SENSORS];
+    sigset_t mask;
+    const char short_options[] = "hi:u:e:p:d:s:r:S:H:l:R:D:B:PC:";
+    const struct option long_options[] =
+    {
+        {"help", no_argument, NULL, 'h'},
+        {"iic", required_argument, NULL, 'i'},
+        {"uart", required_argument, NULL, 'u'},
+        {"emulate", required_argument, NULL, 'e'},
+        {"period", required_argument, NULL, 'p'},
+        {"duration", required_argument, NULL, 'd'},
+        {"stats", required_argument, NULL, 's'},
+        {"ring", required_argument, NULL, 'r'},
+        {"socket", required_argument, NULL, 'S'},
+        {"history", required_argument, NULL, 'H'},
+        {"log", required_argument, NULL, 'l'},
+        {"rrd", required_argument, NULL, 'R'},
+        {"deadband", required_argument, NULL, 'D'},
+        {"heartbeat", required_argument, NULL, 'B'},
+        {"print", no_argument, NULL, 'P'},
+        {"clock", required_argument, NULL, 'C'},
+        {NULL, 0, NULL, 0},
+    };
+
+    /* the deadband filter ignores a 1 lsb flicker and reports at least once a minute */
+    memset(&deadband, 0, sizeof(sfa30_deadband_config_t));
+    deadband.formaldehyde.hysteresis_raw = 1;
+    deadband.humidity.hysteresis_raw = 1;
+    deadband.temperature.hysteresis_raw = 1;
+    deadband.heartbeat_ms = 60000;
+
+    /* parse */
+    do
+    {
+        c = getopt_long(argc, argv, short_options, long_options, &longindex);
+        switch (c)
+        {
+            case 'h' :
+            {
+                (void)printf("Usage:\n");
+                (void)printf("  sfa30d [-i <dev> | --iic=<dev>]... [-u <dev> | --uart=<dev>]... [-e <num> | --emulate=<num>]\n");
+                (void)printf("         [-p <ms> | --period=<ms>] [-d <s> | --duration=<s>] [-s <s> | --stats=<s>]\n");
+                (void)printf("         [-r <name> | --ring=<name>] [-S <path> | --socket=<path>] [-H <num> | --history=<num>]\n");
+                (void)printf("         [-l <path> | --log=<path>] [-R <dir> | --rrd=<dir>]\n");
+                (void)printf("         [-D <ppb,%%,C> | --deadband=<ppb,%%,C>] [-B <s> | --heartbeat=<s>] [-P | --print]\n");
+                (void)printf("         [-C <ms> | --clock=<ms>]\n");
+                (void)printf("\n");
+                (void)printf("Options:\n");
+                (void)printf("  -h, --help                              Show the help.\n");
+                (void)printf("  -i <dev>, --iic=<dev>                   Add an iic sensor, one per bus, e.g. /dev/i2c-1.\n");
+                (void)printf("  -u <dev>, --uart=<dev>                  Add a uart sensor, e.g. /dev/ttyUSB0.\n");
+                (void)printf("  -e <num>, --emulate=<num>               Add emulated uart sensors.([default: 0] max: %d)\n", SFA30_EMULATOR_UART_PORTS);
+                (void)printf("  -p <ms>, --period=<ms>                  Set the sampling period.([default: %d])\n", SFA30_SAMPLING_DEFAULT_PERIOD_MS);
+                (void)printf("  -d <s>, --duration=<s>                  Exit after the duration, 0 runs until SIGINT or SIGTERM.([default: 0])\n");
+                (void)printf("  -s <s>, --stats=<s>                     Set the statistics period, 0 disables it.([default: 10])\n");
+                (void)printf("  -r <name>, --ring=<name>                Publish the samples to the shared memory ring /dev/shm<name>, e.g. /sfa30.\n");
+                (void)printf("  -S <path>, --socket=<path>              Answer latest, range and aggregate queries on a unix socket.\n");
+                (void)printf("  -H <num>, --history=<num>               Set the samples kept per sensor for the queries, a power of two.([default: %d])\n", SFA30D_HISTORY_SAMPLES);
+                (void)printf("  -l <path>, --log=<path>                 Append the samples to a binary log.\n");
+                (void)printf("  -R <dir>, --rrd=<dir>                   Consolidate the samples into <dir>/sfa30_<n>.rrd, one per sensor.\n");
+                (void)printf("  -D <ppb,%%,C>, --deadband=<ppb,%%,C>    Forward a sample only when a channel moved past its band, e.g. 1,0.5,0.1.\n");
+                (void)printf("  -B <s>, --heartbeat=<s>                 Set the max silence of the deadband filter, 0 disables it.([default: 60])\n");
+                (void)printf("  -P, --print                             Print each sample.\n");
+                (void)printf("  -C <ms>, --clock=<ms>                   Start the daemon clock at <ms> to test the 32 bit wrap.([default: 0])\n");
+
+                return 0;
+            }
+            case 'i' :
+            case 'u' :
+            {
+                if (iic_count + uart_count >= SFA30D_MAX_SENSORS)
+                {
+                    (void)printf("sfa30d: param is invalid.\n");
+
+                    return 5;
+                }
+                if (c == 'i')
+                {
+                    iic_names[iic_count++] = optarg;
+                }
+                else
+                {
+                    uart_names[uart_count++] = optarg;
+                }
+
+                break;
+            }
+            case 'e' :
+            {
+                emulate = (uint32_t)atol(optarg);
+
+                break;
+            }
+            case 'p' :
+            {
+                period_ms = (uint32_t)atol(optarg);
+
+                break;
+            }
+            case 'd' :
+            {
+                duration_s = (uint32_t)atol(optarg);
+
+                break;
+            }
+            case 's' :
+            {
+                stats_s = (uint32_t)atol(optarg);
+
+                break;
+            }
+            case 'r' :
+            {
+                ring_name = optarg;
+
+                break;
+            }
+            case 'S' :
+            {
+                socket_name = optarg;
+
+                break;
+            }
+            case 'H' :
+            {
+                history = (uint32_t)atol(optarg);
+
+                break;
+            }
+            case 'l' :
+            {
+                log_name = optarg;
+
+                break;
+            }
+            case 'R' :
+            {
+                rrd_dir = optarg;
+
+                break;
+            }
+            case 'D' :
+            {
+                if ((sscanf(optarg, "%lf,%lf,%lf", &band[0], &band[1], &band[2]) != 3) ||
+                    (band[0] < 0.0) || (band[0] > 6553.0) || (band[1] < 0.0) || (band[1] > 655.0) ||
+                    (band[2] < 0.0) || (band[2] > 327.0))
+                {
+                    (void)printf("sfa30d: param is invalid.\n");
+
+                    return 5;
+                }
+                deadband.formaldehyde.absolute_raw = (uint16_t)(band[0] * 5.0 + 0.5);
+                deadband.humidity.absolute_raw = (uint16_t)(band[1] * 100.0 + 0.5);
+                deadband.temperature.absolute_raw = (uint16_t)(band[2] * 200.0 + 0.5);
+                gs_deadband = 1;
+
+                break;
+            }
+            case 'B' :
+            {
+                deadband.heartbeat_ms = (uint32_t)atol(optarg) * 1000;
+
+                break;
+            }
+            case 'P' :
+            {
+                gs_print = 1;
+
+                break;
+            }
+            case 'C' :
+            {
+                gs_clock_start_ms = (uint64_t)strtoull(optarg, NULL, 10);
+
+                break;
+            }
+            case -1 :
+            {
+                break;
+            }
+            default :
+            {
+                (void)printf("sfa30d: param is invalid.\n");
+
+                return 5;
+            }
+        }
+    } while (c != -1);
+    if ((period_ms == 0) || (emulate > SFA30_EMULATOR_UART_PORTS) || (history < 2) || ((history & (history - 1)) != 0) ||
+        (iic_count + uart_count + emulate == 0) || (iic_count + uart_count + emulate > SFA30D_MAX_SENSORS))
+    {
+        (void)printf("sfa30d: param is invalid.\n");
+
+        return 5;
+    }
+
+    /* open the sensors */
+    gs_sensors = (sfa30d_sensor_t *)calloc(iic_count + uart_count + emulate, sizeof(sfa30d_sensor_t));
+    if (gs_sensors == NULL)
+    {
+        (void)printf("sfa30d: malloc failed.\n");
+
+        return 1;
+    }
+    gs_emulate = (emulate != 0) ? 1 : 0;
+    if (gs_emulate != 0)
+    {
+        sfa30_emulator_power_on();
+        sfa30_emulator_set_latency(2, 5);
+    }
+    for (i = 0; (i < iic_count + uart_count + emulate) && (res == 0); i++)
+    {
+        if (i < iic_count)
+        {
+            res = a_sfa30d_open(&gs_sensors[i], SFA30_INTERFACE_IIC, iic_names[i], 0);
+        }
+        else if (i < iic_count + uart_count)
+        {
+            res = a_sfa30d_open(&gs_sensors[i], SFA30_INTERFACE_UART, uart_names[i - iic_count], 0);
+        }
+        else
+        {
+            res = a_sfa30d_open(&gs_sensors[i], SFA30_INTERFACE_UART, NULL, (uint8_t)(i - iic_count - uart_count));
+        }
+        if (res != 0)
+        {
+            a_sfa30d_close(&gs_sensors[i]);
+        }
+        else
+        {
+            gs_sensor_count++;
+        }
+    }
+
+    /* the ring is created after the sensors so consumers see the final sensor indexes */
+    if ((res == 0) && (ring_name != NULL))
+    {
+        capacity = SFA30_RING_DEFAULT_CAPACITY;
+        while (capacity < gs_sensor_count * SFA30D_RING_SAMPLES)
+        {
+            capacity <<= 1;
+        }
+        if (sfa30_ring_create(&gs_ring, ring_name, capacity) != 0)
+        {
+            (void)printf("sfa30d: ring %s create failed.\n", ring_name);
+            res = 1;
+        }
+    }
+
+    /* the query server reads the history of each sensor from this thread */
+    if ((res == 0) && (socket_name != NULL))
+    {
+        gs_histories = (sfa30_history_t **)calloc(gs_sensor_count, sizeof(sfa30_history_t *));
+        for (i = 0; (i < gs_sensor_count) && (gs_histories != NULL) && (res == 0); i++)
+        {
+            gs_sensors[i].history_buf = (sfa30_history_sample_t *)malloc(history * sizeof(sfa30_history_sample_t));
+            if ((gs_sensors[i].history_buf == NULL) ||
+                (sfa30_history_init(&gs_sensors[i].history, gs_sensors[i].history_buf, history) != 0))
+            {
+                res = 1;
+            }
+            gs_histories[i] = &gs_sensors[i].history;
+        }
+        if ((gs_histories == NULL) || (res != 0) ||
+            (sfa30_query_server_init(&gs_server, socket_name, gs_histories, gs_sensor_count) != 0))
+        {
+            (void)printf("sfa30d: socket %s init failed.\n", socket_name);
+            free(gs_histories);
+            gs_histories = NULL;
+            res = 1;
+        }
+    }
+
+    /* build the event loop */
+    gs_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    (void)sigemptyset(&mask);
+    (void)sigaddset(&mask, SIGINT);
+    (void)sigaddset(&mask, SIGTERM);
+    (void)sigprocmask(SIG_BLOCK, &mask, NULL);
+    signal_fd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+    if ((res != 0) || (gs_epoll_fd < 0) || (signal_fd < 0) ||
+        (a_sfa30d_watch(signal_fd, SFA30D_EVENT_SIGNAL, 0) != 0))
+    {
+        res = 1;
+    }
+    if ((res == 0) && (stats_s != 0))
+    {
+        stats_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        if ((stats_fd < 0) || (a_sfa30d_watch(stats_fd, SFA30D_EVENT_STATS, (uint32_t)stats_fd) != 0))
+        {
+            res = 1;
+        }
+    }
+    if ((res == 0) && (gs_histories != NULL) && (a_sfa30d_watch(gs_server.epoll_fd, SFA30D_EVENT_QUERY, 0) != 0))
+    {
+        res = 1;
+    }
+    if ((res == 0) && (duration_s != 0))
+    {
+        stop_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        if ((stop_fd < 0) || (a_sfa30d_watch(stop_fd, SFA30D_EVENT_STOP, 0) != 0))
+        {
+            res = 1;
+        }
+    }
+    for (i = 0; (i < gs_sensor_count) && (res == 0); i++)
+    {
+        if (a_sfa30d_watch(gs_sensors[i].timer_fd, SFA30D_EVENT_TIMER, i) != 0)
+        {
+            res = 1;
+        }
+        else if ((gs_sensors[i].emulated == 0) && (gs_sensors[i].handle.iic_uart == SFA30_INTERFACE_UART) &&
+                 (a_sfa30d_watch(gs_sensors[i].port.uart_fd, SFA30D_EVENT_TTY, i) != 0))
+        {
+            res = 1;
+        }
+    }
+
+    /* the clock starts after the blocking init, so every sensor begins at once */
+    (void)clock_gettime(CLOCK_MONOTONIC, &gs_start);
+    (void)clock_gettime(CLOCK_REALTIME, &wall);
+    gs_epoch_ms = (uint64_t)wall.tv_sec * 1000ULL + (uint64_t)wall.tv_nsec / 1000000ULL;
+    if ((res == 0) && (log_name != NULL) && (sfa30_log_writer_open(&gs_log, log_name, 0, gs_epoch_ms) != 0))
+    {
+        (void)printf("sfa30d: log %s open failed.\n", log_name);
+        res = 1;
+    }
+    for (i = 0; (i < gs_sensor_count) && (res == 0) && (rrd_dir != NULL); i++)
+    {
+        (void)snprintf(rrd_path, sizeof(rrd_path), "%s/sfa30_%u.rrd", rrd_dir, i);
+        if (sfa30_rrd_open(&gs_sensors[i].rrd, rrd_path, NULL, gs_epoch_ms) != 0)
+        {
+            (void)printf("sfa30d: rrd %s open failed.\n", rrd_path);
+            res = 1;
+        }
+    }
+    if (gs_emulate != 0)
+    {
+        gs_emulator_offset_ms = sfa30_emulator_get_time_ms();
+    }
+    for (i = 0; (i < gs_sensor_count) && (res == 0); i++)
+    {
+        (void)sfa30_sampling_init(&gs_sensors[i].sampling, &gs_sensors[i].handle, period_ms, (uint32_t)gs_clock_start_ms);
+        (void)sfa30_deadband_init(&gs_sensors[i].deadband, &deadband);
+        if (gs_sensors[i].history_buf != NULL)
+        {
+            (void)sfa30_sampling_set_history(&gs_sensors[i].sampling, &gs_sensors[i].history);
+        }
+        res = a_sfa30d_arm(gs_sensors[i].timer_fd, gs_clock_start_ms, 0);
+    }
+    if ((res == 0) && (stats_fd >= 0))
+    {
+        res = a_sfa30d_arm(stats_fd, gs_clock_start_ms + stats_s * 1000ULL, stats_s * 1000);
+    }
+    if ((res == 0) && (stop_fd >= 0))
+    {
+        res = a_sfa30d_arm(stop_fd, gs_clock_start_ms + duration_s * 1000ULL, 0);
+    }
+    if (res != 0)
+    {
+        (void)printf("sfa30d: init failed.\n");
+    }
+    else
+    {
+        (void)printf("sfa30d: serving %u sensors every %u ms.\n", gs_sensor_count, period_ms);
+        (void)fflush(stdout);
+        res = a_sfa30d_loop(signal_fd);
+    }
+
+    /* check a bounded run kept up without spinning, a signal may end it early */
+    now_ms = a_sfa30d_now_ms();
+    if (res == 0)
+    {
+        a_sfa30d_print_stats(now_ms);
+        expected = (uint32_t)((now_ms - gs_clock_start_ms) / period_ms);
+        cpu_s = a_sfa30d_cpu_s();
+        if ((duration_s != 0) && (cpu_s * 1000.0 > 0.5 * (double)(now_ms - gs_clock_start_ms)))
+        {
+            (void)printf("sfa30d: busy, %0.2f s cpu in %u s.\n", cpu_s, duration_s);
+            res = 1;
+        }
+        for (i = 0; (i < gs_sensor_count) && (duration_s != 0); i++)
+        {
+            if ((gs_sensors[i].samples + 1 < expected) || (gs_sensors[i].sampling.errors != 0))
+            {
+                (void)printf("sfa30d: %s fell behind, %u samples, %u errors.\n", gs_sensors[i].name,
+                             gs_sensors[i].samples, gs_sensors[i].sampling.errors);
+                res = 1;
+            }
+            if ((gs_sensors[i].rrd_rejected != 0) || (gs_sensors[i].rrd_errors != 0))
+            {
+                (void)printf("sfa30d: rrd of %s rejected %u samples, %u sync errors.\n", gs_sensors[i].name,
+                             gs_sensors[i].rrd_rejected, gs_sensors[i].rrd_errors);
+                res = 1;
+            }
+        }
+        if ((duration_s != 0) && (gs_log_rejected != 0))
+        {
+            (void)printf("sfa30d: log rejected %u samples.\n", gs_log_rejected);
+            res = 1;
+        }
+    }
+
+    /* close */
+    for (i = 0; i < gs_sensor_count; i++)
+    {
+        a_sfa30d_close(&gs_sensors[i]);
+    }
+    if (stop_fd >= 0)
+    {
+        (void)close(stop_fd);
+    }
+    if (stats_fd >= 0)
+    {
+        (void)close(stats_fd);
+    }
+    if (signal_fd >= 0)
+    {
+        (void)close(signal_fd);
+    }
+    if (gs_epoll_fd >= 0)
+    {
+        (void)close(gs_epoll_fd);
+    }
+    if (gs_histories != NULL)
+    {
+        (void)sfa30_query_server_deinit(&gs_server);
+        free(gs_histories);
+    }
+    (void)sfa30_ring_close(&gs_ring);
+    (void)sfa30_log_writer_close(&gs_log);
+    free(gs_sensors);
+
+    return (res == 0) ? 0 : 1;
+}
@@ -215,7 +215,7 @@ uint8_t sfa30(uint8_t argc, char **argv)
         }
         
         /* delay 2000 ms */
-        sfa30_interface_delay_ms(2000);
+        sfa30_interface_delay_ms(NULL, 2000);
         
         /* loop */
         for (i = 0; i < times; i++)
@@ -233,12 +233,24 @@ uint8_t sfa30(uint8_t argc, char **argv)
             
             /* print */
             sfa30_interface_debug_print("sfa30: %d/%d.\n", i + 1, times);
+#if (SFA30_FLOAT_DATA != 0)
             sfa30_interface_debug_print("sfa30: formaldehyde is %0.2fppb.\n", data.formaldehyde);
             sfa30_interface_debug_print("sfa30: humidity is %0.2f%%.\n", data.humidity);
             sfa30_interface_debug_print("sfa30: temperature is %0.2fC.\n", data.temperature);
+#else
+            sfa30_interface_debug_print("sfa30: formaldehyde is %d.%01dppb.\n",
+                                        (int)(sfa30_formaldehyde_convert_to_ppb_x10(data.formaldehyde_raw) / 10),
+                                        (int)(sfa30_formaldehyde_convert_to_ppb_x10(data.formaldehyde_raw) % 10));
+            sfa30_interface_debug_print("sfa30: humidity is %d.%02d%%.\n",
+                                        (int)(sfa30_humidity_convert_to_rh_x100(data.humidity_raw) / 100),
+                                        (int)(sfa30_humidity_convert_to_rh_x100(data.humidity_raw) % 100));
+            sfa30_interface_debug_print("sfa30: temperature is %s%d.%03dC.\n", (data.temperature_raw < 0) ? "-" : "",
+                                        (int)(labs(sfa30_temperature_convert_to_mc(data.temperature_raw)) / 1000),
+                                        (int)(labs(sfa30_temperature_convert_to_mc(data.temperature_raw)) % 1000));
+#endif
             
             /* delay 2000 ms */
-            sfa30_interface_delay_ms(2000);
+            sfa30_interface_delay_ms(NULL, 2000);
         }
         
         /* deinit */
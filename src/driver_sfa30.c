@@ -35,6 +35,9 @@
  */
 
 #include "driver_sfa30.h"
+#if (SFA30_STATIC_BINDING != 0)
+#include "driver_sfa30_interface.h"
+#endif
 
 /**
  * @brief chip information definition
@@ -68,52 +71,251 @@
 #define SFA30_UART_COMMAND_RESET                                   0xD3           /**< reset command */
 
 /**
- * @brief     generate the crc
- * @param[in] *handle pointer to an sfa30 handle structure
+ * @brief chip read delay definition
+ */
+#define SFA30_IIC_READ_DELAY_MS                                    5              /**< iic command to response delay in ms */
+#define SFA30_UART_READ_DELAY_MS                                   100            /**< uart command to response delay in ms */
+
+/**
+ * @brief uart frame decoder state definition
+ */
+#define SFA30_UART_RX_IDLE                                         0              /**< waiting for the start flag */
+#define SFA30_UART_RX_DATA                                         1              /**< collecting the frame bytes */
+#define SFA30_UART_RX_ESCAPE                                       2              /**< next byte is stuffed */
+#define SFA30_UART_RX_DONE                                         3              /**< a checked frame is in the buffer */
+#define SFA30_UART_RX_ERROR                                        4              /**< bad stuffing, length or checksum */
+
+/**
+ * @brief transport helpers, a single transport build folds the interface test to a
+ *        constant so the other path and its helpers are dropped by the compiler
+ */
+#if (SFA30_TRANSPORT == SFA30_TRANSPORT_IIC)
+    #define SFA30_HANDLE_IS_UART(HANDLE)               0
+#elif (SFA30_TRANSPORT == SFA30_TRANSPORT_UART)
+    #define SFA30_HANDLE_IS_UART(HANDLE)               1
+#elif (SFA30_TRANSPORT == SFA30_TRANSPORT_BOTH)
+    #define SFA30_HANDLE_IS_UART(HANDLE)               ((HANDLE)->iic_uart != 0)
+#else
+    #error "sfa30: SFA30_TRANSPORT is invalid."
+#endif
+
+/**
+ * @brief link function call helper
+ */
+#if (SFA30_STATIC_BINDING != 0)
+    #define SFA30_CALL(HANDLE, FUC)                    ((void)(HANDLE), sfa30_interface_##FUC)
+#else
+    #define SFA30_CALL(HANDLE, FUC)                    (HANDLE)->FUC
+#endif
+
+/**
+ * @brief statistics hooks, they expand to nothing when SFA30_STATS is 0
+ */
+#if (SFA30_STATS != 0)
+    #define SFA30_STATS_ADD(HANDLE, FIELD, N)          do { if ((HANDLE)->stats != NULL) { (HANDLE)->stats->FIELD += (N); } } while (0)
+    #define SFA30_STATS_BEGIN(HANDLE)                  a_sfa30_stats_begin(HANDLE)
+    #define SFA30_STATS_END(HANDLE, COMMAND, RES)      a_sfa30_stats_end(HANDLE, COMMAND, RES)
+#else
+    #define SFA30_STATS_ADD(HANDLE, FIELD, N)
+    #define SFA30_STATS_BEGIN(HANDLE)
+    #define SFA30_STATS_END(HANDLE, COMMAND, RES)
+#endif
+
+#if (SFA30_STATIC_BINDING == 0) && (SFA30_STATS == 0) && (UINTPTR_MAX == 0xFFFFFFFFU)
+/**
+ * @brief handle size check, a 32 bit target with linked functions keeps the handle under 64 bytes
+ */
+typedef char sfa30_handle_size_check_t[(sizeof(sfa30_handle_t) < 64) ? 1 : -1];
+#endif
+
+#if (SFA30_CRC_MODE == SFA30_CRC_MODE_TABLE)
+/**
+ * @brief crc8 table of polynomial 0x31
+ */
+static const uint8_t gsc_sfa30_crc8_table[256] =
+{
+    0x00, 0x31, 0x62, 0x53, 0xC4, 0xF5, 0xA6, 0x97, 0xB9, 0x88, 0xDB, 0xEA, 0x7D, 0x4C, 0x1F, 0x2E,
+    0x43, 0x72, 0x21, 0x10, 0x87, 0xB6, 0xE5, 0xD4, 0xFA, 0xCB, 0x98, 0xA9, 0x3E, 0x0F, 0x5C, 0x6D,
+    0x86, 0xB7, 0xE4, 0xD5, 0x42, 0x73, 0x20, 0x11, 0x3F, 0x0E, 0x5D, 0x6C, 0xFB, 0xCA, 0x99, 0xA8,
+    0xC5, 0xF4, 0xA7, 0x96, 0x01, 0x30, 0x63, 0x52, 0x7C, 0x4D, 0x1E, 0x2F, 0xB8, 0x89, 0xDA, 0xEB,
+    0x3D, 0x0C, 0x5F, 0x6E, 0xF9, 0xC8, 0x9B, 0xAA, 0x84, 0xB5, 0xE6, 0xD7, 0x40, 0x71, 0x22, 0x13,
+    0x7E, 0x4F, 0x1C, 0x2D, 0xBA, 0x8B, 0xD8, 0xE9, 0xC7, 0xF6, 0xA5, 0x94, 0x03, 0x32, 0x61, 0x50,
+    0xBB, 0x8A, 0xD9, 0xE8, 0x7F, 0x4E, 0x1D, 0x2C, 0x02, 0x33, 0x60, 0x51, 0xC6, 0xF7, 0xA4, 0x95,
+    0xF8, 0xC9, 0x9A, 0xAB, 0x3C, 0x0D, 0x5E, 0x6F, 0x41, 0x70, 0x23, 0x12, 0x85, 0xB4, 0xE7, 0xD6,
+    0x7A, 0x4B, 0x18, 0x29, 0xBE, 0x8F, 0xDC, 0xED, 0xC3, 0xF2, 0xA1, 0x90, 0x07, 0x36, 0x65, 0x54,
+    0x39, 0x08, 0x5B, 0x6A, 0xFD, 0xCC, 0x9F, 0xAE, 0x80, 0xB1, 0xE2, 0xD3, 0x44, 0x75, 0x26, 0x17,
+    0xFC, 0xCD, 0x9E, 0xAF, 0x38, 0x09, 0x5A, 0x6B, 0x45, 0x74, 0x27, 0x16, 0x81, 0xB0, 0xE3, 0xD2,
+    0xBF, 0x8E, 0xDD, 0xEC, 0x7B, 0x4A, 0x19, 0x28, 0x06, 0x37, 0x64, 0x55, 0xC2, 0xF3, 0xA0, 0x91,
+    0x47, 0x76, 0x25, 0x14, 0x83, 0xB2, 0xE1, 0xD0, 0xFE, 0xCF, 0x9C, 0xAD, 0x3A, 0x0B, 0x58, 0x69,
+    0x04, 0x35, 0x66, 0x57, 0xC0, 0xF1, 0xA2, 0x93, 0xBD, 0x8C, 0xDF, 0xEE, 0x79, 0x48, 0x1B, 0x2A,
+    0xC1, 0xF0, 0xA3, 0x92, 0x05, 0x34, 0x67, 0x56, 0x78, 0x49, 0x1A, 0x2B, 0xBC, 0x8D, 0xDE, 0xEF,
+    0x82, 0xB3, 0xE0, 0xD1, 0x46, 0x77, 0x24, 0x15, 0x3B, 0x0A, 0x59, 0x68, 0xFF, 0xCE, 0x9D, 0xAC,
+};
+#elif (SFA30_CRC_MODE == SFA30_CRC_MODE_NIBBLE)
+/**
+ * @brief crc8 nibble table of polynomial 0x31
+ */
+static const uint8_t gsc_sfa30_crc8_table[16] =
+{
+    0x00, 0x31, 0x62, 0x53, 0xC4, 0xF5, 0xA6, 0x97, 0xB9, 0x88, 0xDB, 0xEA, 0x7D, 0x4C, 0x1F, 0x2E,
+};
+#elif (SFA30_CRC_MODE != SFA30_CRC_MODE_BITWISE)
+#error "sfa30: SFA30_CRC_MODE is invalid."
+#endif
+
+/**
+ * @brief     calculate the sensirion crc8 of a data word
  * @param[in] *data pointer to a data buffer
- * @param[in] count data length
+ * @param[in] len data length
  * @return    crc
- * @note      none
+ * @note      polynomial 0x31, init 0xFF, the engine is chosen by SFA30_CRC_MODE
  */
-static uint8_t a_sfa30_generate_crc(sfa30_handle_t *handle, uint8_t* data, uint8_t count)
+uint8_t sfa30_crc8(const uint8_t *data, uint16_t len)
 {
-    if (handle->iic_uart == SFA30_INTERFACE_IIC)
+    uint16_t i;
+    uint8_t crc = 0xFF;
+
+    for (i = 0; i < len; i++)                                               /* calculate crc */
     {
-        uint8_t current_byte;
-        uint8_t crc = 0xFF;
+#if (SFA30_CRC_MODE == SFA30_CRC_MODE_TABLE)
+        crc = gsc_sfa30_crc8_table[crc ^ data[i]];                          /* one lookup per byte */
+#elif (SFA30_CRC_MODE == SFA30_CRC_MODE_NIBBLE)
+        crc ^= data[i];                                                     /* xor data */
+        crc = (uint8_t)(crc << 4) ^ gsc_sfa30_crc8_table[crc >> 4];         /* high nibble */
+        crc = (uint8_t)(crc << 4) ^ gsc_sfa30_crc8_table[crc >> 4];         /* low nibble */
+#else
         uint8_t crc_bit;
 
-        for (current_byte = 0; current_byte < count; ++current_byte)        /* calculate crc */
+        crc ^= data[i];                                                     /* xor data */
+        for (crc_bit = 8; crc_bit > 0; --crc_bit)                           /* 8 bit */
         {
-            crc ^= (data[current_byte]);                                    /* xor data */
-            for (crc_bit = 8; crc_bit > 0; --crc_bit)                       /* 8 bit */
+            if ((crc & 0x80) != 0)                                          /* if 7th bit is 1 */
             {
-                if ((crc & 0x80) != 0)                                      /* if 7th bit is 1 */
-                {
-                    crc = (crc << 1) ^ 0x31;                                /* xor */
-                }
-                else
-                {
-                    crc = crc << 1;                                         /* left shift 1 */
-                }
+                crc = (uint8_t)((crc << 1) ^ 0x31);                         /* xor */
+            }
+            else
+            {
+                crc = (uint8_t)(crc << 1);                                  /* left shift 1 */
             }
         }
-
-        return crc;                                                         /* return crc */
+#endif
     }
-    else
+
+    return crc;                                                             /* return crc */
+}
+
+/**
+ * @brief     calculate the shdlc checksum
+ * @param[in] *data pointer to a data buffer
+ * @param[in] len data length
+ * @return    checksum
+ * @note      inverted least significant byte of the sum of all bytes
+ */
+uint8_t sfa30_shdlc_checksum(const uint8_t *data, uint16_t len)
+{
+    uint16_t i;
+    uint8_t sum = 0x00;
+
+    for (i = 0; i < len; i++)                                               /* sum */
     {
-        uint8_t i;
-        uint32_t crc = 0x00;
+        sum = (uint8_t)(sum + data[i]);                                     /* only the least significant byte matters */
+    }
 
-        for (i = 0; i < count; i++)                                         /* sum */
+    return (uint8_t)(~sum);                                                 /* invert it */
+}
+
+#if (SFA30_STATS != 0)
+/**
+ * @brief     get the statistics command of an iic command or shdlc command
+ * @param[in] command iic command or shdlc command
+ * @return    statistics command
+ * @note      none
+ */
+static uint8_t a_sfa30_stats_command(uint16_t command)
+{
+    switch (command)
+    {
+        case SFA30_IIC_COMMAND_START_MEASUREMENT :
+        case SFA30_UART_COMMAND_START_MEASUREMENT :
+        {
+            return SFA30_STATS_COMMAND_START_MEASUREMENT;
+        }
+        case SFA30_IIC_COMMAND_STOP_MEASUREMENT :
+        case SFA30_UART_COMMAND_STOP_MEASUREMENT :
+        {
+            return SFA30_STATS_COMMAND_STOP_MEASUREMENT;
+        }
+        case SFA30_IIC_COMMAND_READ_MEASURED_VALUES :
+        case SFA30_UART_COMMAND_READ_MEASURED_VALUES :
+        {
+            return SFA30_STATS_COMMAND_READ_MEASURED_VALUES;
+        }
+        case SFA30_IIC_COMMAND_READ_DEVICE_INFORMATION :
+        case SFA30_UART_COMMAND_READ_DEVICE_INFORMATION :
         {
-            crc += data[i];                                                 /* sum */
+            return SFA30_STATS_COMMAND_READ_DEVICE_INFORMATION;
         }
+        case SFA30_IIC_COMMAND_RESET :
+        case SFA30_UART_COMMAND_RESET :
+        {
+            return SFA30_STATS_COMMAND_RESET;
+        }
+        default :
+        {
+            return SFA30_STATS_COMMAND_OTHER;
+        }
+    }
+}
+
+/**
+ * @brief     mark the start of a transaction
+ * @param[in] *handle pointer to an sfa30 handle structure
+ * @note      none
+ */
+static void a_sfa30_stats_begin(sfa30_handle_t *handle)
+{
+    if ((handle->stats != NULL) && (handle->clock_us != NULL))                   /* check the hooks */
+    {
+        handle->stats_start_us = handle->clock_us();                             /* save the start time */
+    }
+}
+
+/**
+ * @brief     count a finished transaction
+ * @param[in] *handle pointer to an sfa30 handle structure
+ * @param[in] command iic command or shdlc command
+ * @param[in] res transaction result
+ * @note      none
+ */
+static void a_sfa30_stats_end(sfa30_handle_t *handle, uint16_t command, uint8_t res)
+{
+    sfa30_stats_counter_t *counter;
+    uint32_t us;
+    uint8_t bucket;
 
-        return (uint8_t)(~(crc & 0xFF));                                    /* take the least significant byte of the result and invert it */
+    if (handle->stats == NULL)                                                   /* check the block */
+    {
+        return;                                                                  /* return */
+    }
+    counter = &handle->stats->command[a_sfa30_stats_command(command)];          /* get the counter */
+    counter->count++;                                                            /* count++ */
+    if (res != 0)                                                                /* check the result */
+    {
+        counter->errors++;                                                       /* errors++ */
+    }
+    if (handle->clock_us != NULL)                                                /* check the clock */
+    {
+        us = handle->clock_us() - handle->stats_start_us;                        /* get the latency */
+        bucket = 0;                                                              /* init 0 */
+        while ((us != 0) && (bucket < (SFA30_STATS_LATENCY_BUCKETS - 1)))        /* get the bit length */
+        {
+            us >>= 1;                                                            /* right shift */
+            bucket++;                                                            /* bucket++ */
+        }
+        counter->latency[bucket]++;                                              /* count the latency */
     }
 }
+#endif
 
 /**
  * @brief      read bytes
@@ -132,17 +334,25 @@ static uint8_t a_sfa30_iic_read(sfa30_handle_t *handle, uint8_t addr, uint16_t r
 {
     uint8_t buf[2];
 
+    SFA30_STATS_BEGIN(handle);                                   /* start the transaction */
     buf[0] = (reg >> 8) & 0xFF;                                  /* set msb */
     buf[1] = (reg >> 0) & 0xFF;                                  /* set lsb */
-    if (handle->iic_write_cmd(addr, (uint8_t *)buf, 2) != 0)     /* write data */
+    if (SFA30_CALL(handle, iic_write_cmd)(handle->user, addr, (uint8_t *)buf, 2) != 0) /* write data */
     {
+        SFA30_STATS_END(handle, reg, 1);                         /* count the transaction */
+
         return 1;                                                /* return error */
     }
-    handle->delay_ms(delay_ms);                                  /* delay ms */
-    if (handle->iic_read_cmd(addr, (uint8_t *)data, len) != 0)   /* read data */
+    SFA30_STATS_ADD(handle, tx_bytes, 2);                        /* count the sent bytes */
+    SFA30_CALL(handle, delay_ms)(handle->user, delay_ms);        /* delay ms */
+    if (SFA30_CALL(handle, iic_read_cmd)(handle->user, addr, (uint8_t *)data, len) != 0) /* read data */
     {
+        SFA30_STATS_END(handle, reg, 1);                         /* count the transaction */
+
         return 1;                                                /* return error */
     }
+    SFA30_STATS_ADD(handle, rx_bytes, len);                      /* count the received bytes */
+    SFA30_STATS_END(handle, reg, 0);                             /* count the transaction */
 
     return 0;                                                    /* success return 0 */
 }
@@ -168,99 +378,215 @@ static uint8_t a_sfa30_iic_write(sfa30_handle_t *handle, uint8_t addr, uint16_t
     {
         return 1;                                                    /* return error */
     }
+    SFA30_STATS_BEGIN(handle);                                       /* start the transaction */
     buf[0] = (reg >> 8) & 0xFF;                                      /* set msb */
     buf[1] = (reg >> 0) & 0xFF;                                      /* set lsb */
     memcpy((uint8_t *)&buf[2], data, len);                           /* copy data */
-    if (handle->iic_write_cmd(addr, (uint8_t *)buf, len + 2) != 0)   /* write data */
+    if (SFA30_CALL(handle, iic_write_cmd)(handle->user, addr, (uint8_t *)buf, len + 2) != 0) /* write data */
     {
+        SFA30_STATS_END(handle, reg, 1);                             /* count the transaction */
+
         return 1;                                                    /* return error */
     }
-    handle->delay_ms(delay_ms);                                      /* delay ms */
+    SFA30_STATS_ADD(handle, tx_bytes, len + 2);                      /* count the sent bytes */
+    SFA30_CALL(handle, delay_ms)(handle->user, delay_ms);            /* delay ms */
+    SFA30_STATS_END(handle, reg, 0);                                 /* count the transaction */
 
     return 0;                                                        /* success return 0 */
 }
 
 /**
- * @brief      uart get the rx frame
- * @param[in]  *handle pointer to an sfa30 handle structure
- * @param[in]  len buffer length
- * @param[out] *output pointer to an output buffer
- * @param[in]  out_len output length
- * @return     status code
- *             - 0 success
- *             - 1 uart get rx frame failed
- * @note       none
+ * @brief     uart reset the rx frame decoder
+ * @param[in] *handle pointer to an sfa30 handle structure
+ * @note      call it after the tx frame is written, the decoder reuses the inner buffer
+ */
+static void a_sfa30_uart_rx_reset(sfa30_handle_t *handle)
+{
+    handle->rx_state = SFA30_UART_RX_IDLE;                                       /* wait for the start flag */
+    handle->rx_len = 0;                                                          /* no byte decoded */
+}
+
+/**
+ * @brief     uart feed the rx frame decoder
+ * @param[in] *handle pointer to an sfa30 handle structure
+ * @param[in] len number of new bytes at buf[rx_len]
+ * @note      the frame is unstuffed in place without the flags, the unstuffed
+ *            data never overtakes the received data so no second buffer is needed
  */
-static uint8_t a_sfa30_uart_get_rx_frame(sfa30_handle_t *handle, uint16_t len, uint8_t *output, uint16_t out_len)
+static void a_sfa30_uart_rx_feed(sfa30_handle_t *handle, uint16_t len)
 {
-    uint16_t i, point;
+    uint16_t i;
+    uint16_t pos;
+    uint8_t b;
 
-    output[0] = handle->buf[0];                                                  /* set buf[0] */
-    point = 1;                                                                   /* set point 1 */
-    for (i = 1; i < (len - 1); i++)                                              /* run n -2 times */
+    pos = handle->rx_len;                                                        /* new bytes start here */
+    for (i = 0; i < len; i++)                                                    /* run the state machine */
     {
-        if (point >= (out_len - 1))                                              /* check length */
+        b = handle->buf[pos + i];                                                /* get the byte */
+        switch (handle->rx_state)
         {
-            return 1;                                                            /* return error */
-        }
-        if (((handle->buf[i] == 0x7D) && (handle->buf[i + 1]) == 0x5E) ||        /* check buffer */
-            ((handle->buf[i] == 0x7D) && (handle->buf[i + 1]) == 0x5D) ||
-            ((handle->buf[i] == 0x7D) && (handle->buf[i + 1]) == 0x31) ||
-            ((handle->buf[i] == 0x7D) && (handle->buf[i + 1]) == 0x33)
-           )
-        {
-            switch (handle->buf[i + 1])                                          /* judge */
+            case SFA30_UART_RX_IDLE :                                            /* wait for the start flag */
             {
-                case 0x5E :                                                      /* 0x5E */
+                if (b == 0x7E)                                                   /* start flag */
                 {
-                    output[point] = 0x7E;                                        /* set output */
-                    point++;                                                     /* point++ */
-                    i++;                                                         /* i++ */
-
-                    break;                                                       /* break */
+                    handle->rx_state = SFA30_UART_RX_DATA;                       /* collect data */
                 }
-                case 0x5D :                                                      /* 0x5D */
-                {
-                    output[point] = 0x7D;                                        /* set output */
-                    point++;                                                     /* point++ */
-                    i++;                                                         /* i++ */
 
-                    break;                                                       /* break */
+                break;                                                           /* break */
+            }
+            case SFA30_UART_RX_DATA :                                            /* collect data */
+            {
+                if (b == 0x7E)                                                   /* stop flag */
+                {
+                    if (handle->rx_len == 0)                                     /* back to back flags */
+                    {
+                        break;                                                   /* break */
+                    }
+                    if ((handle->rx_len < 5) ||
+                        (handle->buf[3] != (uint8_t)(handle->rx_len - 5)) ||
+                        (handle->buf[handle->rx_len - 1] !=
+                         sfa30_shdlc_checksum(handle->buf, (uint16_t)(handle->rx_len - 1))))  /* check length and checksum */
+                    {
+                        handle->rx_state = SFA30_UART_RX_ERROR;                  /* bad frame */
+                        SFA30_STATS_ADD(handle, crc_errors, 1);                  /* count the frame error */
+                    }
+                    else
+                    {
+                        handle->rx_state = SFA30_UART_RX_DONE;                   /* frame done */
+                    }
+
+                    return;                                                      /* ignore the trailing bytes */
                 }
-                case 0x31 :                                                      /* 0x31 */
+                else if (b == 0x7D)                                              /* escape */
                 {
-                    output[point] = 0x11;                                        /* set output */
-                    point++;                                                     /* point++ */
-                    i++;                                                         /* i++ */
-
-                    break;                                                       /* break */
+                    handle->rx_state = SFA30_UART_RX_ESCAPE;                     /* unstuff the next byte */
                 }
-                case 0x33 :                                                      /* 0x33 */
+                else
                 {
-                    output[point] = 0x13;                                        /* set output */
-                    point++;                                                     /* point++ */
-                    i++;                                                         /* i++ */
-
-                    break;                                                       /* break */
+                    handle->buf[handle->rx_len++] = b;                           /* copy the byte */
                 }
-                default :
+
+                break;                                                           /* break */
+            }
+            case SFA30_UART_RX_ESCAPE :                                          /* unstuff */
+            {
+                if ((b != 0x5E) && (b != 0x5D) && (b != 0x31) && (b != 0x33))    /* check the stuffed byte */
                 {
-                    break;                                                       /* break */
+                    handle->rx_state = SFA30_UART_RX_ERROR;                      /* bad stuffing */
+
+                    return;                                                      /* return */
                 }
+                handle->buf[handle->rx_len++] = b ^ 0x20;                        /* 0x7E, 0x7D, 0x11 or 0x13 */
+                handle->rx_state = SFA30_UART_RX_DATA;                           /* collect data */
+
+                break;                                                           /* break */
+            }
+            default :
+            {
+                return;                                                          /* frame done or failed */
             }
         }
-        else
+    }
+}
+
+/**
+ * @brief     uart poll the rx frame decoder
+ * @param[in] *handle pointer to an sfa30 handle structure
+ * @return    decoder state
+ * @note      reads the bytes that already arrived without waiting
+ */
+static uint8_t a_sfa30_uart_rx_poll(sfa30_handle_t *handle)
+{
+    uint16_t len;
+
+    if ((handle->rx_state == SFA30_UART_RX_DONE) ||
+        (handle->rx_state == SFA30_UART_RX_ERROR))                               /* check the state */
+    {
+        return handle->rx_state;                                                 /* nothing to read */
+    }
+    if (handle->rx_len >= SFA30_SCRATCH_SIZE)                                    /* check the buffer */
+    {
+        handle->rx_state = SFA30_UART_RX_ERROR;                                  /* frame is too long */
+
+        return handle->rx_state;                                                 /* return the state */
+    }
+    len = SFA30_CALL(handle, uart_read)(handle->user, &handle->buf[handle->rx_len],
+                                        (uint16_t)(SFA30_SCRATCH_SIZE - handle->rx_len));  /* read the arrived bytes */
+    if (len > (uint16_t)(SFA30_SCRATCH_SIZE - handle->rx_len))                   /* check the length */
+    {
+        len = (uint16_t)(SFA30_SCRATCH_SIZE - handle->rx_len);                   /* clamp */
+    }
+    SFA30_STATS_ADD(handle, rx_bytes, len);                                      /* count the received bytes */
+    a_sfa30_uart_rx_feed(handle, len);                                           /* decode */
+
+    return handle->rx_state;                                                     /* return the state */
+}
+
+/**
+ * @brief     uart wait for the rx frame
+ * @param[in] *handle pointer to an sfa30 handle structure
+ * @param[in] timeout_ms timeout in ms
+ * @return    status code
+ *            - 0 success
+ *            - 1 timeout or bad frame
+ * @note      returns as soon as the stop flag arrives
+ */
+static uint8_t a_sfa30_uart_rx_wait(sfa30_handle_t *handle, uint16_t timeout_ms)
+{
+    uint16_t waited;
+    uint16_t last;
+
+    waited = 0;                                                                  /* init 0 */
+    while (1)
+    {
+        last = handle->rx_len;                                                   /* save the length */
+        switch (a_sfa30_uart_rx_poll(handle))                                    /* poll the decoder */
+        {
+            case SFA30_UART_RX_DONE :
+            {
+                return 0;                                                        /* success return 0 */
+            }
+            case SFA30_UART_RX_ERROR :
+            {
+                return 1;                                                        /* return error */
+            }
+            default :
+            {
+                break;                                                           /* break */
+            }
+        }
+        if ((handle->rx_len != last) || (handle->rx_state == SFA30_UART_RX_ESCAPE))  /* bytes are arriving */
         {
-            output[point] = handle->buf[i];                                      /* set output */
-            point++;                                                             /* point++ */
+            continue;                                                            /* read again at once */
         }
+        if (waited >= timeout_ms)                                                /* check the timeout */
+        {
+            return 1;                                                            /* return error */
+        }
+        SFA30_CALL(handle, delay_ms)(handle->user, 1);                           /* delay 1 ms */
+        waited++;                                                                /* waited++ */
     }
-    output[point] = handle->buf[len - 1];                                        /* set the end part */
-    point++;                                                                     /* point++ */
-    if (point != out_len)                                                        /* check point */
+}
+
+/**
+ * @brief      uart get the rx frame
+ * @param[in]  *handle pointer to an sfa30 handle structure
+ * @param[out] *output pointer to an output buffer
+ * @param[in]  out_len output length
+ * @return     status code
+ *             - 0 success
+ *             - 1 uart get rx frame failed
+ * @note       the frame is copied with its start and stop flags
+ */
+static uint8_t a_sfa30_uart_get_rx_frame(sfa30_handle_t *handle, uint8_t *output, uint16_t out_len)
+{
+    if ((handle->rx_state != SFA30_UART_RX_DONE) || ((handle->rx_len + 2) != out_len))  /* check the frame */
     {
         return 1;                                                                /* return error */
     }
+    output[0] = 0x7E;                                                            /* set the start flag */
+    memcpy(&output[1], handle->buf, handle->rx_len);                             /* copy the frame */
+    output[out_len - 1] = 0x7E;                                                  /* set the stop flag */
 
     return 0;                                                                    /* success return 0 */
 }
@@ -280,12 +606,12 @@ static uint8_t a_sfa30_uart_set_tx_frame(sfa30_handle_t *handle, uint8_t *input,
 {
     uint16_t i;
 
-    memset(handle->buf, 0, sizeof(uint8_t) * 256);             /* clear buffer */
+    memset(handle->buf, 0, sizeof(uint8_t) * SFA30_SCRATCH_SIZE);  /* clear buffer */
     handle->buf[0] = input[0];                                 /* set buf[0] */
     *out_len = 1;                                              /* set output length */
     for (i = 1; i < (in_len - 1); i++)
     {
-        if ((*out_len) >= 255)                                 /* check output length */
+        if ((*out_len) >= (SFA30_SCRATCH_SIZE - 1))            /* check output length */
         {
             return 1;                                          /* return error */
         }
@@ -354,13 +680,13 @@ static uint8_t a_sfa30_uart_set_tx_frame(sfa30_handle_t *handle, uint8_t *input,
  * @param[in]  *handle pointer to an sfa30 handle structure
  * @param[in]  *input pointer to an input buffer
  * @param[in]  in_len input length
- * @param[in]  delay_ms delay time in ms
+ * @param[in]  delay_ms timeout in ms
  * @param[out] *output pointer to an output buffer
  * @param[in]  out_len output length
  * @return     status code
  *             - 0 success
  *             - 1 write read failed
- * @note       none
+ * @note       returns as soon as the whole response frame arrived
  */
 static uint8_t a_sfa30_uart_write_read(sfa30_handle_t *handle, uint8_t *input, uint16_t in_len,
                                        uint16_t delay_ms, uint8_t *output, uint16_t out_len)
@@ -371,20 +697,29 @@ static uint8_t a_sfa30_uart_write_read(sfa30_handle_t *handle, uint8_t *input, u
     {
         return 1;                                                                       /* return error */
     }
-    if (handle->uart_flush() != 0)                                                      /* uart flush */
+    SFA30_STATS_BEGIN(handle);                                                          /* start the transaction */
+    if (SFA30_CALL(handle, uart_flush)(handle->user) != 0)                              /* uart flush */
     {
+        SFA30_STATS_END(handle, input[2], 1);                                           /* count the transaction */
+
         return 1;                                                                       /* return error */
     }
-    if (handle->uart_write(handle->buf, len) != 0)                                      /* write data */
+    if (SFA30_CALL(handle, uart_write)(handle->user, handle->buf, len) != 0)            /* write data */
     {
+        SFA30_STATS_END(handle, input[2], 1);                                           /* count the transaction */
+
         return 1;                                                                       /* return error */
     }
-    handle->delay_ms(delay_ms);                                                         /* delay ms */
-    len = handle->uart_read(handle->buf, 256);                                          /* read data */
-    if (a_sfa30_uart_get_rx_frame(handle, len, output, out_len) != 0)                   /* get rx frame */
+    SFA30_STATS_ADD(handle, tx_bytes, len);                                             /* count the sent bytes */
+    a_sfa30_uart_rx_reset(handle);                                                      /* reset the decoder */
+    if ((a_sfa30_uart_rx_wait(handle, delay_ms) != 0) ||
+        (a_sfa30_uart_get_rx_frame(handle, output, out_len) != 0))                      /* wait for the frame */
     {
+        SFA30_STATS_END(handle, input[2], 1);                                           /* count the transaction */
+
         return 1;                                                                       /* return error */
     }
+    SFA30_STATS_END(handle, input[2], 0);                                               /* count the transaction */
 
     return 0;                                                                           /* success return 0 */
 }
@@ -398,6 +733,10 @@ static uint8_t a_sfa30_uart_write_read(sfa30_handle_t *handle, uint8_t *input, u
  */
 static uint8_t a_sfa30_uart_error(sfa30_handle_t *handle, uint8_t e)
 {
+    if (e != 0)                                                                               /* check the state */
+    {
+        SFA30_STATS_ADD(handle, shdlc_errors, 1);                                             /* count the state error */
+    }
     switch (e)
     {
         case 0x00 :
@@ -406,62 +745,258 @@ static uint8_t a_sfa30_uart_error(sfa30_handle_t *handle, uint8_t e)
         }
         case 0x01 :
         {
-            handle->debug_print("sfa30: wrong data length for this command error.\n");        /* wrong data length for this command error */
+            SFA30_CALL(handle, debug_print)("sfa30: wrong data length for this command error.\n"); /* wrong data length for this command error */
 
             break;
         }
         case 0x02 :
         {
-            handle->debug_print("sfa30: unknown command.\n");                                 /* unknown command */
+            SFA30_CALL(handle, debug_print)("sfa30: unknown command.\n");                     /* unknown command */
 
             break;
         }
         case 0x03 :
         {
-            handle->debug_print("sfa30: no access right for command.\n");                     /* no access right for command */
+            SFA30_CALL(handle, debug_print)("sfa30: no access right for command.\n");         /* no access right for command */
 
             break;
         }
         case 0x04 :
         {
-            handle->debug_print("sfa30: illegal command parameter or parameter "
+            SFA30_CALL(handle, debug_print)("sfa30: illegal command parameter or parameter "
                                 "out of allowed range.\n");                                   /* illegal command parameter or parameter out of allowed range */
 
             break;
         }
         case 0x20 :
         {
-            handle->debug_print("sfa30: no measurement data available.\n");                   /* no measurement data available */
+            SFA30_CALL(handle, debug_print)("sfa30: no measurement data available.\n");       /* no measurement data available */
 
             break;
         }
         case 0x43 :
         {
-            handle->debug_print("sfa30: command not allowed in current state.\n");            /* command not allowed in current state */
+            SFA30_CALL(handle, debug_print)("sfa30: command not allowed in current state.\n"); /* command not allowed in current state */
 
             break;
         }
         case 0x44 :
         {
-            handle->debug_print("sfa30: internal error.\n");                                  /* internal error */
+            SFA30_CALL(handle, debug_print)("sfa30: internal error.\n");                      /* internal error */
 
             break;
         }
         case 0x7F :
         {
-            handle->debug_print("sfa30: general error.\n");                                   /* general error */
+            SFA30_CALL(handle, debug_print)("sfa30: general error.\n");                       /* general error */
 
             break;
         }
         default :
         {
-            handle->debug_print("sfa30: unknown code.\n");                                    /* unknown code */
+            SFA30_CALL(handle, debug_print)("sfa30: unknown code.\n");                        /* unknown code */
+
+            break;
+        }
+    }
+
+    return e;                                                                                 /* return error code */
+}
+
+/**
+ * @brief     send the read measured values command
+ * @param[in] *handle pointer to an sfa30 handle structure
+ * @return    status code
+ *            - 0 success
+ *            - 1 send command failed
+ * @note      the response is collected by a_sfa30_read_response
+ */
+static uint8_t a_sfa30_read_command(sfa30_handle_t *handle)
+{
+    SFA30_STATS_BEGIN(handle);                                                                   /* start the transaction */
+    if (SFA30_HANDLE_IS_UART(handle))                                                            /* uart */
+    {
+        uint8_t input_buf[6 + 1];
+        uint16_t len;
+
+        input_buf[0] = 0x7E;                                                                     /* set start */
+        input_buf[1] = 0x00;                                                                     /* set addr */
+        input_buf[2] = SFA30_UART_COMMAND_READ_MEASURED_VALUES;                                  /* set command */
+        input_buf[3] = 0x01;                                                                     /* set length */
+        input_buf[4] = 0x02;                                                                     /* set subcommand */
+        input_buf[5] = sfa30_shdlc_checksum((uint8_t *)&input_buf[1], 4);                        /* set crc */
+        input_buf[6] = 0x7E;                                                                     /* set stop */
+        if (a_sfa30_uart_set_tx_frame(handle, (uint8_t *)input_buf, 7, (uint16_t *)&len) != 0)   /* set tx frame */
+        {
+            SFA30_CALL(handle, debug_print)("sfa30: write read failed.\n");                      /* write read failed */
+            SFA30_STATS_END(handle, SFA30_UART_COMMAND_READ_MEASURED_VALUES, 1);                 /* count the transaction */
+
+            return 1;                                                                            /* return error */
+        }
+        if (SFA30_CALL(handle, uart_flush)(handle->user) != 0)                                   /* uart flush */
+        {
+            SFA30_CALL(handle, debug_print)("sfa30: write read failed.\n");                      /* write read failed */
+            SFA30_STATS_END(handle, SFA30_UART_COMMAND_READ_MEASURED_VALUES, 1);                 /* count the transaction */
+
+            return 1;                                                                            /* return error */
+        }
+        if (SFA30_CALL(handle, uart_write)(handle->user, handle->buf, len) != 0)                 /* write data */
+        {
+            SFA30_CALL(handle, debug_print)("sfa30: write read failed.\n");                      /* write read failed */
+            SFA30_STATS_END(handle, SFA30_UART_COMMAND_READ_MEASURED_VALUES, 1);                 /* count the transaction */
+
+            return 1;                                                                            /* return error */
+        }
+        SFA30_STATS_ADD(handle, tx_bytes, len);                                                  /* count the sent bytes */
+        a_sfa30_uart_rx_reset(handle);                                                           /* reset the decoder */
+    }
+    else                                                                                         /* iic */
+    {
+        uint8_t buf[2];
+
+        buf[0] = (SFA30_IIC_COMMAND_READ_MEASURED_VALUES >> 8) & 0xFF;                           /* set msb */
+        buf[1] = (SFA30_IIC_COMMAND_READ_MEASURED_VALUES >> 0) & 0xFF;                           /* set lsb */
+        if (SFA30_CALL(handle, iic_write_cmd)(handle->user, SFA30_ADDRESS, (uint8_t *)buf, 2) != 0) /* write command */
+        {
+            SFA30_CALL(handle, debug_print)("sfa30: read measured values failed.\n");            /* read measured values failed */
+            SFA30_STATS_END(handle, SFA30_IIC_COMMAND_READ_MEASURED_VALUES, 1);                  /* count the transaction */
+
+            return 1;                                                                            /* return error */
+        }
+        SFA30_STATS_ADD(handle, tx_bytes, 2);                                                    /* count the sent bytes */
+    }
+
+    return 0;                                                                                    /* success return 0 */
+}
+
+/**
+ * @brief      collect and decode the read measured values response
+ * @param[in]  *handle pointer to an sfa30 handle structure
+ * @param[out] *data pointer to an sfa30_data_t structure
+ * @return     status code
+ *             - 0 success
+ *             - 1 read failed
+ * @note       the command must have been sent by a_sfa30_read_command,
+ *             only the raw fields are set
+ */
+static uint8_t a_sfa30_read_decode(sfa30_handle_t *handle, sfa30_data_t *data)
+{
+    if (SFA30_HANDLE_IS_UART(handle))                                                                                       /* uart */
+    {
+        uint8_t out_buf[7 + 6];
+
+        memset(out_buf, 0, sizeof(uint8_t) * 13);                                                                           /* clear the buffer */
+        (void)a_sfa30_uart_rx_poll(handle);                                                                                 /* decode the arrived bytes */
+        if (a_sfa30_uart_get_rx_frame(handle, (uint8_t *)out_buf, 13) != 0)                                                 /* get rx frame */
+        {
+            SFA30_CALL(handle, debug_print)("sfa30: write read failed.\n");                                                 /* write read failed */
+
+            return 1;                                                                                                       /* return error */
+        }
+        if (out_buf[11] != sfa30_shdlc_checksum((uint8_t *)&out_buf[1], 10))                                                /* check crc */
+        {
+            SFA30_CALL(handle, debug_print)("sfa30: crc check error.\n");                                                   /* crc check error */
+            SFA30_STATS_ADD(handle, crc_errors, 1);                                                                         /* count the crc error */
+
+            return 1;                                                                                                       /* return error */
+        }
+        if (a_sfa30_uart_error(handle, out_buf[3]) != 0)                                                                    /* check status */
+        {
+            return 1;                                                                                                       /* return error */
+        }
+        data->formaldehyde_raw = (int16_t)(((uint16_t)(out_buf[5 + 0]) << 8) | ((uint16_t)(out_buf[5 + 1]) << 0));          /* copy formaldehyde */
+        data->humidity_raw = (int16_t)(((uint16_t)(out_buf[5 + 2]) << 8) | ((uint16_t)(out_buf[5 + 3]) << 0));              /* copy humidity */
+        data->temperature_raw = (int16_t)(((uint16_t)(out_buf[5 + 4]) << 8) | ((uint16_t)(out_buf[5 + 5]) << 0));           /* copy temperature*/
+    }
+    else                                                                                                                    /* iic */
+    {
+        uint8_t i;
+        uint8_t buf[9];
+
+        memset(buf, 0, sizeof(uint8_t) * 9);                                                                                /* clear the buffer */
+        if (SFA30_CALL(handle, iic_read_cmd)(handle->user, SFA30_ADDRESS, (uint8_t *)buf, 9) != 0)                          /* read data */
+        {
+            SFA30_CALL(handle, debug_print)("sfa30: read measured values failed.\n");                                       /* read measured values failed */
+
+            return 1;                                                                                                       /* return error */
+        }
+        SFA30_STATS_ADD(handle, rx_bytes, 9);                                                                               /* count the received bytes */
+        for (i = 0; i < 3; i++)                                                                                             /* check crc */
+        {
+            if (buf[i * 3 + 2] != sfa30_crc8((uint8_t *)&buf[i * 3], 2))                                                    /* check crc */
+            {
+                SFA30_CALL(handle, debug_print)("sfa30: crc is error.\n");                                                  /* crc is error */
+                SFA30_STATS_ADD(handle, crc_errors, 1);                                                                     /* count the crc error */
+
+                return 1;                                                                                                   /* return error */
+            }
+        }
+        data->formaldehyde_raw = (int16_t)(((uint16_t)(buf[0]) << 8) | ((uint16_t)(buf[1]) << 0));                          /* copy formaldehyde */
+        data->humidity_raw = (int16_t)(((uint16_t)(buf[3]) << 8) | ((uint16_t)(buf[4]) << 0));                              /* copy humidity */
+        data->temperature_raw = (int16_t)(((uint16_t)(buf[6]) << 8) | ((uint16_t)(buf[7]) << 0));                           /* copy temperature*/
+    }
+
+    return 0;                                                                                                               /* success return 0 */
+}
+
+/**
+ * @brief      collect the read measured values response and count the transaction
+ * @param[in]  *handle pointer to an sfa30 handle structure
+ * @param[out] *data pointer to an sfa30_data_t structure
+ * @return     status code
+ *             - 0 success
+ *             - 1 read failed
+ * @note       only the raw fields are set
+ */
+static uint8_t a_sfa30_read_response(sfa30_handle_t *handle, sfa30_data_t *data)
+{
+    uint8_t res;
+
+    res = a_sfa30_read_decode(handle, data);                                                                                /* decode the response */
+    SFA30_STATS_END(handle, SFA30_IIC_COMMAND_READ_MEASURED_VALUES, res);                                                   /* count the transaction */
+
+    return res;                                                                                                             /* return the result */
+}
 
-            break;
-        }
+/**
+ * @brief     wait for the read measured values response
+ * @param[in] *handle pointer to an sfa30 handle structure
+ * @note      uart returns as soon as the frame arrived, iic waits the fixed delay
+ */
+static void a_sfa30_read_wait(sfa30_handle_t *handle)
+{
+    if (SFA30_HANDLE_IS_UART(handle))                                                                                       /* uart */
+    {
+        (void)a_sfa30_uart_rx_wait(handle, SFA30_UART_READ_DELAY_MS);                                                       /* wait for the frame */
     }
+    else                                                                                                                    /* iic */
+    {
+        SFA30_CALL(handle, delay_ms)(handle->user, SFA30_IIC_READ_DELAY_MS);                                                /* delay ms */
+    }
+}
 
-    return e;                                                                                 /* return error code */
+/**
+ * @brief      collect the read measured values response and convert it
+ * @param[in]  *handle pointer to an sfa30 handle structure
+ * @param[out] *data pointer to an sfa30_data_t structure
+ * @return     status code
+ *             - 0 success
+ *             - 1 read failed
+ * @note       the float fields are only set when SFA30_FLOAT_DATA is 1
+ */
+static uint8_t a_sfa30_read_data(sfa30_handle_t *handle, sfa30_data_t *data)
+{
+    if (a_sfa30_read_response(handle, data) != 0)                                                                           /* read the response */
+    {
+        return 1;                                                                                                           /* return error */
+    }
+#if (SFA30_FLOAT_DATA != 0)
+    data->formaldehyde = (float)(data->formaldehyde_raw) / 5.0f;                                                            /* convert formaldehyde */
+    data->humidity = (float)(data->humidity_raw) / 100.0f;                                                                  /* convert humidity */
+    data->temperature = (float)(data->temperature_raw) / 200.0f;                                                            /* convert temperature*/
+#endif
+
+    return 0;                                                                                                               /* success return 0 */
 }
 
 /**
@@ -471,6 +1006,8 @@ static uint8_t a_sfa30_uart_error(sfa30_handle_t *handle, uint8_t e)
  * @return    status code
  *            - 0 success
  *            - 2 handle is NULL
+ *            - 4 interface is not built
+ *            - 5 a read is in progress
  * @note      none
  */
 uint8_t sfa30_set_interface(sfa30_handle_t *handle, sfa30_interface_t interface)
@@ -479,6 +1016,23 @@ uint8_t sfa30_set_interface(sfa30_handle_t *handle, sfa30_interface_t interface)
     {
         return 2;                                 /* return error */
     }
+    if ((handle->inited == 1) && (handle->read_state != SFA30_READ_STATE_IDLE))        /* check read state */
+    {
+        SFA30_CALL(handle, debug_print)("sfa30: read is in progress.\n");              /* read is in progress */
+
+        return 5;                                 /* return error */
+    }
+#if (SFA30_TRANSPORT == SFA30_TRANSPORT_IIC)
+    if (interface != SFA30_INTERFACE_IIC)         /* check interface */
+    {
+        return 4;                                 /* return error */
+    }
+#elif (SFA30_TRANSPORT == SFA30_TRANSPORT_UART)
+    if (interface != SFA30_INTERFACE_UART)        /* check interface */
+    {
+        return 4;                                 /* return error */
+    }
+#endif
 
     handle->iic_uart = (uint8_t)interface;        /* set interface */
 
@@ -501,7 +1055,7 @@ uint8_t sfa30_get_interface(sfa30_handle_t *handle, sfa30_interface_t *interface
         return 2;                                              /* return error */
     }
 
-    *interface = (sfa30_interface_t)(handle->iic_uart);        /* get interface */
+    *interface = (sfa30_interface_t)(SFA30_HANDLE_IS_UART(handle));        /* get interface */
 
     return 0;                                                  /* success return 0 */
 }
@@ -514,6 +1068,7 @@ uint8_t sfa30_get_interface(sfa30_handle_t *handle, sfa30_interface_t *interface
  *            - 1 start measurement failed
  *            - 2 handle is NULL
  *            - 3 handle is not initialized
+ *            - 4 a read is in progress
  * @note      none
  */
 uint8_t sfa30_start_measurement(sfa30_handle_t *handle)
@@ -528,8 +1083,14 @@ uint8_t sfa30_start_measurement(sfa30_handle_t *handle)
     {
         return 3;                                                                                               /* return error */
     }
+    if (handle->read_state != SFA30_READ_STATE_IDLE)                                                            /* check read state */
+    {
+        SFA30_CALL(handle, debug_print)("sfa30: read is in progress.\n");                                       /* read is in progress */
+
+        return 4;                                                                                               /* return error */
+    }
 
-    if (handle->iic_uart != 0)                                                                                  /* uart */
+    if (SFA30_HANDLE_IS_UART(handle))                                                                           /* uart */
     {
         uint8_t input_buf[6 + 1];
         uint8_t out_buf[7];
@@ -539,19 +1100,20 @@ uint8_t sfa30_start_measurement(sfa30_handle_t *handle)
         input_buf[2] = SFA30_UART_COMMAND_START_MEASUREMENT;                                                    /* set command */
         input_buf[3] = 0x01;                                                                                    /* set length */
         input_buf[4] = 0x00;                                                                                    /* set subcommand */
-        input_buf[5] = a_sfa30_generate_crc(handle, (uint8_t *)&input_buf[1], 4);                               /* set crc */
+        input_buf[5] = sfa30_shdlc_checksum((uint8_t *)&input_buf[1], 4);                                       /* set crc */
         input_buf[6] = 0x7E;                                                                                    /* set stop */
         memset(out_buf, 0, sizeof(uint8_t) * 7);                                                                /* clear the buffer */
         res = a_sfa30_uart_write_read(handle, (uint8_t *)input_buf, 7, 10, (uint8_t *)out_buf, 7);              /* write read frame */
         if (res != 0)                                                                                           /* check result */
         {
-            handle->debug_print("sfa30: write read failed.\n");                                                 /* write read failed */
+            SFA30_CALL(handle, debug_print)("sfa30: write read failed.\n");                                     /* write read failed */
 
             return 1;                                                                                           /* return error */
         }
-        if (out_buf[5] != a_sfa30_generate_crc(handle, (uint8_t *)&out_buf[1], 4))                              /* check crc */
+        if (out_buf[5] != sfa30_shdlc_checksum((uint8_t *)&out_buf[1], 4))                                      /* check crc */
         {
-            handle->debug_print("sfa30: crc check error.\n");                                                   /* crc check error */
+            SFA30_CALL(handle, debug_print)("sfa30: crc check error.\n");                                       /* crc check error */
+            SFA30_STATS_ADD(handle, crc_errors, 1);                                                             /* count the crc error */
 
             return 1;                                                                                           /* return error */
         }
@@ -565,7 +1127,7 @@ uint8_t sfa30_start_measurement(sfa30_handle_t *handle)
         res = a_sfa30_iic_write(handle, SFA30_ADDRESS, SFA30_IIC_COMMAND_START_MEASUREMENT, NULL, 0, 1);        /* start measurement command */
         if (res != 0)                                                                                           /* check result */
         {
-            handle->debug_print("sfa30: start measurement failed.\n");                                          /* start measurement failed */
+            SFA30_CALL(handle, debug_print)("sfa30: start measurement failed.\n");                              /* start measurement failed */
 
             return 1;                                                                                           /* return error */
         }
@@ -582,6 +1144,7 @@ uint8_t sfa30_start_measurement(sfa30_handle_t *handle)
  *            - 1 stop measurement failed
  *            - 2 handle is NULL
  *            - 3 handle is not initialized
+ *            - 4 a read is in progress
  * @note      none
  */
 uint8_t sfa30_stop_measurement(sfa30_handle_t *handle)
@@ -596,8 +1159,14 @@ uint8_t sfa30_stop_measurement(sfa30_handle_t *handle)
     {
         return 3;                                                                                              /* return error */
     }
+    if (handle->read_state != SFA30_READ_STATE_IDLE)                                                           /* check read state */
+    {
+        SFA30_CALL(handle, debug_print)("sfa30: read is in progress.\n");                                      /* read is in progress */
+
+        return 4;                                                                                              /* return error */
+    }
 
-    if (handle->iic_uart != 0)                                                                                 /* uart */
+    if (SFA30_HANDLE_IS_UART(handle))                                                                          /* uart */
     {
         uint8_t input_buf[6 + 0];
         uint8_t out_buf[7];
@@ -606,19 +1175,20 @@ uint8_t sfa30_stop_measurement(sfa30_handle_t *handle)
         input_buf[1] = 0x00;                                                                                   /* set addr */
         input_buf[2] = SFA30_UART_COMMAND_STOP_MEASUREMENT;                                                    /* set command */
         input_buf[3] = 0x00;                                                                                   /* set length */
-        input_buf[4] = a_sfa30_generate_crc(handle, (uint8_t *)&input_buf[1], 3);                              /* set crc */
+        input_buf[4] = sfa30_shdlc_checksum((uint8_t *)&input_buf[1], 3);                                      /* set crc */
         input_buf[5] = 0x7E;                                                                                   /* set stop */
         memset(out_buf, 0, sizeof(uint8_t) * 7);                                                               /* clear the buffer */
         res = a_sfa30_uart_write_read(handle, (uint8_t *)input_buf, 6, 10, (uint8_t *)out_buf, 7);             /* write read frame */
         if (res != 0)                                                                                          /* check result */
         {
-            handle->debug_print("sfa30: write read failed.\n");                                                /* write read failed */
+            SFA30_CALL(handle, debug_print)("sfa30: write read failed.\n");                                    /* write read failed */
 
             return 1;                                                                                          /* return error */
         }
-        if (out_buf[5] != a_sfa30_generate_crc(handle, (uint8_t *)&out_buf[1], 4))                             /* check crc */
+        if (out_buf[5] != sfa30_shdlc_checksum((uint8_t *)&out_buf[1], 4))                                     /* check crc */
         {
-            handle->debug_print("sfa30: crc check error.\n");                                                  /* crc check error */
+            SFA30_CALL(handle, debug_print)("sfa30: crc check error.\n");                                      /* crc check error */
+            SFA30_STATS_ADD(handle, crc_errors, 1);                                                            /* count the crc error */
 
             return 1;                                                                                          /* return error */
         }
@@ -632,7 +1202,7 @@ uint8_t sfa30_stop_measurement(sfa30_handle_t *handle)
         res = a_sfa30_iic_write(handle, SFA30_ADDRESS, SFA30_IIC_COMMAND_STOP_MEASUREMENT, NULL, 0, 50);       /* stop measurement command */
         if (res != 0)                                                                                          /* check result */
         {
-            handle->debug_print("sfa30: stop measurement failed.\n");                                          /* stop measurement failed */
+            SFA30_CALL(handle, debug_print)("sfa30: stop measurement failed.\n");                              /* stop measurement failed */
 
             return 1;                                                                                          /* return error */
         }
@@ -650,6 +1220,7 @@ uint8_t sfa30_stop_measurement(sfa30_handle_t *handle)
  *             - 1 get device information failed
  *             - 2 handle is NULL
  *             - 3 handle is not initialized
+ *             - 4 a read is in progress
  * @note       none
  */
 uint8_t sfa30_get_device_information(sfa30_handle_t *handle, char info[32])
@@ -664,9 +1235,15 @@ uint8_t sfa30_get_device_information(sfa30_handle_t *handle, char info[32])
     {
         return 3;                                                                                                         /* return error */
     }
+    if (handle->read_state != SFA30_READ_STATE_IDLE)                                                                      /* check read state */
+    {
+        SFA30_CALL(handle, debug_print)("sfa30: read is in progress.\n");                                                 /* read is in progress */
+
+        return 4;                                                                                                         /* return error */
+    }
 
 
-    if (handle->iic_uart != 0)                                                                                            /* uart */
+    if (SFA30_HANDLE_IS_UART(handle))                                                                                     /* uart */
     {
         uint8_t input_buf[6 + 1];
         uint8_t out_buf[7 + 17];
@@ -676,20 +1253,21 @@ uint8_t sfa30_get_device_information(sfa30_handle_t *handle, char info[32])
         input_buf[2] = SFA30_UART_COMMAND_READ_DEVICE_INFORMATION;                                                        /* set command */
         input_buf[3] = 0x01;                                                                                              /* set length */
         input_buf[4] = 0x06;                                                                                              /* set subcommand */
-        input_buf[5] = a_sfa30_generate_crc(handle, (uint8_t *)&input_buf[1], 4);                                         /* set crc */
+        input_buf[5] = sfa30_shdlc_checksum((uint8_t *)&input_buf[1], 4);                                                 /* set crc */
         input_buf[6] = 0x7E;                                                                                              /* set stop */
         memset(info, 0, sizeof(char) * 32);                                                                               /* clear info */
         memset(out_buf, 0, sizeof(uint8_t) * 24);                                                                         /* clear the buffer */
         res = a_sfa30_uart_write_read(handle, (uint8_t *)input_buf, 7, 10, (uint8_t *)out_buf, 24);                       /* write read frame */
         if (res != 0)                                                                                                     /* check result */
         {
-            handle->debug_print("sfa30: write read failed.\n");                                                           /* write read failed */
+            SFA30_CALL(handle, debug_print)("sfa30: write read failed.\n");                                               /* write read failed */
 
             return 1;                                                                                                     /* return error */
         }
-        if (out_buf[21] != a_sfa30_generate_crc(handle, (uint8_t *)&out_buf[1], 22))                                      /* check crc */
+        if (out_buf[21] != sfa30_shdlc_checksum((uint8_t *)&out_buf[1], 22))                                              /* check crc */
         {
-            handle->debug_print("sfa30: crc check error.\n");                                                             /* crc check error */
+            SFA30_CALL(handle, debug_print)("sfa30: crc check error.\n");                                                 /* crc check error */
+            SFA30_STATS_ADD(handle, crc_errors, 1);                                                                       /* count the crc error */
 
             return 1;                                                                                                     /* return error */
         }
@@ -710,15 +1288,16 @@ uint8_t sfa30_get_device_information(sfa30_handle_t *handle, char info[32])
                                48, 2);                                                                                    /* read measured values command */
         if (res != 0)                                                                                                     /* check result */
         {
-            handle->debug_print("sfa30: read measured values failed.\n");                                                 /* read measured values failed */
+            SFA30_CALL(handle, debug_print)("sfa30: read measured values failed.\n");                                     /* read measured values failed */
 
             return 1;                                                                                                     /* return error */
         }
         for (i = 0; i < 16; i++)                                                                                          /* check crc */
         {
-            if (buf[i * 3 + 2] != a_sfa30_generate_crc(handle, (uint8_t *)&buf[i * 3], 2))                                /* check crc */
+            if (buf[i * 3 + 2] != sfa30_crc8((uint8_t *)&buf[i * 3], 2))                                                  /* check crc */
             {
-                handle->debug_print("sfa30: crc is error.\n");                                                            /* crc is error */
+                SFA30_CALL(handle, debug_print)("sfa30: crc is error.\n");                                                /* crc is error */
+                SFA30_STATS_ADD(handle, crc_errors, 1);                                                                   /* count the crc error */
 
                 return 1;                                                                                                 /* return error */
             }
@@ -733,6 +1312,34 @@ uint8_t sfa30_get_device_information(sfa30_handle_t *handle, char info[32])
     return 0;                                                                                                             /* success return 0 */
 }
 
+#if (SFA30_STATS != 0)
+/**
+ * @brief      copy the statistics block
+ * @param[in]  *handle pointer to an sfa30 handle structure
+ * @param[out] *stats pointer to an sfa30_stats_t structure
+ * @return     status code
+ *             - 0 success
+ *             - 2 handle or stats is NULL
+ *             - 4 no statistics block is linked
+ * @note       only built when SFA30_STATS is 1
+ */
+uint8_t sfa30_stats_snapshot(sfa30_handle_t *handle, sfa30_stats_t *stats)
+{
+    if ((handle == NULL) || (stats == NULL))                                /* check handle */
+    {
+        return 2;                                                           /* return error */
+    }
+    if (handle->stats == NULL)                                              /* check the block */
+    {
+        return 4;                                                           /* return error */
+    }
+
+    memcpy(stats, handle->stats, sizeof(sfa30_stats_t));                   /* copy the block */
+
+    return 0;                                                               /* success return 0 */
+}
+#endif
+
 /**
  * @brief     reset the chip
  * @param[in] *handle pointer to an sfa30 handle structure
@@ -741,6 +1348,7 @@ uint8_t sfa30_get_device_information(sfa30_handle_t *handle, char info[32])
  *            - 1 reset failed
  *            - 2 handle is NULL
  *            - 3 handle is not initialized
+ *            - 4 a read is in progress
  * @note      none
  */
 uint8_t sfa30_reset(sfa30_handle_t *handle)
@@ -755,8 +1363,14 @@ uint8_t sfa30_reset(sfa30_handle_t *handle)
     {
         return 3;                                                                                    /* return error */
     }
+    if (handle->read_state != SFA30_READ_STATE_IDLE)                                                 /* check read state */
+    {
+        SFA30_CALL(handle, debug_print)("sfa30: read is in progress.\n");                            /* read is in progress */
+
+        return 4;                                                                                    /* return error */
+    }
 
-    if (handle->iic_uart != 0)                                                                       /* uart */
+    if (SFA30_HANDLE_IS_UART(handle))                                                                /* uart */
     {
         uint8_t input_buf[6];
         uint8_t out_buf[7];
@@ -765,19 +1379,20 @@ uint8_t sfa30_reset(sfa30_handle_t *handle)
         input_buf[1] = 0x00;                                                                         /* set addr */
         input_buf[2] = SFA30_UART_COMMAND_RESET;                                                     /* set command */
         input_buf[3] = 0x00;                                                                         /* set length */
-        input_buf[4] = a_sfa30_generate_crc(handle, (uint8_t *)&input_buf[1], 3);                    /* set crc */
+        input_buf[4] = sfa30_shdlc_checksum((uint8_t *)&input_buf[1], 3);                            /* set crc */
         input_buf[5] = 0x7E;                                                                         /* set stop */
         memset(out_buf, 0, sizeof(uint8_t) * 7);                                                     /* clear the buffer */
         res = a_sfa30_uart_write_read(handle, (uint8_t *)input_buf, 6, 200, (uint8_t *)out_buf, 7);  /* write read frame */
         if (res != 0)                                                                                /* check result */
         {
-            handle->debug_print("sfa30: write read failed.\n");                                      /* write read failed */
+            SFA30_CALL(handle, debug_print)("sfa30: write read failed.\n");                          /* write read failed */
 
             return 1;                                                                                /* return error */
         }
-        if (out_buf[5] != a_sfa30_generate_crc(handle, (uint8_t *)&out_buf[1], 4))                   /* check crc */
+        if (out_buf[5] != sfa30_shdlc_checksum((uint8_t *)&out_buf[1], 4))                           /* check crc */
         {
-            handle->debug_print("sfa30: crc check error.\n");                                        /* crc check error */
+            SFA30_CALL(handle, debug_print)("sfa30: crc check error.\n");                            /* crc check error */
+            SFA30_STATS_ADD(handle, crc_errors, 1);                                                  /* count the crc error */
 
             return 1;                                                                                /* return error */
         }
@@ -791,7 +1406,7 @@ uint8_t sfa30_reset(sfa30_handle_t *handle)
         res = a_sfa30_iic_write(handle, SFA30_ADDRESS, SFA30_IIC_COMMAND_RESET, NULL, 0, 100);       /* reset command */
         if (res != 0)                                                                                /* check result */
         {
-            handle->debug_print("sfa30: reset failed.\n");                                           /* reset failed */
+            SFA30_CALL(handle, debug_print)("sfa30: reset failed.\n");                               /* reset failed */
 
             return 1;                                                                                /* return error */
         }
@@ -809,89 +1424,368 @@ uint8_t sfa30_reset(sfa30_handle_t *handle)
  *             - 1 read failed
  *             - 2 handle is NULL
  *             - 3 handle is not initialized
+ *             - 4 a read is in progress
  * @note       none
  */
 uint8_t sfa30_read(sfa30_handle_t *handle, sfa30_data_t *data)
 {
-    uint8_t res;
+    if ((handle == NULL) || (data == NULL))                                 /* check handle */
+    {
+        return 2;                                                           /* return error */
+    }
+    if (handle->inited != 1)                                                /* check handle initialization */
+    {
+        return 3;                                                           /* return error */
+    }
+    if (handle->read_state != SFA30_READ_STATE_IDLE)                        /* check read state */
+    {
+        SFA30_CALL(handle, debug_print)("sfa30: read is in progress.\n");   /* read is in progress */
 
-    if ((handle == NULL) || (data == NULL))                                                                                 /* check handle */
+        return 4;                                                           /* return error */
+    }
+
+    if (a_sfa30_read_command(handle) != 0)                                  /* send the read command */
     {
-        return 2;                                                                                                           /* return error */
+        return 1;                                                           /* return error */
     }
-    if (handle->inited != 1)                                                                                                /* check handle initialization */
+    a_sfa30_read_wait(handle);                                              /* wait for the response */
+    if (a_sfa30_read_data(handle, data) != 0)                               /* read the response */
     {
-        return 3;                                                                                                           /* return error */
+        return 1;                                                           /* return error */
     }
 
-    if (handle->iic_uart != 0)                                                                                              /* uart */
+    return 0;                                                               /* success return 0 */
+}
+
+/**
+ * @brief      read the raw result
+ * @param[in]  *handle pointer to an sfa30 handle structure
+ * @param[out] *formaldehyde_raw pointer to a formaldehyde raw buffer
+ * @param[out] *humidity_raw pointer to a humidity raw buffer
+ * @param[out] *temperature_raw pointer to a temperature raw buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 read failed
+ *             - 2 handle is NULL
+ *             - 3 handle is not initialized
+ *             - 4 a read is in progress
+ * @note       no float conversion is done
+ */
+uint8_t sfa30_read_raw(sfa30_handle_t *handle, int16_t *formaldehyde_raw, int16_t *humidity_raw, int16_t *temperature_raw)
+{
+    sfa30_data_t data;
+
+    if ((handle == NULL) || (formaldehyde_raw == NULL) ||
+        (humidity_raw == NULL) || (temperature_raw == NULL))                /* check handle */
     {
-        uint8_t input_buf[6 + 1];
-        uint8_t out_buf[7 + 6];
+        return 2;                                                           /* return error */
+    }
+    if (handle->inited != 1)                                                /* check handle initialization */
+    {
+        return 3;                                                           /* return error */
+    }
+    if (handle->read_state != SFA30_READ_STATE_IDLE)                        /* check read state */
+    {
+        SFA30_CALL(handle, debug_print)("sfa30: read is in progress.\n");   /* read is in progress */
 
-        input_buf[0] = 0x7E;                                                                                                /* set start */
-        input_buf[1] = 0x00;                                                                                                /* set addr */
-        input_buf[2] = SFA30_UART_COMMAND_READ_MEASURED_VALUES;                                                             /* set command */
-        input_buf[3] = 0x01;                                                                                                /* set length */
-        input_buf[4] = 0x02;                                                                                                /* set subcommand */
-        input_buf[5] = a_sfa30_generate_crc(handle, (uint8_t *)&input_buf[1], 4);                                           /* set crc */
-        input_buf[6] = 0x7E;                                                                                                /* set stop */
-        memset(out_buf, 0, sizeof(uint8_t) * 13);                                                                           /* clear the buffer */
-        res = a_sfa30_uart_write_read(handle, (uint8_t *)input_buf, 7, 100, (uint8_t *)out_buf, 13);                        /* write read frame */
-        if (res != 0)                                                                                                       /* check result */
+        return 4;                                                           /* return error */
+    }
+
+    if (a_sfa30_read_command(handle) != 0)                                  /* send the read command */
+    {
+        return 1;                                                           /* return error */
+    }
+    a_sfa30_read_wait(handle);                                              /* wait for the response */
+    if (a_sfa30_read_response(handle, &data) != 0)                          /* read the response */
+    {
+        return 1;                                                           /* return error */
+    }
+    *formaldehyde_raw = data.formaldehyde_raw;                              /* set formaldehyde raw */
+    *humidity_raw = data.humidity_raw;                                      /* set humidity raw */
+    *temperature_raw = data.temperature_raw;                                /* set temperature raw */
+
+    return 0;                                                               /* success return 0 */
+}
+
+/**
+ * @brief     convert the formaldehyde raw to ppb x 10
+ * @param[in] raw formaldehyde raw
+ * @return    formaldehyde in 0.1 ppb
+ * @note      exact, the sensor step is 0.2 ppb
+ */
+int32_t sfa30_formaldehyde_convert_to_ppb_x10(int16_t raw)
+{
+    return (int32_t)raw * 2;                                                /* raw / 5 * 10 */
+}
+
+/**
+ * @brief     convert the humidity raw to %RH x 100
+ * @param[in] raw humidity raw
+ * @return    humidity in 0.01 %RH
+ * @note      exact, the sensor step is 0.01 %RH
+ */
+int32_t sfa30_humidity_convert_to_rh_x100(int16_t raw)
+{
+    return (int32_t)raw;                                                    /* raw / 100 * 100 */
+}
+
+/**
+ * @brief     convert the temperature raw to mC
+ * @param[in] raw temperature raw
+ * @return    temperature in 0.001 C
+ * @note      exact, the sensor step is 0.005 C so C x 100 would need rounding
+ */
+int32_t sfa30_temperature_convert_to_mc(int16_t raw)
+{
+    return (int32_t)raw * 5;                                                /* raw / 200 * 1000 */
+}
+
+/**
+ * @brief      read the result of many sensors
+ * @param[in]  **handles pointer to an array of sfa30 handle structures
+ * @param[out] *data pointer to an sfa30_data_t array
+ * @param[out] *status pointer to a status array
+ * @param[in]  n number of handles
+ * @return     status code
+ *             - 0 success
+ *             - 1 one or more reads failed
+ *             - 2 handles, data or status is NULL
+ * @note       every read command is issued first, then the longest command delay is
+ *             waited once and all responses are collected, each status is the
+ *             sfa30_read status code of its handle or 4 when a non-blocking read is
+ *             in progress, each handle may appear only once
+ */
+uint8_t sfa30_read_many(sfa30_handle_t **handles, sfa30_data_t *data, uint8_t *status, uint16_t n)
+{
+    uint16_t i;
+    uint8_t ret;
+    uint32_t delay;
+    sfa30_handle_t *waiter;
+
+    if ((handles == NULL) || (data == NULL) || (status == NULL))            /* check the arrays */
+    {
+        return 2;                                                           /* return error */
+    }
+
+    delay = 0;                                                              /* no delay */
+    waiter = NULL;                                                          /* no command issued */
+    for (i = 0; i < n; i++)                                                 /* issue all read commands */
+    {
+        sfa30_handle_t *handle = handles[i];
+
+        if (handle == NULL)                                                 /* check handle */
         {
-            handle->debug_print("sfa30: write read failed.\n");                                                             /* write read failed */
+            status[i] = 2;                                                  /* handle is NULL */
 
-            return 1;                                                                                                       /* return error */
+            continue;                                                       /* next */
         }
-        if (out_buf[11] != a_sfa30_generate_crc(handle, (uint8_t *)&out_buf[1], 10))                                        /* check crc */
+        if (handle->inited != 1)                                            /* check handle initialization */
         {
-            handle->debug_print("sfa30: crc check error.\n");                                                               /* crc check error */
+            status[i] = 3;                                                  /* handle is not initialized */
 
-            return 1;                                                                                                       /* return error */
+            continue;                                                       /* next */
         }
-        if (a_sfa30_uart_error(handle, out_buf[3]) != 0)                                                                    /* check status */
+        if (handle->read_state != SFA30_READ_STATE_IDLE)                    /* check read state */
         {
-            return 1;                                                                                                       /* return error */
+            SFA30_CALL(handle, debug_print)("sfa30: read is in progress.\n"); /* read is in progress */
+            status[i] = 4;                                                  /* read is in progress */
+
+            continue;                                                       /* next */
+        }
+        if (a_sfa30_read_command(handle) != 0)                              /* send the read command */
+        {
+            status[i] = 1;                                                  /* read failed */
+
+            continue;                                                       /* next */
+        }
+        status[i] = 0;                                                      /* command issued */
+        waiter = handle;                                                    /* the last handle waits */
+        if (SFA30_HANDLE_IS_UART(handle))                                   /* uart */
+        {
+            delay = SFA30_UART_READ_DELAY_MS;                               /* the uart delay is the longest */
+        }
+        else if (delay < SFA30_IIC_READ_DELAY_MS)                           /* iic */
+        {
+            delay = SFA30_IIC_READ_DELAY_MS;                                /* iic delay */
         }
-        data->formaldehyde_raw = (int16_t)(((uint16_t)(out_buf[5 + 0]) << 8) | ((uint16_t)(out_buf[5 + 1]) << 0));          /* copy formaldehyde */
-        data->humidity_raw = (int16_t)(((uint16_t)(out_buf[5 + 2]) << 8) | ((uint16_t)(out_buf[5 + 3]) << 0));              /* copy humidity */
-        data->temperature_raw = (int16_t)(((uint16_t)(out_buf[5 + 4]) << 8) | ((uint16_t)(out_buf[5 + 5]) << 0));           /* copy temperature*/
-        data->formaldehyde = (float)(data->formaldehyde_raw) / 5.0f;                                                        /* convert formaldehyde */
-        data->humidity = (float)(data->humidity_raw) / 100.0f;                                                              /* convert humidity */
-        data->temperature = (float)(data->temperature_raw) / 200.0f;                                                        /* convert temperature*/
     }
-    else                                                                                                                    /* iic */
+    if (waiter != NULL)                                                     /* check the issued commands */
     {
-        uint8_t i;
-        uint8_t buf[9];
+        SFA30_CALL(waiter, delay_ms)(waiter->user, delay);                  /* wait once after the last command */
+    }
 
-        memset(buf, 0, sizeof(uint8_t) * 9);                                                                                /* clear the buffer */
-        res = a_sfa30_iic_read(handle, SFA30_ADDRESS, SFA30_IIC_COMMAND_READ_MEASURED_VALUES, (uint8_t *)buf, 9, 5);        /* read measured values command */
-        if (res != 0)                                                                                                       /* check result */
+    ret = 0;                                                                /* init 0 */
+    for (i = 0; i < n; i++)                                                 /* collect all responses */
+    {
+        if (status[i] == 0)                                                 /* command issued */
         {
-            handle->debug_print("sfa30: read measured values failed.\n");                                                   /* read measured values failed */
-
-            return 1;                                                                                                       /* return error */
+            if (a_sfa30_read_data(handles[i], &data[i]) != 0)               /* read the response */
+            {
+                status[i] = 1;                                              /* read failed */
+            }
         }
-        for (i = 0; i < 3; i++)                                                                                             /* check crc */
+        if (status[i] != 0)                                                 /* check the status */
         {
-            if (buf[i * 3 + 2] != a_sfa30_generate_crc(handle, (uint8_t *)&buf[i * 3], 2))                                  /* check crc */
-            {
-                handle->debug_print("sfa30: crc is error.\n");                                                              /* crc is error */
+            ret = 1;                                                        /* set failed */
+        }
+    }
 
-                return 1;                                                                                                   /* return error */
-            }
+    return ret;                                                             /* return the result */
+}
+
+/**
+ * @brief     begin a non-blocking read
+ * @param[in] *handle pointer to an sfa30 handle structure
+ * @param[in] now_ms current time of a monotonic millisecond clock
+ * @return    status code
+ *            - 0 success
+ *            - 1 read begin failed
+ *            - 2 handle is NULL
+ *            - 3 handle is not initialized
+ *            - 4 a read is already in progress
+ * @note      the command is sent and the function returns at once,
+ *            drive the read with sfa30_read_poll and collect it with sfa30_read_finish
+ */
+uint8_t sfa30_read_begin(sfa30_handle_t *handle, uint32_t now_ms)
+{
+    if (handle == NULL)                                                     /* check handle */
+    {
+        return 2;                                                           /* return error */
+    }
+    if (handle->inited != 1)                                                /* check handle initialization */
+    {
+        return 3;                                                           /* return error */
+    }
+    if (handle->read_state != SFA30_READ_STATE_IDLE)                        /* check read state */
+    {
+        SFA30_CALL(handle, debug_print)("sfa30: read is in progress.\n");   /* read is in progress */
+
+        return 4;                                                           /* return error */
+    }
+
+    if (a_sfa30_read_command(handle) != 0)                                  /* send the read command */
+    {
+        return 1;                                                           /* return error */
+    }
+    if (SFA30_HANDLE_IS_UART(handle))                                       /* uart */
+    {
+        handle->read_deadline = now_ms + SFA30_UART_READ_DELAY_MS;          /* set the deadline */
+    }
+    else                                                                    /* iic */
+    {
+        handle->read_deadline = now_ms + SFA30_IIC_READ_DELAY_MS;           /* set the deadline */
+    }
+    handle->read_state = SFA30_READ_STATE_WAIT;                             /* set wait state */
+
+    return 0;                                                               /* success return 0 */
+}
+
+/**
+ * @brief      poll a non-blocking read
+ * @param[in]  *handle pointer to an sfa30 handle structure
+ * @param[in]  now_ms current time of a monotonic millisecond clock
+ * @param[out] *state pointer to a read state buffer
+ * @return     status code
+ *             - 0 success
+ *             - 2 handle is NULL
+ *             - 3 handle is not initialized
+ * @note       now_ms must come from the same clock passed to sfa30_read_begin,
+ *             the clock may wrap around, poll at least once every 24 days,
+ *             the uart read is ready as soon as the whole response frame arrived
+ */
+uint8_t sfa30_read_poll(sfa30_handle_t *handle, uint32_t now_ms, sfa30_read_state_t *state)
+{
+    if ((handle == NULL) || (state == NULL))                                /* check handle */
+    {
+        return 2;                                                           /* return error */
+    }
+    if (handle->inited != 1)                                                /* check handle initialization */
+    {
+        return 3;                                                           /* return error */
+    }
+
+    if ((handle->read_state == SFA30_READ_STATE_WAIT) && (SFA30_HANDLE_IS_UART(handle))) /* uart */
+    {
+        uint8_t rx_state;
+
+        rx_state = a_sfa30_uart_rx_poll(handle);                            /* decode the arrived bytes */
+        if ((rx_state == SFA30_UART_RX_DONE) || (rx_state == SFA30_UART_RX_ERROR))  /* frame finished */
+        {
+            handle->read_state = SFA30_READ_STATE_READY;                    /* set ready state */
         }
-        data->formaldehyde_raw = (int16_t)(((uint16_t)(buf[0]) << 8) | ((uint16_t)(buf[1]) << 0));                          /* copy formaldehyde */
-        data->humidity_raw = (int16_t)(((uint16_t)(buf[3]) << 8) | ((uint16_t)(buf[4]) << 0));                              /* copy humidity */
-        data->temperature_raw = (int16_t)(((uint16_t)(buf[6]) << 8) | ((uint16_t)(buf[7]) << 0));                           /* copy temperature*/
-        data->formaldehyde = (float)(data->formaldehyde_raw) / 5.0f;                                                        /* convert formaldehyde */
-        data->humidity = (float)(data->humidity_raw) / 100.0f;                                                              /* convert humidity */
-        data->temperature = (float)(data->temperature_raw) / 200.0f;                                                        /* convert temperature*/
     }
+    if ((handle->read_state == SFA30_READ_STATE_WAIT) &&
+        ((int32_t)(now_ms - handle->read_deadline) >= 0))                   /* check the deadline */
+    {
+        handle->read_state = SFA30_READ_STATE_READY;                        /* set ready state */
+    }
+    *state = (sfa30_read_state_t)(handle->read_state);                      /* get the state */
 
-    return 0;                                                                                                               /* success return 0 */
+    return 0;                                                               /* success return 0 */
+}
+
+/**
+ * @brief      finish a non-blocking read
+ * @param[in]  *handle pointer to an sfa30 handle structure
+ * @param[out] *data pointer to an sfa30_data_t structure
+ * @return     status code
+ *             - 0 success
+ *             - 1 read failed
+ *             - 2 handle is NULL
+ *             - 3 handle is not initialized
+ *             - 4 read is not ready
+ * @note       the handle returns to the idle state whether the read succeeds or not
+ */
+uint8_t sfa30_read_finish(sfa30_handle_t *handle, sfa30_data_t *data)
+{
+    if ((handle == NULL) || (data == NULL))                                 /* check handle */
+    {
+        return 2;                                                           /* return error */
+    }
+    if (handle->inited != 1)                                                /* check handle initialization */
+    {
+        return 3;                                                           /* return error */
+    }
+    if (handle->read_state != SFA30_READ_STATE_READY)                       /* check read state */
+    {
+        SFA30_CALL(handle, debug_print)("sfa30: read is not ready.\n");     /* read is not ready */
+
+        return 4;                                                           /* return error */
+    }
+
+    handle->read_state = SFA30_READ_STATE_IDLE;                             /* set idle state */
+    if (a_sfa30_read_data(handle, data) != 0)                               /* read the response */
+    {
+        return 1;                                                           /* return error */
+    }
+
+    return 0;                                                               /* success return 0 */
+}
+
+/**
+ * @brief     cancel a non-blocking read
+ * @param[in] *handle pointer to an sfa30 handle structure
+ * @return    status code
+ *            - 0 success
+ *            - 2 handle is NULL
+ *            - 3 handle is not initialized
+ * @note      the handle returns to the idle state without any bus traffic,
+ *            a late response is dropped by the next command
+ */
+uint8_t sfa30_read_cancel(sfa30_handle_t *handle)
+{
+    if (handle == NULL)                                                     /* check handle */
+    {
+        return 2;                                                           /* return error */
+    }
+    if (handle->inited != 1)                                                /* check handle initialization */
+    {
+        return 3;                                                           /* return error */
+    }
+
+    handle->read_state = SFA30_READ_STATE_IDLE;                             /* set idle state */
+
+    return 0;                                                               /* success return 0 */
 }
 
 /**
@@ -913,79 +1807,91 @@ uint8_t sfa30_init(sfa30_handle_t *handle)
     {
         return 2;                                                                                    /* return error */
     }
+#if (SFA30_STATIC_BINDING == 0)
     if (handle->debug_print == NULL)                                                                 /* check debug_print */
     {
         return 3;                                                                                    /* return error */
     }
+#if (SFA30_TRANSPORT != SFA30_TRANSPORT_UART)
     if (handle->iic_init == NULL)                                                                    /* check iic_init */
     {
-        handle->debug_print("sfa30: iic_init is null.\n");                                           /* iic_init is null */
+        SFA30_CALL(handle, debug_print)("sfa30: iic_init is null.\n");                               /* iic_init is null */
 
         return 3;                                                                                    /* return error */
     }
     if (handle->iic_deinit == NULL)                                                                  /* check iic_deinit */
     {
-        handle->debug_print("sfa30: iic_deinit is null.\n");                                         /* iic_deinit is null */
+        SFA30_CALL(handle, debug_print)("sfa30: iic_deinit is null.\n");                             /* iic_deinit is null */
 
         return 3;                                                                                    /* return error */
     }
     if (handle->iic_write_cmd == NULL)                                                               /* check iic_write_cmd */
     {
-        handle->debug_print("sfa30: iic_write_cmd is null.\n");                                      /* iic_write_cmd is null */
+        SFA30_CALL(handle, debug_print)("sfa30: iic_write_cmd is null.\n");                          /* iic_write_cmd is null */
 
         return 3;                                                                                    /* return error */
     }
     if (handle->iic_read_cmd == NULL)                                                                /* check iic_read_cmd */
     {
-        handle->debug_print("sfa30: iic_read_cmd is null.\n");                                       /* iic_read_cmd is null */
+        SFA30_CALL(handle, debug_print)("sfa30: iic_read_cmd is null.\n");                           /* iic_read_cmd is null */
 
         return 3;                                                                                    /* return error */
     }
+#endif
+#if (SFA30_TRANSPORT != SFA30_TRANSPORT_IIC)
     if (handle->uart_init == NULL)                                                                   /* check uart_init */
     {
-        handle->debug_print("sfa30: uart_init is null.\n");                                          /* uart_init is null */
+        SFA30_CALL(handle, debug_print)("sfa30: uart_init is null.\n");                              /* uart_init is null */
 
         return 3;                                                                                    /* return error */
     }
     if (handle->uart_deinit == NULL)                                                                 /* check uart_deinit */
     {
-        handle->debug_print("sfa30: uart_deinit is null.\n");                                        /* uart_deinit is null */
+        SFA30_CALL(handle, debug_print)("sfa30: uart_deinit is null.\n");                            /* uart_deinit is null */
 
         return 3;                                                                                    /* return error */
     }
     if (handle->uart_read == NULL)                                                                   /* check uart_read */
     {
-        handle->debug_print("sfa30: uart_read is null.\n");                                          /* uart_read is null */
+        SFA30_CALL(handle, debug_print)("sfa30: uart_read is null.\n");                              /* uart_read is null */
 
         return 3;                                                                                    /* return error */
     }
     if (handle->uart_write == NULL)                                                                  /* check uart_write */
     {
-        handle->debug_print("sfa30: uart_write is null.\n");                                         /* uart_write is null */
+        SFA30_CALL(handle, debug_print)("sfa30: uart_write is null.\n");                             /* uart_write is null */
 
         return 3;                                                                                    /* return error */
     }
     if (handle->uart_flush == NULL)                                                                  /* check uart_flush */
     {
-        handle->debug_print("sfa30: uart_flush is null.\n");                                         /* uart_flush is null */
+        SFA30_CALL(handle, debug_print)("sfa30: uart_flush is null.\n");                             /* uart_flush is null */
 
         return 3;                                                                                    /* return error */
     }
+#endif
     if (handle->delay_ms == NULL)                                                                    /* check delay_ms */
     {
-        handle->debug_print("sfa30: delay_ms is null.\n");                                           /* delay_ms is null */
+        SFA30_CALL(handle, debug_print)("sfa30: delay_ms is null.\n");                               /* delay_ms is null */
 
         return 3;                                                                                    /* return error */
     }
+#endif
 
-    if (handle->iic_uart != 0)                                                                       /* uart */
+    if (SFA30_HANDLE_IS_UART(handle))                                                                /* uart */
     {
         uint8_t input_buf[6];
         uint8_t out_buf[7];
 
-        if (handle->uart_init() != 0)                                                                /* uart init */
+        if (handle->buf == NULL)                                                                     /* check buf */
         {
-            handle->debug_print("sfa30: uart init failed.\n");                                       /* uart init failed */
+            SFA30_CALL(handle, debug_print)("sfa30: buf is null.\n");                                /* buf is null */
+
+            return 3;                                                                                /* return error */
+        }
+        if (SFA30_CALL(handle, uart_init)(handle->user) != 0)                                        /* uart init */
+        {
+            SFA30_CALL(handle, debug_print)("sfa30: uart init failed.\n");                           /* uart init failed */
 
             return 3;                                                                                /* return error */
         }
@@ -993,48 +1899,50 @@ uint8_t sfa30_init(sfa30_handle_t *handle)
         input_buf[1] = 0x00;                                                                         /* set addr */
         input_buf[2] = SFA30_UART_COMMAND_RESET;                                                     /* set command */
         input_buf[3] = 0x00;                                                                         /* set length */
-        input_buf[4] = a_sfa30_generate_crc(handle, (uint8_t *)&input_buf[1], 3);                    /* set crc */
+        input_buf[4] = sfa30_shdlc_checksum((uint8_t *)&input_buf[1], 3);                            /* set crc */
         input_buf[5] = 0x7E;                                                                         /* set stop */
         memset(out_buf, 0, sizeof(uint8_t) * 7);                                                     /* clear the buffer */
         res = a_sfa30_uart_write_read(handle, (uint8_t *)input_buf, 6, 100, (uint8_t *)out_buf, 7);  /* write read frame */
         if (res != 0)                                                                                /* check result */
         {
-            handle->debug_print("sfa30: write read failed.\n");                                      /* write read failed */
-            (void)handle->uart_deinit();                                                             /* uart deinit */
+            SFA30_CALL(handle, debug_print)("sfa30: write read failed.\n");                          /* write read failed */
+            (void)SFA30_CALL(handle, uart_deinit)(handle->user);                                     /* uart deinit */
 
             return 1;                                                                                /* return error */
         }
-        if (out_buf[5] != a_sfa30_generate_crc(handle, (uint8_t *)&out_buf[1], 4))                   /* check crc */
+        if (out_buf[5] != sfa30_shdlc_checksum((uint8_t *)&out_buf[1], 4))                           /* check crc */
         {
-            handle->debug_print("sfa30: crc check error.\n");                                        /* crc check error */
-            (void)handle->uart_deinit();                                                             /* uart deinit */
+            SFA30_CALL(handle, debug_print)("sfa30: crc check error.\n");                            /* crc check error */
+            SFA30_STATS_ADD(handle, crc_errors, 1);                                                  /* count the crc error */
+            (void)SFA30_CALL(handle, uart_deinit)(handle->user);                                     /* uart deinit */
 
             return 1;                                                                                /* return error */
         }
         if (a_sfa30_uart_error(handle, out_buf[3]) != 0)                                             /* check status */
         {
-            (void)handle->uart_deinit();                                                             /* uart deinit */
+            (void)SFA30_CALL(handle, uart_deinit)(handle->user);                                     /* uart deinit */
 
             return 1;                                                                                /* return error */
         }
     }
     else                                                                                             /* iic */
     {
-        if (handle->iic_init() != 0)                                                                 /* iic init */
+        if (SFA30_CALL(handle, iic_init)(handle->user) != 0)                                         /* iic init */
         {
-            handle->debug_print("sfa30: iic init failed.\n");                                        /* iic init failed */
+            SFA30_CALL(handle, debug_print)("sfa30: iic init failed.\n");                            /* iic init failed */
 
             return 3;                                                                                /* return error */
         }
         res = a_sfa30_iic_write(handle, SFA30_ADDRESS, SFA30_IIC_COMMAND_RESET, NULL, 0, 100);       /* reset command */
         if (res != 0)                                                                                /* check result */
         {
-            handle->debug_print("sfa30: reset failed.\n");                                           /* reset failed */
-            (void)handle->iic_deinit();                                                              /* iic deinit */
+            SFA30_CALL(handle, debug_print)("sfa30: reset failed.\n");                               /* reset failed */
+            (void)SFA30_CALL(handle, iic_deinit)(handle->user);                                      /* iic deinit */
 
             return 4;                                                                                /* return error */
         }
     }
+    handle->read_state = SFA30_READ_STATE_IDLE;                                                      /* no read in progress */
     handle->inited = 1;                                                                              /* flag finish initialization */
 
     return 0;                                                                                        /* success return 0 */
@@ -1049,7 +1957,7 @@ uint8_t sfa30_init(sfa30_handle_t *handle)
  *            - 2 handle is NULL
  *            - 3 handle is not initialized
  *            - 4 soft reset failed
- * @note      none
+ * @note      a read in progress is cancelled first
  */
 uint8_t sfa30_deinit(sfa30_handle_t *handle)
 {
@@ -1063,8 +1971,9 @@ uint8_t sfa30_deinit(sfa30_handle_t *handle)
     {
         return 3;                                                                                    /* return error */
     }
+    handle->read_state = SFA30_READ_STATE_IDLE;                                                      /* cancel a read in progress */
 
-    if (handle->iic_uart != 0)                                                                       /* uart */
+    if (SFA30_HANDLE_IS_UART(handle))                                                                /* uart */
     {
         uint8_t input_buf[6];
         uint8_t out_buf[7];
@@ -1073,19 +1982,20 @@ uint8_t sfa30_deinit(sfa30_handle_t *handle)
         input_buf[1] = 0x00;                                                                         /* set addr */
         input_buf[2] = SFA30_UART_COMMAND_RESET;                                                     /* set command */
         input_buf[3] = 0x00;                                                                         /* set length */
-        input_buf[4] = a_sfa30_generate_crc(handle, (uint8_t *)&input_buf[1], 3);                    /* set crc */
+        input_buf[4] = sfa30_shdlc_checksum((uint8_t *)&input_buf[1], 3);                            /* set crc */
         input_buf[5] = 0x7E;                                                                         /* set stop */
         memset(out_buf, 0, sizeof(uint8_t) * 7);                                                     /* clear the buffer */
         res = a_sfa30_uart_write_read(handle, (uint8_t *)input_buf, 6, 100, (uint8_t *)out_buf, 7);  /* write read frame */
         if (res != 0)                                                                                /* check result */
         {
-            handle->debug_print("sfa30: write read failed.\n");                                      /* write read failed */
+            SFA30_CALL(handle, debug_print)("sfa30: write read failed.\n");                          /* write read failed */
 
             return 4;                                                                                /* return error */
         }
-        if (out_buf[5] != a_sfa30_generate_crc(handle, (uint8_t *)&out_buf[1], 4))                   /* check crc */
+        if (out_buf[5] != sfa30_shdlc_checksum((uint8_t *)&out_buf[1], 4))                           /* check crc */
         {
-            handle->debug_print("sfa30: crc check error.\n");                                        /* crc check error */
+            SFA30_CALL(handle, debug_print)("sfa30: crc check error.\n");                            /* crc check error */
+            SFA30_STATS_ADD(handle, crc_errors, 1);                                                  /* count the crc error */
 
             return 4;                                                                                /* return error */
         }
@@ -1093,9 +2003,9 @@ uint8_t sfa30_deinit(sfa30_handle_t *handle)
         {
             return 4;                                                                                /* return error */
         }
-        if (handle->uart_deinit() != 0)                                                              /* uart deinit */
+        if (SFA30_CALL(handle, uart_deinit)(handle->user) != 0)                                      /* uart deinit */
         {
-            handle->debug_print("sfa30: uart deinit failed.\n");                                     /* uart deinit failed */
+            SFA30_CALL(handle, debug_print)("sfa30: uart deinit failed.\n");                         /* uart deinit failed */
 
             return 1;                                                                                /* return error */
         }
@@ -1105,14 +2015,14 @@ uint8_t sfa30_deinit(sfa30_handle_t *handle)
         res = a_sfa30_iic_write(handle, SFA30_ADDRESS, SFA30_IIC_COMMAND_RESET, NULL, 0, 100);       /* reset command */
         if (res != 0)                                                                                /* check result */
         {
-            handle->debug_print("sfa30: reset failed.\n");                                           /* reset failed */
+            SFA30_CALL(handle, debug_print)("sfa30: reset failed.\n");                               /* reset failed */
 
             return 4;                                                                                /* return error */
         }
-        res = handle->iic_deinit();                                                                  /* iic deinit */
+        res = SFA30_CALL(handle, iic_deinit)(handle->user);                                          /* iic deinit */
         if (res != 0)                                                                                /* check result */
         {
-            handle->debug_print("sfa30: iic deinit failed.\n");                                      /* iic deinit */
+            SFA30_CALL(handle, debug_print)("sfa30: iic deinit failed.\n");                          /* iic deinit */
 
             return 1;                                                                                /* return error */
         }
@@ -1133,6 +2043,9 @@ uint8_t sfa30_deinit(sfa30_handle_t *handle)
  * @return     status code
  *             - 0 success
  *             - 1 write read failed
+ *             - 2 handle is NULL
+ *             - 3 handle is not initialized
+ *             - 4 a read is in progress
  * @note       none
  */
 uint8_t sfa30_set_get_reg_uart(sfa30_handle_t *handle, uint8_t *input, uint16_t in_len, uint8_t *output, uint16_t out_len)
@@ -1145,14 +2058,20 @@ uint8_t sfa30_set_get_reg_uart(sfa30_handle_t *handle, uint8_t *input, uint16_t
     {
         return 3;                                                                         /* return error */
     }
+    if (handle->read_state != SFA30_READ_STATE_IDLE)                                      /* check read state */
+    {
+        SFA30_CALL(handle, debug_print)("sfa30: read is in progress.\n");                 /* read is in progress */
+
+        return 4;                                                                         /* return error */
+    }
 
-    if (handle->iic_uart != 0)
+    if (SFA30_HANDLE_IS_UART(handle))
     {
         return a_sfa30_uart_write_read(handle, input, in_len, 20, output, out_len);       /* write and read with the uart interface */
     }
     else
     {
-        handle->debug_print("sfa30: iic interface is invalid.\n");                        /* iic interface is invalid */
+        SFA30_CALL(handle, debug_print)("sfa30: iic interface is invalid.\n");            /* iic interface is invalid */
 
         return 1;                                                                         /* return error */
     }
@@ -1169,6 +2088,7 @@ uint8_t sfa30_set_get_reg_uart(sfa30_handle_t *handle, uint8_t *input, uint16_t
  *            - 1 write failed
  *            - 2 handle is NULL
  *            - 3 handle is not initialized
+ *            - 4 a read is in progress
  * @note      none
  */
 uint8_t sfa30_set_reg_iic(sfa30_handle_t *handle, uint16_t reg, uint8_t *buf, uint16_t len)
@@ -1181,10 +2101,16 @@ uint8_t sfa30_set_reg_iic(sfa30_handle_t *handle, uint16_t reg, uint8_t *buf, ui
     {
         return 3;                                                                 /* return error */
     }
+    if (handle->read_state != SFA30_READ_STATE_IDLE)                              /* check read state */
+    {
+        SFA30_CALL(handle, debug_print)("sfa30: read is in progress.\n");         /* read is in progress */
+
+        return 4;                                                                 /* return error */
+    }
 
-    if (handle->iic_uart != 0)
+    if (SFA30_HANDLE_IS_UART(handle))
     {
-        handle->debug_print("sfa30: uart interface is invalid.\n");               /* uart interface is invalid */
+        SFA30_CALL(handle, debug_print)("sfa30: uart interface is invalid.\n");   /* uart interface is invalid */
 
         return 1;                                                                 /* return error */
     }
@@ -1205,6 +2131,7 @@ uint8_t sfa30_set_reg_iic(sfa30_handle_t *handle, uint16_t reg, uint8_t *buf, ui
  *             - 1 read failed
  *             - 2 handle is NULL
  *             - 3 handle is not initialized
+ *             - 4 a read is in progress
  * @note       none
  */
 uint8_t sfa30_get_reg_iic(sfa30_handle_t *handle, uint16_t reg, uint8_t *buf, uint16_t len)
@@ -1217,10 +2144,16 @@ uint8_t sfa30_get_reg_iic(sfa30_handle_t *handle, uint16_t reg, uint8_t *buf, ui
     {
         return 3;                                                                /* return error */
     }
+    if (handle->read_state != SFA30_READ_STATE_IDLE)                             /* check read state */
+    {
+        SFA30_CALL(handle, debug_print)("sfa30: read is in progress.\n");        /* read is in progress */
+
+        return 4;                                                                /* return error */
+    }
 
-    if (handle->iic_uart != 0)
+    if (SFA30_HANDLE_IS_UART(handle))
     {
-        handle->debug_print("sfa30: uart interface is invalid.\n");              /* uart interface is invalid */
+        SFA30_CALL(handle, debug_print)("sfa30: uart interface is invalid.\n");  /* uart interface is invalid */
 
         return 1;
     }
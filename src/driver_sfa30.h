@@ -51,6 +51,61 @@ extern "C"{
  * @{
  */
 
+/**
+ * @brief sfa30 crc mode definition
+ */
+#define SFA30_CRC_MODE_TABLE          0        /**< 256 bytes table, one lookup per byte */
+#define SFA30_CRC_MODE_NIBBLE         1        /**< 16 bytes table, two lookups per byte */
+#define SFA30_CRC_MODE_BITWISE        2        /**< no table, eight shifts per byte */
+
+/**
+ * @brief sfa30 crc mode selection, define it before the build to save flash
+ */
+#ifndef SFA30_CRC_MODE
+    #define SFA30_CRC_MODE            SFA30_CRC_MODE_TABLE        /**< table by default */
+#endif
+
+/**
+ * @brief sfa30 float data selection, define it as 0 to drop the float fields on fpu-less targets
+ */
+#ifndef SFA30_FLOAT_DATA
+    #define SFA30_FLOAT_DATA          1                           /**< float fields by default */
+#endif
+
+/**
+ * @brief sfa30 transport definition
+ */
+#define SFA30_TRANSPORT_BOTH          0        /**< iic and uart, chosen by sfa30_set_interface */
+#define SFA30_TRANSPORT_IIC           1        /**< iic only, the shdlc code is not built */
+#define SFA30_TRANSPORT_UART          2        /**< uart only, the iic code is not built */
+
+/**
+ * @brief sfa30 transport selection, define it before the build to save flash
+ */
+#ifndef SFA30_TRANSPORT
+    #define SFA30_TRANSPORT           SFA30_TRANSPORT_BOTH        /**< both by default */
+#endif
+
+/**
+ * @brief sfa30 static binding selection, define it as 1 to call the sfa30_interface
+ *        functions directly instead of the handle function pointers
+ */
+#ifndef SFA30_STATIC_BINDING
+    #define SFA30_STATIC_BINDING      0                           /**< function pointers by default */
+#endif
+
+/**
+ * @brief sfa30 statistics selection, define it as 1 to count the transactions
+ */
+#ifndef SFA30_STATS
+    #define SFA30_STATS               0                           /**< no statistics by default */
+#endif
+
+/**
+ * @brief sfa30 uart scratch buffer size definition, the largest stuffed shdlc frame
+ */
+#define SFA30_SCRATCH_SIZE            256
+
 /**
  * @addtogroup sfa30_basic_driver
  * @{
@@ -65,6 +120,16 @@ typedef enum
     SFA30_INTERFACE_UART = 0x01,       /**< uart interface */
 } sfa30_interface_t;
 
+/**
+ * @brief sfa30 read state enumeration definition
+ */
+typedef enum
+{
+    SFA30_READ_STATE_IDLE  = 0x00,        /**< no read in progress */
+    SFA30_READ_STATE_WAIT  = 0x01,        /**< command sent, waiting for the response */
+    SFA30_READ_STATE_READY = 0x02,        /**< response is ready to be collected */
+} sfa30_read_state_t;
+
 /**
  * @brief sfa30 data structure definition
  */
@@ -73,30 +138,88 @@ typedef struct sfa30_data_s
     int16_t formaldehyde_raw;        /**< formaldehyde raw */
     int16_t humidity_raw;            /**< humidity raw */
     int16_t temperature_raw;         /**< temperature raw */
+#if (SFA30_FLOAT_DATA != 0)
     float formaldehyde;              /**< formaldehyde in ppb */
     float humidity;                  /**< humidity in % */
     float temperature;               /**< temperature in C */
+#endif
 } sfa30_data_t;
 
+#if (SFA30_STATS != 0)
+/**
+ * @brief sfa30 statistics command enumeration definition
+ */
+typedef enum
+{
+    SFA30_STATS_COMMAND_START_MEASUREMENT      = 0x00,        /**< 0x0006 or shdlc 0x00 */
+    SFA30_STATS_COMMAND_STOP_MEASUREMENT       = 0x01,        /**< 0x0104 or shdlc 0x01 */
+    SFA30_STATS_COMMAND_READ_MEASURED_VALUES   = 0x02,        /**< 0x0327 or shdlc 0x03 */
+    SFA30_STATS_COMMAND_READ_DEVICE_INFORMATION = 0x03,       /**< 0xD060 or shdlc 0xD0 */
+    SFA30_STATS_COMMAND_RESET                  = 0x04,        /**< 0xD304 or shdlc 0xD3 */
+    SFA30_STATS_COMMAND_OTHER                  = 0x05,        /**< raw register access */
+    SFA30_STATS_COMMAND_MAX                    = 0x06,        /**< number of commands */
+} sfa30_stats_command_t;
+
+/**
+ * @brief sfa30 statistics latency bucket number definition
+ * @note  bucket 0 holds 0 us, bucket b holds 2^(b-1) to 2^b - 1 us, the last one is open
+ */
+#define SFA30_STATS_LATENCY_BUCKETS        24
+
+/**
+ * @brief sfa30 statistics command structure definition
+ */
+typedef struct sfa30_stats_counter_s
+{
+    uint32_t count;                                          /**< transactions */
+    uint32_t errors;                                         /**< failed transactions */
+    uint32_t latency[SFA30_STATS_LATENCY_BUCKETS];           /**< log2 latency histogram in us */
+} sfa30_stats_counter_t;
+
+/**
+ * @brief sfa30 statistics structure definition
+ */
+typedef struct sfa30_stats_s
+{
+    sfa30_stats_counter_t command[SFA30_STATS_COMMAND_MAX];        /**< per command statistics */
+    uint32_t crc_errors;                                             /**< crc or frame check failures */
+    uint32_t shdlc_errors;                                           /**< shdlc state errors */
+    uint32_t tx_bytes;                                               /**< bytes sent */
+    uint32_t rx_bytes;                                               /**< bytes received */
+} sfa30_stats_t;
+#endif
+
 /**
  * @brief sfa30 handle structure definition
  */
 typedef struct sfa30_handle_s
 {
-    uint8_t (*iic_init)(void);                                                /**< point to an iic_init function address */
-    uint8_t (*iic_deinit)(void);                                              /**< point to an iic_deinit function address */
-    uint8_t (*iic_write_cmd)(uint8_t addr, uint8_t *buf, uint16_t len);       /**< point to an iic_write_cmd function address */
-    uint8_t (*iic_read_cmd)(uint8_t addr, uint8_t *buf, uint16_t len);        /**< point to an iic_read_cmd function address */
-    uint8_t (*uart_init)(void);                                               /**< point to a uart_init function address */
-    uint8_t (*uart_deinit)(void);                                             /**< point to a uart_deinit function address */
-    uint16_t (*uart_read)(uint8_t *buf, uint16_t len);                        /**< point to a uart_read function address */
-    uint8_t (*uart_flush)(void);                                              /**< point to a uart_flush function address */
-    uint8_t (*uart_write)(uint8_t *buf, uint16_t len);                        /**< point to a uart_write function address */
-    void (*delay_ms)(uint32_t ms);                                            /**< point to a delay_ms function address */
-    void (*debug_print)(const char *const fmt, ...);                          /**< point to a debug_print function address */
-    uint8_t inited;                                                           /**< inited flag */
-    uint8_t iic_uart;                                                         /**< iic uart */
-    uint8_t buf[256];                                                         /**< inner buffer */
+#if (SFA30_STATIC_BINDING == 0)
+    uint8_t (*iic_init)(void *user);                                                  /**< point to an iic_init function address */
+    uint8_t (*iic_deinit)(void *user);                                                /**< point to an iic_deinit function address */
+    uint8_t (*iic_write_cmd)(void *user, uint8_t addr, uint8_t *buf, uint16_t len);   /**< point to an iic_write_cmd function address */
+    uint8_t (*iic_read_cmd)(void *user, uint8_t addr, uint8_t *buf, uint16_t len);    /**< point to an iic_read_cmd function address */
+    uint8_t (*uart_init)(void *user);                                                 /**< point to a uart_init function address */
+    uint8_t (*uart_deinit)(void *user);                                               /**< point to a uart_deinit function address */
+    uint16_t (*uart_read)(void *user, uint8_t *buf, uint16_t len);                    /**< point to a uart_read function address */
+    uint8_t (*uart_flush)(void *user);                                                /**< point to a uart_flush function address */
+    uint8_t (*uart_write)(void *user, uint8_t *buf, uint16_t len);                    /**< point to a uart_write function address */
+    void (*delay_ms)(void *user, uint32_t ms);                                        /**< point to a delay_ms function address */
+    void (*debug_print)(const char *const fmt, ...);                                  /**< point to a debug_print function address */
+#endif
+#if (SFA30_STATS != 0)
+    uint32_t (*clock_us)(void);                                                       /**< point to a clock_us function address */
+    sfa30_stats_t *stats;                                                             /**< statistics block, can be NULL */
+    uint32_t stats_start_us;                                                          /**< transaction start time */
+#endif
+    void *user;                                                                       /**< user context passed to the transport hooks */
+    uint8_t *buf;                                                                     /**< uart scratch buffer, SFA30_SCRATCH_SIZE bytes */
+    uint32_t read_deadline;                                                           /**< non-blocking read deadline in ms */
+    uint16_t rx_len;                                                                  /**< uart decoded frame length */
+    uint8_t inited : 1;                                                               /**< inited flag */
+    uint8_t iic_uart : 1;                                                             /**< iic uart */
+    uint8_t read_state : 2;                                                           /**< non-blocking read state */
+    uint8_t rx_state : 3;                                                             /**< uart frame decoder state */
 } sfa30_handle_t;
 
 /**
@@ -134,6 +257,27 @@ typedef struct sfa30_info_s
  */
 #define DRIVER_SFA30_LINK_INIT(HANDLE, STRUCTURE)              memset(HANDLE, 0, sizeof(STRUCTURE))
 
+/**
+ * @brief     link the user context
+ * @param[in] HANDLE pointer to an sfa30 handle structure
+ * @param[in] USER pointer to the user context
+ * @note      passed unchanged as the first argument of every transport and delay hook,
+ *            it selects the bus or port of this handle so one set of hooks can serve many sensors
+ */
+#define DRIVER_SFA30_LINK_USER(HANDLE, USER)                  (HANDLE)->user = USER
+
+/**
+ * @brief     link the uart scratch buffer
+ * @param[in] HANDLE pointer to an sfa30 handle structure
+ * @param[in] BUF pointer to a buffer of SFA30_SCRATCH_SIZE bytes
+ * @note      only the uart interface uses it, iic handles can leave it NULL
+ *            handles whose transactions never overlap can share one buffer,
+ *            a non-blocking uart read owns it from sfa30_read_begin until sfa30_read_finish
+ *            or sfa30_read_cancel returns
+ */
+#define DRIVER_SFA30_LINK_SCRATCH(HANDLE, BUF)                (HANDLE)->buf = BUF
+
+#if (SFA30_STATIC_BINDING == 0)
 /**
  * @brief     link uart_init function
  * @param[in] HANDLE pointer to an sfa30 handle structure
@@ -221,6 +365,40 @@ typedef struct sfa30_info_s
  * @note      none
  */
 #define DRIVER_SFA30_LINK_DEBUG_PRINT(HANDLE, FUC)            (HANDLE)->debug_print = FUC
+#else
+/**
+ * @brief link functions are bound to the sfa30_interface functions at build time
+ */
+#define DRIVER_SFA30_LINK_UART_INIT(HANDLE, FUC)              (void)(HANDLE)
+#define DRIVER_SFA30_LINK_UART_DEINIT(HANDLE, FUC)            (void)(HANDLE)
+#define DRIVER_SFA30_LINK_UART_READ(HANDLE, FUC)              (void)(HANDLE)
+#define DRIVER_SFA30_LINK_UART_WRITE(HANDLE, FUC)             (void)(HANDLE)
+#define DRIVER_SFA30_LINK_UART_FLUSH(HANDLE, FUC)             (void)(HANDLE)
+#define DRIVER_SFA30_LINK_IIC_INIT(HANDLE, FUC)               (void)(HANDLE)
+#define DRIVER_SFA30_LINK_IIC_DEINIT(HANDLE, FUC)             (void)(HANDLE)
+#define DRIVER_SFA30_LINK_IIC_WRITE_COMMAND(HANDLE, FUC)      (void)(HANDLE)
+#define DRIVER_SFA30_LINK_IIC_READ_COMMAND(HANDLE, FUC)       (void)(HANDLE)
+#define DRIVER_SFA30_LINK_DELAY_MS(HANDLE, FUC)               (void)(HANDLE)
+#define DRIVER_SFA30_LINK_DEBUG_PRINT(HANDLE, FUC)            (void)(HANDLE)
+#endif
+
+#if (SFA30_STATS != 0)
+/**
+ * @brief     link clock_us function
+ * @param[in] HANDLE pointer to an sfa30 handle structure
+ * @param[in] FUC pointer to a clock_us function address
+ * @note      a free running microsecond clock, latencies are not recorded without it
+ */
+#define DRIVER_SFA30_LINK_CLOCK_US(HANDLE, FUC)               (HANDLE)->clock_us = FUC
+
+/**
+ * @brief     link a statistics block
+ * @param[in] HANDLE pointer to an sfa30 handle structure
+ * @param[in] STATS pointer to a cleared sfa30_stats_t structure
+ * @note      none
+ */
+#define DRIVER_SFA30_LINK_STATS(HANDLE, STATS)                (HANDLE)->stats = STATS
+#endif
 
 /**
  * @}
@@ -250,6 +428,8 @@ uint8_t sfa30_info(sfa30_info_t *info);
  * @return    status code
  *            - 0 success
  *            - 2 handle is NULL
+ *            - 4 interface is not built
+ *            - 5 a read is in progress
  * @note      none
  */
 uint8_t sfa30_set_interface(sfa30_handle_t *handle, sfa30_interface_t interface);
@@ -287,7 +467,7 @@ uint8_t sfa30_init(sfa30_handle_t *handle);
  *            - 2 handle is NULL
  *            - 3 handle is not initialized
  *            - 4 soft reset failed
- * @note      none
+ * @note      a read in progress is cancelled first
  */
 uint8_t sfa30_deinit(sfa30_handle_t *handle);
 
@@ -300,10 +480,123 @@ uint8_t sfa30_deinit(sfa30_handle_t *handle);
  *             - 1 read failed
  *             - 2 handle is NULL
  *             - 3 handle is not initialized
- * @note       none
+ *             - 4 a read is in progress
+ * @note       the float fields are only set when SFA30_FLOAT_DATA is 1
  */
 uint8_t sfa30_read(sfa30_handle_t *handle, sfa30_data_t *data);
 
+/**
+ * @brief      read the raw result
+ * @param[in]  *handle pointer to an sfa30 handle structure
+ * @param[out] *formaldehyde_raw pointer to a formaldehyde raw buffer
+ * @param[out] *humidity_raw pointer to a humidity raw buffer
+ * @param[out] *temperature_raw pointer to a temperature raw buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 read failed
+ *             - 2 handle is NULL
+ *             - 3 handle is not initialized
+ *             - 4 a read is in progress
+ * @note       no float conversion is done
+ */
+uint8_t sfa30_read_raw(sfa30_handle_t *handle, int16_t *formaldehyde_raw, int16_t *humidity_raw, int16_t *temperature_raw);
+
+/**
+ * @brief     convert the formaldehyde raw to ppb x 10
+ * @param[in] raw formaldehyde raw
+ * @return    formaldehyde in 0.1 ppb
+ * @note      exact, the sensor step is 0.2 ppb
+ */
+int32_t sfa30_formaldehyde_convert_to_ppb_x10(int16_t raw);
+
+/**
+ * @brief     convert the humidity raw to %RH x 100
+ * @param[in] raw humidity raw
+ * @return    humidity in 0.01 %RH
+ * @note      exact, the sensor step is 0.01 %RH
+ */
+int32_t sfa30_humidity_convert_to_rh_x100(int16_t raw);
+
+/**
+ * @brief     convert the temperature raw to mC
+ * @param[in] raw temperature raw
+ * @return    temperature in 0.001 C
+ * @note      exact, the sensor step is 0.005 C so C x 100 would need rounding
+ */
+int32_t sfa30_temperature_convert_to_mc(int16_t raw);
+
+/**
+ * @brief      read the result of many sensors
+ * @param[in]  **handles pointer to an array of sfa30 handle structures
+ * @param[out] *data pointer to an sfa30_data_t array
+ * @param[out] *status pointer to a status array
+ * @param[in]  n number of handles
+ * @return     status code
+ *             - 0 success
+ *             - 1 one or more reads failed
+ *             - 2 handles, data or status is NULL
+ * @note       every read command is issued first, then the longest command delay is
+ *             waited once and all responses are collected, each status is the
+ *             sfa30_read status code of its handle or 4 when a non-blocking read is
+ *             in progress, each handle may appear only once
+ */
+uint8_t sfa30_read_many(sfa30_handle_t **handles, sfa30_data_t *data, uint8_t *status, uint16_t n);
+
+/**
+ * @brief     begin a non-blocking read
+ * @param[in] *handle pointer to an sfa30 handle structure
+ * @param[in] now_ms current time of a monotonic millisecond clock
+ * @return    status code
+ *            - 0 success
+ *            - 1 read begin failed
+ *            - 2 handle is NULL
+ *            - 3 handle is not initialized
+ *            - 4 a read is already in progress
+ * @note      the command is sent and the function returns at once,
+ *            drive the read with sfa30_read_poll and collect it with sfa30_read_finish
+ */
+uint8_t sfa30_read_begin(sfa30_handle_t *handle, uint32_t now_ms);
+
+/**
+ * @brief      poll a non-blocking read
+ * @param[in]  *handle pointer to an sfa30 handle structure
+ * @param[in]  now_ms current time of a monotonic millisecond clock
+ * @param[out] *state pointer to a read state buffer
+ * @return     status code
+ *             - 0 success
+ *             - 2 handle is NULL
+ *             - 3 handle is not initialized
+ * @note       now_ms must come from the same clock passed to sfa30_read_begin,
+ *             the clock may wrap around, poll at least once every 24 days
+ */
+uint8_t sfa30_read_poll(sfa30_handle_t *handle, uint32_t now_ms, sfa30_read_state_t *state);
+
+/**
+ * @brief      finish a non-blocking read
+ * @param[in]  *handle pointer to an sfa30 handle structure
+ * @param[out] *data pointer to an sfa30_data_t structure
+ * @return     status code
+ *             - 0 success
+ *             - 1 read failed
+ *             - 2 handle is NULL
+ *             - 3 handle is not initialized
+ *             - 4 read is not ready
+ * @note       the handle returns to the idle state whether the read succeeds or not
+ */
+uint8_t sfa30_read_finish(sfa30_handle_t *handle, sfa30_data_t *data);
+
+/**
+ * @brief     cancel a non-blocking read
+ * @param[in] *handle pointer to an sfa30 handle structure
+ * @return    status code
+ *            - 0 success
+ *            - 2 handle is NULL
+ *            - 3 handle is not initialized
+ * @note      the handle returns to the idle state without any bus traffic,
+ *            a late response is dropped by the next command
+ */
+uint8_t sfa30_read_cancel(sfa30_handle_t *handle);
+
 /**
  * @brief     start the measurement
  * @param[in] *handle pointer to an sfa30 handle structure
@@ -312,6 +605,7 @@ uint8_t sfa30_read(sfa30_handle_t *handle, sfa30_data_t *data);
  *            - 1 start measurement failed
  *            - 2 handle is NULL
  *            - 3 handle is not initialized
+ *            - 4 a read is in progress
  * @note      none
  */
 uint8_t sfa30_start_measurement(sfa30_handle_t *handle);
@@ -324,6 +618,7 @@ uint8_t sfa30_start_measurement(sfa30_handle_t *handle);
  *            - 1 stop measurement failed
  *            - 2 handle is NULL
  *            - 3 handle is not initialized
+ *            - 4 a read is in progress
  * @note      none
  */
 uint8_t sfa30_stop_measurement(sfa30_handle_t *handle);
@@ -336,6 +631,7 @@ uint8_t sfa30_stop_measurement(sfa30_handle_t *handle);
  *            - 1 reset failed
  *            - 2 handle is NULL
  *            - 3 handle is not initialized
+ *            - 4 a read is in progress
  * @note      none
  */
 uint8_t sfa30_reset(sfa30_handle_t *handle);
@@ -349,10 +645,25 @@ uint8_t sfa30_reset(sfa30_handle_t *handle);
  *             - 1 get device information failed
  *             - 2 handle is NULL
  *             - 3 handle is not initialized
+ *             - 4 a read is in progress
  * @note       none
  */
 uint8_t sfa30_get_device_information(sfa30_handle_t *handle, char info[32]);
 
+#if (SFA30_STATS != 0)
+/**
+ * @brief      copy the statistics block
+ * @param[in]  *handle pointer to an sfa30 handle structure
+ * @param[out] *stats pointer to an sfa30_stats_t structure
+ * @return     status code
+ *             - 0 success
+ *             - 2 handle or stats is NULL
+ *             - 4 no statistics block is linked
+ * @note       only built when SFA30_STATS is 1
+ */
+uint8_t sfa30_stats_snapshot(sfa30_handle_t *handle, sfa30_stats_t *stats);
+#endif
+
 /**
  * @}
  */
@@ -364,6 +675,24 @@ uint8_t sfa30_get_device_information(sfa30_handle_t *handle, char info[32]);
  * @{
  */
 
+/**
+ * @brief     calculate the sensirion crc8 of a data word
+ * @param[in] *data pointer to a data buffer
+ * @param[in] len data length
+ * @return    crc
+ * @note      polynomial 0x31, init 0xFF, the engine is chosen by SFA30_CRC_MODE
+ */
+uint8_t sfa30_crc8(const uint8_t *data, uint16_t len);
+
+/**
+ * @brief     calculate the shdlc checksum
+ * @param[in] *data pointer to a data buffer
+ * @param[in] len data length
+ * @return    checksum
+ * @note      inverted least significant byte of the sum of all bytes
+ */
+uint8_t sfa30_shdlc_checksum(const uint8_t *data, uint16_t len);
+
 /**
  * @brief      set and get the chip register with uart interface
  * @param[in]  *handle pointer to an sfa30 handle structure
@@ -374,6 +703,9 @@ uint8_t sfa30_get_device_information(sfa30_handle_t *handle, char info[32]);
  * @return     status code
  *             - 0 success
  *             - 1 write read failed
+ *             - 2 handle is NULL
+ *             - 3 handle is not initialized
+ *             - 4 a read is in progress
  * @note       none
  */
 uint8_t sfa30_set_get_reg_uart(sfa30_handle_t *handle, uint8_t *input, uint16_t in_len, uint8_t *output, uint16_t out_len);
@@ -389,6 +721,7 @@ uint8_t sfa30_set_get_reg_uart(sfa30_handle_t *handle, uint8_t *input, uint16_t
  *            - 1 write failed
  *            - 2 handle is NULL
  *            - 3 handle is not initialized
+ *            - 4 a read is in progress
  * @note      none
  */
 uint8_t sfa30_set_reg_iic(sfa30_handle_t *handle, uint16_t reg, uint8_t *buf, uint16_t len);
@@ -404,6 +737,7 @@ uint8_t sfa30_set_reg_iic(sfa30_handle_t *handle, uint16_t reg, uint8_t *buf, ui
  *             - 1 read failed
  *             - 2 handle is NULL
  *             - 3 handle is not initialized
+ *             - 4 a read is in progress
  * @note       none
  */
 uint8_t sfa30_get_reg_iic(sfa30_handle_t *handle, uint16_t reg, uint8_t *buf, uint16_t len);
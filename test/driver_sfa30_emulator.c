@@ -0,0 +1,825 @@
+/**
+ * Copyright (c) 2015 - present LibDriver All rights reserved
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @file      driver_sfa30_emulator.c
+ * @brief     driver sfa30 emulator source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2023-07-30
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2023/07/30  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#include "driver_sfa30_emulator.h"
+#include <stdarg.h>
+#include <math.h>
+
+/**
+ * @brief emulator chip definition
+ */
+#define EMULATOR_ADDRESS              (0x5D << 1)        /**< chip iic address */
+#define EMULATOR_UPDATE_MS            500                /**< measurement update period */
+#define EMULATOR_PI                   3.14159265358979   /**< pi */
+#define EMULATOR_MUX_ADDRESS          (0x70 << 1)        /**< tca9548a iic address */
+#define EMULATOR_MUX_CHANNELS         8                  /**< tca9548a channels */
+
+/**
+ * @brief emulator shdlc state definition
+ */
+#define EMULATOR_STATE_OK                       0x00     /**< no error */
+#define EMULATOR_STATE_WRONG_LENGTH             0x01     /**< wrong data length for this command */
+#define EMULATOR_STATE_UNKNOWN_COMMAND          0x02     /**< unknown command */
+#define EMULATOR_STATE_NOT_ALLOWED              0x43     /**< command not allowed in current state */
+
+/**
+ * @brief emulator sensor structure definition
+ */
+typedef struct emulator_sensor_s
+{
+    uint8_t channel;                  /**< mux channel */
+    uint8_t measuring;                /**< measuring flag */
+    uint8_t resp[64];                 /**< pending response */
+    uint16_t resp_len;                /**< pending response length */
+    uint16_t resp_pos;                /**< pending response read position */
+    uint32_t resp_ready_ms;           /**< pending response ready time */
+} emulator_sensor_t;
+
+/**
+ * @brief emulator structure definition
+ */
+typedef struct emulator_s
+{
+    uint32_t now_ms;                                       /**< emulator clock */
+    uint32_t iic_latency_ms;                               /**< iic response latency */
+    uint32_t uart_latency_ms;                              /**< uart response latency */
+    uint16_t uart_chunk;                                   /**< uart read chunk size */
+    uint8_t mux_enable;                                    /**< tca9548a enable flag */
+    uint8_t mux_mask;                                      /**< tca9548a control register */
+    uint32_t mux_selects;                                  /**< tca9548a control register writes */
+    emulator_sensor_t sensor[SFA30_EMULATOR_UART_PORTS];   /**< sensors, the first one without the mux */
+    uint32_t tx_bytes;                                     /**< host to sensor bytes */
+    uint32_t rx_bytes;                                     /**< sensor to host bytes */
+} emulator_t;
+
+static emulator_t gs_emulator;        /**< emulator state */
+
+/**
+ * @brief     emulator sensirion crc8
+ * @param[in] *data pointer to a data buffer
+ * @param[in] count data length
+ * @return    crc
+ * @note      none
+ */
+static uint8_t a_emulator_crc8(const uint8_t *data, uint16_t count)
+{
+    uint16_t i;
+    uint8_t bit;
+    uint8_t crc = 0xFF;
+
+    for (i = 0; i < count; i++)
+    {
+        crc ^= data[i];
+        for (bit = 0; bit < 8; bit++)
+        {
+            if ((crc & 0x80) != 0)
+            {
+                crc = (uint8_t)((crc << 1) ^ 0x31);
+            }
+            else
+            {
+                crc = (uint8_t)(crc << 1);
+            }
+        }
+    }
+
+    return crc;
+}
+
+/**
+ * @brief     emulator shdlc checksum
+ * @param[in] *data pointer to a data buffer
+ * @param[in] count data length
+ * @return    checksum
+ * @note      none
+ */
+static uint8_t a_emulator_checksum(const uint8_t *data, uint16_t count)
+{
+    uint16_t i;
+    uint32_t sum = 0;
+
+    for (i = 0; i < count; i++)
+    {
+        sum += data[i];
+    }
+
+    return (uint8_t)(~(sum & 0xFF));
+}
+
+/**
+ * @brief     emulator waveform
+ * @param[in] t_ms time in ms
+ * @param[in] mean mean value
+ * @param[in] amplitude amplitude
+ * @param[in] period_s period in s
+ * @return    waveform value
+ * @note      none
+ */
+static double a_emulator_wave(uint32_t t_ms, double mean, double amplitude, double period_s)
+{
+    return mean + amplitude * sin(2.0 * EMULATOR_PI * ((double)t_ms / 1000.0) / period_s);
+}
+
+/**
+ * @brief      emulator raw measurement
+ * @param[in]  channel mux channel of the sensor
+ * @param[out] *raw pointer to a 3 words raw buffer
+ * @note       formaldehyde in ppb x 5, humidity in % x 100, temperature in C x 200,
+ *             slow sine waves with one lsb of noise, each mux channel reads 1 ppb higher
+ */
+static void a_emulator_measure(uint8_t channel, int16_t raw[3])
+{
+    uint32_t t;
+    uint32_t noise;
+
+    t = (gs_emulator.now_ms / EMULATOR_UPDATE_MS) * EMULATOR_UPDATE_MS;                    /* hold between updates */
+    noise = (t / EMULATOR_UPDATE_MS) * 2654435761U;                                       /* deterministic hash */
+    raw[0] = (int16_t)(lround(a_emulator_wave(t, 25.0, 15.0, 3600.0) * 5.0) +
+                       (int32_t)((noise >> 8) % 3U) - 1 + channel * 5);                   /* formaldehyde with 1 lsb noise */
+    raw[1] = (int16_t)(lround(a_emulator_wave(t, 45.0, 10.0, 86400.0) * 100.0) +
+                       (int32_t)((noise >> 16) % 3U) - 1);                                /* humidity with 1 lsb noise */
+    raw[2] = (int16_t)(lround(a_emulator_wave(t, 22.0, 3.0, 43200.0) * 200.0) +
+                       (int32_t)((noise >> 24) % 3U) - 1);                                /* temperature with 1 lsb noise */
+}
+
+/**
+ * @brief     emulator set the pending response
+ * @param[in] *sensor pointer to an emulator sensor structure
+ * @param[in] *buf pointer to a response buffer
+ * @param[in] len response length
+ * @param[in] latency_ms response latency
+ * @note      none
+ */
+static void a_emulator_respond(emulator_sensor_t *sensor, const uint8_t *buf, uint16_t len, uint32_t latency_ms)
+{
+    memcpy(sensor->resp, buf, len);
+    sensor->resp_len = len;
+    sensor->resp_pos = 0;
+    sensor->resp_ready_ms = gs_emulator.now_ms + latency_ms;
+}
+
+/**
+ * @brief     emulator build a shdlc miso frame
+ * @param[in] *sensor pointer to an emulator sensor structure
+ * @param[in] cmd command
+ * @param[in] state state
+ * @param[in] *data pointer to a data buffer
+ * @param[in] len data length
+ * @note      the frame is byte stuffed and queued as the pending response
+ */
+static void a_emulator_uart_respond(emulator_sensor_t *sensor, uint8_t cmd, uint8_t state, const uint8_t *data, uint8_t len)
+{
+    uint8_t raw[5 + 32];
+    uint8_t frame[64];
+    uint16_t i;
+    uint16_t n;
+
+    raw[0] = 0x00;                                                   /* addr */
+    raw[1] = cmd;                                                    /* command */
+    raw[2] = state;                                                  /* state */
+    raw[3] = len;                                                    /* length */
+    if (len != 0)
+    {
+        memcpy(&raw[4], data, len);                                  /* data */
+    }
+    raw[4 + len] = a_emulator_checksum(raw, (uint16_t)(4 + len));    /* checksum */
+    n = 0;
+    frame[n++] = 0x7E;                                               /* start */
+    for (i = 0; i < (uint16_t)(5 + len); i++)                        /* stuff */
+    {
+        if ((raw[i] == 0x7E) || (raw[i] == 0x7D) || (raw[i] == 0x11) || (raw[i] == 0x13))
+        {
+            frame[n++] = 0x7D;
+            frame[n++] = raw[i] ^ 0x20;
+        }
+        else
+        {
+            frame[n++] = raw[i];
+        }
+    }
+    frame[n++] = 0x7E;                                               /* stop */
+    a_emulator_respond(sensor, frame, n, gs_emulator.uart_latency_ms);
+}
+
+/**
+ * @brief     emulator get the sensor of a uart port
+ * @param[in] *user pointer to the user context
+ * @return    pointer to an emulator sensor structure
+ * @note      none
+ */
+static emulator_sensor_t *a_emulator_uart_sensor(void *user)
+{
+    return (user != NULL) ? (emulator_sensor_t *)user : &gs_emulator.sensor[0];
+}
+
+/**
+ * @brief  emulator get the sensor addressed on the iic bus
+ * @return pointer to an emulator sensor structure, NULL if no sensor answers
+ * @note   behind the mux exactly one channel must be selected, several selected
+ *         sensors at the same address would collide
+ */
+static emulator_sensor_t *a_emulator_iic_sensor(void)
+{
+    uint8_t i;
+
+    if (gs_emulator.mux_enable == 0)                                 /* sensor on the bus */
+    {
+        return &gs_emulator.sensor[0];
+    }
+    for (i = 0; i < EMULATOR_MUX_CHANNELS; i++)                      /* sensor behind the mux */
+    {
+        if (gs_emulator.mux_mask == (uint8_t)(1 << i))
+        {
+            return &gs_emulator.sensor[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief     reset the emulator to its power on state
+ * @note      latency, chunk size, clock and counters are cleared
+ */
+void sfa30_emulator_power_on(void)
+{
+    uint8_t i;
+
+    memset(&gs_emulator, 0, sizeof(emulator_t));
+    for (i = 0; i < SFA30_EMULATOR_UART_PORTS; i++)
+    {
+        gs_emulator.sensor[i].channel = i;
+    }
+}
+
+/**
+ * @brief     set the emulator response latency
+ * @param[in] iic_ms iic command to response latency in ms
+ * @param[in] uart_ms uart command to response latency in ms
+ * @note      a read issued before the latency elapsed is nacked on iic
+ *            and returns no bytes on uart
+ */
+void sfa30_emulator_set_latency(uint32_t iic_ms, uint32_t uart_ms)
+{
+    gs_emulator.iic_latency_ms = iic_ms;
+    gs_emulator.uart_latency_ms = uart_ms;
+}
+
+/**
+ * @brief     set the emulator uart chunk size
+ * @param[in] chunk max bytes returned by one uart read, 0 means unlimited
+ * @note      none
+ */
+void sfa30_emulator_set_uart_chunk(uint16_t chunk)
+{
+    gs_emulator.uart_chunk = chunk;
+}
+
+/**
+ * @brief     enable the emulator mux
+ * @param[in] enable bool value
+ * @note      models a tca9548a at 0x70 with one sensor on each of its 8 channels,
+ *            the mux powers on with no channel selected
+ */
+void sfa30_emulator_set_mux(uint8_t enable)
+{
+    gs_emulator.mux_enable = enable;
+    gs_emulator.mux_mask = 0;
+}
+
+/**
+ * @brief  get the emulator mux control register writes
+ * @return number of channel select writes
+ * @note   none
+ */
+uint32_t sfa30_emulator_get_mux_selects(void)
+{
+    return gs_emulator.mux_selects;
+}
+
+/**
+ * @brief     advance the emulator clock
+ * @param[in] ms time in ms
+ * @note      none
+ */
+void sfa30_emulator_advance_ms(uint32_t ms)
+{
+    gs_emulator.now_ms += ms;
+}
+
+/**
+ * @brief  get the emulator clock
+ * @return current emulator time in ms
+ * @note   none
+ */
+uint32_t sfa30_emulator_get_time_ms(void)
+{
+    return gs_emulator.now_ms;
+}
+
+/**
+ * @brief      get the synthetic measurement at the current emulator time
+ * @param[out] *data pointer to an sfa30_data_t structure
+ * @note       the sensor updates its values every 500 ms
+ */
+void sfa30_emulator_get_expected(sfa30_data_t *data)
+{
+    sfa30_emulator_get_expected_channel(0, data);
+}
+
+/**
+ * @brief      get the synthetic measurement of a mux channel at the current emulator time
+ * @param[in]  channel mux channel
+ * @param[out] *data pointer to an sfa30_data_t structure
+ * @note       the sensor updates its values every 500 ms
+ */
+void sfa30_emulator_get_expected_channel(uint8_t channel, sfa30_data_t *data)
+{
+    int16_t raw[3];
+
+    a_emulator_measure(channel, raw);
+    data->formaldehyde_raw = raw[0];
+    data->humidity_raw = raw[1];
+    data->temperature_raw = raw[2];
+#if (SFA30_FLOAT_DATA != 0)
+    data->formaldehyde = (float)(data->formaldehyde_raw) / 5.0f;
+    data->humidity = (float)(data->humidity_raw) / 100.0f;
+    data->temperature = (float)(data->temperature_raw) / 200.0f;
+#endif
+}
+
+/**
+ * @brief     get the user context of an emulator uart port
+ * @param[in] port uart port
+ * @return    pointer to the user context, NULL if the port is invalid
+ * @note      port n is wired to the sensor of mux channel n, so do not drive both at once,
+ *            a handle without a user context uses port 0
+ */
+void *sfa30_emulator_get_uart_port(uint8_t port)
+{
+    if (port >= SFA30_EMULATOR_UART_PORTS)
+    {
+        return NULL;
+    }
+
+    return &gs_emulator.sensor[port];
+}
+
+/**
+ * @brief      get the bytes moved on the wire
+ * @param[out] *tx pointer to a host to sensor byte counter buffer
+ * @param[out] *rx pointer to a sensor to host byte counter buffer
+ * @note       iic counts include the address byte of each transfer
+ */
+void sfa30_emulator_get_bytes(uint32_t *tx, uint32_t *rx)
+{
+    *tx = gs_emulator.tx_bytes;
+    *rx = gs_emulator.rx_bytes;
+}
+
+/**
+ * @brief     emulator iic bus init
+ * @param[in] *user pointer to the user context
+ * @return    status code
+ *            - 0 success
+ * @note      none
+ */
+uint8_t sfa30_emulator_iic_init(void *user)
+{
+    (void)user;
+
+    return 0;
+}
+
+/**
+ * @brief     emulator iic bus deinit
+ * @param[in] *user pointer to the user context
+ * @return    status code
+ *            - 0 success
+ * @note      none
+ */
+uint8_t sfa30_emulator_iic_deinit(void *user)
+{
+    (void)user;
+
+    return 0;
+}
+
+/**
+ * @brief      emulator iic bus read
+ * @param[in]  *user pointer to the user context
+ * @param[in]  addr iic device write address
+ * @param[out] *buf pointer to a data buffer
+ * @param[in]  len length of the data buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 read failed
+ * @note       none
+ */
+uint8_t sfa30_emulator_iic_read_cmd(void *user, uint8_t addr, uint8_t *buf, uint16_t len)
+{
+    uint16_t i;
+    emulator_sensor_t *sensor;
+
+    (void)user;
+    gs_emulator.tx_bytes++;                                                     /* address byte */
+    if ((gs_emulator.mux_enable != 0) && (addr == EMULATOR_MUX_ADDRESS) && (len == 1))
+    {
+        buf[0] = gs_emulator.mux_mask;                                          /* read the control register */
+        gs_emulator.rx_bytes++;                                                 /* count bytes */
+
+        return 0;
+    }
+    sensor = a_emulator_iic_sensor();                                           /* get the addressed sensor */
+    if ((addr != EMULATOR_ADDRESS) || (sensor == NULL))                         /* check address */
+    {
+        return 1;                                                               /* nack */
+    }
+    if ((sensor->resp_len == 0) ||
+        ((int32_t)(gs_emulator.now_ms - sensor->resp_ready_ms) < 0))            /* check response */
+    {
+        return 1;                                                               /* nack */
+    }
+    for (i = 0; i < len; i++)                                                   /* copy response */
+    {
+        buf[i] = (i < sensor->resp_len) ? sensor->resp[i] : 0xFF;               /* idle bus reads 0xFF */
+    }
+    gs_emulator.rx_bytes += len;                                                /* count bytes */
+    sensor->resp_len = 0;                                                       /* consume response */
+
+    return 0;
+}
+
+/**
+ * @brief     emulator iic bus write
+ * @param[in] *user pointer to the user context
+ * @param[in] addr iic device write address
+ * @param[in] *buf pointer to a data buffer
+ * @param[in] len length of the data buffer
+ * @return    status code
+ *            - 0 success
+ *            - 1 write failed
+ * @note      none
+ */
+uint8_t sfa30_emulator_iic_write_cmd(void *user, uint8_t addr, uint8_t *buf, uint16_t len)
+{
+    uint16_t cmd;
+    uint8_t resp[48];
+    uint8_t i;
+    emulator_sensor_t *sensor;
+
+    (void)user;
+    gs_emulator.tx_bytes += 1 + len;                                            /* address and data bytes */
+    if ((gs_emulator.mux_enable != 0) && (addr == EMULATOR_MUX_ADDRESS) && (len == 1))
+    {
+        gs_emulator.mux_mask = buf[0];                                          /* write the control register */
+        gs_emulator.mux_selects++;                                              /* count selects */
+
+        return 0;
+    }
+    sensor = a_emulator_iic_sensor();                                           /* get the addressed sensor */
+    if ((addr != EMULATOR_ADDRESS) || (sensor == NULL) || (len < 2))            /* check address and length */
+    {
+        return 1;                                                               /* nack */
+    }
+    cmd = (uint16_t)(((uint16_t)buf[0] << 8) | buf[1]);                         /* get command */
+    sensor->resp_len = 0;                                                       /* drop the old response */
+    switch (cmd)
+    {
+        case 0x0006 :                                                           /* start measurement */
+        {
+            sensor->measuring = 1;
+
+            return 0;
+        }
+        case 0x0104 :                                                           /* stop measurement */
+        {
+            sensor->measuring = 0;
+
+            return 0;
+        }
+        case 0x0327 :                                                           /* read measured values */
+        {
+            int16_t raw[3];
+
+            if (sensor->measuring == 0)                                     /* no data in idle mode */
+            {
+                return 0;
+            }
+            a_emulator_measure(sensor->channel, raw);
+            for (i = 0; i < 3; i++)
+            {
+                resp[i * 3 + 0] = (uint8_t)(((uint16_t)raw[i] >> 8) & 0xFF);
+                resp[i * 3 + 1] = (uint8_t)(((uint16_t)raw[i] >> 0) & 0xFF);
+                resp[i * 3 + 2] = a_emulator_crc8(&resp[i * 3], 2);
+            }
+            a_emulator_respond(sensor, resp, 9, gs_emulator.iic_latency_ms);
+
+            return 0;
+        }
+        case 0xD060 :                                                           /* read device marking */
+        {
+            char marking[32];
+
+            memset(marking, 0, sizeof(char) * 32);
+            memcpy(marking, SFA30_EMULATOR_SERIAL, 16);
+            for (i = 0; i < 16; i++)
+            {
+                resp[i * 3 + 0] = (uint8_t)marking[i * 2 + 0];
+                resp[i * 3 + 1] = (uint8_t)marking[i * 2 + 1];
+                resp[i * 3 + 2] = a_emulator_crc8(&resp[i * 3], 2);
+            }
+            a_emulator_respond(sensor, resp, 48, gs_emulator.iic_latency_ms);
+
+            return 0;
+        }
+        case 0xD304 :                                                           /* reset */
+        {
+            sensor->measuring = 0;
+
+            return 0;
+        }
+        default :
+        {
+            return 1;                                                           /* nack unknown command */
+        }
+    }
+}
+
+/**
+ * @brief     emulator uart init
+ * @param[in] *user pointer to the user context
+ * @return    status code
+ *            - 0 success
+ * @note      none
+ */
+uint8_t sfa30_emulator_uart_init(void *user)
+{
+    (void)user;
+
+    return 0;
+}
+
+/**
+ * @brief     emulator uart deinit
+ * @param[in] *user pointer to the user context
+ * @return    status code
+ *            - 0 success
+ * @note      none
+ */
+uint8_t sfa30_emulator_uart_deinit(void *user)
+{
+    (void)user;
+
+    return 0;
+}
+
+/**
+ * @brief      emulator uart read
+ * @param[in]  *user pointer to the user context
+ * @param[out] *buf pointer to a data buffer
+ * @param[in]  len length of the data buffer
+ * @return     length of the read data
+ * @note       none
+ */
+uint16_t sfa30_emulator_uart_read(void *user, uint8_t *buf, uint16_t len)
+{
+    uint16_t n;
+    emulator_sensor_t *sensor = a_emulator_uart_sensor(user);
+
+    if ((int32_t)(gs_emulator.now_ms - sensor->resp_ready_ms) < 0)              /* response is not sent yet */
+    {
+        return 0;
+    }
+    n = sensor->resp_len - sensor->resp_pos;                                    /* remaining bytes */
+    if (n > len)
+    {
+        n = len;
+    }
+    if ((gs_emulator.uart_chunk != 0) && (n > gs_emulator.uart_chunk))          /* split into chunks */
+    {
+        n = gs_emulator.uart_chunk;
+    }
+    memcpy(buf, &sensor->resp[sensor->resp_pos], n);
+    sensor->resp_pos += n;
+    gs_emulator.rx_bytes += n;
+
+    return n;
+}
+
+/**
+ * @brief     emulator uart write
+ * @param[in] *user pointer to the user context
+ * @param[in] *buf pointer to a data buffer
+ * @param[in] len length of the data buffer
+ * @return    status code
+ *            - 0 success
+ *            - 1 write failed
+ * @note      a frame with a bad checksum is ignored like the real sensor does
+ */
+uint8_t sfa30_emulator_uart_write(void *user, uint8_t *buf, uint16_t len)
+{
+    uint8_t raw[64];
+    uint16_t i;
+    uint16_t n;
+    uint8_t cmd;
+    uint8_t data_len;
+    emulator_sensor_t *sensor = a_emulator_uart_sensor(user);
+
+    gs_emulator.tx_bytes += len;                                                /* count bytes */
+    if ((len < 2) || (buf[0] != 0x7E) || (buf[len - 1] != 0x7E))                /* check the flags */
+    {
+        return 0;
+    }
+    n = 0;
+    for (i = 1; i < (uint16_t)(len - 1); i++)                                   /* unstuff */
+    {
+        if (n >= 64)
+        {
+            return 0;
+        }
+        if ((buf[i] == 0x7D) && (i + 1 < (uint16_t)(len - 1)))
+        {
+            i++;
+            raw[n++] = buf[i] ^ 0x20;
+        }
+        else
+        {
+            raw[n++] = buf[i];
+        }
+    }
+    if ((n < 4) || (raw[2] != (uint8_t)(n - 4)) ||
+        (raw[n - 1] != a_emulator_checksum(raw, (uint16_t)(n - 1))))            /* check length and checksum */
+    {
+        return 0;
+    }
+    cmd = raw[1];                                                               /* addr, cmd, len, data, checksum */
+    data_len = raw[2];
+    switch (cmd)
+    {
+        case 0x00 :                                                             /* start measurement */
+        {
+            if ((data_len != 1) || (raw[3] != 0x00))
+            {
+                a_emulator_uart_respond(sensor, cmd, EMULATOR_STATE_WRONG_LENGTH, NULL, 0);
+            }
+            else if (sensor->measuring != 0)
+            {
+                a_emulator_uart_respond(sensor, cmd, EMULATOR_STATE_NOT_ALLOWED, NULL, 0);
+            }
+            else
+            {
+                sensor->measuring = 1;
+                a_emulator_uart_respond(sensor, cmd, EMULATOR_STATE_OK, NULL, 0);
+            }
+
+            break;
+        }
+        case 0x01 :                                                             /* stop measurement */
+        {
+            sensor->measuring = 0;
+            a_emulator_uart_respond(sensor, cmd, EMULATOR_STATE_OK, NULL, 0);
+
+            break;
+        }
+        case 0x03 :                                                             /* read measured values */
+        {
+            int16_t values[3];
+            uint8_t out[6];
+
+            if ((data_len != 1) || (raw[3] != 0x02))
+            {
+                a_emulator_uart_respond(sensor, cmd, EMULATOR_STATE_WRONG_LENGTH, NULL, 0);
+            }
+            else if (sensor->measuring == 0)
+            {
+                a_emulator_uart_respond(sensor, cmd, EMULATOR_STATE_NOT_ALLOWED, NULL, 0);
+            }
+            else
+            {
+                a_emulator_measure(sensor->channel, values);
+                for (i = 0; i < 3; i++)
+                {
+                    out[i * 2 + 0] = (uint8_t)(((uint16_t)values[i] >> 8) & 0xFF);
+                    out[i * 2 + 1] = (uint8_t)(((uint16_t)values[i] >> 0) & 0xFF);
+                }
+                a_emulator_uart_respond(sensor, cmd, EMULATOR_STATE_OK, out, 6);
+            }
+
+            break;
+        }
+        case 0xD0 :                                                             /* device information */
+        {
+            uint8_t out[17];
+
+            if ((data_len != 1) || (raw[3] != 0x06))
+            {
+                a_emulator_uart_respond(sensor, cmd, EMULATOR_STATE_WRONG_LENGTH, NULL, 0);
+            }
+            else
+            {
+                memcpy(out, SFA30_EMULATOR_SERIAL, 16);
+                out[16] = 0x00;                                                 /* null terminated string */
+                a_emulator_uart_respond(sensor, cmd, EMULATOR_STATE_OK, out, 17);
+            }
+
+            break;
+        }
+        case 0xD3 :                                                             /* reset */
+        {
+            sensor->measuring = 0;
+            a_emulator_uart_respond(sensor, cmd, EMULATOR_STATE_OK, NULL, 0);
+
+            break;
+        }
+        default :
+        {
+            a_emulator_uart_respond(sensor, cmd, EMULATOR_STATE_UNKNOWN_COMMAND, NULL, 0);
+
+            break;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief     emulator uart flush
+ * @param[in] *user pointer to the user context
+ * @return    status code
+ *            - 0 success
+ * @note      none
+ */
+uint8_t sfa30_emulator_uart_flush(void *user)
+{
+    emulator_sensor_t *sensor = a_emulator_uart_sensor(user);
+
+    sensor->resp_len = 0;
+    sensor->resp_pos = 0;
+
+    return 0;
+}
+
+/**
+ * @brief     emulator delay ms
+ * @param[in] *user pointer to the user context
+ * @param[in] ms time
+ * @note      advances the emulator clock instead of sleeping
+ */
+void sfa30_emulator_delay_ms(void *user, uint32_t ms)
+{
+    (void)user;
+
+    gs_emulator.now_ms += ms;
+}
+
+/**
+ * @brief     emulator print format data
+ * @param[in] fmt format data
+ * @note      none
+ */
+void sfa30_emulator_debug_print(const char *const fmt, ...)
+{
+    char str[256];
+    va_list args;
+
+    memset((char *)str, 0, sizeof(char) * 256);
+    va_start(args, fmt);
+    vsnprintf((char *)str, 255, (char const *)fmt, args);
+    va_end(args);
+
+    (void)printf("%s", str);
+}
@@ -0,0 +1,258 @@
+/**
+ * Copyright (c) 2015 - present LibDriver All rights reserved
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @file      driver_sfa30_emulator.h
+ * @brief     driver sfa30 emulator header file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2023-07-30
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2023/07/30  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#ifndef DRIVER_SFA30_EMULATOR_H
+#define DRIVER_SFA30_EMULATOR_H
+
+#include "driver_sfa30.h"
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/**
+ * @defgroup sfa30_emulator_driver sfa30 emulator driver function
+ * @brief    sfa30 emulator driver modules
+ * @ingroup  sfa30_driver
+ * @{
+ */
+
+/**
+ * @brief emulator serial number definition
+ */
+#define SFA30_EMULATOR_SERIAL        "SFA30EMULATOR001"        /**< 16 characters device marking */
+#define SFA30_EMULATOR_UART_PORTS    64                        /**< uart ports, the first 8 sensors are also behind the mux */
+
+/**
+ * @brief     reset the emulator to its power on state
+ * @note      latency, chunk size, clock and counters are cleared
+ */
+void sfa30_emulator_power_on(void);
+
+/**
+ * @brief     set the emulator response latency
+ * @param[in] iic_ms iic command to response latency in ms
+ * @param[in] uart_ms uart command to response latency in ms
+ * @note      a read issued before the latency elapsed is nacked on iic
+ *            and returns no bytes on uart
+ */
+void sfa30_emulator_set_latency(uint32_t iic_ms, uint32_t uart_ms);
+
+/**
+ * @brief     set the emulator uart chunk size
+ * @param[in] chunk max bytes returned by one uart read, 0 means unlimited
+ * @note      none
+ */
+void sfa30_emulator_set_uart_chunk(uint16_t chunk);
+
+/**
+ * @brief     enable the emulator mux
+ * @param[in] enable bool value
+ * @note      models a tca9548a at 0x70 with one sensor on each of its 8 channels,
+ *            the mux powers on with no channel selected
+ */
+void sfa30_emulator_set_mux(uint8_t enable);
+
+/**
+ * @brief  get the emulator mux control register writes
+ * @return number of channel select writes
+ * @note   none
+ */
+uint32_t sfa30_emulator_get_mux_selects(void);
+
+/**
+ * @brief     advance the emulator clock
+ * @param[in] ms time in ms
+ * @note      none
+ */
+void sfa30_emulator_advance_ms(uint32_t ms);
+
+/**
+ * @brief  get the emulator clock
+ * @return current emulator time in ms
+ * @note   none
+ */
+uint32_t sfa30_emulator_get_time_ms(void);
+
+/**
+ * @brief      get the synthetic measurement at the current emulator time
+ * @param[out] *data pointer to an sfa30_data_t structure
+ * @note       the sensor updates its values every 500 ms
+ */
+void sfa30_emulator_get_expected(sfa30_data_t *data);
+
+/**
+ * @brief      get the synthetic measurement of a mux channel at the current emulator time
+ * @param[in]  channel mux channel
+ * @param[out] *data pointer to an sfa30_data_t structure
+ * @note       the sensor updates its values every 500 ms
+ */
+void sfa30_emulator_get_expected_channel(uint8_t channel, sfa30_data_t *data);
+
+/**
+ * @brief     get the user context of an emulator uart port
+ * @param[in] port uart port
+ * @return    pointer to the user context, NULL if the port is invalid
+ * @note      port n is wired to the sensor of mux channel n, so do not drive both at once,
+ *            a handle without a user context uses port 0
+ */
+void *sfa30_emulator_get_uart_port(uint8_t port);
+
+/**
+ * @brief      get the bytes moved on the wire
+ * @param[out] *tx pointer to a host to sensor byte counter buffer
+ * @param[out] *rx pointer to a sensor to host byte counter buffer
+ * @note       iic counts include the address byte of each transfer
+ */
+void sfa30_emulator_get_bytes(uint32_t *tx, uint32_t *rx);
+
+/**
+ * @brief     emulator iic bus init
+ * @param[in] *user pointer to the user context
+ * @return    status code
+ *            - 0 success
+ * @note      none
+ */
+uint8_t sfa30_emulator_iic_init(void *user);
+
+/**
+ * @brief     emulator iic bus deinit
+ * @param[in] *user pointer to the user context
+ * @return    status code
+ *            - 0 success
+ * @note      none
+ */
+uint8_t sfa30_emulator_iic_deinit(void *user);
+
+/**
+ * @brief      emulator iic bus read
+ * @param[in]  *user pointer to the user context
+ * @param[in]  addr iic device write address
+ * @param[out] *buf pointer to a data buffer
+ * @param[in]  len length of the data buffer
+ * @return     status code
+ *             - 0 success
+ *             - 1 read failed
+ * @note       none
+ */
+uint8_t sfa30_emulator_iic_read_cmd(void *user, uint8_t addr, uint8_t *buf, uint16_t len);
+
+/**
+ * @brief     emulator iic bus write
+ * @param[in] *user pointer to the user context
+ * @param[in] addr iic device write address
+ * @param[in] *buf pointer to a data buffer
+ * @param[in] len length of the data buffer
+ * @return    status code
+ *            - 0 success
+ *            - 1 write failed
+ * @note      none
+ */
+uint8_t sfa30_emulator_iic_write_cmd(void *user, uint8_t addr, uint8_t *buf, uint16_t len);
+
+/**
+ * @brief     emulator uart init
+ * @param[in] *user pointer to the user context
+ * @return    status code
+ *            - 0 success
+ * @note      none
+ */
+uint8_t sfa30_emulator_uart_init(void *user);
+
+/**
+ * @brief     emulator uart deinit
+ * @param[in] *user pointer to the user context
+ * @return    status code
+ *            - 0 success
+ * @note      none
+ */
+uint8_t sfa30_emulator_uart_deinit(void *user);
+
+/**
+ * @brief      emulator uart read
+ * @param[in]  *user pointer to the user context
+ * @param[out] *buf pointer to a data buffer
+ * @param[in]  len length of the data buffer
+ * @return     length of the read data
+ * @note       none
+ */
+uint16_t sfa30_emulator_uart_read(void *user, uint8_t *buf, uint16_t len);
+
+/**
+ * @brief     emulator uart write
+ * @param[in] *user pointer to the user context
+ * @param[in] *buf pointer to a data buffer
+ * @param[in] len length of the data buffer
+ * @return    status code
+ *            - 0 success
+ *            - 1 write failed
+ * @note      none
+ */
+uint8_t sfa30_emulator_uart_write(void *user, uint8_t *buf, uint16_t len);
+
+/**
+ * @brief     emulator uart flush
+ * @param[in] *user pointer to the user context
+ * @return    status code
+ *            - 0 success
+ * @note      none
+ */
+uint8_t sfa30_emulator_uart_flush(void *user);
+
+/**
+ * @brief     emulator delay ms
+ * @param[in] *user pointer to the user context
+ * @param[in] ms time
+ * @note      advances the emulator clock instead of sleeping
+ */
+void sfa30_emulator_delay_ms(void *user, uint32_t ms);
+
+/**
+ * @brief     emulator print format data
+ * @param[in] fmt format data
+ * @note      none
+ */
+void sfa30_emulator_debug_print(const char *const fmt, ...);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,1683 @@
+/**
+ * Copyright (c) 2015 - present LibDriver All rights reserved
+ *
+ * The MIT License (MIT)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ * @file      driver_sfa30_emulator_test.c
+ * @brief     driver sfa30 emulator test source file
+ * @version   1.0.0
+ * @author    Shifeng Li
+ * @date      2023-07-30
+ *
+ * <h3>history</h3>
+ * <table>
+ * <tr><th>Date        <th>Version  <th>Author      <th>Description
+ * <tr><td>2023/07/30  <td>1.0      <td>Shifeng Li  <td>first upload
+ * </table>
+ */
+
+#include "driver_sfa30_emulator_test.h"
+#include <stdlib.h>
+
+static sfa30_handle_t gs_handle;        /**< sfa30 handle */
+static uint8_t gs_scratch[SFA30_SCRATCH_SIZE];        /**< sfa30 uart scratch buffer */
+static sfa30_sampling_t gs_sampling;    /**< sfa30 sampling */
+static sfa30_history_t gs_history;      /**< sfa30 history */
+static sfa30_history_sample_t gs_history_buf[8];        /**< sfa30 history buffer */
+static sfa30_history_sample_t gs_history_out[8];        /**< sfa30 history drain buffer */
+static sfa30_mux_t gs_mux;                                  /**< sfa30 mux */
+static sfa30_handle_t gs_mux_handle[SFA30_MUX_MAX_CHANNELS];        /**< sfa30 mux handles */
+static sfa30_handle_t gs_port_handle[3];                            /**< sfa30 uart port handles */
+static uint8_t gs_decode_frames[1003 * SFA30_DECODE_FRAME_SIZE];    /**< sfa30 decode input */
+static float gs_decode_ref[3][1003];                                /**< sfa30 decode scalar output */
+static float gs_decode_out[3][1003];                                /**< sfa30 decode kernel output */
+static uint8_t gs_decode_ref_mask[(1003 + 7) / 8];                  /**< sfa30 decode scalar crc mask */
+static uint8_t gs_decode_out_mask[(1003 + 7) / 8];                  /**< sfa30 decode kernel crc mask */
+static uint8_t gs_codec_block[2048];                                /**< sfa30 codec block */
+static uint32_t gs_codec_timestamp[2][3001];                        /**< sfa30 codec input and decoded timestamps */
+static int16_t gs_codec_raw[2][3][3001];                            /**< sfa30 codec input and decoded raw values */
+static sfa30_aggregate_t gs_aggregate;                              /**< sfa30 aggregate */
+static sfa30_aggregate_slot_t gs_aggregate_slot[32 + 128];          /**< sfa30 aggregate slot rings */
+static uint32_t gs_aggregate_timestamp[2001];                       /**< sfa30 aggregate input timestamps */
+static int16_t gs_aggregate_raw[3][2001];                           /**< sfa30 aggregate input raw values */
+static sfa30_quantile_t gs_quantile[3];                             /**< sfa30 quantile sketches of all, even and odd samples */
+static int16_t gs_quantile_raw[20000];                              /**< sfa30 quantile input raw values */
+#if (SFA30_STATS != 0)
+static sfa30_stats_t gs_stats;                                      /**< sfa30 statistics */
+
+/**
+ * @brief  emulator microsecond clock
+ * @return time in us
+ * @note   none
+ */
+static uint32_t a_sfa30_emulator_test_clock_us(void)
+{
+    return sfa30_emulator_get_time_ms() * 1000;
+}
+
+/**
+ * @brief     check the statistics against the emulator
+ * @param[in] interface chip interface
+ * @param[in] tx0 host to sensor bytes before the test
+ * @param[in] rx0 sensor to host bytes before the test
+ * @return    status code
+ *            - 0 success
+ *            - 1 check failed
+ * @note      none
+ */
+static uint8_t a_sfa30_emulator_test_stats(sfa30_interface_t interface, uint32_t tx0, uint32_t rx0)
+{
+    sfa30_stats_t stats;
+    sfa30_stats_counter_t *read;
+    uint32_t tx1;
+    uint32_t rx1;
+    uint32_t sum;
+    uint8_t i;
+
+    sfa30_emulator_debug_print("sfa30: statistics test.\n");
+    if (sfa30_stats_snapshot(&gs_handle, &stats) != 0)
+    {
+        sfa30_emulator_debug_print("sfa30: stats snapshot failed.\n");
+
+        return 1;
+    }
+    read = &stats.command[SFA30_STATS_COMMAND_READ_MEASURED_VALUES];
+    sum = 0;
+    for (i = 0; i < SFA30_STATS_LATENCY_BUCKETS; i++)
+    {
+        sum += read->latency[i];
+    }
+    if ((read->count == 0) || (read->errors == 0) || (sum != read->count) ||
+        (stats.command[SFA30_STATS_COMMAND_START_MEASUREMENT].count == 0) ||
+        (stats.command[SFA30_STATS_COMMAND_READ_DEVICE_INFORMATION].count == 0) ||
+        (stats.command[SFA30_STATS_COMMAND_RESET].count == 0))
+    {
+        sfa30_emulator_debug_print("sfa30: stats command check failed.\n");
+
+        return 1;
+    }
+    if (interface == SFA30_INTERFACE_UART)
+    {
+        sfa30_emulator_get_bytes(&tx1, &rx1);
+        if ((stats.tx_bytes != tx1 - tx0) || (stats.rx_bytes != rx1 - rx0))
+        {
+            sfa30_emulator_debug_print("sfa30: stats byte check failed.\n");
+
+            return 1;
+        }
+    }
+    sfa30_emulator_debug_print("sfa30: %d reads, %d failed, %d tx bytes, %d rx bytes.\n",
+                               (int)read->count, (int)read->errors, (int)stats.tx_bytes, (int)stats.rx_bytes);
+
+    return 0;
+}
+#endif
+
+/**
+ * @brief     check the read data against the emulator
+ * @param[in] *data pointer to the read data
+ * @param[in] *expect pointer to the expected data
+ * @return    status code
+ *            - 0 success
+ *            - 1 check failed
+ * @note      none
+ */
+static uint8_t a_sfa30_emulator_test_check(sfa30_data_t *data, sfa30_data_t *expect)
+{
+    if ((data->formaldehyde_raw != expect->formaldehyde_raw) ||
+        (data->humidity_raw != expect->humidity_raw) ||
+        (data->temperature_raw != expect->temperature_raw))
+    {
+        sfa30_emulator_debug_print("sfa30: data check failed.\n");
+
+        return 1;
+    }
+#if (SFA30_FLOAT_DATA != 0)
+    if ((data->formaldehyde != expect->formaldehyde) ||
+        (data->humidity != expect->humidity) ||
+        (data->temperature != expect->temperature))
+    {
+        sfa30_emulator_debug_print("sfa30: data check failed.\n");
+
+        return 1;
+    }
+#endif
+
+    return 0;
+}
+
+/**
+ * @brief     print a sample
+ * @param[in] *data pointer to an sfa30_data_t structure
+ * @note      a float free build prints the fixed point conversions
+ */
+static void a_sfa30_emulator_test_print(const sfa30_data_t *data)
+{
+#if (SFA30_FLOAT_DATA != 0)
+    sfa30_emulator_debug_print("sfa30: formaldehyde is %0.2fppb.\n", data->formaldehyde);
+    sfa30_emulator_debug_print("sfa30: humidity is %0.2f%%.\n", data->humidity);
+    sfa30_emulator_debug_print("sfa30: temperature is %0.2fC.\n", data->temperature);
+#else
+    int32_t formaldehyde = sfa30_formaldehyde_convert_to_ppb_x10(data->formaldehyde_raw);
+    int32_t humidity = sfa30_humidity_convert_to_rh_x100(data->humidity_raw);
+    int32_t temperature = sfa30_temperature_convert_to_mc(data->temperature_raw);
+
+    sfa30_emulator_debug_print("sfa30: formaldehyde is %s%d.%01dppb.\n", (formaldehyde < 0) ? "-" : "",
+                               (int)(((formaldehyde < 0) ? -formaldehyde : formaldehyde) / 10),
+                               (int)(((formaldehyde < 0) ? -formaldehyde : formaldehyde) % 10));
+    sfa30_emulator_debug_print("sfa30: humidity is %s%d.%02d%%.\n", (humidity < 0) ? "-" : "",
+                               (int)(((humidity < 0) ? -humidity : humidity) / 100),
+                               (int)(((humidity < 0) ? -humidity : humidity) % 100));
+    sfa30_emulator_debug_print("sfa30: temperature is %s%d.%03dC.\n", (temperature < 0) ? "-" : "",
+                               (int)(((temperature < 0) ? -temperature : temperature) / 1000),
+                               (int)(((temperature < 0) ? -temperature : temperature) % 1000));
+#endif
+}
+
+/**
+ * @brief  check the fixed point conversion against the float conversion
+ * @return status code
+ *         - 0 success
+ *         - 1 check failed
+ * @note   every raw value is checked
+ */
+static uint8_t a_sfa30_emulator_test_fixed_point(void)
+{
+    int32_t i;
+
+    for (i = -32768; i <= 32767; i++)
+    {
+        int16_t raw = (int16_t)i;
+
+        if (((float)sfa30_formaldehyde_convert_to_ppb_x10(raw) / 10.0f != (float)raw / 5.0f) ||
+            ((float)sfa30_humidity_convert_to_rh_x100(raw) / 100.0f != (float)raw / 100.0f) ||
+            ((float)sfa30_temperature_convert_to_mc(raw) / 1000.0f != (float)raw / 200.0f))
+        {
+            sfa30_emulator_debug_print("sfa30: fixed point check failed at %d.\n", i);
+
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief      emulator codec check of one sealed block
+ * @param[in]  first first sample of the block
+ * @param[in]  n samples in the block
+ * @param[in]  size block size
+ * @return     status code
+ *             - 0 success
+ *             - 1 check failed
+ * @note       none
+ */
+static uint8_t a_sfa30_emulator_test_codec_check(uint32_t first, uint32_t n, uint32_t size)
+{
+    uint32_t count;
+    uint32_t i;
+
+    if ((sfa30_codec_decode(gs_codec_block, size, n, gs_codec_timestamp[1], gs_codec_raw[1][0],
+                            gs_codec_raw[1][1], gs_codec_raw[1][2], &count) != 0) || (count != n))
+    {
+        sfa30_emulator_debug_print("sfa30: codec decode failed at %d.\n", (int)first);
+
+        return 1;
+    }
+    for (i = 0; i < n; i++)
+    {
+        if ((gs_codec_timestamp[1][i] != gs_codec_timestamp[0][first + i]) ||
+            (gs_codec_raw[1][0][i] != gs_codec_raw[0][0][first + i]) ||
+            (gs_codec_raw[1][1][i] != gs_codec_raw[0][1][first + i]) ||
+            (gs_codec_raw[1][2][i] != gs_codec_raw[0][2][first + i]))
+        {
+            sfa30_emulator_debug_print("sfa30: codec check failed at %d.\n", (int)(first + i));
+
+            return 1;
+        }
+    }
+
+    /* a short buffer and a damaged size are refused */
+    if ((n > 1) && (sfa30_codec_decode(gs_codec_block, size, n - 1, gs_codec_timestamp[1], gs_codec_raw[1][0],
+                                       gs_codec_raw[1][1], gs_codec_raw[1][2], &count) != 4))
+    {
+        sfa30_emulator_debug_print("sfa30: codec short buffer check failed.\n");
+
+        return 1;
+    }
+    if (sfa30_codec_decode(gs_codec_block, size - 1, n, gs_codec_timestamp[1], gs_codec_raw[1][0],
+                           gs_codec_raw[1][1], gs_codec_raw[1][2], &count) != 1)
+    {
+        sfa30_emulator_debug_print("sfa30: codec size check failed.\n");
+
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief  emulator codec test
+ * @return status code
+ *         - 0 success
+ *         - 1 test failed
+ * @note   jittered timestamps wrapping past 0xFFFFFFFF with a few gaps, slow noisy values
+ *         with a few full range jumps, split over small blocks
+ */
+static uint8_t a_sfa30_emulator_test_codec(void)
+{
+    const uint32_t n = 3001;
+    sfa30_codec_encoder_t encoder;
+    sfa30_data_t data;
+    uint32_t seed = 0x9E3779B9U;
+    uint32_t first;
+    uint32_t blocks;
+    uint32_t size;
+    uint32_t i;
+    uint8_t res;
+
+    sfa30_emulator_debug_print("sfa30: codec test.\n");
+    gs_codec_timestamp[0][0] = 0xFFFFFFFFU - 500U * 1000U;
+    gs_codec_raw[0][0][0] = 125;
+    gs_codec_raw[0][1][0] = 4500;
+    gs_codec_raw[0][2][0] = 4400;
+    for (i = 1; i < n; i++)
+    {
+        uint8_t s;
+
+        seed = seed * 1664525U + 1013904223U;
+        gs_codec_timestamp[0][i] = gs_codec_timestamp[0][i - 1] + 500U + ((seed >> 28) & 1U) -
+                                   ((seed >> 29) & 1U) + ((((seed >> 8) & 511U) == 0) ? 70000U : 0U);
+        for (s = 0; s < 3; s++)
+        {
+            gs_codec_raw[0][s][i] = (int16_t)(gs_codec_raw[0][s][i - 1] + (int32_t)((seed >> (10 + 4 * s)) % 3U) - 1);
+        }
+        if ((i % 997U) == 0)
+        {
+            gs_codec_raw[0][i % 3U][i] = (gs_codec_raw[0][i % 3U][i - 1] < 0) ? 32767 : -32768;        /* full range jump */
+        }
+    }
+
+    /* fill small blocks, seal them when full and check each one */
+    first = 0;
+    blocks = 0;
+    (void)sfa30_codec_encoder_init(&encoder, gs_codec_block, sizeof(gs_codec_block), 500);
+    for (i = 0; i < n; )
+    {
+        data.formaldehyde_raw = gs_codec_raw[0][0][i];
+        data.humidity_raw = gs_codec_raw[0][1][i];
+        data.temperature_raw = gs_codec_raw[0][2][i];
+        res = sfa30_codec_encoder_append(&encoder, gs_codec_timestamp[0][i], &data);
+        if (res == 0)
+        {
+            i++;
+            continue;
+        }
+        if ((res != 1) || (i == first) || (sfa30_codec_encoder_seal(&encoder, &size) != 0) ||
+            (sfa30_codec_encoder_append(&encoder, gs_codec_timestamp[0][i], &data) != 4))
+        {
+            sfa30_emulator_debug_print("sfa30: codec append failed at %d.\n", (int)i);
+
+            return 1;
+        }
+        if (a_sfa30_emulator_test_codec_check(first, i - first, size) != 0)
+        {
+            return 1;
+        }
+        blocks++;
+        first = i;
+        (void)sfa30_codec_encoder_init(&encoder, gs_codec_block, sizeof(gs_codec_block), 500);
+    }
+    if ((sfa30_codec_encoder_seal(&encoder, &size) != 0) || (a_sfa30_emulator_test_codec_check(first, n - first, size) != 0))
+    {
+        sfa30_emulator_debug_print("sfa30: codec last block failed.\n");
+
+        return 1;
+    }
+    sfa30_emulator_debug_print("sfa30: codec %d samples in %d blocks match.\n", (int)n, (int)(blocks + 1));
+
+    /* constant values on the period grid give width 0 streams, decoded from an exact size copy
+       so a sanitizer sees any read past the pad, with full frames only and with a short last frame */
+    for (blocks = 0; blocks < 2; blocks++)
+    {
+        const uint32_t total = (blocks == 0) ? 257 : 101;
+        uint8_t *copy;
+        uint32_t count;
+
+        (void)sfa30_codec_encoder_init(&encoder, gs_codec_block, sizeof(gs_codec_block), 500);
+        data.formaldehyde_raw = 125;
+        data.humidity_raw = 4500;
+        data.temperature_raw = 4400;
+        for (i = 0; i < total; i++)
+        {
+            if (sfa30_codec_encoder_append(&encoder, 1000U + i * 500U, &data) != 0)
+            {
+                sfa30_emulator_debug_print("sfa30: codec constant append failed at %d.\n", (int)i);
+
+                return 1;
+            }
+        }
+        copy = NULL;
+        if (sfa30_codec_encoder_seal(&encoder, &size) == 0)
+        {
+            copy = (uint8_t *)malloc(size);
+        }
+        if (copy == NULL)
+        {
+            sfa30_emulator_debug_print("sfa30: codec constant seal failed.\n");
+
+            return 1;
+        }
+        memcpy(copy, gs_codec_block, size);
+        res = sfa30_codec_decode(copy, size, total, gs_codec_timestamp[1], gs_codec_raw[1][0],
+                                 gs_codec_raw[1][1], gs_codec_raw[1][2], &count);
+        free(copy);
+        for (i = 0; (res == 0) && (i < total); i++)
+        {
+            if ((gs_codec_timestamp[1][i] != 1000U + i * 500U) || (gs_codec_raw[1][0][i] != 125) ||
+                (gs_codec_raw[1][1][i] != 4500) || (gs_codec_raw[1][2][i] != 4400))
+            {
+                res = 1;
+            }
+        }
+        if ((res != 0) || (count != total))
+        {
+            sfa30_emulator_debug_print("sfa30: codec constant check failed.\n");
+
+            return 1;
+        }
+        sfa30_emulator_debug_print("sfa30: codec %d constant samples in %d bytes match.\n", (int)total, (int)size);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief      emulator aggregate check of one window against a two pass reference
+ * @param[in]  first first sample of the window
+ * @param[in]  n samples in the window
+ * @param[in]  *result pointer to the aggregate result
+ * @return     status code
+ *             - 0 success
+ *             - 1 check failed
+ * @note       the mean must be rounded and the standard deviation rounded down
+ */
+static uint8_t a_sfa30_emulator_test_aggregate_check(uint32_t first, uint32_t n, const sfa30_aggregate_result_t *result)
+{
+    const sfa30_aggregate_stat_t *stat[3];
+    uint32_t i;
+    uint8_t c;
+
+    stat[0] = &result->formaldehyde;
+    stat[1] = &result->humidity;
+    stat[2] = &result->temperature;
+    if ((result->count != n) || (n == 0))
+    {
+        return 1;
+    }
+    for (c = 0; c < 3; c++)
+    {
+        int16_t min = gs_aggregate_raw[c][first];
+        int16_t max = min;
+        double mean = 0.0;
+        double var = 0.0;
+        double sd;
+
+        for (i = first; i < first + n; i++)
+        {
+            min = (gs_aggregate_raw[c][i] < min) ? gs_aggregate_raw[c][i] : min;
+            max = (gs_aggregate_raw[c][i] > max) ? gs_aggregate_raw[c][i] : max;
+            mean += (double)gs_aggregate_raw[c][i];
+        }
+        mean /= (double)n;
+        for (i = first; i < first + n; i++)
+        {
+            var += ((double)gs_aggregate_raw[c][i] - mean) * ((double)gs_aggregate_raw[c][i] - mean);
+        }
+        var = var / (double)n * 65536.0;
+        sd = (double)stat[c]->stddev_q8;
+        if ((stat[c]->min_raw != min) || (stat[c]->max_raw != max) ||
+            ((double)stat[c]->mean_q8 - mean * 256.0 > 0.5001) || ((double)stat[c]->mean_q8 - mean * 256.0 < -0.5001) ||
+            (sd * sd > var + 2.0) || ((sd + 1.0) * (sd + 1.0) <= var - 2.0))
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief  emulator aggregate test
+ * @return status code
+ *         - 0 success
+ *         - 1 test failed
+ * @note   a 10 s and a 60 s sliding window and a 7 s tumbling only window are checked
+ *         after every push across jitter, gaps and full range jumps
+ */
+static uint8_t a_sfa30_emulator_test_aggregate(void)
+{
+    const uint32_t n = 2001;
+    const uint32_t length[3] = {10000, 60000, 7000};
+    sfa30_aggregate_slot_t *const slot[3] = {&gs_aggregate_slot[0], &gs_aggregate_slot[32], NULL};
+    const uint32_t capacity[3] = {32, 128, 0};
+    sfa30_aggregate_result_t result;
+    sfa30_data_t data;
+    uint32_t begin[3] = {0, 0, 0};
+    uint32_t seed = 0x7F4A7C15U;
+    uint32_t closed = 0;
+    uint32_t index;
+    uint32_t first;
+    uint32_t i;
+    uint8_t w;
+
+    sfa30_emulator_debug_print("sfa30: aggregate test.\n");
+    gs_aggregate_timestamp[0] = 0xFFFFFFFFU - 500U * 300U;
+    gs_aggregate_raw[0][0] = 125;
+    gs_aggregate_raw[1][0] = 4500;
+    gs_aggregate_raw[2][0] = -400;
+    for (i = 1; i < n; i++)
+    {
+        uint8_t c;
+
+        seed = seed * 1664525U + 1013904223U;
+        gs_aggregate_timestamp[i] = gs_aggregate_timestamp[i - 1] + 500U + ((seed >> 28) & 1U) +
+                                    ((((seed >> 8) & 255U) == 0) ? 70000U : 0U);
+        for (c = 0; c < 3; c++)
+        {
+            gs_aggregate_raw[c][i] = (int16_t)(gs_aggregate_raw[c][i - 1] + (int32_t)((seed >> (10 + 4 * c)) % 7U) - 3);
+        }
+        if ((i % 331U) == 0)
+        {
+            gs_aggregate_raw[i % 3U][i] = (gs_aggregate_raw[i % 3U][i - 1] < 0) ? 32767 : -32768;        /* full range jump */
+        }
+    }
+
+    (void)sfa30_aggregate_init(&gs_aggregate);
+    for (w = 0; w < 3; w++)
+    {
+        if (sfa30_aggregate_add_window(&gs_aggregate, length[w], slot[w], capacity[w], &index) != 0)
+        {
+            sfa30_emulator_debug_print("sfa30: aggregate add window failed.\n");
+
+            return 1;
+        }
+    }
+    if ((sfa30_aggregate_get(&gs_aggregate, 2, SFA30_AGGREGATE_MODE_SLIDING, &result) != 4) ||
+        (sfa30_aggregate_get(&gs_aggregate, 3, SFA30_AGGREGATE_MODE_TUMBLING, &result) != 4))
+    {
+        sfa30_emulator_debug_print("sfa30: aggregate get check failed.\n");
+
+        return 1;
+    }
+    for (i = 0; i < n; i++)
+    {
+        data.formaldehyde_raw = gs_aggregate_raw[0][i];
+        data.humidity_raw = gs_aggregate_raw[1][i];
+        data.temperature_raw = gs_aggregate_raw[2][i];
+        (void)sfa30_aggregate_push(&gs_aggregate, gs_aggregate_timestamp[i], &data);
+        for (w = 0; w < 3; w++)
+        {
+            /* sliding windows hold the samples younger than the length */
+            if (slot[w] != NULL)
+            {
+                first = i;
+                while ((first > 0) && ((uint32_t)(gs_aggregate_timestamp[i] - gs_aggregate_timestamp[first - 1]) < length[w]))
+                {
+                    first--;
+                }
+                if ((sfa30_aggregate_get(&gs_aggregate, w, SFA30_AGGREGATE_MODE_SLIDING, &result) != 0) ||
+                    (result.start_ms != gs_aggregate_timestamp[first]) ||
+                    (a_sfa30_emulator_test_aggregate_check(first, i - first + 1, &result) != 0))
+                {
+                    sfa30_emulator_debug_print("sfa30: aggregate sliding window %d failed at %d.\n", (int)w, (int)i);
+
+                    return 1;
+                }
+            }
+
+            /* a tumbling window closes at the first sample past its aligned end */
+            if ((i > begin[w]) &&
+                ((uint32_t)(gs_aggregate_timestamp[i] - (gs_aggregate_timestamp[begin[w]] -
+                 gs_aggregate_timestamp[begin[w]] % length[w])) >= length[w]))
+            {
+                if (((gs_aggregate.closed >> w) & 1U) == 0)
+                {
+                    sfa30_emulator_debug_print("sfa30: aggregate tumbling window %d did not close at %d.\n", (int)w, (int)i);
+
+                    return 1;
+                }
+                if ((sfa30_aggregate_get(&gs_aggregate, w, SFA30_AGGREGATE_MODE_TUMBLING, &result) != 0) ||
+                    (result.start_ms != gs_aggregate_timestamp[begin[w]] - gs_aggregate_timestamp[begin[w]] % length[w]) ||
+                    (a_sfa30_emulator_test_aggregate_check(begin[w], i - begin[w], &result) != 0))
+                {
+                    sfa30_emulator_debug_print("sfa30: aggregate tumbling window %d failed at %d.\n", (int)w, (int)i);
+
+                    return 1;
+                }
+                begin[w] = i;
+                closed++;
+            }
+            else if (((gs_aggregate.closed >> w) & 1U) != 0)
+            {
+                sfa30_emulator_debug_print("sfa30: aggregate tumbling window %d closed early at %d.\n", (int)w, (int)i);
+
+                return 1;
+            }
+            if ((sfa30_aggregate_get(&gs_aggregate, w, SFA30_AGGREGATE_MODE_PARTIAL, &result) != 0) ||
+                (a_sfa30_emulator_test_aggregate_check(begin[w], i - begin[w] + 1, &result) != 0))
+            {
+                sfa30_emulator_debug_print("sfa30: aggregate partial window %d failed at %d.\n", (int)w, (int)i);
+
+                return 1;
+            }
+        }
+    }
+    if ((gs_aggregate.window[0].evicted != 0) || (gs_aggregate.window[1].evicted != 0))
+    {
+        sfa30_emulator_debug_print("sfa30: aggregate evicted samples early.\n");
+
+        return 1;
+    }
+    sfa30_emulator_debug_print("sfa30: aggregate %d samples, %d closed windows match.\n", (int)n, (int)closed);
+
+    return 0;
+}
+
+/**
+ * @brief  emulator quantile test
+ * @return status code
+ *         - 0 success
+ *         - 1 test failed
+ * @note   quantiles spread over every octave must stay within the precision of the
+ *         exact nearest rank quantile, and merging two halves must equal the whole
+ */
+static uint8_t a_sfa30_emulator_test_quantile(void)
+{
+    const uint32_t n = 20000;
+    const uint32_t quantiles[9] = {0, 1, 100, 5000, 9000, 9500, 9900, 9999, 10000};
+    uint32_t seed = 0x3C6EF372U;
+    sfa30_data_t data;
+    uint32_t i;
+    uint32_t q;
+
+    sfa30_emulator_debug_print("sfa30: quantile test.\n");
+    (void)sfa30_quantile_init(&gs_quantile[0]);
+    (void)sfa30_quantile_init(&gs_quantile[1]);
+    (void)sfa30_quantile_init(&gs_quantile[2]);
+    if (sfa30_quantile_get(&gs_quantile[0], 5000, &data.formaldehyde_raw) != 1)
+    {
+        sfa30_emulator_debug_print("sfa30: quantile empty check failed.\n");
+
+        return 1;
+    }
+    for (i = 0; i < n; i++)
+    {
+        seed = seed * 1664525U + 1013904223U;
+        gs_quantile_raw[i] = (int16_t)(((seed >> 8) % 400U) << ((seed >> 24) % 7U));
+        if (((seed >> 4) & 1023U) == 0)
+        {
+            gs_quantile_raw[i] = (((seed >> 16) & 1U) != 0) ? 32767 : -3;        /* range ends */
+        }
+        data.formaldehyde_raw = gs_quantile_raw[i];
+        (void)sfa30_quantile_add(&gs_quantile[0], &data);
+        (void)sfa30_quantile_add(&gs_quantile[1 + (i & 1)], &data);
+    }
+    (void)sfa30_quantile_merge(&gs_quantile[1], &gs_quantile[2]);
+    if (memcmp(&gs_quantile[0], &gs_quantile[1], sizeof(sfa30_quantile_t)) != 0)
+    {
+        sfa30_emulator_debug_print("sfa30: quantile merge mismatch.\n");
+
+        return 1;
+    }
+    for (q = 0; q < 9; q++)
+    {
+        uint32_t rank = (quantiles[q] * n + 9999) / 10000;
+        int32_t lo = -32768;
+        int32_t hi = 32767;
+        int32_t exact;
+        int32_t err;
+        int16_t raw;
+
+        /* the exact quantile is the smallest value with rank samples at or below it */
+        rank = (rank == 0) ? 1 : rank;
+        while (lo < hi)
+        {
+            int32_t mid = lo + ((hi - lo) >> 1);
+            uint32_t below = 0;
+
+            for (i = 0; i < n; i++)
+            {
+                below += (gs_quantile_raw[i] <= mid) ? 1U : 0U;
+            }
+            if (below >= rank)
+            {
+                hi = mid;
+            }
+            else
+            {
+                lo = mid + 1;
+            }
+        }
+        exact = lo;
+        if (sfa30_quantile_get(&gs_quantile[0], quantiles[q], &raw) != 0)
+        {
+            sfa30_emulator_debug_print("sfa30: quantile get failed.\n");
+
+            return 1;
+        }
+        err = (raw > exact) ? (raw - exact) : (exact - raw);
+        err = ((exact < 0) && (raw >= exact) && (raw <= 0)) ? 0 : err;        /* negative values count as 0 */
+        if ((err << SFA30_QUANTILE_PRECISION_BITS) > ((exact > 0) ? exact : 0))
+        {
+            sfa30_emulator_debug_print("sfa30: quantile %d is %d, exact %d.\n", (int)quantiles[q], (int)raw, (int)exact);
+
+            return 1;
+        }
+    }
+    if (sfa30_quantile_get(&gs_quantile[0], 10001, &data.formaldehyde_raw) != 4)
+    {
+        sfa30_emulator_debug_print("sfa30: quantile range check failed.\n");
+
+        return 1;
+    }
+    sfa30_emulator_debug_print("sfa30: quantile %d samples in %d bytes match.\n", (int)n, (int)sizeof(sfa30_quantile_t));
+
+    return 0;
+}
+
+/**
+ * @brief  emulator deadband test
+ * @return status code
+ *         - 0 success
+ *         - 1 test failed
+ * @note   holding the reported samples must stay within the band and hysteresis of every
+ *         dropped sample, the heartbeat must bound the silence, and a 1 lsb flicker must
+ *         stay quiet with a 1 lsb hysteresis
+ */
+static uint8_t a_sfa30_emulator_test_deadband(void)
+{
+    const uint32_t n = 20000;
+    const sfa30_deadband_config_t config =
+    {
+        {5, 200, 2},          /* 1 ppb or 2 %, 0.4 ppb hysteresis */
+        {50, 0, 10},          /* 0.5 % */
+        {20, 0, 4},           /* 0.1 C */
+        60000,
+    };
+    uint32_t seed = 0x9E3779B9U;
+    uint32_t i;
+    uint32_t c;
+    uint32_t last_ms = 0;
+    uint32_t samples;
+    uint32_t reports;
+    uint32_t ratio_q8;
+    int32_t walk[3] = {400, 4500, 5000};
+    int32_t held[3] = {0, 0, 0};
+    int32_t bound[3] = {0, 0, 0};
+    int32_t err;
+    uint8_t report;
+    sfa30_deadband_t filter;
+    sfa30_deadband_config_t flicker;
+    sfa30_data_t data;
+
+    sfa30_emulator_debug_print("sfa30: deadband test.\n");
+    (void)sfa30_deadband_init(&filter, &config);
+    for (i = 0; i < n; i++)
+    {
+        /* slow random walks with 1 lsb noise and a rare step */
+        for (c = 0; c < 3; c++)
+        {
+            seed = seed * 1664525U + 1013904223U;
+            walk[c] += (int32_t)((seed >> 28) % 3U) - 1;
+            walk[c] += (((seed >> 8) & 4095U) == 0) ? 300 : 0;
+            walk[c] = (walk[c] < 0) ? 0 : walk[c];
+        }
+        data.formaldehyde_raw = (int16_t)(walk[0] + (int32_t)((seed >> 16) & 1U));
+        data.humidity_raw = (int16_t)(walk[1] + (int32_t)((seed >> 17) & 1U));
+        data.temperature_raw = (int16_t)(walk[2] + (int32_t)((seed >> 18) & 1U));
+        if ((sfa30_deadband_filter(&filter, i * 500, &data, &report) != 0) || ((i == 0) && (report == 0)))
+        {
+            sfa30_emulator_debug_print("sfa30: deadband filter failed.\n");
+
+            return 1;
+        }
+        if (report != 0)
+        {
+            if (i * 500 - last_ms > config.heartbeat_ms)
+            {
+                sfa30_emulator_debug_print("sfa30: deadband silence %d ms is too long.\n", (int)(i * 500 - last_ms));
+
+                return 1;
+            }
+            last_ms = i * 500;
+            held[0] = data.formaldehyde_raw;
+            held[1] = data.humidity_raw;
+            held[2] = data.temperature_raw;
+            bound[0] = held[0] * config.formaldehyde.relative_bp / 10000;
+            bound[0] = ((bound[0] > config.formaldehyde.absolute_raw) ? bound[0] : config.formaldehyde.absolute_raw) +
+                       config.formaldehyde.hysteresis_raw;
+            bound[1] = config.humidity.absolute_raw + config.humidity.hysteresis_raw;
+            bound[2] = config.temperature.absolute_raw + config.temperature.hysteresis_raw;
+        }
+        for (c = 0; c < 3; c++)
+        {
+            err = ((c == 0) ? data.formaldehyde_raw : ((c == 1) ? data.humidity_raw : data.temperature_raw)) - held[c];
+            if ((err > bound[c]) || (err < -bound[c]))
+            {
+                sfa30_emulator_debug_print("sfa30: deadband sample %d channel %d error %d.\n", (int)i, (int)c, (int)err);
+
+                return 1;
+            }
+        }
+    }
+    if ((sfa30_deadband_get_reduction(&filter, &samples, &reports, &ratio_q8) != 0) ||
+        (samples != n) || (reports != filter.reports) || (ratio_q8 != (uint32_t)(((uint64_t)n << 8) / reports)) ||
+        (ratio_q8 < 4 * 256))
+    {
+        sfa30_emulator_debug_print("sfa30: deadband reduction check failed.\n");
+
+        return 1;
+    }
+    sfa30_emulator_debug_print("sfa30: deadband reported %d of %d samples, %d heartbeats, %d.%02dx reduction.\n",
+                               (int)reports, (int)samples, (int)filter.heartbeats,
+                               (int)(ratio_q8 >> 8), (int)(((ratio_q8 & 0xFFU) * 100U) >> 8));
+
+    /* a 1 lsb flicker reports every sample without hysteresis and only the first rise with it */
+    memset(&flicker, 0, sizeof(flicker));
+    for (c = 0; c < 2; c++)
+    {
+        flicker.formaldehyde.hysteresis_raw = (uint16_t)c;
+        (void)sfa30_deadband_init(&filter, &flicker);
+        for (i = 0; i < 100; i++)
+        {
+            data.formaldehyde_raw = (int16_t)(100 + (i & 1U));
+            (void)sfa30_deadband_filter(&filter, i * 500, &data, &report);
+        }
+        if (filter.reports != ((c == 0) ? 100U : 2U))
+        {
+            sfa30_emulator_debug_print("sfa30: deadband flicker check failed.\n");
+
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief  emulator batch decode test
+ * @return status code
+ *         - 0 success
+ *         - 1 test failed
+ * @note   every kernel of this build and cpu must match the scalar kernel bit for bit
+ */
+static uint8_t a_sfa30_emulator_test_decode(void)
+{
+    const uint32_t n = 1003;
+    uint32_t seed = 0x12345678U;
+    uint32_t i;
+    uint8_t k;
+    sfa30_decode_kernel_t best;
+
+    sfa30_emulator_debug_print("sfa30: batch decode test.\n");
+    for (i = 0; i < n * 3; i++)
+    {
+        uint8_t *p = &gs_decode_frames[i * 3];
+
+        seed = seed * 1664525U + 1013904223U;
+        p[0] = (uint8_t)(seed >> 24);
+        p[1] = (uint8_t)(seed >> 16);
+        p[2] = sfa30_crc8(p, 2);
+        if (((seed >> 8) % 17U) == 0)
+        {
+            p[2 - (seed >> 4) % 3U] ^= (uint8_t)(1 << ((seed >> 12) % 8U));        /* flip one bit */
+        }
+    }
+    best = sfa30_decode_get_kernel();
+    (void)sfa30_decode_set_kernel(SFA30_DECODE_KERNEL_SCALAR);
+    if (sfa30_decode_batch(gs_decode_frames, n, gs_decode_ref[0], gs_decode_ref[1],
+                           gs_decode_ref[2], gs_decode_ref_mask) != 0)
+    {
+        sfa30_emulator_debug_print("sfa30: decode batch failed.\n");
+
+        return 1;
+    }
+    for (i = 0; i < n; i++)
+    {
+        const uint8_t *p = &gs_decode_frames[i * SFA30_DECODE_FRAME_SIZE];
+        uint8_t ok = (uint8_t)((sfa30_crc8(&p[0], 2) == p[2]) && (sfa30_crc8(&p[3], 2) == p[5]) &&
+                               (sfa30_crc8(&p[6], 2) == p[8]));
+
+        if ((((gs_decode_ref_mask[i / 8] >> (i % 8)) & 1) != ok) ||
+            (gs_decode_ref[0][i] != (float)((int16_t)(((uint16_t)p[0] << 8) | p[1])) / 5.0f) ||
+            (gs_decode_ref[1][i] != (float)((int16_t)(((uint16_t)p[3] << 8) | p[4])) / 100.0f) ||
+            (gs_decode_ref[2][i] != (float)((int16_t)(((uint16_t)p[6] << 8) | p[7])) / 200.0f))
+        {
+            sfa30_emulator_debug_print("sfa30: decode scalar check failed at %d.\n", (int)i);
+
+            return 1;
+        }
+    }
+    for (k = SFA30_DECODE_KERNEL_SSE41; k <= SFA30_DECODE_KERNEL_NEON; k++)
+    {
+        if (sfa30_decode_set_kernel((sfa30_decode_kernel_t)k) != 0)
+        {
+            continue;
+        }
+        if ((sfa30_decode_batch(gs_decode_frames, n, gs_decode_out[0], gs_decode_out[1],
+                                gs_decode_out[2], gs_decode_out_mask) != 0) ||
+            (memcmp(gs_decode_out, gs_decode_ref, sizeof(gs_decode_ref)) != 0) ||
+            (memcmp(gs_decode_out_mask, gs_decode_ref_mask, sizeof(gs_decode_ref_mask)) != 0))
+        {
+            sfa30_emulator_debug_print("sfa30: decode kernel %d check failed.\n", k);
+            (void)sfa30_decode_set_kernel(best);
+
+            return 1;
+        }
+        sfa30_emulator_debug_print("sfa30: decode kernel %d matches.\n", k);
+    }
+    (void)sfa30_decode_set_kernel(best);
+
+    return 0;
+}
+
+/**
+ * @brief     emulator mux test
+ * @param[in] times test times
+ * @return    status code
+ *            - 0 success
+ *            - 1 test failed
+ * @note      eight sensors behind a tca9548a
+ */
+static uint8_t a_sfa30_emulator_test_mux(uint32_t times)
+{
+    uint8_t res;
+    uint8_t ch;
+    uint32_t i;
+    uint32_t selects;
+    float rate;
+    sfa30_data_t data[SFA30_MUX_MAX_CHANNELS];
+    sfa30_data_t expect;
+    uint8_t status[SFA30_MUX_MAX_CHANNELS];
+
+    sfa30_emulator_debug_print("sfa30: mux test.\n");
+    sfa30_emulator_set_mux(1);
+    (void)sfa30_mux_init(&gs_mux, SFA30_MUX_ADDRESS, sfa30_emulator_iic_write_cmd, sfa30_emulator_delay_ms, NULL);
+    for (ch = 0; ch < SFA30_MUX_MAX_CHANNELS; ch++)
+    {
+        DRIVER_SFA30_LINK_INIT(&gs_mux_handle[ch], sfa30_handle_t);
+        DRIVER_SFA30_LINK_UART_INIT(&gs_mux_handle[ch], sfa30_emulator_uart_init);
+        DRIVER_SFA30_LINK_UART_DEINIT(&gs_mux_handle[ch], sfa30_emulator_uart_deinit);
+        DRIVER_SFA30_LINK_UART_READ(&gs_mux_handle[ch], sfa30_emulator_uart_read);
+        DRIVER_SFA30_LINK_UART_WRITE(&gs_mux_handle[ch], sfa30_emulator_uart_write);
+        DRIVER_SFA30_LINK_UART_FLUSH(&gs_mux_handle[ch], sfa30_emulator_uart_flush);
+        DRIVER_SFA30_LINK_IIC_INIT(&gs_mux_handle[ch], sfa30_emulator_iic_init);
+        DRIVER_SFA30_LINK_IIC_DEINIT(&gs_mux_handle[ch], sfa30_emulator_iic_deinit);
+        DRIVER_SFA30_LINK_IIC_WRITE_COMMAND(&gs_mux_handle[ch], sfa30_emulator_iic_write_cmd);
+        DRIVER_SFA30_LINK_IIC_READ_COMMAND(&gs_mux_handle[ch], sfa30_emulator_iic_read_cmd);
+        DRIVER_SFA30_LINK_DELAY_MS(&gs_mux_handle[ch], sfa30_emulator_delay_ms);
+        DRIVER_SFA30_LINK_DEBUG_PRINT(&gs_mux_handle[ch], sfa30_emulator_debug_print);
+        res = sfa30_mux_attach(&gs_mux, ch, &gs_mux_handle[ch]);
+        if (res != 0)
+        {
+            sfa30_emulator_debug_print("sfa30: mux attach failed.\n");
+            sfa30_emulator_set_mux(0);
+
+            return 1;
+        }
+    }
+
+    /* sweep all channels */
+    for (i = 0; i < times; i++)
+    {
+        /* sweep at the start of an update window so all channels see the same window */
+        sfa30_emulator_advance_ms(500 - (sfa30_emulator_get_time_ms() % 500));
+        selects = sfa30_emulator_get_mux_selects();
+        res = sfa30_mux_read_all(&gs_mux, data, status);
+        if (res != 0)
+        {
+            sfa30_emulator_debug_print("sfa30: mux read all failed.\n");
+            sfa30_emulator_set_mux(0);
+
+            return 1;
+        }
+        for (ch = 0; ch < SFA30_MUX_MAX_CHANNELS; ch++)
+        {
+            sfa30_emulator_get_expected_channel(ch, &expect);
+            if ((status[ch] != 0) || (a_sfa30_emulator_test_check(&data[ch], &expect) != 0))
+            {
+                sfa30_emulator_debug_print("sfa30: mux channel %d check failed.\n", ch);
+                sfa30_emulator_set_mux(0);
+
+                return 1;
+            }
+        }
+
+        /* the serpentine order needs 2n - 2 selects per sweep */
+        if ((sfa30_emulator_get_mux_selects() - selects) != 2 * SFA30_MUX_MAX_CHANNELS - 2)
+        {
+            sfa30_emulator_debug_print("sfa30: mux select count check failed.\n");
+            sfa30_emulator_set_mux(0);
+
+            return 1;
+        }
+    }
+    if (gs_mux.selects != sfa30_emulator_get_mux_selects())
+    {
+        sfa30_emulator_debug_print("sfa30: mux select total check failed.\n");
+        sfa30_emulator_set_mux(0);
+
+        return 1;
+    }
+    (void)sfa30_mux_get_rate(&gs_mux, 100000, &rate);
+    sfa30_emulator_debug_print("sfa30: mux aggregate rate is %0.2f samples/s at 100kHz.\n", rate);
+
+    /* detach all channels */
+    for (ch = 0; ch < SFA30_MUX_MAX_CHANNELS; ch++)
+    {
+        if (sfa30_mux_detach(&gs_mux, ch) != 0)
+        {
+            sfa30_emulator_debug_print("sfa30: mux detach failed.\n");
+            sfa30_emulator_set_mux(0);
+
+            return 1;
+        }
+    }
+    sfa30_emulator_set_mux(0);
+
+    return 0;
+}
+
+/**
+ * @brief     emulator uart port test
+ * @param[in] times test times
+ * @return    status code
+ *            - 0 success
+ *            - 1 test failed
+ * @note      three sensors on three uart ports driven by the same hooks,
+ *            the user context selects the port and all handles share one scratch buffer
+ */
+static uint8_t a_sfa30_emulator_test_ports(uint32_t times)
+{
+    uint8_t res;
+    uint8_t port;
+    uint32_t i;
+    sfa30_data_t data;
+    sfa30_data_t expect;
+
+    sfa30_emulator_debug_print("sfa30: uart port test.\n");
+    for (port = 0; port < 3; port++)
+    {
+        DRIVER_SFA30_LINK_INIT(&gs_port_handle[port], sfa30_handle_t);
+        DRIVER_SFA30_LINK_UART_INIT(&gs_port_handle[port], sfa30_emulator_uart_init);
+        DRIVER_SFA30_LINK_UART_DEINIT(&gs_port_handle[port], sfa30_emulator_uart_deinit);
+        DRIVER_SFA30_LINK_UART_READ(&gs_port_handle[port], sfa30_emulator_uart_read);
+        DRIVER_SFA30_LINK_UART_WRITE(&gs_port_handle[port], sfa30_emulator_uart_write);
+        DRIVER_SFA30_LINK_UART_FLUSH(&gs_port_handle[port], sfa30_emulator_uart_flush);
+        DRIVER_SFA30_LINK_IIC_INIT(&gs_port_handle[port], sfa30_emulator_iic_init);
+        DRIVER_SFA30_LINK_IIC_DEINIT(&gs_port_handle[port], sfa30_emulator_iic_deinit);
+        DRIVER_SFA30_LINK_IIC_WRITE_COMMAND(&gs_port_handle[port], sfa30_emulator_iic_write_cmd);
+        DRIVER_SFA30_LINK_IIC_READ_COMMAND(&gs_port_handle[port], sfa30_emulator_iic_read_cmd);
+        DRIVER_SFA30_LINK_DELAY_MS(&gs_port_handle[port], sfa30_emulator_delay_ms);
+        DRIVER_SFA30_LINK_DEBUG_PRINT(&gs_port_handle[port], sfa30_emulator_debug_print);
+        DRIVER_SFA30_LINK_SCRATCH(&gs_port_handle[port], gs_scratch);
+        DRIVER_SFA30_LINK_USER(&gs_port_handle[port], sfa30_emulator_get_uart_port(port + 1));
+        res = sfa30_set_interface(&gs_port_handle[port], SFA30_INTERFACE_UART);
+        if (res == 0)
+        {
+            res = sfa30_init(&gs_port_handle[port]);
+        }
+        if (res == 0)
+        {
+            res = sfa30_start_measurement(&gs_port_handle[port]);
+        }
+        if (res != 0)
+        {
+            sfa30_emulator_debug_print("sfa30: port %d init failed.\n", port + 1);
+
+            return 1;
+        }
+    }
+
+    /* read the ports in turn, each one answers with its own sensor */
+    res = 0;
+    for (i = 0; (i < times) && (res == 0); i++)
+    {
+        sfa30_emulator_advance_ms(500 - (sfa30_emulator_get_time_ms() % 500));
+        for (port = 0; port < 3; port++)
+        {
+            if (sfa30_read(&gs_port_handle[port], &data) != 0)
+            {
+                sfa30_emulator_debug_print("sfa30: port %d read failed.\n", port + 1);
+                res = 1;
+
+                break;
+            }
+            sfa30_emulator_get_expected_channel(port + 1, &expect);
+            if (a_sfa30_emulator_test_check(&data, &expect) != 0)
+            {
+                sfa30_emulator_debug_print("sfa30: port %d check failed.\n", port + 1);
+                res = 1;
+
+                break;
+            }
+        }
+    }
+    for (port = 0; port < 3; port++)
+    {
+        (void)sfa30_stop_measurement(&gs_port_handle[port]);
+        (void)sfa30_deinit(&gs_port_handle[port]);
+    }
+
+    return res;
+}
+
+/**
+ * @brief     emulator test
+ * @param[in] interface chip interface
+ * @param[in] times test times
+ * @return    status code
+ *            - 0 success
+ *            - 1 test failed
+ * @note      runs the driver against the software sensor, no hardware is needed
+ */
+uint8_t sfa30_emulator_test(sfa30_interface_t interface, uint32_t times)
+{
+    uint8_t res;
+    uint32_t i;
+    uint32_t samples;
+    uint32_t timestamp;
+    uint32_t last_timestamp;
+    uint32_t len;
+    char device_info[32];
+    sfa30_data_t data;
+    sfa30_data_t expect;
+    sfa30_read_state_t state;
+    sfa30_handle_t idle_handle;
+    sfa30_handle_t *handles[3];
+    sfa30_data_t batch[3];
+    uint8_t batch_status[3];
+    uint8_t reg_buf[7];
+    uint32_t start_ms;
+#if (SFA30_STATS != 0)
+    uint32_t stats_tx0;
+    uint32_t stats_rx0;
+#endif
+
+    /* link functions */
+    DRIVER_SFA30_LINK_INIT(&gs_handle, sfa30_handle_t);
+    DRIVER_SFA30_LINK_UART_INIT(&gs_handle, sfa30_emulator_uart_init);
+    DRIVER_SFA30_LINK_UART_DEINIT(&gs_handle, sfa30_emulator_uart_deinit);
+    DRIVER_SFA30_LINK_UART_READ(&gs_handle, sfa30_emulator_uart_read);
+    DRIVER_SFA30_LINK_UART_WRITE(&gs_handle, sfa30_emulator_uart_write);
+    DRIVER_SFA30_LINK_UART_FLUSH(&gs_handle, sfa30_emulator_uart_flush);
+    DRIVER_SFA30_LINK_IIC_INIT(&gs_handle, sfa30_emulator_iic_init);
+    DRIVER_SFA30_LINK_IIC_DEINIT(&gs_handle, sfa30_emulator_iic_deinit);
+    DRIVER_SFA30_LINK_IIC_WRITE_COMMAND(&gs_handle, sfa30_emulator_iic_write_cmd);
+    DRIVER_SFA30_LINK_IIC_READ_COMMAND(&gs_handle, sfa30_emulator_iic_read_cmd);
+    DRIVER_SFA30_LINK_DELAY_MS(&gs_handle, sfa30_emulator_delay_ms);
+    DRIVER_SFA30_LINK_DEBUG_PRINT(&gs_handle, sfa30_emulator_debug_print);
+#if (SFA30_STATS != 0)
+    memset(&gs_stats, 0, sizeof(sfa30_stats_t));
+    DRIVER_SFA30_LINK_CLOCK_US(&gs_handle, a_sfa30_emulator_test_clock_us);
+    DRIVER_SFA30_LINK_STATS(&gs_handle, &gs_stats);
+#endif
+
+    /* start emulator test */
+    sfa30_emulator_debug_print("sfa30: start emulator test.\n");
+
+    /* power on the emulator */
+    sfa30_emulator_power_on();
+    sfa30_emulator_set_latency(2, 5);
+#if (SFA30_STATS != 0)
+    sfa30_emulator_get_bytes(&stats_tx0, &stats_rx0);
+#endif
+
+    /* set the interface */
+    res = sfa30_set_interface(&gs_handle, interface);
+    if (res != 0)
+    {
+        sfa30_emulator_debug_print("sfa30: set interface failed.\n");
+
+        return 1;
+    }
+
+    /* a uart handle needs the scratch buffer */
+    if (interface == SFA30_INTERFACE_UART)
+    {
+        res = sfa30_init(&gs_handle);
+        if (res != 3)
+        {
+            sfa30_emulator_debug_print("sfa30: scratch check failed.\n");
+
+            return 1;
+        }
+    }
+    DRIVER_SFA30_LINK_SCRATCH(&gs_handle, gs_scratch);
+
+    /* init the chip */
+    res = sfa30_init(&gs_handle);
+    if (res != 0)
+    {
+        sfa30_emulator_debug_print("sfa30: init failed.\n");
+
+        return 1;
+    }
+
+    /* get device information */
+    res = sfa30_get_device_information(&gs_handle, device_info);
+    if (res != 0)
+    {
+        sfa30_emulator_debug_print("sfa30: get device information failed.\n");
+        (void)sfa30_deinit(&gs_handle);
+
+        return 1;
+    }
+    if (strcmp(device_info, SFA30_EMULATOR_SERIAL) != 0)
+    {
+        sfa30_emulator_debug_print("sfa30: device information check failed.\n");
+        (void)sfa30_deinit(&gs_handle);
+
+        return 1;
+    }
+    sfa30_emulator_debug_print("sfa30: device information is %s.\n", device_info);
+
+    /* start measurement */
+    res = sfa30_start_measurement(&gs_handle);
+    if (res != 0)
+    {
+        sfa30_emulator_debug_print("sfa30: start measurement failed.\n");
+        (void)sfa30_deinit(&gs_handle);
+
+        return 1;
+    }
+
+    /* blocking read */
+    sfa30_emulator_debug_print("sfa30: blocking read test.\n");
+    for (i = 0; i < times; i++)
+    {
+        sfa30_emulator_advance_ms(500);
+        sfa30_emulator_get_expected(&expect);
+        res = sfa30_read(&gs_handle, &data);
+        if (res != 0)
+        {
+            sfa30_emulator_debug_print("sfa30: read failed.\n");
+            (void)sfa30_deinit(&gs_handle);
+
+            return 1;
+        }
+        if (a_sfa30_emulator_test_check(&data, &expect) != 0)
+        {
+            (void)sfa30_deinit(&gs_handle);
+
+            return 1;
+        }
+        a_sfa30_emulator_test_print(&data);
+    }
+
+    /* the uart frame is decoded as it arrives */
+    if (interface == SFA30_INTERFACE_UART)
+    {
+        sfa30_emulator_debug_print("sfa30: streaming frame test.\n");
+        sfa30_emulator_set_uart_chunk(3);
+        sfa30_emulator_advance_ms(500);
+        sfa30_emulator_get_expected(&expect);
+        start_ms = sfa30_emulator_get_time_ms();
+        res = sfa30_read(&gs_handle, &data);
+        sfa30_emulator_set_uart_chunk(0);
+        if (res != 0)
+        {
+            sfa30_emulator_debug_print("sfa30: read failed.\n");
+            (void)sfa30_deinit(&gs_handle);
+
+            return 1;
+        }
+        if (a_sfa30_emulator_test_check(&data, &expect) != 0)
+        {
+            (void)sfa30_deinit(&gs_handle);
+
+            return 1;
+        }
+        if ((sfa30_emulator_get_time_ms() - start_ms) >= 100)
+        {
+            sfa30_emulator_debug_print("sfa30: streaming frame check failed.\n");
+            (void)sfa30_deinit(&gs_handle);
+
+            return 1;
+        }
+        sfa30_emulator_debug_print("sfa30: frame done after %dms.\n",
+                                   (int)(sfa30_emulator_get_time_ms() - start_ms));
+    }
+
+    /* raw read and fixed point conversion */
+    sfa30_emulator_debug_print("sfa30: raw read test.\n");
+    sfa30_emulator_advance_ms(500);
+    sfa30_emulator_get_expected(&expect);
+    res = sfa30_read_raw(&gs_handle, &data.formaldehyde_raw, &data.humidity_raw, &data.temperature_raw);
+    if (res != 0)
+    {
+        sfa30_emulator_debug_print("sfa30: read raw failed.\n");
+        (void)sfa30_deinit(&gs_handle);
+
+        return 1;
+    }
+    if ((data.formaldehyde_raw != expect.formaldehyde_raw) ||
+        (data.humidity_raw != expect.humidity_raw) ||
+        (data.temperature_raw != expect.temperature_raw))
+    {
+        sfa30_emulator_debug_print("sfa30: raw check failed.\n");
+        (void)sfa30_deinit(&gs_handle);
+
+        return 1;
+    }
+    if (a_sfa30_emulator_test_fixed_point() != 0)
+    {
+        (void)sfa30_deinit(&gs_handle);
+
+        return 1;
+    }
+    sfa30_emulator_debug_print("sfa30: formaldehyde is %d.%dppb.\n",
+                               (int)(sfa30_formaldehyde_convert_to_ppb_x10(data.formaldehyde_raw) / 10),
+                               (int)(sfa30_formaldehyde_convert_to_ppb_x10(data.formaldehyde_raw) % 10));
+
+    /* batch read */
+    sfa30_emulator_debug_print("sfa30: batch read test.\n");
+    sfa30_emulator_advance_ms(500);
+    sfa30_emulator_get_expected(&expect);
+    handles[0] = &gs_handle;
+    handles[1] = NULL;
+    handles[2] = &idle_handle;
+    memset(&idle_handle, 0, sizeof(sfa30_handle_t));
+    start_ms = sfa30_emulator_get_time_ms();
+    if ((sfa30_read_many(handles, batch, batch_status, 3) != 1) ||
+        (batch_status[0] != 0) || (batch_status[1] != 2) || (batch_status[2] != 3))
+    {
+        sfa30_emulator_debug_print("sfa30: batch read status check failed.\n");
+        (void)sfa30_deinit(&gs_handle);
+
+        return 1;
+    }
+    if (a_sfa30_emulator_test_check(&batch[0], &expect) != 0)
+    {
+        (void)sfa30_deinit(&gs_handle);
+
+        return 1;
+    }
+    if ((sfa30_emulator_get_time_ms() - start_ms) != ((interface == SFA30_INTERFACE_IIC) ? 5 : 100))
+    {
+        sfa30_emulator_debug_print("sfa30: batch read delay check failed.\n");
+        (void)sfa30_deinit(&gs_handle);
+
+        return 1;
+    }
+
+    /* non-blocking read */
+    sfa30_emulator_debug_print("sfa30: non-blocking read test.\n");
+    for (i = 0; i < times; i++)
+    {
+        sfa30_emulator_advance_ms(500);
+        sfa30_emulator_get_expected(&expect);
+        res = sfa30_read_begin(&gs_handle, sfa30_emulator_get_time_ms());
+        if (res != 0)
+        {
+            sfa30_emulator_debug_print("sfa30: read begin failed.\n");
+            (void)sfa30_deinit(&gs_handle);
+
+            return 1;
+        }
+        if (sfa30_read_begin(&gs_handle, sfa30_emulator_get_time_ms()) != 4)
+        {
+            sfa30_emulator_debug_print("sfa30: read begin in progress check failed.\n");
+            (void)sfa30_deinit(&gs_handle);
+
+            return 1;
+        }
+        res = sfa30_read_poll(&gs_handle, sfa30_emulator_get_time_ms(), &state);
+        if ((res != 0) || (state != SFA30_READ_STATE_WAIT))
+        {
+            sfa30_emulator_debug_print("sfa30: read poll wait check failed.\n");
+            (void)sfa30_deinit(&gs_handle);
+
+            return 1;
+        }
+        if (sfa30_read_finish(&gs_handle, &data) != 4)
+        {
+            sfa30_emulator_debug_print("sfa30: read finish not ready check failed.\n");
+            (void)sfa30_deinit(&gs_handle);
+
+            return 1;
+        }
+        if ((i == 0) && ((sfa30_read(&gs_handle, &data) != 4) || (sfa30_reset(&gs_handle) != 4) ||
+            (sfa30_stop_measurement(&gs_handle) != 4)))
+        {
+            sfa30_emulator_debug_print("sfa30: blocking call in progress check failed.\n");
+            (void)sfa30_deinit(&gs_handle);
+
+            return 1;
+        }
+        if ((i == 0) && ((sfa30_set_get_reg_uart(&gs_handle, reg_buf, 6, reg_buf, 7) != 4) ||
+            (sfa30_set_reg_iic(&gs_handle, 0xD304U, NULL, 0) != 4) ||
+            (sfa30_get_reg_iic(&gs_handle, 0xD304U, reg_buf, 3) != 4) ||
+            (sfa30_set_interface(&gs_handle, interface) != 5)))
+        {
+            sfa30_emulator_debug_print("sfa30: register call in progress check failed.\n");
+            (void)sfa30_deinit(&gs_handle);
+
+            return 1;
+        }
+        do
+        {
+            sfa30_emulator_advance_ms(1);
+            res = sfa30_read_poll(&gs_handle, sfa30_emulator_get_time_ms(), &state);
+            if (res != 0)
+            {
+                sfa30_emulator_debug_print("sfa30: read poll failed.\n");
+                (void)sfa30_deinit(&gs_handle);
+
+                return 1;
+            }
+        } while (state != SFA30_READ_STATE_READY);
+        res = sfa30_read_finish(&gs_handle, &data);
+        if (res != 0)
+        {
+            sfa30_emulator_debug_print("sfa30: read finish failed.\n");
+            (void)sfa30_deinit(&gs_handle);
+
+            return 1;
+        }
+        if (a_sfa30_emulator_test_check(&data, &expect) != 0)
+        {
+            (void)sfa30_deinit(&gs_handle);
+
+            return 1;
+        }
+        a_sfa30_emulator_test_print(&data);
+    }
+
+    /* a late poll still sees the deadline, even 65536 ms after it */
+    if (interface == SFA30_INTERFACE_IIC)
+    {
+        sfa30_emulator_debug_print("sfa30: late poll test.\n");
+        res = sfa30_read_begin(&gs_handle, sfa30_emulator_get_time_ms());
+        sfa30_emulator_advance_ms(65536);
+        if ((res != 0) || (sfa30_read_poll(&gs_handle, sfa30_emulator_get_time_ms(), &state) != 0) ||
+            (state != SFA30_READ_STATE_READY) || (sfa30_read_finish(&gs_handle, &data) != 0))
+        {
+            sfa30_emulator_debug_print("sfa30: late poll check failed.\n");
+            (void)sfa30_deinit(&gs_handle);
+
+            return 1;
+        }
+    }
+
+    /* background sampling */
+    sfa30_emulator_debug_print("sfa30: background sampling test.\n");
+    sfa30_emulator_advance_ms(500 - (sfa30_emulator_get_time_ms() % 500));
+    (void)sfa30_sampling_init(&gs_sampling, &gs_handle, 0, sfa30_emulator_get_time_ms());
+    if (sfa30_history_init(&gs_history, gs_history_buf, 8) != 0)
+    {
+        sfa30_emulator_debug_print("sfa30: history init failed.\n");
+        (void)sfa30_deinit(&gs_handle);
+
+        return 1;
+    }
+    (void)sfa30_sampling_set_history(&gs_sampling, &gs_history);
+    if (sfa30_sampling_load(&gs_sampling, &data, NULL) != 1)
+    {
+        sfa30_emulator_debug_print("sfa30: sampling empty check failed.\n");
+        (void)sfa30_deinit(&gs_handle);
+
+        return 1;
+    }
+    samples = 0;
+    last_timestamp = 0;
+    for (i = 0; (i < (times + 1) * 500) && (samples < times); i++)
+    {
+        res = sfa30_sampling_poll(&gs_sampling, sfa30_emulator_get_time_ms());
+        if (res != 0)
+        {
+            sfa30_emulator_debug_print("sfa30: sampling poll failed.\n");
+            (void)sfa30_deinit(&gs_handle);
+
+            return 1;
+        }
+        if ((sfa30_sampling_load(&gs_sampling, &data, &timestamp) == 0) &&
+            ((samples == 0) || (timestamp != last_timestamp)))
+        {
+            /* the sample keeps the value of the update window it began in */
+            sfa30_emulator_get_expected(&expect);
+            if (a_sfa30_emulator_test_check(&data, &expect) != 0)
+            {
+                (void)sfa30_deinit(&gs_handle);
+
+                return 1;
+            }
+            if ((samples != 0) && (timestamp - last_timestamp != SFA30_SAMPLING_DEFAULT_PERIOD_MS))
+            {
+                sfa30_emulator_debug_print("sfa30: sampling period check failed.\n");
+                (void)sfa30_deinit(&gs_handle);
+
+                return 1;
+            }
+            last_timestamp = timestamp;
+            samples++;
+        }
+        sfa30_emulator_advance_ms(1);
+    }
+    if (samples != times)
+    {
+        sfa30_emulator_debug_print("sfa30: sampling count check failed.\n");
+        (void)sfa30_deinit(&gs_handle);
+
+        return 1;
+    }
+    sfa30_emulator_debug_print("sfa30: sampling published %d samples.\n", (int)samples);
+
+    /* history drain */
+    sfa30_emulator_debug_print("sfa30: history drain test.\n");
+    (void)sfa30_history_drain(&gs_history, gs_history_out, 8, &len);
+    if ((len != ((times < 7) ? times : 7)) || (len == 0) ||
+        (gs_history_out[len - 1].timestamp_ms != last_timestamp) ||
+        (gs_history_out[len - 1].formaldehyde_raw != data.formaldehyde_raw) ||
+        (gs_history_out[len - 1].humidity_raw != data.humidity_raw) ||
+        (gs_history_out[len - 1].temperature_raw != data.temperature_raw))
+    {
+        sfa30_emulator_debug_print("sfa30: history drain check failed.\n");
+        (void)sfa30_deinit(&gs_handle);
+
+        return 1;
+    }
+    for (i = 1; i < len; i++)
+    {
+        if (gs_history_out[i].timestamp_ms - gs_history_out[i - 1].timestamp_ms != SFA30_SAMPLING_DEFAULT_PERIOD_MS)
+        {
+            sfa30_emulator_debug_print("sfa30: history order check failed.\n");
+            (void)sfa30_deinit(&gs_handle);
+
+            return 1;
+        }
+    }
+    (void)sfa30_history_drain(&gs_history, gs_history_out, 8, &len);
+    if (len != 0)
+    {
+        sfa30_emulator_debug_print("sfa30: history empty check failed.\n");
+        (void)sfa30_deinit(&gs_handle);
+
+        return 1;
+    }
+
+    /* the ring keeps the newest samples when the consumer falls behind */
+    (void)sfa30_history_init(&gs_history, gs_history_buf, 8);
+    for (i = 0; i < 20; i++)
+    {
+        (void)sfa30_history_push(&gs_history, i, &data);
+    }
+    (void)sfa30_history_drain(&gs_history, gs_history_out, 8, &len);
+    if ((len != 7) || (gs_history.lost != 13) || (gs_history_out[0].timestamp_ms != 13))
+    {
+        sfa30_emulator_debug_print("sfa30: history overwrite check failed.\n");
+        (void)sfa30_deinit(&gs_handle);
+
+        return 1;
+    }
+    (void)sfa30_sampling_set_history(&gs_sampling, NULL);
+
+    /* finish the read in flight before the next test */
+    do
+    {
+        sfa30_emulator_advance_ms(1);
+        res = sfa30_read_poll(&gs_handle, sfa30_emulator_get_time_ms(), &state);
+        if ((res == 0) && (state == SFA30_READ_STATE_READY))
+        {
+            (void)sfa30_read_finish(&gs_handle, &data);
+        }
+    } while ((res == 0) && (state != SFA30_READ_STATE_IDLE));
+
+    /* a sensor slower than the read delay must fail the read */
+    sfa30_emulator_debug_print("sfa30: slow sensor test.\n");
+    sfa30_emulator_set_latency(1000, 1000);
+    if (sfa30_read(&gs_handle, &data) == 0)
+    {
+        sfa30_emulator_debug_print("sfa30: slow sensor check failed.\n");
+        (void)sfa30_deinit(&gs_handle);
+
+        return 1;
+    }
+    sfa30_emulator_advance_ms(1000);
+    sfa30_emulator_set_latency(2, 5);
+
+    /* stop measurement */
+    res = sfa30_stop_measurement(&gs_handle);
+    if (res != 0)
+    {
+        sfa30_emulator_debug_print("sfa30: stop measurement failed.\n");
+        (void)sfa30_deinit(&gs_handle);
+
+        return 1;
+    }
+
+    /* read in idle mode must fail */
+    if (sfa30_read(&gs_handle, &data) == 0)
+    {
+        sfa30_emulator_debug_print("sfa30: idle read check failed.\n");
+        (void)sfa30_deinit(&gs_handle);
+
+        return 1;
+    }
+
+    /* reset */
+    res = sfa30_reset(&gs_handle);
+    if (res != 0)
+    {
+        sfa30_emulator_debug_print("sfa30: reset failed.\n");
+        (void)sfa30_deinit(&gs_handle);
+
+        return 1;
+    }
+
+#if (SFA30_STATS != 0)
+    /* statistics */
+    if (a_sfa30_emulator_test_stats(interface, stats_tx0, stats_rx0) != 0)
+    {
+        (void)sfa30_deinit(&gs_handle);
+
+        return 1;
+    }
+#endif
+
+    /* mux */
+    if (interface == SFA30_INTERFACE_IIC)
+    {
+        if (a_sfa30_emulator_test_mux(times) != 0)
+        {
+            (void)sfa30_deinit(&gs_handle);
+
+            return 1;
+        }
+    }
+
+    /* uart ports */
+    if (interface == SFA30_INTERFACE_UART)
+    {
+        if (a_sfa30_emulator_test_ports(times) != 0)
+        {
+            (void)sfa30_deinit(&gs_handle);
+
+            return 1;
+        }
+    }
+
+    /* batch decode */
+    if (a_sfa30_emulator_test_decode() != 0)
+    {
+        (void)sfa30_deinit(&gs_handle);
+
+        return 1;
+    }
+
+    /* block codec */
+    if (a_sfa30_emulator_test_codec() != 0)
+    {
+        (void)sfa30_deinit(&gs_handle);
+
+        return 1;
+    }
+
+    /* windowed aggregate */
+    if (a_sfa30_emulator_test_aggregate() != 0)
+    {
+        (void)sfa30_deinit(&gs_handle);
+
+        return 1;
+    }
+
+    /* quantile sketch */
+    if (a_sfa30_emulator_test_quantile() != 0)
+    {
+        (void)sfa30_deinit(&gs_handle);
+
+        return 1;
+    }
+
+    /* deadband filter */
+    if (a_sfa30_emulator_test_deadband() != 0)
+    {
+        (void)sfa30_deinit(&gs_handle);
+
+        return 1;
+    }
+
+    /* close with a read in progress */
+    if ((sfa30_read_begin(&gs_handle, sfa30_emulator_get_time_ms()) != 0) || (sfa30_deinit(&gs_handle) != 0) ||
+        (gs_handle.read_state != SFA30_READ_STATE_IDLE))
+    {
+        sfa30_emulator_debug_print("sfa30: deinit in progress check failed.\n");
+        (void)sfa30_deinit(&gs_handle);
+
+        return 1;
+    }
+
+    /* finish emulator test */
+    sfa30_emulator_debug_print("sfa30: finish emulator test.\n");
+
+    return 0;
+}
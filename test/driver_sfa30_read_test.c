@@ -35,8 +35,10 @@
  */
 
 #include "driver_sfa30_read_test.h"
+#include <stdlib.h>
 
 static sfa30_handle_t gs_handle;        /**< sfa30 handle */
+static uint8_t gs_scratch[SFA30_SCRATCH_SIZE];        /**< sfa30 uart scratch buffer */
 
 /**
  * @brief     read test
@@ -68,6 +70,7 @@ uint8_t sfa30_read_test(sfa30_interface_t interface, uint32_t times)
     DRIVER_SFA30_LINK_IIC_READ_COMMAND(&gs_handle, sfa30_interface_iic_read_cmd);
     DRIVER_SFA30_LINK_DELAY_MS(&gs_handle, sfa30_interface_delay_ms);
     DRIVER_SFA30_LINK_DEBUG_PRINT(&gs_handle, sfa30_interface_debug_print);
+    DRIVER_SFA30_LINK_SCRATCH(&gs_handle, gs_scratch);
     
     /* get information */
     res = sfa30_info(&info);
@@ -135,7 +138,7 @@ uint8_t sfa30_read_test(sfa30_interface_t interface, uint32_t times)
     }
     
     /* delay 2000 ms */
-    sfa30_interface_delay_ms(2000);
+    sfa30_interface_delay_ms(NULL, 2000);
     
     for (i = 0; i < times; i++)
     {
@@ -147,12 +150,24 @@ uint8_t sfa30_read_test(sfa30_interface_t interface, uint32_t times)
             
             return 1;
         }
+#if (SFA30_FLOAT_DATA != 0)
         sfa30_interface_debug_print("sfa30: formaldehyde is %0.2fppb.\n", data.formaldehyde);
         sfa30_interface_debug_print("sfa30: humidity is %0.2f%%.\n", data.humidity);
         sfa30_interface_debug_print("sfa30: temperature is %0.2fC.\n", data.temperature);
+#else
+        sfa30_interface_debug_print("sfa30: formaldehyde is %d.%01dppb.\n",
+                                    (int)(sfa30_formaldehyde_convert_to_ppb_x10(data.formaldehyde_raw) / 10),
+                                    (int)(sfa30_formaldehyde_convert_to_ppb_x10(data.formaldehyde_raw) % 10));
+        sfa30_interface_debug_print("sfa30: humidity is %d.%02d%%.\n",
+                                    (int)(sfa30_humidity_convert_to_rh_x100(data.humidity_raw) / 100),
+                                    (int)(sfa30_humidity_convert_to_rh_x100(data.humidity_raw) % 100));
+        sfa30_interface_debug_print("sfa30: temperature is %s%d.%03dC.\n", (data.temperature_raw < 0) ? "-" : "",
+                                    (int)(labs(sfa30_temperature_convert_to_mc(data.temperature_raw)) / 1000),
+                                    (int)(labs(sfa30_temperature_convert_to_mc(data.temperature_raw)) % 1000));
+#endif
         
         /* delay 2000 ms */
-        sfa30_interface_delay_ms(2000);
+        sfa30_interface_delay_ms(NULL, 2000);
     }
     
     /* stop measurement */